@@ -67,6 +67,11 @@ public:
     virtual void       onSoundEnabledBack()             {}
     virtual void       setRolloff(float rolloff)        {}
     virtual const SFXBuffer* getBuffer() const          { return NULL; }
+    virtual float      getAudibility(const Vec3 &listener) const
+                                                        { return -1.0f; }
+    virtual bool       isReal() const                   { return false; }
+    virtual void       makeReal()                       {}
+    virtual void       makeVirtual()                    {}
 
 };   // DummySFX
 
@@ -0,0 +1,148 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#if HAVE_OGGVORBIS
+
+#include "audio/music_decoder.hpp"
+
+#include "audio/music_ogg.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+#include "utils/vs.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+// ----------------------------------------------------------------------------
+/** Creates the decoder thread. */
+MusicDecoder::MusicDecoder()
+{
+    m_abort.store(false);
+    pthread_mutex_init(&m_mutex, NULL);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    int error = pthread_create(&m_thread, &attr, &MusicDecoder::mainLoop,
+                               this);
+    m_thread_created = error == 0;
+    if (error)
+    {
+        Log::error("MusicDecoder", "Could not create thread, error=%d.",
+                   error);
+    }
+    pthread_attr_destroy(&attr);
+}   // MusicDecoder
+
+// ----------------------------------------------------------------------------
+/** Stops the decoder thread. All streams must have been removed. */
+MusicDecoder::~MusicDecoder()
+{
+    assert(m_streams.empty());
+    m_abort.store(true);
+    if (m_thread_created)
+        pthread_join(m_thread, NULL);
+    pthread_mutex_destroy(&m_mutex);
+}   // ~MusicDecoder
+
+// ----------------------------------------------------------------------------
+/** Adds a stream that was just loaded, so the decoder starts to fill its
+ *  ring buffer.
+ *  \param stream The stream to decode.
+ */
+void MusicDecoder::addStream(MusicOggStream *stream)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (std::find(m_streams.begin(), m_streams.end(), stream) ==
+        m_streams.end())
+        m_streams.push_back(stream);
+    pthread_mutex_unlock(&m_mutex);
+}   // addStream
+
+// ----------------------------------------------------------------------------
+/** Removes a stream. Once this function returns, the decoder thread will
+ *  not access the stream anymore, so it can be released.
+ *  \param stream The stream to remove.
+ */
+void MusicDecoder::removeStream(MusicOggStream *stream)
+{
+    pthread_mutex_lock(&m_mutex);
+    std::vector<MusicOggStream*>::iterator i =
+        std::find(m_streams.begin(), m_streams.end(), stream);
+    if (i != m_streams.end())
+        m_streams.erase(i);
+    pthread_mutex_unlock(&m_mutex);
+}   // removeStream
+
+// ----------------------------------------------------------------------------
+/** Makes sure that at least the specified amount of decoded data is
+ *  available in the ring buffer of a stream, decoding it in the calling
+ *  thread if the decoder thread has not done so yet. This is used when a
+ *  music is started immediately after it was loaded.
+ *  \param stream The stream, which must have been added.
+ *  \param num_bytes Number of bytes of decoded data that are needed.
+ */
+void MusicDecoder::prefetch(MusicOggStream *stream, unsigned int num_bytes)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (stream->getNumDecodedBytes() < num_bytes)
+    {
+        if (stream->decode() == 0)
+            break;
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // prefetch
+
+// ----------------------------------------------------------------------------
+/** Decodes one buffer for each stream that has space left in its ring
+ *  buffer.
+ *  \return True if any data was decoded.
+ */
+bool MusicDecoder::decodeAll()
+{
+    bool decoded = false;
+    pthread_mutex_lock(&m_mutex);
+    for (unsigned int i = 0; i < m_streams.size(); i++)
+    {
+        if (m_streams[i]->decode() > 0)
+            decoded = true;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return decoded;
+}   // decodeAll
+
+// ----------------------------------------------------------------------------
+/** The decoder thread. It decodes one buffer of each stream at a time (so
+ *  that the lock is only held for a short time), and waits a bit once all
+ *  ring buffers are full. Since a ring buffer contains several seconds of
+ *  music, a short wait does not cause any underruns.
+ *  \param obj Pointer to the decoder object.
+ */
+void* MusicDecoder::mainLoop(void *obj)
+{
+    VS::setThreadName("MusicDecoder");
+    MusicDecoder *me = (MusicDecoder*)obj;
+    while (!me->m_abort.load())
+    {
+        if (!me->decodeAll())
+            StkTime::sleep(10);
+    }
+    return NULL;
+}   // mainLoop
+
+#endif   // HAVE_OGGVORBIS
@@ -0,0 +1,73 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MUSIC_DECODER_HPP
+#define HEADER_MUSIC_DECODER_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <pthread.h>
+#include <vector>
+
+class MusicOggStream;
+
+/**
+  * \brief Decodes all loaded ogg music streams in a separate thread.
+  * Decoding ogg data can take a few milliseconds for each buffer, which
+  * used to be done by the sfx thread each time a buffer was played, and
+  * synchronously for the first buffers when the music was started. The
+  * decoder thread instead keeps the PCM ring buffer of each stream that is
+  * loaded full (see MusicOggStream::decode()), independent of whether the
+  * stream is playing or not. This way the start of a music that was loaded
+  * while the track was loading, and the fast music of the last lap, are
+  * already decoded when they are started. The sfx thread then only copies
+  * the decoded data into the openal buffers.
+  * \ingroup audio
+  */
+class MusicDecoder : public NoCopy
+{
+private:
+    /** All streams that are decoded. */
+    std::vector<MusicOggStream*> m_streams;
+
+    /** Protects m_streams. It is also kept locked while streams are being
+     *  decoded, so a stream that was removed is not used anymore. */
+    pthread_mutex_t m_mutex;
+
+    /** The decoder thread. */
+    pthread_t m_thread;
+
+    /** If the thread could be created. */
+    bool m_thread_created;
+
+    /** Set to stop the decoder thread. */
+    std::atomic<bool> m_abort;
+
+    static void* mainLoop(void *obj);
+    bool decodeAll();
+
+public:
+         MusicDecoder();
+        ~MusicDecoder();
+    void addStream(MusicOggStream *stream);
+    void removeStream(MusicOggStream *stream);
+    void prefetch(MusicOggStream *stream, unsigned int num_bytes);
+};   // MusicDecoder
+
+#endif
@@ -138,13 +138,31 @@ void MusicInformation::addMusicToTracks()
 }   // addMusicToTracks
 
 //-----------------------------------------------------------------------------
-/** Starts the music.
+/** Starts the music. If the music was loaded while it was waiting (see
+ *  setMusicWaiting()), the start of the music is already decoded and it is
+ *  not loaded again.
  */
 void MusicInformation::startMusic()
 {
     m_time_since_faster  = 0.0f;
     m_mode               = SOUND_NORMAL;
 
+    if (!m_music_waiting || !m_normal_music)
+        loadMusic();
+    m_music_waiting = false;
+
+    if (!m_normal_music) return;
+    m_normal_music->setVolume(m_gain);
+    m_normal_music->playMusic();
+}   // startMusic
+
+//-----------------------------------------------------------------------------
+/** Loads the normal and (if available) the fast music. Loading a music
+ *  starts decoding it in the background, so the fast music is ready to
+ *  be played by switchToFastMusic().
+ */
+void MusicInformation::loadMusic()
+{
     if (m_normal_filename== "") return;
 
     // First load the 'normal' music
@@ -157,6 +175,7 @@ void MusicInformation::startMusic()
     }
 
     if (m_normal_music) delete m_normal_music;
+    m_normal_music = NULL;
 
 #if HAVE_OGGVORBIS
     m_normal_music = new MusicOggStream(m_normal_loop_start);
@@ -173,17 +192,13 @@ void MusicInformation::startMusic()
                   m_normal_filename.c_str());
         return;
     }
-    m_normal_music->setVolume(m_gain);
-    m_normal_music->playMusic();
 
     // Then (if available) load the music for the last track
     // -----------------------------------------------------
     if (m_fast_music) delete m_fast_music;
+    m_fast_music = NULL;
     if (m_fast_filename == "")
-    {
-        m_fast_music = NULL;
         return;   // no fast music
-    }
 
     if(StringUtils::getExtension(m_fast_filename)!="ogg")
     {
@@ -208,7 +223,7 @@ void MusicInformation::startMusic()
         return;
     }
     m_fast_music->setVolume(m_gain);
-}   // startMusic
+}   // loadMusic
 
 //-----------------------------------------------------------------------------
 void MusicInformation::update(float dt)
@@ -291,7 +306,6 @@ void MusicInformation::resumeMusic()
     if(m_music_waiting)
     {
         startMusic();
-        m_music_waiting = false;
         return;
     }
     if (m_normal_music != NULL) m_normal_music->resumeMusic();
@@ -318,6 +332,9 @@ void MusicInformation::setTemporaryVolume(float volume)
 }
 
 //-----------------------------------------------------------------------------
+/** Fades to the fast music. The fast music was loaded together with the
+ *  normal music, so its start is already decoded.
+ */
 void MusicInformation::switchToFastMusic()
 {
     if(!m_enable_fast) return;
@@ -335,6 +352,18 @@ void MusicInformation::switchToFastMusic()
     }
 }   // switchToFastMusic
 
+//-----------------------------------------------------------------------------
+/** Sets the music to be waiting, i.e. startMusic still needs to be called.
+ *  Used to pre-load track music during track loading time: the music is
+ *  loaded now, so the decoder thread can decode its start before the race
+ *  starts.
+ */
+void MusicInformation::setMusicWaiting()
+{
+    m_music_waiting = true;
+    loadMusic();
+}   // setMusicWaiting
+
 //-----------------------------------------------------------------------------
 
 bool MusicInformation::isPlaying() const
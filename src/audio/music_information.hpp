@@ -86,17 +86,14 @@ private:
     friend class SFXManager;
     void   update(float dt);
     void   startMusic();
+    void   loadMusic();
     void   stopMusic();
     void   pauseMusic();
     void   resumeMusic();
     void   setDefaultVolume();
     void   switchToFastMusic();
     void   setTemporaryVolume(float volume);
-    // ------------------------------------------------------------------------
-    /** Sets the music to be waiting, i.e. startMusic still needs to be
-    *  called. Used to pre-load track music during track loading time. */
-    void setMusicWaiting() { m_music_waiting = true; }
-    // ------------------------------------------------------------------------
+    void   setMusicWaiting();
 
 public:
     LEAK_CHECK()
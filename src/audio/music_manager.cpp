@@ -32,6 +32,7 @@
 #  endif
 #endif
 
+#include "audio/music_decoder.hpp"
 #include "audio/music_ogg.hpp"
 #include "audio/sfx_openal.hpp"
 #include "config/user_config.hpp"
@@ -44,6 +45,7 @@ MusicManager* music_manager= NULL;
 MusicManager::MusicManager()
 {
     m_current_music= NULL;
+    m_decoder      = NULL;
     setMasterMusicVolume(UserConfigParams::m_music_volume);
 
     //FIXME: I'm not sure that this code goes here
@@ -85,6 +87,9 @@ MusicManager::MusicManager()
 #endif
 
     alGetError(); //Called here to clear any non-important errors found
+
+    if (m_initialized)
+        m_decoder = new MusicDecoder();
 #endif
 
     loadMusicInformation();
@@ -101,6 +106,10 @@ MusicManager::~MusicManager()
     }
 
 #if HAVE_OGGVORBIS
+    // The music streams (which use the decoder) were all deleted above.
+    delete m_decoder;
+    m_decoder = NULL;
+
     if(m_initialized)
     {
         ALCcontext* context = alcGetCurrentContext();
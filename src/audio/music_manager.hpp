@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+class MusicDecoder;
 class Vec3;
 
 /**
@@ -49,6 +50,10 @@ private:
                       m_all_music;
     float             m_master_gain;
 
+    /** The thread decoding the ogg music, or NULL if there is no ogg
+     *  support or no sound. */
+    MusicDecoder     *m_decoder;
+
     void              loadMusicInformation();
     void              loadMusicFromOneDir(const std::string& dir);
 
@@ -75,6 +80,9 @@ public:
     /** Returns if the music system is initialised. */
     bool initialized() const { return m_initialized; }
     // ------------------------------------------------------------------------
+    /** Returns the thread that decodes the ogg music (or NULL). */
+    MusicDecoder* getDecoder() { return m_decoder; }
+    // ------------------------------------------------------------------------
     /** Returns the information object of the current music. */
     MusicInformation* getCurrentMusic() { return m_current_music; }
     // ------------------------------------------------------------------------
@@ -20,13 +20,16 @@
 
 #include "audio/music_ogg.hpp"
 
+#include <algorithm>
 #include <stdexcept>
+#include <string.h>
 #ifdef __APPLE__
 #  include <OpenAL/al.h>
 #else
 #  include <AL/al.h>
 #endif
 
+#include "audio/music_decoder.hpp"
 #include "audio/music_manager.hpp"
 #include "audio/sfx_manager.hpp"
 #include "utils/constants.hpp"
@@ -35,11 +38,18 @@
 MusicOggStream::MusicOggStream(float loop_start)
 {
     //m_oggStream= NULL;
-    m_soundBuffers[0] = m_soundBuffers[1]= 0;
-    m_soundSource     = -1;
-    m_pausedMusic     = true;
-    m_playing         = false;
-    m_loop_start      = loop_start;
+    for (int i = 0; i < NUM_BUFFERS; i++)
+        m_soundBuffers[i] = 0;
+    m_soundSource        = -1;
+    m_pausedMusic        = true;
+    m_playing            = false;
+    m_error              = true;
+    m_loop_start         = loop_start;
+    m_num_buffers_played = 0;
+    m_num_underruns      = 0;
+    m_pcm_write.store(0);
+    m_pcm_read.store(0);
+    m_decode_error.store(false);
 }   // MusicOggStream
 
 //-----------------------------------------------------------------------------
@@ -52,7 +62,9 @@ MusicOggStream::~MusicOggStream()
 //-----------------------------------------------------------------------------
 bool MusicOggStream::load(const std::string& filename)
 {
-    if (isPlaying()) stopMusic();
+    // Release a previously loaded music (which also removes it from the
+    // decoder thread).
+    stopMusic();
 
     m_error = true;
     m_fileName = filename;
@@ -112,7 +124,7 @@ bool MusicOggStream::load(const std::string& filename)
     if (m_vorbisInfo->channels == 1) nb_channels = AL_FORMAT_MONO16;
     else                             nb_channels = AL_FORMAT_STEREO16;
 
-    alGenBuffers(2, m_soundBuffers);
+    alGenBuffers(NUM_BUFFERS, m_soundBuffers);
     if (check("alGenBuffers") == false) return false;
 
     alGenSources(1, &m_soundSource);
@@ -125,7 +137,19 @@ bool MusicOggStream::load(const std::string& filename)
     alSourcef (m_soundSource, AL_GAIN,            1.0          );
     alSourcei (m_soundSource, AL_SOURCE_RELATIVE, AL_TRUE      );
 
+    m_pcm.resize(PCM_BUFFER_SIZE);
+    m_pcm_write.store(0);
+    m_pcm_read.store(0);
+    m_decode_error.store(false);
+    m_free_buffers.clear();
+    m_num_buffers_played = 0;
+    m_num_underruns      = 0;
+
     m_error=false;
+
+    // Start decoding now, so that the music is ready once it is played.
+    if (music_manager->getDecoder())
+        music_manager->getDecoder()->addStream(this);
     return true;
 }   // load
 
@@ -156,13 +180,26 @@ bool MusicOggStream::release()
     }
 
     pauseMusic();
+
+    if (m_num_underruns > 0)
+        Log::warn("MusicOgg", "'%s': %u buffers played, %u underruns.",
+                  m_fileName.c_str(), m_num_buffers_played, m_num_underruns);
+    else
+        Log::verbose("MusicOgg", "'%s': %u buffers played, no underruns.",
+                     m_fileName.c_str(), m_num_buffers_played);
     m_fileName= "";
 
+    // Make sure the decoder thread does not access the stream anymore.
+    if (music_manager->getDecoder())
+        music_manager->getDecoder()->removeStream(this);
+
     empty();
     alDeleteSources(1, &m_soundSource);
     check("alDeleteSources");
-    alDeleteBuffers(2, m_soundBuffers);
+    alDeleteBuffers(NUM_BUFFERS, m_soundBuffers);
     check("alDeleteBuffers");
+    m_free_buffers.clear();
+    std::vector<char>().swap(m_pcm);
 
     // Handle error correctly
     if(!m_error) ov_clear(&m_oggStream);
@@ -179,13 +216,24 @@ bool MusicOggStream::playMusic()
     if(isPlaying())
         return true;
 
-    if(!streamIntoBuffer(m_soundBuffers[0]))
+    // Usually the start of the music was decoded by the decoder thread
+    // while the music was waiting to be played, otherwise decode it now.
+    if (music_manager->getDecoder())
+        music_manager->getDecoder()->prefetch(this,
+                                              NUM_BUFFERS * m_buffer_size);
+
+    int num_filled = 0;
+    while (num_filled < NUM_BUFFERS &&
+           fillBuffer(m_soundBuffers[num_filled]))
+        num_filled++;
+    if (num_filled == 0)
         return false;
 
-    if(!streamIntoBuffer(m_soundBuffers[1]))
-        return false;
+    m_free_buffers.clear();
+    for (int i = num_filled; i < NUM_BUFFERS; i++)
+        m_free_buffers.push_back(m_soundBuffers[i]);
 
-    alSourceQueueBuffers(m_soundSource, 2, m_soundBuffers);
+    alSourceQueueBuffers(m_soundSource, num_filled, m_soundBuffers);
 
     alSourcePlay(m_soundSource);
     m_pausedMusic = false;
@@ -275,8 +323,10 @@ void MusicOggStream::update()
         return;
     }
 
+    // If no buffer was queued, the music already ran out of data before.
+    const bool was_starving = (int)m_free_buffers.size() == NUM_BUFFERS;
+
     int processed= 0;
-    bool active= true;
 
     alGetSourcei(m_soundSource, AL_BUFFERS_PROCESSED, &processed);
 
@@ -286,20 +336,22 @@ void MusicOggStream::update()
 
         alSourceUnqueueBuffers(m_soundSource, 1, &buffer);
         if(!check("alSourceUnqueueBuffers")) return;
+        m_free_buffers.push_back(buffer);
+    }
 
-        active = streamIntoBuffer(buffer);
-        if(!active)
-        {
-            // no more data. Seek to loop start (causes the sound to loop)
-            ov_time_seek(&m_oggStream, m_loop_start);
-            active = streamIntoBuffer(buffer);//now there really should be data
-        }
+    // Refill the played buffers with data from the decoder thread.
+    while (!m_free_buffers.empty())
+    {
+        ALuint buffer = m_free_buffers.back();
+        if (!fillBuffer(buffer))
+            break;
+        m_free_buffers.pop_back();
 
         alSourceQueueBuffers(m_soundSource, 1, &buffer);
         if (!check("alSourceQueueBuffers")) return;
     }
 
-    if (active)
+    if ((int)m_free_buffers.size() < NUM_BUFFERS)
     {
         // For debugging
         SFXManager::checkError("before source state");
@@ -308,53 +360,123 @@ void MusicOggStream::update()
         alGetSourcei(m_soundSource, AL_SOURCE_STATE, &state);
         if (state != AL_PLAYING)
         {
-            // Prevent flooding
+            // Prevent flooding (the source is expected to stop after an
+            // underrun, so don't warn in this case).
             static int count = 0;
-            count++;
-            if (count<10)
+            if (!was_starving && ++count < 10)
                 Log::warn("MusicOgg", "Music not playing when it should be. "
                           "Source state: %d", state);
-            alGetSourcei(m_soundSource, AL_BUFFERS_PROCESSED, &processed);
             alSourcePlay(m_soundSource);
         }
     }
-    else
+    else if (!was_starving)
     {
-        Log::warn("MusicOgg", "Attempt to stream music into buffer failed "
-                              "twice in a row.");
+        // All buffers were played, and no decoded data is available.
+        m_num_underruns++;
+        if (m_decode_error.load())
+            Log::warn("MusicOgg", "No more music data for '%s'.",
+                      m_fileName.c_str());
     }
 }   // update
 
 //-----------------------------------------------------------------------------
-bool MusicOggStream::streamIntoBuffer(ALuint buffer)
+/** Copies the next decoded data from the ring buffer into an openal buffer.
+ *  Called from the sfx thread.
+ *  \param buffer The openal buffer to fill.
+ *  \return False if no decoded data is available.
+ */
+bool MusicOggStream::fillBuffer(ALuint buffer)
 {
-    char pcm[m_buffer_size];
-    const int isBigEndian = (IS_LITTLE_ENDIAN ? 0 : 1);
+    const unsigned int read = m_pcm_read.load(std::memory_order_relaxed);
+    const unsigned int available =
+        m_pcm_write.load(std::memory_order_acquire) - read;
+    if (available == 0) return false;
+
+    const unsigned int size = std::min(available,
+                                       (unsigned int)m_buffer_size);
+    const unsigned int offset = read & (PCM_BUFFER_SIZE - 1);
+    if (offset + size <= PCM_BUFFER_SIZE)
+    {
+        alBufferData(buffer, nb_channels, &m_pcm[offset], size,
+                     m_vorbisInfo->rate);
+    }
+    else
+    {
+        // The data wraps around the end of the ring buffer.
+        char pcm[m_buffer_size];
+        const unsigned int first = PCM_BUFFER_SIZE - offset;
+        memcpy(pcm, &m_pcm[offset], first);
+        memcpy(pcm + first, &m_pcm[0], size - first);
+        alBufferData(buffer, nb_channels, pcm, size, m_vorbisInfo->rate);
+    }
+    check("alBufferData");
 
-    int  size = 0;
+    m_pcm_read.store(read + size, std::memory_order_release);
+    m_num_buffers_played++;
+    return true;
+}   // fillBuffer
+
+//-----------------------------------------------------------------------------
+/** Decodes one buffer of ogg data into the ring buffer, if there is enough
+ *  space. At the end of the file decoding continues at the loop start, so
+ *  the ring buffer always contains the music to be played next. Called
+ *  by the MusicDecoder (with its lock held).
+ *  \return Number of bytes decoded.
+ */
+unsigned int MusicOggStream::decode()
+{
+    if (m_decode_error.load(std::memory_order_relaxed))
+        return 0;
+
+    const unsigned int write = m_pcm_write.load(std::memory_order_relaxed);
+    const unsigned int used  =
+        write - m_pcm_read.load(std::memory_order_acquire);
+    if (PCM_BUFFER_SIZE - used < (unsigned int)m_buffer_size)
+        return 0;
+
+    const int isBigEndian = (IS_LITTLE_ENDIAN ? 0 : 1);
+    unsigned int size = 0;
+    bool at_loop_start = false;
     int  portion;
 
-    while(size < m_buffer_size)
+    while (size < (unsigned int)m_buffer_size)
     {
-        int result = ov_read(&m_oggStream, pcm + size, m_buffer_size - size,
-                         isBigEndian, 2, 1, &portion);
-
-        if(result > 0)
+        const unsigned int offset = (write + size) & (PCM_BUFFER_SIZE - 1);
+        const unsigned int max = std::min(m_buffer_size - size,
+                                          PCM_BUFFER_SIZE - offset);
+        long result = ov_read(&m_oggStream, &m_pcm[offset], max,
+                              isBigEndian, 2, 1, &portion);
+        if (result > 0)
+        {
             size += result;
-        else
-            if(result < 0)
-                throw errorString(result);
-            else
+            at_loop_start = false;
+        }
+        else if (result == 0 && !at_loop_start)
+        {
+            // no more data. Seek to loop start (causes the sound to loop)
+            if (ov_time_seek(&m_oggStream, m_loop_start) != 0)
+            {
+                Log::error("MusicOgg", "Can not seek to loop start in '%s'.",
+                           m_fileName.c_str());
+                m_decode_error.store(true);
                 break;
+            }
+            at_loop_start = true;
+        }
+        else
+        {
+            Log::error("MusicOgg", "Decoding '%s' failed: %s",
+                       m_fileName.c_str(),
+                       result == 0 ? "No data after loop start."
+                                   : errorString(result).c_str());
+            m_decode_error.store(true);
+            break;
+        }
     }
 
-    if(size == 0) return false;
-
-    alBufferData(buffer, nb_channels, pcm, size, m_vorbisInfo->rate);
-    check("alBufferData");
-
-    return true;
-}   // streamIntoBuffer
+    m_pcm_write.store(write + size, std::memory_order_release);
+    return size;
+}   // decode
 
 //-----------------------------------------------------------------------------
 bool MusicOggStream::check(const char* what)
@@ -21,7 +21,9 @@
 
 #if HAVE_OGGVORBIS
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include <ogg/ogg.h>
 // Disable warning about potential loss of precision in vorbisfile.h
@@ -42,6 +44,9 @@
 
 /**
   * \brief ogg files based implementation of the Music interface
+  * The ogg data is decoded by the MusicDecoder thread into a ring buffer
+  * as soon as the music is loaded. The sfx thread only copies the decoded
+  * data into the openal buffers when they are played (see update()).
   * \ingroup audio
   */
 class MusicOggStream : public Music
@@ -68,8 +73,18 @@ protected:
     std::string errorString(int code);
 
 private:
-    bool release();
-    bool streamIntoBuffer(ALuint buffer);
+    friend class MusicDecoder;
+
+    bool         release();
+    bool         fillBuffer(ALuint buffer);
+    unsigned int decode();
+    // ------------------------------------------------------------------------
+    /** Returns the number of bytes decoded and not yet played. */
+    unsigned int getNumDecodedBytes() const
+    {
+        return m_pcm_write.load(std::memory_order_acquire)
+             - m_pcm_read.load(std::memory_order_acquire);
+    }   // getNumDecodedBytes
 
     float           m_loop_start;
     std::string     m_fileName;
@@ -80,13 +95,37 @@ private:
 
     bool            m_playing;
 
-    ALuint m_soundBuffers[2];
+    /** Number of openal buffers queued. */
+    static const int NUM_BUFFERS = 4;
+
+    ALuint m_soundBuffers[NUM_BUFFERS];
     ALuint m_soundSource;
     ALenum nb_channels;
 
+    /** Openal buffers that were played, but could not be refilled yet
+     *  since not enough data was decoded. */
+    std::vector<ALuint> m_free_buffers;
+
     bool m_pausedMusic;
 
-    //one full second of audio at 44100 samples per second
+    /** Ring buffer with the decoded data, about 6 seconds of stereo music.
+     *  It is filled by the decoder thread, and read by the sfx thread. */
+    static const unsigned int PCM_BUFFER_SIZE = 1 << 20;
+    std::vector<char> m_pcm;
+
+    /** Total number of bytes decoded and played. The ring buffer index is
+     *  the value modulo PCM_BUFFER_SIZE. */
+    std::atomic<unsigned int> m_pcm_write, m_pcm_read;
+
+    /** Set by the decoder thread if decoding failed. */
+    std::atomic<bool> m_decode_error;
+
+    /** Statistics: number of buffers queued, and number of times a played
+     *  buffer could not be refilled since no decoded data was available. */
+    unsigned int m_num_buffers_played;
+    unsigned int m_num_underruns;
+
+    //a quarter of a second of stereo audio at 44100 samples per second
     static const int m_buffer_size = 11025*4;
 };
 
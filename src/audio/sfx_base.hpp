@@ -21,6 +21,7 @@
 #define HEADER_SFX_HPP
 
 #include "audio/sfx_manager.hpp"
+#include "audio/voice_manager.hpp"
 #include "utils/no_copy.hpp"
 
 /**
@@ -36,10 +37,11 @@ class Vec3;
  *  manager, which is shared between all instances. Do create a new sound
  *  effect object, use sfx_manager->getSFX(...); do not create an instance
  *  with new, since SFXManager makes sure to stop/restart all SFX (esp.
- *  looping sfx like engine sounds) when necessary.
+ *  looping sfx like engine sounds) when necessary. The VoiceManager
+ *  decides which sound effects get a real sound source.
  * \ingroup audio
  */
-class SFXBase : public NoCopy
+class SFXBase : public NoCopy, public VoiceManager::Voice
 {
 public:
     /** Status of a sound effect. */
@@ -40,11 +40,15 @@ class XMLNode;
 
 /**
  * \brief The buffer (data) for one kind of sound effects
+ * The data is only loaded once a sound effect using this buffer is
+ * initialised, and shared with all buffers using the same file, see
+ * SFXBufferCache.
  * \ingroup audio
  */
 class SFXBuffer
 {
 private:
+    friend class SFXBufferCache;
 
     LEAK_CHECK()
 
@@ -72,7 +76,9 @@ private:
     /** Duration of the sfx. */
     float    m_duration;
 
-    bool loadVorbisBuffer(const std::string &name, ALuint buffer);
+    /** Number of users (usually sound effects) that loaded this buffer.
+     *  Protected by the mutex of the SFXBufferCache. */
+    int      m_num_users;
 
 public:
 
@@ -90,6 +96,7 @@ public:
 
 
     bool load();
+    void release();
     void unload();
 
     // ------------------------------------------------------------------------
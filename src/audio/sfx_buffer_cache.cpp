@@ -0,0 +1,327 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "audio/sfx_buffer_cache.hpp"
+
+#include "audio/sfx_manager.hpp"
+#include "config/user_config.hpp"
+#include "utils/constants.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#if HAVE_OGGVORBIS
+#  include <vorbis/codec.h>
+#  include <vorbis/vorbisfile.h>
+#  ifdef __APPLE__
+#    include <OpenAL/al.h>
+#  else
+#    include <AL/al.h>
+#  endif
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+//----------------------------------------------------------------------------
+SFXBufferCache::SFXBufferCache()
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    int budget_mb = UserConfigParams::m_sfx_cache_size;
+    if (budget_mb < 0) budget_mb = 0;
+    m_budget      = (unsigned int)budget_mb * 1024 * 1024;
+    m_total_size  = 0;
+    m_use_counter = 0;
+    m_num_decoded = 0;
+    m_num_hits    = 0;
+    m_num_evicted = 0;
+    m_peak_size   = 0;
+    m_decode_time = 0.0;
+}   // SFXBufferCache
+
+//----------------------------------------------------------------------------
+/** Frees all openal buffers. All sound effects must have been deleted. */
+SFXBufferCache::~SFXBufferCache()
+{
+#if HAVE_OGGVORBIS
+    std::map<std::string, CacheEntry>::iterator i;
+    for (i = m_entries.begin(); i != m_entries.end(); i++)
+        alDeleteBuffers(1, &i->second.m_buffer);
+#endif
+    m_entries.clear();
+    pthread_mutex_destroy(&m_mutex);
+}   // ~SFXBufferCache
+
+//----------------------------------------------------------------------------
+/** Adds a user to a buffer. If it is the first user, the buffer gets the
+ *  openal buffer of its file, which is decoded if it is not in the cache.
+ *  \param buffer The buffer to load.
+ *  \return True if the buffer is loaded.
+ */
+bool SFXBufferCache::addUser(SFXBuffer *buffer)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (buffer->m_num_users > 0)
+    {
+        buffer->m_num_users++;
+        pthread_mutex_unlock(&m_mutex);
+        return true;
+    }
+
+    std::map<std::string, CacheEntry>::iterator i =
+        m_entries.find(buffer->m_file);
+    if (i != m_entries.end())
+    {
+        m_num_hits++;
+    }
+    else
+    {
+        CacheEntry entry;
+        const double start = StkTime::getRealTime();
+        if (!decodeFile(buffer->m_file, &entry))
+        {
+            pthread_mutex_unlock(&m_mutex);
+            Log::error("SFXBuffer", "Could not load sound effect %s",
+                       buffer->m_file.c_str());
+            return false;
+        }
+        m_decode_time += StkTime::getRealTime() - start;
+        m_num_decoded++;
+        m_total_size += entry.m_size;
+        if (m_total_size > m_peak_size)
+            m_peak_size = m_total_size;
+        i = m_entries.insert(std::make_pair(buffer->m_file, entry)).first;
+    }
+
+    CacheEntry &entry = i->second;
+    entry.m_ref_count++;
+    entry.m_last_used = m_use_counter++;
+
+    buffer->m_buffer    = entry.m_buffer;
+    buffer->m_loaded    = true;
+    buffer->m_num_users = 1;
+    // Allow the xml data to overwrite the duration.
+    if (buffer->m_duration < 0)
+        buffer->m_duration = entry.m_duration;
+
+    // Adding an entry can exceed the budget.
+    evictUnused();
+    pthread_mutex_unlock(&m_mutex);
+    return true;
+}   // addUser
+
+//----------------------------------------------------------------------------
+/** Removes a user from a buffer. If it was the last user, the openal buffer
+ *  of its file is not used by this buffer anymore, but stays in the cache
+ *  (unless the cache is too big).
+ *  \param buffer The buffer.
+ */
+void SFXBufferCache::removeUser(SFXBuffer *buffer)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (buffer->m_num_users > 0 && --buffer->m_num_users == 0)
+    {
+        buffer->m_loaded = false;
+        buffer->m_buffer = 0;
+        releaseEntry(buffer->m_file);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // removeUser
+
+//----------------------------------------------------------------------------
+/** Removes all users of a buffer, i.e. the buffer is not loaded anymore.
+ *  \param buffer The buffer.
+ */
+void SFXBufferCache::removeAllUsers(SFXBuffer *buffer)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (buffer->m_num_users > 0)
+    {
+        buffer->m_num_users = 0;
+        buffer->m_loaded    = false;
+        buffer->m_buffer    = 0;
+        releaseEntry(buffer->m_file);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // removeAllUsers
+
+//----------------------------------------------------------------------------
+/** Decreases the reference count of a file, and frees unused buffers if the
+ *  cache is too big. Must be called with the mutex locked.
+ *  \param file The file name.
+ */
+void SFXBufferCache::releaseEntry(const std::string &file)
+{
+    std::map<std::string, CacheEntry>::iterator i = m_entries.find(file);
+    assert(i != m_entries.end());
+    if (i == m_entries.end()) return;
+    i->second.m_ref_count--;
+    i->second.m_last_used = m_use_counter++;
+    evictUnused();
+}   // releaseEntry
+
+//----------------------------------------------------------------------------
+/** Frees the least recently used unused buffers until the total size is
+ *  within the budget, or no unused buffers are left. Must be called with
+ *  the mutex locked.
+ */
+void SFXBufferCache::evictUnused()
+{
+    while (m_total_size > m_budget)
+    {
+        std::map<std::string, CacheEntry>::iterator oldest = m_entries.end();
+        std::map<std::string, CacheEntry>::iterator i;
+        for (i = m_entries.begin(); i != m_entries.end(); i++)
+        {
+            if (i->second.m_ref_count > 0) continue;
+            if (oldest == m_entries.end() ||
+                i->second.m_last_used < oldest->second.m_last_used)
+                oldest = i;
+        }
+        if (oldest == m_entries.end())
+            return;
+
+#if HAVE_OGGVORBIS
+        alDeleteBuffers(1, &oldest->second.m_buffer);
+#endif
+        m_total_size -= oldest->second.m_size;
+        m_num_evicted++;
+        m_entries.erase(oldest);
+    }
+}   // evictUnused
+
+//----------------------------------------------------------------------------
+/** Loads a vorbis file into a new OpenAL buffer
+ *  based on a routine by Peter Mulholland, used with permission (quote :
+ *  "Feel free to use")
+ *  \param name The file name.
+ *  \param entry The cache entry to fill in.
+ */
+bool SFXBufferCache::decodeFile(const std::string &name, CacheEntry *entry)
+{
+#if HAVE_OGGVORBIS
+    const int ogg_endianness = (IS_LITTLE_ENDIAN ? 0 : 1);
+
+    FILE *file;
+    vorbis_info *info;
+    OggVorbis_File oggFile;
+
+    alGetError(); // clear errors from previously
+
+    file = fopen(name.c_str(), "rb");
+
+    if(!file)
+    {
+        Log::error("SFXBuffer", "LoadVorbisBuffer() - couldn't open file!");
+        return false;
+    }
+
+    if (ov_open_callbacks(file, &oggFile, NULL, 0,  OV_CALLBACKS_NOCLOSE) != 0)
+    {
+        fclose(file);
+        Log::error("SFXBuffer", "LoadVorbisBuffer() - ov_open_callbacks() failed, "
+                                "file isn't vorbis?");
+        return false;
+    }
+
+    info = ov_info(&oggFile, -1);
+
+    // always 16 bit data
+    long len = (long)ov_pcm_total(&oggFile, -1) * info->channels * 2;
+
+    char *data = (char *) malloc(len);
+    if(!data)
+    {
+        ov_clear(&oggFile);
+        fclose(file);
+        Log::error("SFXBuffer", "[SFXBuffer] Could not allocate decode buffer.");
+        return false;
+    }
+
+    int bs = -1;
+    long todo = len;
+    char *bufpt = data;
+
+    while (todo)
+    {
+        int read = ov_read(&oggFile, bufpt, todo, ogg_endianness, 2, 1, &bs);
+        if (read <= 0)
+        {
+            // Truncated or broken file, only use the data read so far.
+            len -= todo;
+            break;
+        }
+        todo -= read;
+        bufpt += read;
+    }
+
+    alGenBuffers(1, &entry->m_buffer);
+    if (!SFXManager::checkError("generating a buffer"))
+    {
+        free(data);
+        ov_clear(&oggFile);
+        fclose(file);
+        return false;
+    }
+
+    alBufferData(entry->m_buffer, (info->channels == 1) ? AL_FORMAT_MONO16
+                                                        : AL_FORMAT_STEREO16,
+                 data, len, info->rate);
+    entry->m_size      = (unsigned int)len;
+    entry->m_duration  = float(len) / (info->rate * info->channels * 2);
+    entry->m_ref_count = 0;
+    entry->m_last_used = 0;
+
+    free(data);
+
+    ov_clear(&oggFile);
+    fclose(file);
+
+    if (!SFXManager::checkError("filling a buffer"))
+    {
+        alDeleteBuffers(1, &entry->m_buffer);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}   // decodeFile
+
+//----------------------------------------------------------------------------
+/** Prints how many files were decoded and how much memory they use. Before
+ *  the cache all sound effects were decoded at startup.
+ */
+void SFXBufferCache::printStatistics() const
+{
+    pthread_mutex_lock(&m_mutex);
+    unsigned int num_used = 0;
+    std::map<std::string, CacheEntry>::const_iterator i;
+    for (i = m_entries.begin(); i != m_entries.end(); i++)
+    {
+        if (i->second.m_ref_count > 0)
+            num_used++;
+    }
+    Log::verbose("SFXBufferCache", "%u files decoded in %.1f ms, %u cache "
+                 "hits, %u evicted.", m_num_decoded, m_decode_time*1000.0,
+                 m_num_hits, m_num_evicted);
+    Log::verbose("SFXBufferCache", "%u files cached (%u in use), %u KB, "
+                 "peak %u KB, budget %u KB.", (unsigned int)m_entries.size(),
+                 num_used, m_total_size/1024, m_peak_size/1024,
+                 m_budget/1024);
+    pthread_mutex_unlock(&m_mutex);
+}   // printStatistics
@@ -0,0 +1,96 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SFX_BUFFER_CACHE_HPP
+#define HEADER_SFX_BUFFER_CACHE_HPP
+
+#include "audio/sfx_buffer.hpp"
+#include "utils/no_copy.hpp"
+
+#include <map>
+#include <pthread.h>
+#include <string>
+
+/**
+ * \brief Loads the data of sound effects on demand and shares it.
+ * The decoded data of a sound file is only loaded into an openal buffer
+ * when a sound effect using it is initialised (see SFXBuffer::load()).
+ * All SFXBuffers using the same file share one openal buffer, which is
+ * reference counted. Once a file is not used anymore its buffer is kept
+ * in the cache, so it does not need to be decoded again if it is used
+ * later, but the least recently used unused buffers are freed if the total
+ * size of all buffers exceeds a budget (see the sfx_cache_size user config
+ * option). Buffers in use are never freed.
+ * Buffers can be loaded from the sfx thread and the main thread, so all
+ * functions are protected by a mutex.
+ * \ingroup audio
+ */
+class SFXBufferCache : public NoCopy
+{
+private:
+    /** The data of one sound file. */
+    struct CacheEntry
+    {
+        /** The openal buffer with the decoded data. */
+        ALuint       m_buffer;
+        /** Size of the decoded data in bytes. */
+        unsigned int m_size;
+        /** Duration of the sound in seconds. */
+        float        m_duration;
+        /** Number of SFXBuffers using this entry. */
+        int          m_ref_count;
+        /** Value of m_use_counter when this entry was last used. */
+        unsigned int m_last_used;
+    };   // CacheEntry
+
+    /** All loaded sound files, indexed by file name. */
+    std::map<std::string, CacheEntry> m_entries;
+
+    /** Protects all data of the cache and the load state of all buffers. */
+    mutable pthread_mutex_t m_mutex;
+
+    /** Maximum size in bytes of all buffers before unused ones are freed. */
+    unsigned int m_budget;
+
+    /** Total size of all buffers. */
+    unsigned int m_total_size;
+
+    /** Incremented each time an entry is used, for the LRU order. */
+    unsigned int m_use_counter;
+
+    /** Statistics. */
+    unsigned int m_num_decoded;
+    unsigned int m_num_hits;
+    unsigned int m_num_evicted;
+    unsigned int m_peak_size;
+    double       m_decode_time;
+
+    bool decodeFile(const std::string &file, CacheEntry *entry);
+    void releaseEntry(const std::string &file);
+    void evictUnused();
+
+public:
+         SFXBufferCache();
+        ~SFXBufferCache();
+    bool addUser(SFXBuffer *buffer);
+    void removeUser(SFXBuffer *buffer);
+    void removeAllUsers(SFXBuffer *buffer);
+    void printStatistics() const;
+};   // SFXBufferCache
+
+#endif
@@ -22,7 +22,6 @@
 #include "audio/sfx_buffer.hpp"
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
-#include "modes/world.hpp"
 #include "race/race_manager.hpp"
 #include "utils/vs.hpp"
 
@@ -71,6 +70,7 @@ void SFXManager::destroy()
 /** Initialises the SFX manager and loads the sfx from a config file.
  */
 SFXManager::SFXManager()
+          : m_voice_manager(UserConfigParams::m_max_sfx_voices)
 {
 
     // The sound manager initialises OpenAL
@@ -83,6 +83,16 @@ SFXManager::SFXManager()
     m_listener_front              = Vec3(0, 0, 1);
     m_listener_up                 = Vec3(0, 1, 0);
 
+    // The sfx manager is created by the main thread.
+    m_main_thread    = pthread_self();
+    m_read_index     = 0;
+    m_write_index    = 0;
+    m_staged_index   = 0;
+    m_num_enqueued   = 0;
+    m_num_coalesced  = 0;
+    m_num_dropped    = 0;
+    m_thread_started.setAtomic(false);
+
     loadSfx();
 
     pthread_cond_init(&m_cond_request, NULL);
@@ -111,9 +121,6 @@ SFXManager::SFXManager()
     pthread_attr_destroy(&attr);
 
     setMasterSFXVolume( UserConfigParams::m_sfx_volume );
-    m_sfx_commands.lock();
-    m_sfx_commands.getData().clear();
-    m_sfx_commands.unlock();
 
 }  // SoundManager
 
@@ -176,8 +183,7 @@ SFXManager::~SFXManager()
  */
 void SFXManager::queue(SFXCommands command,  SFXBase *sfx)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, sfx));
 }   // queue
 
 //----------------------------------------------------------------------------
@@ -190,8 +196,7 @@ void SFXManager::queue(SFXCommands command,  SFXBase *sfx)
  */
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx, f);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, sfx, f));
 }   // queue(float)
 
 //----------------------------------------------------------------------------
@@ -204,8 +209,7 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f)
  */
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, const Vec3 &p)
 {
-   SFXCommand *sfx_command = new SFXCommand(command, sfx, p);
-   queueCommand(sfx_command);
+   queueCommand(SFXCommand(command, sfx, p));
 }   // queue (Vec3)
 
 //----------------------------------------------------------------------------
@@ -220,8 +224,7 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, const Vec3 &p)
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f,
                        const Vec3 &p)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx, f, p);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, sfx, f, p));
 }   // queue(float, Vec3)
 
 //----------------------------------------------------------------------------
@@ -230,8 +233,7 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f,
  */
 void SFXManager::queue(SFXCommands command, MusicInformation *mi)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, mi);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, mi));
 }   // queue(MusicInformation)
 //----------------------------------------------------------------------------
 /** Queues a command for the music manager that takes a floating point value
@@ -241,53 +243,117 @@ void SFXManager::queue(SFXCommands command, MusicInformation *mi)
  */
 void SFXManager::queue(SFXCommands command, MusicInformation *mi, float f)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, mi, f);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, mi, f));
 }   // queue(MusicInformation)
 
 //----------------------------------------------------------------------------
-/** Enqueues a command to the sfx queue threadsafe. Then signal the
- *  sfx manager to wake up.
- *  \param command Pointer to the command to queue up.
+/** Adds a command to the queue of the sfx thread. This must only be called
+ *  from the main thread. Position and speed updates are not handed to the
+ *  sfx thread immediately: if the same sfx gets another update of the same
+ *  kind before, the previous update is just replaced (e.g. during a rewind,
+ *  which updates the engine sounds of all karts for each resimulated tick).
+ *  If the queue is full, position and speed updates are dropped, all other
+ *  commands wait until the sfx thread has executed some commands.
+ *  \param command The command to queue up.
  */
-void SFXManager::queueCommand(SFXCommand *command)
+void SFXManager::queueCommand(const SFXCommand &command)
 {
-    m_sfx_commands.lock();
-    if(World::getWorld() && 
-        m_sfx_commands.getData().size() > 20*race_manager->getNumberOfKarts()+20 &&
-        race_manager->getMinorMode() != RaceManager::MINOR_MODE_CUTSCENE)
+    assert(pthread_equal(pthread_self(), m_main_thread));
+    m_num_enqueued++;
+
+    const bool is_update = command.m_command == SFX_POSITION ||
+                           command.m_command == SFX_SPEED    ||
+                           command.m_command == SFX_SPEED_POSITION;
+    const unsigned int published =
+        m_write_index.load(std::memory_order_relaxed);
+    if (is_update)
+    {
+        // Only position and speed updates are staged, so if the latest
+        // staged command for this sfx is of the same kind, it can be
+        // replaced without changing the result.
+        for (unsigned int i = m_staged_index; i != published; i--)
+        {
+            SFXCommand &staged = m_commands[(i-1) & (COMMAND_QUEUE_SIZE-1)];
+            if (staged.m_sfx != command.m_sfx) continue;
+            if (staged.m_command == command.m_command)
+            {
+                staged.m_parameter = command.m_parameter;
+                m_num_coalesced++;
+                return;
+            }
+            break;
+        }
+    }
+
+    while (m_staged_index - m_read_index.load(std::memory_order_acquire)
+           >= COMMAND_QUEUE_SIZE)
     {
-        if(command->m_command==SFX_POSITION || command->m_command==SFX_LOOP ||
-           command->m_command==SFX_SPEED    || 
-           command->m_command==SFX_SPEED_POSITION                               )
+        if (is_update)
         {
-            delete command;
+            m_num_dropped++;
             static int count_messages = 0;
-            if(count_messages < 5)
+            if (count_messages < 5)
             {
-                Log::warn("SFXManager", "Throttling sfx - queue size %d",
-                         m_sfx_commands.getData().size());
+                Log::warn("SFXManager", "Throttling sfx - queue is full.");
                 count_messages++;
             }
-            m_sfx_commands.unlock();
             return;
-        }   // if throttling
+        }
+        // Make sure the sfx thread is running and can see all commands,
+        // then give it time to execute some of them.
+        publishCommands();
+        startThread();
+        StkTime::sleep(1);
     }
-    m_sfx_commands.getData().push_back(command);
-    m_sfx_commands.unlock();
+
+    m_commands[m_staged_index & (COMMAND_QUEUE_SIZE-1)] = command;
+    m_staged_index++;
+    if (!is_update || m_staged_index - published >= MAX_STAGED_COMMANDS)
+        publishCommands();
 }   // queueCommand
 
 //----------------------------------------------------------------------------
-/** Puts a NULL request into the queue, which will trigger the thread to
+/** Makes all queued commands visible to the sfx thread.
+ */
+void SFXManager::publishCommands()
+{
+    m_write_index.store(m_staged_index, std::memory_order_release);
+}   // publishCommands
+
+//----------------------------------------------------------------------------
+/** Wakes up the sfx thread the first time. Until then the thread just waits,
+ *  afterwards it checks the queue for new commands every millisecond.
+ */
+void SFXManager::startThread()
+{
+    m_thread_started.lock();
+    m_thread_started.getData() = true;
+    pthread_cond_signal(&m_cond_request);
+    m_thread_started.unlock();
+}   // startThread
+
+//----------------------------------------------------------------------------
+/** Puts an exit request into the queue, which will trigger the thread to
  *  exit.
  */
 void SFXManager::stopThread()
 {
     queue(SFX_EXIT);
     // Make sure the thread wakes up.
-    pthread_cond_signal(&m_cond_request);
+    startThread();
 }   // stopThread
 
+//----------------------------------------------------------------------------
+/** Prints the number of commands queued, combined and dropped. */
+void SFXManager::printStatistics() const
+{
+    Log::verbose("SFXManager", "%u commands queued, %u position/speed "
+                 "updates combined, %u dropped.", m_num_enqueued,
+                 m_num_coalesced, m_num_dropped);
+    m_voice_manager.printStatistics();
+    m_buffer_cache.printStatistics();
+}   // printStatistics
+
 //----------------------------------------------------------------------------
 /** This loops runs in a different threads, and starts sfx to be played.
  *  This can sometimes take up to 5 ms, so it needs to be handled in a thread
@@ -301,120 +367,103 @@ void* SFXManager::mainLoop(void *obj)
 
     pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 
-    me->m_sfx_commands.lock();
-
-    // Wait till we have an empty sfx in the queue
-    while (me->m_sfx_commands.getData().empty() ||
-           me->m_sfx_commands.getData().front()->m_command!=SFX_EXIT)
+    // Wait till the first update (or exit) request. The 'while' is necessary
+    // since "spurious wakeups from the pthread_cond_wait ... may occur"
+    // (pthread_cond_wait man page)!
+    me->m_thread_started.lock();
+    while (!me->m_thread_started.getData())
     {
-        bool empty = me->m_sfx_commands.getData().empty();
+        pthread_cond_wait(&me->m_cond_request,
+                          me->m_thread_started.getMutex());
+    }
+    me->m_thread_started.unlock();
 
-        // Wait in cond_wait for a request to arrive. The 'while' is necessary
-        // since "spurious wakeups from the pthread_cond_wait ... may occur"
-        // (pthread_cond_wait man page)!
-        while (empty)
+    while (true)
+    {
+        const unsigned int read =
+            me->m_read_index.load(std::memory_order_relaxed);
+        if (read == me->m_write_index.load(std::memory_order_acquire))
         {
-            pthread_cond_wait(&me->m_cond_request, me->m_sfx_commands.getMutex());
-            empty = me->m_sfx_commands.getData().empty();
+            // Wait some time to let other threads run, then update to
+            // keep music playing.
+            StkTime::sleep(1);
+            me->reallyUpdateNow();
+            continue;
         }
-        SFXCommand *current = me->m_sfx_commands.getData().front();
-        me->m_sfx_commands.getData().erase(me->m_sfx_commands.getData().begin());
+        // Copy the command, so that its slot can be reused immediately.
+        const SFXCommand current =
+            me->m_commands[read & (COMMAND_QUEUE_SIZE-1)];
+        me->m_read_index.store(read + 1, std::memory_order_release);
 
-        if (current->m_command == SFX_EXIT)
-        {
-            delete current;
+        if (current.m_command == SFX_EXIT)
             break;
-        }
-        me->m_sfx_commands.unlock();
-        switch (current->m_command)
+
+        switch (current.m_command)
         {
-        case SFX_PLAY:     current->m_sfx->reallyPlayNow();       break;
+        case SFX_PLAY:     current.m_sfx->reallyPlayNow();       break;
         case SFX_PLAY_POSITION:
-            current->m_sfx->reallyPlayNow(current->m_parameter);  break;
-        case SFX_STOP:     current->m_sfx->reallyStopNow();       break;
-        case SFX_PAUSE:    current->m_sfx->reallyPauseNow();      break;
-        case SFX_RESUME:   current->m_sfx->reallyResumeNow();     break;
-        case SFX_SPEED:    current->m_sfx->reallySetSpeed(
-                                  current->m_parameter.getX());   break;
-        case SFX_POSITION: current->m_sfx->reallySetPosition(
-                                         current->m_parameter);   break;
-        case SFX_SPEED_POSITION: current->m_sfx->reallySetSpeedPosition(
+            current.m_sfx->reallyPlayNow(current.m_parameter);  break;
+        case SFX_STOP:     current.m_sfx->reallyStopNow();       break;
+        case SFX_PAUSE:    current.m_sfx->reallyPauseNow();      break;
+        case SFX_RESUME:   current.m_sfx->reallyResumeNow();     break;
+        case SFX_SPEED:    current.m_sfx->reallySetSpeed(
+                                  current.m_parameter.getX());   break;
+        case SFX_POSITION: current.m_sfx->reallySetPosition(
+                                         current.m_parameter);   break;
+        case SFX_SPEED_POSITION: current.m_sfx->reallySetSpeedPosition(
                                          // Extract float from W component
-                                         current->m_parameter.getW(),
-                                         current->m_parameter);   break;
-        case SFX_VOLUME:   current->m_sfx->reallySetVolume(
-                                  current->m_parameter.getX());   break;
+                                         current.m_parameter.getW(),
+                                         current.m_parameter);   break;
+        case SFX_VOLUME:   current.m_sfx->reallySetVolume(
+                                  current.m_parameter.getX());   break;
         case SFX_MASTER_VOLUME:
-            current->m_sfx->reallySetMasterVolumeNow(
-                                  current->m_parameter.getX());   break;
-        case SFX_LOOP:     current->m_sfx->reallySetLoop(
-                             current->m_parameter.getX() != 0);   break;
-        case SFX_DELETE:     me->deleteSFX(current->m_sfx);       break;
-        case SFX_PAUSE_ALL:  me->reallyPauseAllNow();             break;
-        case SFX_RESUME_ALL: me->reallyResumeAllNow();            break;
-        case SFX_LISTENER:   me->reallyPositionListenerNow();     break;
-        case SFX_UPDATE:     me->reallyUpdateNow(current);        break;
+            current.m_sfx->reallySetMasterVolumeNow(
+                                  current.m_parameter.getX());   break;
+        case SFX_LOOP:     current.m_sfx->reallySetLoop(
+                             current.m_parameter.getX() != 0);   break;
+        case SFX_DELETE:     me->deleteSFX(current.m_sfx);       break;
+        case SFX_PAUSE_ALL:  me->reallyPauseAllNow();            break;
+        case SFX_RESUME_ALL: me->reallyResumeAllNow();           break;
+        case SFX_LISTENER:   me->reallyPositionListenerNow();    break;
+        case SFX_UPDATE:
+            me->reallyUpdateNow();
+            me->updateVoices();                                  break;
         case SFX_MUSIC_START:
         {
-            current->m_music_information->setDefaultVolume();
-            current->m_music_information->startMusic();           break;
+            current.m_music_information->setDefaultVolume();
+            current.m_music_information->startMusic();           break;
         }
         case SFX_MUSIC_STOP:
-            current->m_music_information->stopMusic();            break;
+            current.m_music_information->stopMusic();            break;
         case SFX_MUSIC_PAUSE:
-            current->m_music_information->pauseMusic();           break;
+            current.m_music_information->pauseMusic();           break;
         case SFX_MUSIC_RESUME:
-            current->m_music_information->resumeMusic();
+            current.m_music_information->resumeMusic();
             // This might be necessasary if the volume was changed
             // in the in-game menu
-            current->m_music_information->setDefaultVolume();     break;
+            current.m_music_information->setDefaultVolume();     break;
         case SFX_MUSIC_SWITCH_FAST:
-            current->m_music_information->switchToFastMusic();    break;
+            current.m_music_information->switchToFastMusic();    break;
         case SFX_MUSIC_SET_TMP_VOLUME:
         {
-            MusicInformation *mi = current->m_music_information;
-            mi->setTemporaryVolume(current->m_parameter.getX());  break;
+            MusicInformation *mi = current.m_music_information;
+            mi->setTemporaryVolume(current.m_parameter.getX());  break;
         }
         case SFX_MUSIC_WAITING:
-               current->m_music_information->setMusicWaiting();   break;
+               current.m_music_information->setMusicWaiting();   break;
         case SFX_MUSIC_DEFAULT_VOLUME:
         {
-            current->m_music_information->setDefaultVolume();
+            current.m_music_information->setDefaultVolume();
             break;
         }
         case SFX_CREATE_SOURCE:
-            current->m_sfx->init(); break;
+            current.m_sfx->init(); break;
         default: assert("Not yet supported.");
         }
-        delete current;
-        current = NULL;
-        // We access the size without lock, doesn't matter if we
-        // should get an incorrect value because of concurrent read/writes
-        if (me->m_sfx_commands.getData().size() == 0)
-        {
-            // Wait some time to let other threads run, then queue an
-            // update event to keep music playing.
-            double t = StkTime::getRealTime();
-            StkTime::sleep(1);
-            t = StkTime::getRealTime() - t;
-            me->queue(SFX_UPDATE, (SFXBase*)NULL, float(t));
-        }
-        me->m_sfx_commands.lock();
-
     }   // while
 
     // Signal that the sfx manager can now be deleted.
-    // We signal this even before cleaning up memory, since there is no
-    // need to keep the user waiting for STK to exit.
     me->setCanBeDeleted();
-
-    // Clean up memory to avoid leak detection
-    while(!me->m_sfx_commands.getData().empty())
-    {
-        delete me->m_sfx_commands.getData().front();
-        me->m_sfx_commands.getData().erase(me->m_sfx_commands.getData().begin());
-    }
-    me->m_sfx_commands.unlock();
     return NULL;
 }   // mainLoop
 
@@ -425,16 +474,9 @@ void* SFXManager::mainLoop(void *obj)
  */
 void SFXManager::toggleSound(const bool on)
 {
-    // When activating SFX, load all buffers
+    // When activating SFX, the buffers are loaded once they are used.
     if (on)
     {
-        std::map<std::string, SFXBuffer*>::iterator i = m_all_sfx_types.begin();
-        for (; i != m_all_sfx_types.end(); i++)
-        {
-            SFXBuffer* buffer = (*i).second;
-            buffer->load();
-        }
-
         reallyResumeAllNow();
         m_all_sfx.lock();
         const int sfx_amount = (int)m_all_sfx.getData().size();
@@ -474,10 +516,12 @@ bool SFXManager::sfxAllowed()
 }   // sfxAllowed
 
 //----------------------------------------------------------------------------
-/** Loads all sounds specified in the sound config file.
+/** Reads all sounds specified in the sound config file. The sound data is
+ *  only loaded once a sound is used, see SFXBufferCache.
  */
 void SFXManager::loadSfx()
 {
+    const double start = StkTime::getRealTime();
     std::string sfx_config_name = file_manager->getAsset(FileManager::SFX, "sfx.xml");
     XMLNode* root = file_manager->createXMLTree(sfx_config_name);
     if (!root || root->getName()!="sfx-config")
@@ -507,25 +551,9 @@ void SFXManager::loadSfx()
 
     delete root;
 
-    // Now load them in parallel
-    const int max = m_all_sfx_types.size();
-    SFXBuffer **array = new SFXBuffer *[max];
-    i = 0;
-
-    for (std::map<std::string, SFXBuffer*>::iterator it = m_all_sfx_types.begin();
-         it != m_all_sfx_types.end(); it++)
-    {
-        SFXBuffer* const buffer = (*it).second;
-        array[i++] = buffer;
-    }
-
-    #pragma omp parallel for private(i)
-    for (i = 0; i < max; i++)
-    {
-        array[i]->load();
-    }
-
-    delete [] array;
+    Log::verbose("SFXManager", "Read %d sound effects in %.1f ms, their "
+                 "data is loaded on demand.", (int)m_all_sfx_types.size(),
+                 (StkTime::getRealTime() - start)*1000.0);
 }   // loadSfx
 
 // -----------------------------------------------------------------------------
@@ -535,7 +563,9 @@ void SFXManager::loadSfx()
  *  enumeration for each effect, for each kart.
  *  \param sfx_name
  *  \param sfxFile must be an absolute pathname
- *  \return        whether loading this sound effect was successful
+ *  \param load   If the data should be loaded now (and kept loaded until
+ *                the buffer is unloaded), otherwise it is loaded on demand.
+ *  \return        the buffer, or NULL if loading this sound effect failed
 
 */
 SFXBuffer* SFXManager::addSingleSfx(const std::string &sfx_name,
@@ -559,10 +589,13 @@ SFXBuffer* SFXManager::addSingleSfx(const std::string &sfx_name,
         return NULL;
     }
 
+    // Otherwise the data is loaded once the sfx is used.
+    if (!load) return buffer;
+
     if (UserConfigParams::logMisc())
         Log::debug("SFXManager", "Loading SFX %s", sfx_file.c_str());
 
-    if (load && buffer->load()) return buffer;
+    if (buffer->load()) return buffer;
 
     return NULL;
 } // addSingleSFX
@@ -696,23 +729,21 @@ void SFXManager::deleteSFXMapping(const std::string &name)
 }   // deleteSFXMapping
 
 //----------------------------------------------------------------------------
-/** Make sure that the sfx thread is started at least once per frame. It also
- *  adds an update command for the music manager.
- *  \param dt Time step size.
+/** Make sure that the sfx thread is started, and hands all queued commands
+ *  to it. It also adds an update command for the music manager.
  */
 void SFXManager::update()
 {
     queue(SFX_UPDATE, (SFXBase*)NULL);
-    // Wake up the sfx thread to handle all queued up audio commands.
-    pthread_cond_signal(&m_cond_request);
+    startThread();
 }   // update
 
 //----------------------------------------------------------------------------
 /** Updates the status of all playing sfx (to test if they are finished).
- *  This function is executed once per frame (triggered by the audio thread).
- *  \param current The sfx command - used to get timestep information.
-*/
-void SFXManager::reallyUpdateNow(SFXCommand *current)
+ *  This function is executed once per frame, and whenever the sfx thread
+ *  has no commands to execute.
+ */
+void SFXManager::reallyUpdateNow()
 {
     if (m_last_update_time < 0.0)
     {
@@ -724,7 +755,6 @@ void SFXManager::reallyUpdateNow(SFXCommand *current)
     m_last_update_time = StkTime::getRealTime();
     float dt = float(m_last_update_time - previous_update_time);
 
-    assert(current->m_command==SFX_UPDATE);
     if (music_manager->getCurrentMusic())
         music_manager->getCurrentMusic()->update(dt);
     m_all_sfx.lock();
@@ -749,6 +779,32 @@ void SFXManager::reallyUpdateNow(SFXCommand *current)
 
 }   // reallyUpdateNow
 
+//----------------------------------------------------------------------------
+/** Lets the voice manager decide which sfx get an OpenAL source, depending
+ *  on how audible they are. This is executed once per frame in the sfx
+ *  thread (which is also the only thread deleting sfx, so the list can be
+ *  used without lock).
+ */
+void SFXManager::updateVoices()
+{
+    if (!sfxAllowed()) return;
+
+    m_voices.clear();
+    m_all_sfx.lock();
+    m_voices.insert(m_voices.end(), m_all_sfx.getData().begin(),
+                    m_all_sfx.getData().end());
+    m_all_sfx.unlock();
+
+    m_quick_sounds.lock();
+    std::map<std::string, SFXBase*>::iterator i =
+                                              m_quick_sounds.getData().begin();
+    for (; i != m_quick_sounds.getData().end(); i++)
+        m_voices.push_back(i->second);
+    m_quick_sounds.unlock();
+
+    m_voice_manager.update(m_voices, getListenerPos());
+}   // updateVoices
+
 //----------------------------------------------------------------------------
 /** Delete a sound effect object, and removes it from the internal list of
  *  all SFXs. This call deletes the object, and removes it from the list of
@@ -19,12 +19,14 @@
 #ifndef HEADER_SFX_MANAGER_HPP
 #define HEADER_SFX_MANAGER_HPP
 
+#include "audio/sfx_buffer_cache.hpp"
+#include "audio/voice_manager.hpp"
 #include "utils/can_be_deleted.hpp"
-#include "utils/leak_check.hpp"
 #include "utils/no_copy.hpp"
 #include "utils/synchronised.hpp"
 #include "utils/vec3.hpp"
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
@@ -113,11 +115,10 @@ public:
 private:
 
     /** Data structure for the queue, which stores a sfx and the command to 
-     *  execute for it. */
-    class SFXCommand : public NoCopy
+     *  execute for it. The commands are copied into a fixed size ring
+     *  buffer, so this must remain a plain data structure. */
+    class SFXCommand
     {
-    private:
-        LEAK_CHECK()
     public:
         /** The sound effect for which the command should be executed. */
         SFXBase *m_sfx;
@@ -131,16 +132,25 @@ private:
          *  floating point values are stored in the X component. */
         Vec3        m_parameter;
         // --------------------------------------------------------------------
+        SFXCommand()
+        {
+            m_command           = SFX_UPDATE;
+            m_sfx               = NULL;
+            m_music_information = NULL;
+        }   // SFXCommand
+        // --------------------------------------------------------------------
         SFXCommand(SFXCommands command, SFXBase *base)
         {
-            m_command   = command;
-            m_sfx       = base;
+            m_command           = command;
+            m_sfx               = base;
+            m_music_information = NULL;
         }   // SFXCommand()
         // --------------------------------------------------------------------
         /** Constructor for music information commands. */
         SFXCommand(SFXCommands command, MusicInformation *mi)
         {
             m_command           = command;
+            m_sfx               = NULL;
             m_music_information = mi;
         }   // SFXCommnd(MusicInformation*)
         // --------------------------------------------------------------------
@@ -150,21 +160,24 @@ private:
         {
             m_command = command;
             m_parameter.setX(f);
+            m_sfx               = NULL;
             m_music_information = mi;
         }   // SFXCommnd(MusicInformation *, float)
         // --------------------------------------------------------------------
         SFXCommand(SFXCommands command, SFXBase *base, float parameter)
         {
-            m_command   = command;
-            m_sfx       = base;
+            m_command           = command;
+            m_sfx               = base;
+            m_music_information = NULL;
             m_parameter.setX(parameter);
         }   // SFXCommand(float)
         // --------------------------------------------------------------------
         SFXCommand(SFXCommands command, SFXBase *base, const Vec3 &parameter)
         {
-            m_command   = command;
-            m_sfx       = base;
-            m_parameter = parameter;
+            m_command           = command;
+            m_sfx               = base;
+            m_music_information = NULL;
+            m_parameter         = parameter;
         }   // SFXCommand(Vec3)
         // --------------------------------------------------------------------
         /** Store a float and vec3 parameter. The float is stored as W
@@ -173,9 +186,10 @@ private:
         SFXCommand(SFXCommands command, SFXBase *base, float f,
                    const Vec3 &parameter)
         {
-            m_command   = command;
-            m_sfx       = base;
-            m_parameter = parameter;
+            m_command           = command;
+            m_sfx               = base;
+            m_music_information = NULL;
+            m_parameter         = parameter;
             m_parameter.setW(f);
         }   // SFXCommand(Vec3)
     };   // SFXCommand
@@ -192,6 +206,9 @@ private:
     Vec3                      m_listener_up;
 
 
+    /** Loads the data of the sfx buffers on demand. */
+    SFXBufferCache            m_buffer_cache;
+
     /** The buffers and info for all sound effects. These are shared among all
      *  instances of SFXOpenal. */
     std::map<std::string, SFXBuffer*> m_all_sfx_types;
@@ -199,8 +216,52 @@ private:
     /** The actual instances (sound sources) */
     Synchronised<std::vector<SFXBase*> > m_all_sfx;
 
-    /** The list of sound effects to be played in the next update. */
-    Synchronised< std::vector<SFXCommand*> > m_sfx_commands;
+    /** Size of the command queue, must be a power of 2. */
+    static const unsigned int COMMAND_QUEUE_SIZE = 2048;
+
+    /** Maximum number of position and speed updates that are kept back
+     *  (so that they can be combined with later updates) before they are
+     *  handed to the sfx thread. */
+    static const unsigned int MAX_STAGED_COMMANDS = 64;
+
+    /** Ring buffer with the commands to be executed by the sfx thread. The
+     *  main thread is the only thread adding commands, and the sfx thread
+     *  the only thread removing them, so no lock is necessary. */
+    SFXCommand                m_commands[COMMAND_QUEUE_SIZE];
+
+    /** Index (modulo the queue size) of the next command to be executed by
+     *  the sfx thread. Only changed by the sfx thread. */
+    std::atomic<unsigned int> m_read_index;
+
+    /** All commands before this index have been handed to the sfx thread.
+     *  Only changed by the main thread. */
+    std::atomic<unsigned int> m_write_index;
+
+    /** Index after the last command added. Position and speed updates
+     *  between m_write_index and this index are not yet visible to the sfx
+     *  thread, so they can still be replaced by a newer update for the same
+     *  sfx. Only used by the main thread. */
+    unsigned int              m_staged_index;
+
+    /** The thread which is allowed to add commands. */
+    pthread_t                 m_main_thread;
+
+    /** Statistics: number of commands queued, number of position and speed
+     *  updates that were combined with a previous update, and number of
+     *  updates dropped because the queue was full. */
+    unsigned int              m_num_enqueued;
+    unsigned int              m_num_coalesced;
+    unsigned int              m_num_dropped;
+
+    /** Set when the sfx thread should start processing commands. */
+    Synchronised<bool>        m_thread_started;
+
+    /** Decides which sfx get an OpenAL source. Only used in the sfx
+     *  thread. */
+    VoiceManager              m_voice_manager;
+
+    /** All sfx passed to the voice manager, reused each frame. */
+    std::vector<VoiceManager::Voice*> m_voices;
 
     /** To play non-positional sounds without having to create a
      *  new object for each. */
@@ -217,7 +278,7 @@ private:
 
     double                    m_last_update_time;
 
-    /** A conditional variable to wake up the main loop. */
+    /** A conditional variable to start the main loop. */
     pthread_cond_t            m_cond_request;
 
     void                      loadSfx();
@@ -226,8 +287,11 @@ private:
 
     static void* mainLoop(void *obj);
     void deleteSFX(SFXBase *sfx);
-    void queueCommand(SFXCommand *command);
+    void queueCommand(const SFXCommand &command);
+    void publishCommands();
+    void startThread();
     void reallyPositionListenerNow();
+    void updateVoices();
 
 public:
     static void create();
@@ -272,8 +336,13 @@ public:
     void                     resumeAll();
     void                     reallyResumeAllNow();
     void                     update();
-    void                     reallyUpdateNow(SFXCommand *current);
+    void                     reallyUpdateNow();
     bool                     soundExist(const std::string &name);
+    void                     printStatistics() const;
+    // ------------------------------------------------------------------------
+    /** Returns the cache that loads the sfx buffers. */
+    SFXBufferCache*          getBufferCache() { return &m_buffer_cache; }
+    // ------------------------------------------------------------------------
     void                     setMasterSFXVolume(float gain);
     float                    getMasterSFXVolume() const { return m_master_gain; }
 
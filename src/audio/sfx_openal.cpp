@@ -51,7 +51,12 @@ SFXOpenAL::SFXOpenAL(SFXBuffer* buffer, bool positional, float volume,
     m_gain         = -1.0f;
     m_master_gain  = 1.0f;
     m_owns_buffer  = owns_buffer;
+    m_buffer_loaded= false;
     m_play_time    = 0.0f;
+    m_has_source   = false;
+    m_position     = Vec3(0, 0, 0);
+    m_pitch        = 1.0f;
+    m_rolloff      = buffer->getRolloff();
 
     // Don't initialise anything else if the sfx manager was not correctly
     // initialised. First of all the initialisation will not work, and it
@@ -67,11 +72,14 @@ SFXOpenAL::SFXOpenAL(SFXBuffer* buffer, bool positional, float volume,
  *  buffer. */
 SFXOpenAL::~SFXOpenAL()
 {
-    if (m_status!=SFX_UNKNOWN && m_status!=SFX_NOT_INITIALISED)
+    if (m_has_source)
     {
         alDeleteSources(1, &m_sound_source);
     }
 
+    if (m_buffer_loaded)
+        m_sound_buffer->release();
+
     if (m_owns_buffer && m_sound_buffer)
     {
         m_sound_buffer->unload();
@@ -80,39 +88,61 @@ SFXOpenAL::~SFXOpenAL()
 }   // ~SFXOpenAL
 
 //-----------------------------------------------------------------------------
-/** Initialises the sfx. 
+/** Initialises the sfx. This loads the sound buffer if no other sfx
+ *  using it was initialised before. The OpenAL source is only created
+ *  when the sfx is played (and is audible enough), see makeReal.
  */
 bool SFXOpenAL::init()
 {
-    m_status = SFX_UNKNOWN;
+    if (!m_buffer_loaded)
+    {
+        if (!m_sound_buffer->load())
+        {
+            // If sfx are disabled, try again once they are enabled.
+            if (UserConfigParams::m_sfx)
+                m_status = SFX_UNKNOWN;
+            return false;
+        }
+        m_buffer_loaded = true;
+    }
+    assert( alIsBuffer(m_sound_buffer->getBufferID()) );
+    m_status = SFX_STOPPED;
+    return true;
+}   // init
 
+//-----------------------------------------------------------------------------
+/** Creates the OpenAL source for this sfx and sets all its properties.
+ *  \return False if no source could be created.
+ */
+bool SFXOpenAL::createSource()
+{
+    assert(!m_has_source);
     alGenSources(1, &m_sound_source );
     if (!SFXManager::checkError("generating a source"))
         return false;
 
-    assert( alIsBuffer(m_sound_buffer->getBufferID()) );
     assert( alIsSource(m_sound_source) );
 
     alSourcei (m_sound_source, AL_BUFFER, m_sound_buffer->getBufferID());
 
     if (!SFXManager::checkError("attaching the buffer to the source"))
+    {
+        alDeleteSources(1, &m_sound_source);
         return false;
+    }
 
-    alSource3f(m_sound_source, AL_POSITION,       0.0, 0.0, 0.0);
+    if (m_positional)
+        alSource3f(m_sound_source, AL_POSITION, m_position.getX(),
+                   m_position.getY(), -m_position.getZ());
+    else
+        alSource3f(m_sound_source, AL_POSITION, 0.0, 0.0, 0.0);
     alSource3f(m_sound_source, AL_VELOCITY,       0.0, 0.0, 0.0);
     alSource3f(m_sound_source, AL_DIRECTION,      0.0, 0.0, 0.0);
 
-    alSourcef (m_sound_source, AL_ROLLOFF_FACTOR, m_sound_buffer->getRolloff());
+    alSourcef (m_sound_source, AL_ROLLOFF_FACTOR, m_rolloff);
     alSourcef (m_sound_source, AL_MAX_DISTANCE,   m_sound_buffer->getMaxDist());
-
-    if (m_gain < 0.0f)
-    {
-        alSourcef (m_sound_source, AL_GAIN, m_default_gain * m_master_gain);
-    }
-    else
-    {
-        alSourcef (m_sound_source, AL_GAIN, m_gain * m_master_gain);
-    }
+    alSourcef (m_sound_source, AL_GAIN,           getSourceGain());
+    alSourcef (m_sound_source, AL_PITCH,          m_pitch);
 
     if (m_positional) alSourcei (m_sound_source, AL_SOURCE_RELATIVE, AL_FALSE);
     else              alSourcei (m_sound_source, AL_SOURCE_RELATIVE, AL_TRUE);
@@ -120,11 +150,87 @@ bool SFXOpenAL::init()
     alSourcei(m_sound_source, AL_LOOPING, m_loop ? AL_TRUE : AL_FALSE);
 
     if(!SFXManager::checkError("setting up the source"))
+    {
+        alDeleteSources(1, &m_sound_source);
         return false;
+    }
 
-    m_status = SFX_STOPPED;
+    m_has_source = true;
     return true;
-}   // init
+}   // createSource
+
+//-----------------------------------------------------------------------------
+/** Returns the gain to use for the source: sounds further away than the
+ *  maximum distance are muted.
+ */
+float SFXOpenAL::getSourceGain() const
+{
+    if (m_positional && SFXManager::get()->getListenerPos()
+                        .distance(m_position) > m_sound_buffer->getMaxDist())
+        return 0.0f;
+    return (m_gain < 0.0f ? m_default_gain : m_gain) * m_master_gain;
+}   // getSourceGain
+
+//-----------------------------------------------------------------------------
+/** Sets the play position of a newly created source to the time this sfx
+ *  has been playing.
+ */
+void SFXOpenAL::setSourceOffset()
+{
+    float offset = m_play_time;
+    const float duration = m_sound_buffer->getDuration();
+    if (duration > 0 && offset >= duration)
+        offset = m_loop ? fmodf(offset, duration) : 0.0f;
+    alSourcef(m_sound_source, AL_SEC_OFFSET, offset);
+    SFXManager::checkError("setting the offset");
+}   // setSourceOffset
+
+//-----------------------------------------------------------------------------
+/** Returns the gain of this sfx at the listener position, see
+ *  VoiceManager. Only playing and paused sfx need a source.
+ *  \param listener Position of the listener.
+ */
+float SFXOpenAL::getAudibility(const Vec3 &listener) const
+{
+    if (m_status != SFX_PLAYING && m_status != SFX_PAUSED)
+        return -1.0f;
+    const float gain = (m_gain < 0.0f ? m_default_gain : m_gain)
+                     * m_master_gain;
+    if (!m_positional)
+        return gain;
+    return gain * VoiceManager::getAttenuation(listener.distance(m_position),
+                                               m_rolloff,
+                                               m_sound_buffer->getMaxDist());
+}   // getAudibility
+
+//-----------------------------------------------------------------------------
+/** Creates a source for this sfx, and if it is playing, continues playing
+ *  it at the time it has been playing so far. Called from the sfx thread.
+ */
+void SFXOpenAL::makeReal()
+{
+    if (m_has_source || !createSource()) return;
+    if (m_status == SFX_PLAYING || m_status == SFX_PAUSED)
+        setSourceOffset();
+    if (m_status == SFX_PLAYING)
+    {
+        alSourcePlay(m_sound_source);
+        SFXManager::checkError("playing");
+    }
+}   // makeReal
+
+//-----------------------------------------------------------------------------
+/** Deletes the source of this sfx. The status does not change, and the
+ *  playing time is still updated. Called from the sfx thread.
+ */
+void SFXOpenAL::makeVirtual()
+{
+    if (!m_has_source) return;
+    alSourceStop(m_sound_source);
+    alDeleteSources(1, &m_sound_source);
+    SFXManager::checkError("deleting a source");
+    m_has_source = false;
+}   // makeVirtual
 
 // ------------------------------------------------------------------------
 /** Updates the status of a playing sfx. If the sound has been played long
@@ -175,6 +281,8 @@ void SFXOpenAL::reallySetSpeed(float factor)
     {
         factor = 0.5f;
     }
+    m_pitch = factor;
+    if (!m_has_source) return;
     alSourcef(m_sound_source,AL_PITCH,factor);
     SFXManager::checkError("setting speed");
 }   // reallySetSpeed
@@ -207,6 +315,7 @@ void SFXOpenAL::reallySetVolume(float volume)
             return;
     }
 
+    if (!m_has_source) return;
     alSourcef(m_sound_source, AL_GAIN, m_gain * m_master_gain);
 }   // reallySetVolume
 
@@ -230,7 +339,7 @@ void SFXOpenAL::reallySetMasterVolumeNow(float volume)
 {
     m_master_gain = volume;
     
-    if(m_status==SFX_UNKNOWN || m_status == SFX_NOT_INITIALISED) return;
+    if(!m_has_source) return;
 
     alSourcef(m_sound_source, AL_GAIN, 
                (m_gain < 0.0f ? m_default_gain : m_gain) * m_master_gain);
@@ -261,6 +370,7 @@ void SFXOpenAL::reallySetLoop(bool status)
             return;
     }
 
+    if (!m_has_source) return;
     alSourcei(m_sound_source, AL_LOOPING, status ? AL_TRUE : AL_FALSE);
     SFXManager::checkError("looping");
 }   // reallySetLoop
@@ -283,6 +393,7 @@ void SFXOpenAL::reallyStopNow()
     {
         m_status = SFX_STOPPED;
         m_loop = false;
+        if (!m_has_source) return;
         alSourcei(m_sound_source, AL_LOOPING, AL_FALSE);
         alSourceStop(m_sound_source);
         SFXManager::checkError("stoping");
@@ -307,6 +418,7 @@ void SFXOpenAL::reallyPauseNow()
     // from pauseAll, and we have to make sure to only pause playing sfx.
     if (m_status != SFX_PLAYING || !SFXManager::get()->sfxAllowed()) return;
     m_status = SFX_PAUSED;
+    if (!m_has_source) return;
     alSourcePause(m_sound_source);
     SFXManager::checkError("pausing");
 }   // reallyPauseNow
@@ -335,8 +447,14 @@ void SFXOpenAL::reallyResumeNow()
 
     if(m_status==SFX_PAUSED)
     {
-        alSourcePlay(m_sound_source);
-        SFXManager::checkError("resuming");
+        // The source might have been deleted while paused.
+        if (!m_has_source && createSource())
+            setSourceOffset();
+        if (m_has_source)
+        {
+            alSourcePlay(m_sound_source);
+            SFXManager::checkError("resuming");
+        }
         m_status = SFX_PLAYING;
     }
 }   // reallyResumeNow
@@ -376,8 +494,14 @@ void SFXOpenAL::reallyPlayNow()
         if (m_status==SFX_UNKNOWN) return;
     }
 
-    alSourcePlay(m_sound_source);
-    SFXManager::checkError("playing");
+    // A new sound gets a source immediately, the voice manager will delete
+    // it in the next update if the sound is not audible enough. If no source
+    // can be created, the sound is still tracked as playing.
+    if (m_has_source || createSource())
+    {
+        alSourcePlay(m_sound_source);
+        SFXManager::checkError("playing");
+    }
     // Esp. with terrain sounds it can (very likely) happen that the status
     // got overwritten: a sound is created and an init event is queued. Then
     // a play event is queued, and the status is immediately changed to
@@ -454,19 +578,12 @@ void SFXOpenAL::reallySetPosition(const Vec3 &position)
         return;
     }
 
+    m_position = position;
+    if (!m_has_source) return;
+
     alSource3f(m_sound_source, AL_POSITION, position.getX(),
                position.getY(), -position.getZ());
-
-    if (SFXManager::get()->getListenerPos().distance(position)
-        > m_sound_buffer->getMaxDist())
-    {
-        alSourcef(m_sound_source, AL_GAIN, 0);
-    }
-    else
-    {
-        alSourcef(m_sound_source, AL_GAIN, 
-                  (m_gain < 0.0f ? m_default_gain : m_gain) * m_master_gain);
-    }
+    alSourcef(m_sound_source, AL_GAIN, getSourceGain());
 
     SFXManager::checkError("positioning");
 }   // reallySetPosition
@@ -511,10 +628,11 @@ void SFXOpenAL::onSoundEnabledBack()
         if (m_status==SFX_NOT_INITIALISED) init();
         if (m_status!=SFX_UNKNOWN)
         {
-            alSourcef(m_sound_source, AL_GAIN, 0);
+            if (m_has_source) alSourcef(m_sound_source, AL_GAIN, 0);
             play();
             pause();
-            alSourcef(m_sound_source, AL_GAIN,
+            if (m_has_source)
+                alSourcef(m_sound_source, AL_GAIN,
                      (m_gain < 0.0f ? m_default_gain : m_gain) * m_master_gain);
         }
     }
@@ -524,7 +642,9 @@ void SFXOpenAL::onSoundEnabledBack()
 
 void SFXOpenAL::setRolloff(float rolloff)
 {
-    alSourcef (m_sound_source, AL_ROLLOFF_FACTOR,  rolloff);
+    m_rolloff = rolloff;
+    if (m_has_source)
+        alSourcef (m_sound_source, AL_ROLLOFF_FACTOR,  rolloff);
 }
 
 #endif //if HAVE_OGGVORBIS
@@ -29,6 +29,7 @@
 #endif
 #include "audio/sfx_base.hpp"
 #include "utils/leak_check.hpp"
+#include "utils/vec3.hpp"
 
 /**
   * \brief OpenAL implementation of the abstract SFXBase interface
@@ -72,9 +73,32 @@ private:
     /** If this sfx should also free the sound buffer. */
     bool m_owns_buffer;
 
+    /** True once init() has loaded the sound buffer, which then needs to
+     *  be released again. */
+    bool m_buffer_loaded;
+
     /** How long the sfx has been playing. */
     float m_play_time;
 
+    /** True if m_sound_source is a valid OpenAL source. Sources are only
+     *  created for the most audible sfx, see VoiceManager, and the other
+     *  ones are just tracked without being played. */
+    bool m_has_source;
+
+    /** Position of this sfx, so that it can be set when a source is
+     *  created. */
+    Vec3 m_position;
+
+    /** The pitch of this sfx. */
+    float m_pitch;
+
+    /** The rolloff factor of this sfx. */
+    float m_rolloff;
+
+    bool  createSource();
+    void  setSourceOffset();
+    float getSourceGain() const;
+
 public:
               SFXOpenAL(SFXBuffer* buffer, bool positional, float volume,
                         bool owns_buffer = false);
@@ -107,6 +131,12 @@ public:
     virtual void      reallySetMasterVolumeNow(float volue);
     virtual void      onSoundEnabledBack();
     virtual void      setRolloff(float rolloff);
+    virtual float     getAudibility(const Vec3 &listener) const;
+    virtual void      makeReal();
+    virtual void      makeVirtual();
+    // ------------------------------------------------------------------------
+    /** Returns if this sfx currently has an OpenAL source. */
+    virtual bool      isReal() const { return m_has_source; }
     // ------------------------------------------------------------------------
     /** Returns if this sfx is looped or not. */
     virtual bool      isLooped() { return m_loop; }
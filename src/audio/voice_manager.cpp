@@ -0,0 +1,255 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#include "audio/voice_manager.hpp"
+
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+// ----------------------------------------------------------------------------
+/** Creates a voice manager.
+ *  \param max_real_voices Maximum number of voices with a source.
+ */
+VoiceManager::VoiceManager(unsigned int max_real_voices)
+{
+    m_max_real_voices  = max_real_voices;
+    m_num_updates      = 0;
+    m_num_voices       = 0;
+    m_num_audible      = 0;
+    m_num_made_real    = 0;
+    m_num_made_virtual = 0;
+}   // VoiceManager
+
+// ----------------------------------------------------------------------------
+/** Returns the factor by which the gain of a positional sound is reduced at
+ *  a given distance, using the default distance model of OpenAL (inverse
+ *  distance clamped, with a reference distance of 1). Sounds further away
+ *  than the maximum distance are muted, see SFXOpenAL::reallySetPosition.
+ *  \param distance Distance between the sound and the listener.
+ *  \param rolloff Rolloff factor of the sound.
+ *  \param max_distance Maximum distance of the sound.
+ */
+float VoiceManager::getAttenuation(float distance, float rolloff,
+                                   float max_distance)
+{
+    if (distance > max_distance) return 0.0f;
+    const float reference = 1.0f;
+    if (distance < reference) distance = reference;
+    return reference / (reference + rolloff * (distance - reference));
+}   // getAttenuation
+
+// ----------------------------------------------------------------------------
+/** Ranks all voices by their audibility, and makes the most audible ones
+ *  real and all others virtual. Voices with the same audibility are ranked
+ *  by their index, so the result does not depend on the sort order.
+ *  \param voices All voices.
+ *  \param listener Position of the listener.
+ */
+void VoiceManager::update(const std::vector<Voice*> &voices,
+                          const Vec3 &listener)
+{
+    m_num_updates++;
+    m_num_voices += (unsigned int)voices.size();
+
+    m_ranking.clear();
+    for (unsigned int i = 0; i < voices.size(); i++)
+    {
+        const float audibility = voices[i]->getAudibility(listener);
+        // Store the negative audibility, so that the most audible voices
+        // (and then the lowest indices) come first.
+        if (audibility >= 0)
+            m_ranking.push_back(std::make_pair(-audibility, (int)i));
+    }
+    m_num_audible += (unsigned int)m_ranking.size();
+
+    unsigned int num_real = (unsigned int)m_ranking.size();
+    if (num_real > m_max_real_voices)
+    {
+        num_real = m_max_real_voices;
+        std::nth_element(m_ranking.begin(), m_ranking.begin() + num_real,
+                         m_ranking.end());
+    }
+
+    m_should_be_real.assign(voices.size(), false);
+    for (unsigned int i = 0; i < num_real; i++)
+        m_should_be_real[m_ranking[i].second] = true;
+
+    // First release all sources that are not needed anymore, so that they
+    // are available for the voices that become real.
+    for (unsigned int i = 0; i < voices.size(); i++)
+    {
+        if (!m_should_be_real[i] && voices[i]->isReal())
+        {
+            voices[i]->makeVirtual();
+            m_num_made_virtual++;
+        }
+    }
+    for (unsigned int i = 0; i < voices.size(); i++)
+    {
+        if (m_should_be_real[i] && !voices[i]->isReal())
+        {
+            voices[i]->makeReal();
+            m_num_made_real++;
+        }
+    }
+}   // update
+
+// ----------------------------------------------------------------------------
+/** Prints the average number of voices and of voices that needed a source
+ *  per update, and how often voices became real or virtual. */
+void VoiceManager::printStatistics() const
+{
+    if (m_num_updates == 0) return;
+    Log::verbose("VoiceManager", "%u updates, %f voices, %f playing, "
+                 "at most %u real, %u times made real, %u times made "
+                 "virtual.", m_num_updates,
+                 float(m_num_voices) / m_num_updates,
+                 float(m_num_audible) / m_num_updates, m_max_real_voices,
+                 m_num_made_real, m_num_made_virtual);
+}   // printStatistics
+
+// ============================================================================
+namespace
+{
+    /** A voice without audio device, used for testing. */
+    class DummyVoice : public VoiceManager::Voice
+    {
+    public:
+        Vec3 m_xyz;
+        float m_gain;
+        bool m_playing;
+        bool m_real;
+        DummyVoice(const Vec3 &xyz, float gain)
+            : m_xyz(xyz), m_gain(gain), m_playing(true), m_real(false) {}
+        virtual float getAudibility(const Vec3 &listener) const
+        {
+            if (!m_playing) return -1.0f;
+            return m_gain * VoiceManager::getAttenuation(
+                                     (m_xyz - listener).length(), 1.0f, 50.0f);
+        }   // getAudibility
+        virtual bool isReal() const { return m_real; }
+        virtual void makeReal()     { assert(!m_real); m_real = true;  }
+        virtual void makeVirtual()  { assert(m_real);  m_real = false; }
+    };   // DummyVoice
+
+    // ------------------------------------------------------------------------
+    unsigned int countReal(const std::vector<VoiceManager::Voice*> &voices)
+    {
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < voices.size(); i++)
+            if (voices[i]->isReal()) n++;
+        return n;
+    }   // countReal
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Tests the ranking of voices using dummy voices. */
+void VoiceManager::unitTesting()
+{
+    assert(getAttenuation(  0.5f, 1.0f, 50.0f) == 1.0f);
+    assert(getAttenuation(  3.0f, 1.0f, 50.0f) == 1.0f/3.0f);
+    assert(getAttenuation(  3.0f, 0.5f, 50.0f) == 0.5f);
+    assert(getAttenuation( 51.0f, 1.0f, 50.0f) == 0.0f);
+
+    // Ten voices at x = 0, 2, ..., 18.
+    std::vector<DummyVoice> dummies;
+    for (unsigned int i = 0; i < 10; i++)
+        dummies.push_back(DummyVoice(Vec3(2.0f*i, 0, 0), 1.0f));
+    std::vector<Voice*> voices;
+    for (unsigned int i = 0; i < dummies.size(); i++)
+        voices.push_back(&dummies[i]);
+
+    VoiceManager vm(4);
+    vm.update(voices, Vec3(0, 0, 0));
+    assert(countReal(voices) == 4);
+    for (unsigned int i = 0; i < 10; i++)
+        assert(dummies[i].m_real == (i < 4));
+
+    // The listener moves to the other end.
+    vm.update(voices, Vec3(18.0f, 0, 0));
+    assert(countReal(voices) == 4);
+    for (unsigned int i = 0; i < 10; i++)
+        assert(dummies[i].m_real == (i >= 6));
+    assert(vm.m_num_made_real == 8 && vm.m_num_made_virtual == 4);
+
+    // A stopped voice releases its source, and the next one gets it.
+    dummies[9].m_playing = false;
+    vm.update(voices, Vec3(18.0f, 0, 0));
+    assert(!dummies[9].m_real && dummies[5].m_real);
+
+    // A loud voice far away is preferred over quiet close ones.
+    dummies[0].m_gain = 100.0f;
+    vm.update(voices, Vec3(18.0f, 0, 0));
+    assert(dummies[0].m_real && !dummies[5].m_real);
+
+    // Voices with the same audibility are ranked by index. A muted voice
+    // (gain 0) still gets a source if there are enough.
+    for (unsigned int i = 0; i < 10; i++)
+    {
+        dummies[i].m_xyz     = Vec3(100.0f, 0, 0);
+        dummies[i].m_playing = true;
+        dummies[i].m_gain    = 1.0f;
+    }
+    vm.update(voices, Vec3(0, 0, 0));
+    for (unsigned int i = 0; i < 10; i++)
+        assert(dummies[i].m_real == (i < 4));
+
+    // Without limit all playing voices are real.
+    vm.setMaxRealVoices(100);
+    vm.update(voices, Vec3(0, 0, 0));
+    assert(countReal(voices) == 10);
+}   // unitTesting
+
+// ----------------------------------------------------------------------------
+/** Measures the time of an update with dummy voices spread over an area of
+ *  200x200m, and a listener moving through that area.
+ *  \param num_voices Number of voices.
+ *  \param max_real_voices Maximum number of real voices.
+ */
+void VoiceManager::benchmark(unsigned int num_voices,
+                             unsigned int max_real_voices)
+{
+    std::vector<DummyVoice> dummies;
+    unsigned int seed = 1;
+    for (unsigned int i = 0; i < num_voices; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        const float x = float((seed >> 16) % 200);
+        seed = seed * 1103515245 + 12345;
+        const float z = float((seed >> 16) % 200);
+        dummies.push_back(DummyVoice(Vec3(x, 0, z), 1.0f));
+    }
+    std::vector<Voice*> voices;
+    for (unsigned int i = 0; i < dummies.size(); i++)
+        voices.push_back(&dummies[i]);
+
+    VoiceManager vm(max_real_voices);
+    const unsigned int num_updates = 1000;
+    const double start = StkTime::getRealTime();
+    for (unsigned int i = 0; i < num_updates; i++)
+        vm.update(voices, Vec3(0.2f*i, 0, 0.2f*i));
+    const double time = StkTime::getRealTime() - start;
+    Log::verbose("VoiceManager", "Update of %u voices with %u real: %f us.",
+                 num_voices, max_real_voices,
+                 time * 1000000.0 / num_updates);
+    vm.printStatistics();
+}   // benchmark
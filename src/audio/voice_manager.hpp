@@ -0,0 +1,98 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#ifndef HEADER_VOICE_MANAGER_HPP
+#define HEADER_VOICE_MANAGER_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Decides which sound effects are played with a real sound source.
+ *  Each kart has several sound effects (engine, skidding, crash, ...), and
+ *  with many karts the number of sound sources of the audio device is
+ *  quickly exhausted, while most of these sounds can't be heard anyway.
+ *  Once per frame the voice manager ranks all sound effects that are
+ *  playing (or paused) by their gain at the listener position, and keeps
+ *  only the most audible ones as real voices. The other ones are virtual:
+ *  they release their source, but keep track of their playing time, so
+ *  that they can continue at the right position once they become audible
+ *  again. The voice manager only knows the Voice interface, so it can be
+ *  tested and benchmarked without an audio device.
+ * \ingroup audio
+ */
+class VoiceManager : public NoCopy
+{
+public:
+    /** The interface of a sound effect for the voice manager. */
+    class Voice
+    {
+    public:
+        virtual ~Voice() {}
+        /** Returns the gain of this voice at the listener position, or a
+         *  negative value if the voice does not need a source (e.g. because
+         *  it is stopped). */
+        virtual float getAudibility(const Vec3 &listener) const = 0;
+        /** Returns true if this voice currently has a source. */
+        virtual bool  isReal() const = 0;
+        /** Gets a source and continues playing at the current position. */
+        virtual void  makeReal() = 0;
+        /** Releases the source, but keeps track of the playing time. */
+        virtual void  makeVirtual() = 0;
+    };   // Voice
+
+private:
+    /** Maximum number of real voices. */
+    unsigned int m_max_real_voices;
+
+    /** Audibility and index of all voices that need a source, reused
+     *  each update to avoid allocations. */
+    std::vector<std::pair<float, int> > m_ranking;
+
+    /** True for each voice that should be real, reused each update. */
+    std::vector<bool> m_should_be_real;
+
+    /** Statistics. */
+    unsigned int m_num_updates;
+    unsigned int m_num_voices;
+    unsigned int m_num_audible;
+    unsigned int m_num_made_real;
+    unsigned int m_num_made_virtual;
+
+public:
+         VoiceManager(unsigned int max_real_voices);
+    void update(const std::vector<Voice*> &voices, const Vec3 &listener);
+    void printStatistics() const;
+    static float getAttenuation(float distance, float rolloff,
+                                float max_distance);
+    static void  unitTesting();
+    static void  benchmark(unsigned int num_voices,
+                           unsigned int max_real_voices);
+    // ------------------------------------------------------------------------
+    /** Sets the maximum number of real voices. */
+    void setMaxRealVoices(unsigned int n) { m_max_real_voices = n; }
+    // ------------------------------------------------------------------------
+    /** Returns the maximum number of real voices. */
+    unsigned int getMaxRealVoices() const { return m_max_real_voices; }
+};   // VoiceManager
+
+#endif
@@ -138,6 +138,24 @@ void STKConfig::load(const std::string &filename)
     CHECK_NEG(m_replay_delta_pos2,         "replay delta-position"      );
     CHECK_NEG(m_replay_dt,                 "replay delta-t"             );
     CHECK_NEG(m_smooth_angle_limit,        "physics smooth-angle-limit" );
+    CHECK_NEG(m_object_reduced_distance,   "physics object-reduced-distance");
+    CHECK_NEG(m_object_frozen_distance,    "physics object-frozen-distance" );
+    CHECK_NEG(m_object_reduced_interval,   "physics object-reduced-interval");
+    CHECK_NEG(m_ticks_per_second,          "physics ticks-per-second"   );
+    CHECK_NEG(m_kart_update_near_distance,
+              "networking kart-update-near-distance");
+    CHECK_NEG(m_kart_update_far_distance,
+              "networking kart-update-far-distance");
+    CHECK_NEG(m_kart_update_near_interval,
+              "networking kart-update-near-interval");
+    CHECK_NEG(m_kart_update_interval,
+              "networking kart-update-interval");
+    CHECK_NEG(m_kart_update_far_interval,
+              "networking kart-update-far-interval");
+    CHECK_NEG(m_kart_update_bandwidth,
+              "networking kart-update-bandwidth");
+    CHECK_NEG(m_lag_compensation_max,
+              "networking lag-compensation-max");
 
     // Square distance to make distance checks cheaper (no sqrt)
     m_replay_delta_pos2 *= m_replay_delta_pos2;
@@ -156,11 +174,17 @@ void STKConfig::init_defaults()
         m_delay_finish_time      = m_skid_fadeout_time         =
         m_near_ground            = m_item_switch_time          =
         m_smooth_angle_limit     = m_penalty_time              =
+        m_object_reduced_distance = m_object_frozen_distance   =
+        m_object_reduced_interval = m_kart_update_near_distance  =
+        m_kart_update_far_distance = m_kart_update_near_interval =
+        m_kart_update_interval   = m_kart_update_far_interval  =
+        m_kart_update_bandwidth  = m_lag_compensation_max      =
         UNDEFINED;
     m_bubblegum_counter          = -100;
     m_shield_restrict_weapos     = false;
     m_max_karts                  = -100;
     m_max_skidmarks              = -100;
+    m_ticks_per_second           = -100;
     m_min_kart_version           = -100;
     m_max_kart_version           = -100;
     m_min_track_version          = -100;
@@ -243,6 +267,13 @@ void STKConfig::getAllData(const XMLNode * root)
     {
         physics_node->get("smooth-normals",     &m_smooth_normals    );
         physics_node->get("smooth-angle-limit", &m_smooth_angle_limit);
+        physics_node->get("object-reduced-distance",
+                          &m_object_reduced_distance);
+        physics_node->get("object-frozen-distance",
+                          &m_object_frozen_distance );
+        physics_node->get("object-reduced-interval",
+                          &m_object_reduced_interval);
+        physics_node->get("ticks-per-second",   &m_ticks_per_second  );
     }
 
     if (const XMLNode *startup_node= root->getNode("startup"))
@@ -343,7 +374,23 @@ void STKConfig::getAllData(const XMLNode * root)
     }
 
     if(const XMLNode *networking_node= root->getNode("networking"))
+    {
         networking_node->get("enable", &m_enable_networking);
+        networking_node->get("kart-update-near-distance",
+                             &m_kart_update_near_distance);
+        networking_node->get("kart-update-far-distance",
+                             &m_kart_update_far_distance);
+        networking_node->get("kart-update-near-interval",
+                             &m_kart_update_near_interval);
+        networking_node->get("kart-update-interval",
+                             &m_kart_update_interval);
+        networking_node->get("kart-update-far-interval",
+                             &m_kart_update_far_interval);
+        networking_node->get("kart-update-bandwidth",
+                             &m_kart_update_bandwidth);
+        networking_node->get("lag-compensation-max",
+                             &m_lag_compensation_max);
+    }
 
     if(const XMLNode *replay_node = root->getNode("replay"))
     {
@@ -28,7 +28,9 @@
 
 #include "network/remote_kart_info.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/types.hpp"
 
+#include <cmath>
 #include <vector>
 #include <string>
 #include <map>
@@ -85,6 +87,21 @@ public:
      *  triangle are more than this value, the physics will use the normal
      *  of the triangle in smoothing normal. */
     float m_smooth_angle_limit;
+
+    /** Animated track objects further away than this from all karts are
+     *  updated at a reduced rate (0 disables). */
+    float m_object_reduced_distance;
+
+    /** Track objects further away than this from all karts are frozen,
+     *  i.e. not simulated at all (0 disables). */
+    float m_object_frozen_distance;
+
+    /** Time between two updates of track objects at reduced rate. */
+    float m_object_reduced_interval;
+
+    /** Number of simulation ticks per second, i.e. the inverse of the
+     *  fixed time step size of the world. */
+    int   m_ticks_per_second;
     int   m_max_skidmarks;           /**<Maximum number of skid marks/kart.  */
     float m_skid_fadeout_time;       /**<Time till skidmarks fade away.      */
     float m_near_ground;             /**<Determines when a kart is not near
@@ -99,6 +116,22 @@ public:
                                          before it is ignored. */
     bool  m_enable_networking;
 
+    /** Karts closer than this to a kart of a client (or next to it in the
+     *  race) are sent to that client with the near update interval, karts
+     *  further away than the far distance with the far interval, all others
+     *  with the default interval (see KartUpdateScheduler). */
+    float m_kart_update_near_distance, m_kart_update_far_distance;
+    float m_kart_update_near_interval, m_kart_update_interval,
+          m_kart_update_far_interval;
+
+    /** Maximum number of bytes per second of kart updates for a client. */
+    float m_kart_update_bandwidth;
+
+    /** Maximum delay (in seconds) between a client and the server that is
+     *  compensated when testing for item and flyable hits on the server.
+     *  0 disables lag compensation. */
+    float m_lag_compensation_max;
+
     /** Disable steering if skidding is stopped. This can help in making
      *  skidding more controllable (since otherwise when trying to steer while
      *  steering is reset to match the graphics it often results in the kart
@@ -179,6 +212,18 @@ public:
     {
         return *m_kart_properties.at(type);
     }   // getKartProperties
+    // ------------------------------------------------------------------------
+    /** Converts a number of ticks into seconds. */
+    float ticks2Time(int64_t ticks) const
+    {
+        return float(ticks) / m_ticks_per_second;
+    }   // ticks2Time
+    // ------------------------------------------------------------------------
+    /** Converts a time in seconds into the nearest number of ticks. */
+    int64_t time2Ticks(float t) const
+    {
+        return (int64_t)floor(t * m_ticks_per_second + 0.5f);
+    }   // time2Ticks
 }
 ;   // STKConfig
 
@@ -319,6 +319,17 @@ namespace UserConfigParams
     PARAM_PREFIX FloatUserConfigParam       m_music_volume
             PARAM_DEFAULT(  FloatUserConfigParam(0.7f, "music_volume",
             &m_audio_group, "Music volume from 0.0 to 1.0") );
+    PARAM_PREFIX IntUserConfigParam         m_max_sfx_voices
+            PARAM_DEFAULT(  IntUserConfigParam(32, "max_sfx_voices",
+            &m_audio_group, "Maximum number of sound effects played at the "
+                            "same time. Only the most audible ones are "
+                            "played, the others are resumed once they "
+                            "become audible enough.") );
+    PARAM_PREFIX IntUserConfigParam         m_sfx_cache_size
+            PARAM_DEFAULT(  IntUserConfigParam(16, "sfx_cache_size",
+            &m_audio_group, "Size in MB of the decoded sound effects that "
+                            "are kept loaded after they were used. Sound "
+                            "effects that are in use are always kept.") );
 
     // ---- Race setup
     PARAM_PREFIX GroupUserConfigParam        m_race_setup_group
@@ -624,6 +635,12 @@ namespace UserConfigParams
                             "stun.voxgratia.org",
                             "stun.xten.com") );
 
+    PARAM_PREFIX IntUserConfigParam         m_rewind_max_frame_time
+            PARAM_DEFAULT(  IntUserConfigParam(4, "rewind-max-frame-time",
+                            "Time (in ms) per frame used to resimulate after "
+                            "a rewind, longer rewinds are spread over "
+                            "several frames.") );
+
     PARAM_PREFIX BoolUserConfigParam m_log_packets
             PARAM_DEFAULT( BoolUserConfigParam(false, "log-network-packets",
                                                  "If all network packets should be logged") );
@@ -711,6 +728,12 @@ namespace UserConfigParams
     PARAM_PREFIX BoolUserConfigParam        m_cache_overworld
             PARAM_DEFAULT(  BoolUserConfigParam(true, "cache-overworld") );
 
+    PARAM_PREFIX IntUserConfigParam         m_track_data_cache_size
+            PARAM_DEFAULT(  IntUserConfigParam(32, "track-data-cache-size",
+                            "Memory (in MB) used to keep drive and arena "
+                            "graphs of recently used tracks between races, "
+                            "0 to disable.") );
+
     // TODO : is this used with new code? does it still work?
     PARAM_PREFIX BoolUserConfigParam        m_crashed
             PARAM_DEFAULT(  BoolUserConfigParam(false, "crashed") );
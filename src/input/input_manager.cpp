@@ -18,6 +18,7 @@
 
 #include "input/input_manager.hpp"
 
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "graphics/camera_fps.hpp"
 #include "graphics/irr_driver.hpp"
@@ -283,7 +284,7 @@ void InputManager::handleStaticAction(int key, int value)
                 fgets(s, 256, stdin);
                 float t;
                 StringUtils::fromString(s,t);
-                RewindManager::get()->rewindTo(t);
+                RewindManager::get()->rewindTo(stk_config->time2Ticks(t));
                 Log::info("Rewind", "Rewinding from %f to %f",
                           world->getTime(), t);
             }
@@ -36,6 +36,7 @@
 #include "karts/kart_properties.hpp"
 #include "modes/three_strikes_battle.hpp"
 #include "modes/world.hpp"
+#include "network/bit_string.hpp"
 #include "network/rewind_manager.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "tracks/track.hpp"
@@ -227,25 +228,41 @@ void Attachment::clear()
     m_kart->updateWeight();
 }   // clear
 
+// -----------------------------------------------------------------------------
+/** Resets the attachment at the start of a race: removes any attachment and
+ *  seeds the random number generator.
+ */
+void Attachment::reset()
+{
+    clear();
+    m_random.seedForRace(RandomGenerator::RS_ATTACHMENT,
+                         m_kart->getWorldKartId());
+}   // reset
+
 // -----------------------------------------------------------------------------
 /** Saves the attachment state. Called as part of the kart saving its state.
  *  \param buffer The kart rewinder's state buffer.
  */
 void Attachment::saveState(BareNetworkString *buffer) const
 {
-    // We use bit 7 to indicate if a previous owner is defined for a bomb
-    assert(ATTACH_MAX<=127);
-    uint8_t type = m_type | (( (m_type==ATTACH_BOMB) && (m_previous_owner!=NULL) )
-                             ? 0x80 : 0 );
-    buffer->addUInt8(type);
-    if(m_type!=ATTACH_NOTHING)
+    // The time left is quantized to ticks, and (like the kart id of the
+    // previous owner of a bomb) only saved if there is an attachment.
+    assert(ATTACH_NOTHING < (1 << TYPE_BITS));
+    BitWriter writer(buffer);
+    writer.addBits(m_type, TYPE_BITS);
+    if(m_type==ATTACH_NOTHING)
+        return;
+
+    writer.addVarInt(int32_t(stk_config->time2Ticks(m_time_left)),
+                     TIME_CHUNK_BITS);
+    if(m_type==ATTACH_BOMB)
     {
-        buffer->addFloat(m_time_left);
-        if(m_type==ATTACH_BOMB && m_previous_owner)
-            buffer->addUInt8(m_previous_owner->getWorldKartId());
-        // m_initial_speed is not saved, on restore state it will
-        // be set to the kart speed, which has already been restored
+        writer.addBool(m_previous_owner!=NULL);
+        if(m_previous_owner)
+            writer.addBits(m_previous_owner->getWorldKartId(), KART_ID_BITS);
     }
+    // m_initial_speed is not saved, on restore state it will
+    // be set to the kart speed, which has already been restored
 }   // saveState
 
 // -----------------------------------------------------------------------------
@@ -254,8 +271,10 @@ void Attachment::saveState(BareNetworkString *buffer) const
  */
 void Attachment::rewindTo(BareNetworkString *buffer)
 {
-    uint8_t type = buffer->getUInt8();
-    AttachmentType new_type = AttachmentType(type & 0x7f);   // mask out bit 7
+    // All values must be read before returning, otherwise the next
+    // section of the state would not be read from the right position.
+    BitReader reader(buffer);
+    AttachmentType new_type = AttachmentType(reader.getBits(TYPE_BITS));
 
     // If there is no attachment, clear the attachment if necessary and exit
     if(new_type==ATTACH_NOTHING)
@@ -264,7 +283,14 @@ void Attachment::rewindTo(BareNetworkString *buffer)
         return;
     }
 
-    float time_left = buffer->getFloat();
+    float time_left =
+        stk_config->ticks2Time(reader.getVarInt(TIME_CHUNK_BITS));
+    AbstractKart *previous_owner = NULL;
+    if(new_type==ATTACH_BOMB && reader.getBool())
+    {
+        unsigned int kart_id = reader.getBits(KART_ID_BITS);
+        previous_owner = World::getWorld()->getKart(kart_id);
+    }
 
     // Attaching an object can be expensive (loading new models, ...)
     // so avoid doing this if there is no change in attachment type
@@ -275,16 +301,7 @@ void Attachment::rewindTo(BareNetworkString *buffer)
     }
 
     // Now it is a new attachment:
-
-    if (type == (ATTACH_BOMB | 0x80))   // we have previous owner information
-    {
-        uint8_t kart_id = buffer->getUInt8();
-        m_previous_owner = World::getWorld()->getKart(kart_id);
-    }
-    else
-    {
-        m_previous_owner = NULL;
-    }
+    m_previous_owner = previous_owner;
     set(new_type, time_left, m_previous_owner);
 }   // rewindTo
 // -----------------------------------------------------------------------------
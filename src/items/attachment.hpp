@@ -71,6 +71,16 @@ public:
     };
 
 private:
+    /** Number of bits used to save the type in a state. */
+    static const unsigned int TYPE_BITS = 4;
+
+    /** Size of the chunks the time left (in ticks) is saved in, see
+     *  BitWriter::addVarInt. */
+    static const unsigned int TIME_CHUNK_BITS = 6;
+
+    /** Number of bits used to save the kart id of the previous owner. */
+    static const unsigned int KART_ID_BITS = 8;
+
     /** Attachment type. */
     AttachmentType  m_type;
 
@@ -111,6 +121,7 @@ public:
           Attachment(AbstractKart* kart);
          ~Attachment();
     void  clear ();
+    void  reset ();
     void  hitBanana(Item *item, int new_attachment=-1);
     void  update (float dt);
     void  handleCollisionWithKart(AbstractKart *other);
@@ -140,6 +151,12 @@ public:
     /** Returns additional weight for the kart. */
     float weightAdjust() const;
     // ------------------------------------------------------------------------
+    /** Returns the random number generator (which is part of the rewind
+     *  state of the kart). */
+    RandomGenerator* getRandom() { return &m_random; }
+    // ------------------------------------------------------------------------
+    const RandomGenerator* getRandom() const { return &m_random; }
+    // ------------------------------------------------------------------------
     /** Return the currently associated scene node (used by e.g the swatter) */
     scene::IAnimatedMeshSceneNode* getNode() {return m_node;}
     // ------------------------------------------------------------------------
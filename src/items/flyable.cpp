@@ -37,6 +37,9 @@
 #include "karts/explosion_animation.hpp"
 #include "modes/linear_world.hpp"
 #include "modes/soccer_world.hpp"
+#include "network/network_config.hpp"
+#include "network/race_event_manager.hpp"
+#include "network/rewind_manager.hpp"
 #include "physics/physics.hpp"
 #include "tracks/track.hpp"
 #include "utils/constants.hpp"
@@ -201,6 +204,52 @@ Flyable::~Flyable()
     World::getWorld()->getPhysics()->removeBody(getBody());
 }   // ~Flyable
 
+//-----------------------------------------------------------------------------
+namespace
+{
+    /** The cost of aiming at a kart used by Flyable::getClosestKart: the
+     *  squared distance from the projectile, with the height difference
+     *  added again, or -1 if the kart can't be a target.
+     */
+    class TargetCost
+    {
+    private:
+        const AbstractKart *m_owner;
+        const SoccerWorld  *m_soccer_world;
+        Vec3                m_origin;
+    public:
+        TargetCost(const AbstractKart *owner, const Vec3 &origin)
+            : m_owner(owner), m_origin(origin)
+        {
+            m_soccer_world = dynamic_cast<SoccerWorld*>(World::getWorld());
+        }   // TargetCost
+        // --------------------------------------------------------------------
+        float operator()(unsigned int id) const
+        {
+            const AbstractKart *kart = World::getWorld()->getKart(id);
+            // If a kart has star effect shown, the kart is immune, so
+            // it is not considered a target anymore.
+            if(kart->isEliminated() || kart == m_owner ||
+                kart->isInvulnerable()                 ||
+                kart->getKartAnimation()                   ) return -1.0f;
+
+            // Don't hit teammates in soccer world
+            if(m_soccer_world &&
+               m_soccer_world->getKartTeam(kart->getWorldKartId()) ==
+               m_soccer_world->getKartTeam(m_owner->getWorldKartId()))
+                return -1.0f;
+
+            const Vec3 &xyz = kart->getTrans().getOrigin();
+            Vec3 delta      = xyz - m_origin;
+            // the Y distance is added again because karts above or below
+            // should not be prioritized when aiming
+            return delta.length2() + std::abs(xyz.getY() - m_origin.getY())*2;
+        }   // operator()
+        // --------------------------------------------------------------------
+        float getLowerBound(float distance) const { return distance*distance; }
+    };   // TargetCost
+}   // anonymous namespace
+
 //-----------------------------------------------------------------------------
 /** Returns information on what is the closest kart and at what distance it is.
  *  All 3 parameters first are of type 'out'. 'inFrontOf' can be set if you
@@ -220,53 +269,52 @@ void Flyable::getClosestKart(const AbstractKart **minKart,
     *minKart = NULL;
 
     World *world = World::getWorld();
-    for(unsigned int i=0 ; i<world->getNumKarts(); i++ )
+    const TargetCost cost(m_owner, trans_projectile.getOrigin());
+    if(inFrontOf == NULL)
     {
-        AbstractKart *kart = world->getKart(i);
-        // If a kart has star effect shown, the kart is immune, so
-        // it is not considered a target anymore.
-        if(kart->isEliminated() || kart == m_owner ||
-            kart->isInvulnerable()                 ||
-            kart->getKartAnimation()                   ) continue;
-
-        const SoccerWorld* sw = dynamic_cast<SoccerWorld*>(World::getWorld());
-        if (sw)
+        float distance2;
+        int id = world->getKartIndex().findClosest(trans_projectile.getOrigin(),
+                                                   cost, /*prefer_last*/false,
+                                                   &distance2);
+        if(id >= 0 && distance2 < *minDistSquared)
         {
-            // Don't hit teammates in soccer world
-            if (sw->getKartTeam(kart->getWorldKartId()) == sw
-                ->getKartTeam(m_owner->getWorldKartId()))
-            continue;
+            *minDistSquared = distance2;
+            *minKart  = world->getKart(id);
+            *minDelta = (*minKart)->getTrans().getOrigin()
+                      - trans_projectile.getOrigin();
         }
+        return;
+    }
 
-        btTransform t=kart->getTrans();
-
-        Vec3 delta      = t.getOrigin()-trans_projectile.getOrigin();
-        // the Y distance is added again because karts above or below should//
-        // not be prioritized when aiming
-        float distance2 = delta.length2() + std::abs(t.getOrigin().getY()
-                        - trans_projectile.getOrigin().getY())*2;
-
-        if(inFrontOf != NULL)
-        {
-            // Ignore karts behind the current one
-            Vec3 to_target       = kart->getXYZ() - inFrontOf->getXYZ();
-            const float distance = to_target.length();
-            if(distance > 50) continue; // kart too far, don't aim at it
-
-            btTransform trans = inFrontOf->getTrans();
-            // get heading=trans.getBasis*(0,0,1) ... so save the multiplication:
-            Vec3 direction(trans.getBasis().getColumn(2));
-            // Originally it used angle = to_target.angle( backwards ? -direction : direction );
-            // but sometimes due to rounding errors we get an acos(x) with x>1, causing
-            // an assertion failure. So we remove the whole acos() test here and copy the
-            // code from to_target.angle(...)
-            Vec3  v = backwards ? -direction : direction;
-            float s = sqrt(v.length2() * to_target.length2());
-            float c = to_target.dot(v)/s;
-            // Original test was: fabsf(acos(c))>1,  which is the same as
-            // c<cos(1) (acos returns values in [0, pi] anyway)
-            if(c<0.54) continue;
-        }
+    // Only karts closer than 50m to inFrontOf are considered.
+    std::vector<unsigned int> ids;
+    world->getKartIndex().getKartsInRadius(inFrontOf->getXYZ(), 50.0f, &ids);
+    for(unsigned int i=0 ; i<ids.size(); i++ )
+    {
+        AbstractKart *kart = world->getKart(ids[i]);
+        float distance2 = cost(ids[i]);
+        if(distance2 < 0) continue;
+
+        Vec3 delta = kart->getTrans().getOrigin()-trans_projectile.getOrigin();
+
+        // Ignore karts behind the current one
+        Vec3 to_target       = kart->getXYZ() - inFrontOf->getXYZ();
+        const float distance = to_target.length();
+        if(distance > 50) continue; // kart too far, don't aim at it
+
+        btTransform trans = inFrontOf->getTrans();
+        // get heading=trans.getBasis*(0,0,1) ... so save the multiplication:
+        Vec3 direction(trans.getBasis().getColumn(2));
+        // Originally it used angle = to_target.angle( backwards ? -direction : direction );
+        // but sometimes due to rounding errors we get an acos(x) with x>1, causing
+        // an assertion failure. So we remove the whole acos() test here and copy the
+        // code from to_target.angle(...)
+        Vec3  v = backwards ? -direction : direction;
+        float s = sqrt(v.length2() * to_target.length2());
+        float c = to_target.dot(v)/s;
+        // Original test was: fabsf(acos(c))>1,  which is the same as
+        // c<cos(1) (acos returns values in [0, pi] anyway)
+        if(c<0.54) continue;
 
         if(distance2 < *minDistSquared)
         {
@@ -274,7 +322,7 @@ void Flyable::getClosestKart(const AbstractKart **minKart,
             *minKart  = kart;
             *minDelta = delta;
         }
-    }  // for i<getNumKarts
+    }  // for i<ids.size()
 
 }   // getClosestKart
 
@@ -391,6 +439,10 @@ bool Flyable::updateAndDelete(float dt)
         return true;
     }
 
+    if (RaceEventManager::getInstance()->isRunning() &&
+        NetworkConfig::get()->isServer() && checkLagCompensatedHit())
+        return true;
+
     if (m_do_terrain_info)
     {
         Vec3 towards = getBody()->getGravity();
@@ -444,6 +496,43 @@ bool Flyable::updateAndDelete(float dt)
     return false;
 }   // updateAndDelete
 
+// ----------------------------------------------------------------------------
+/** Tests on the server if a flyable shot by a client hits a kart at the
+ *  position the kart had when the client saw it (see LagCompensation).
+ *  The test uses a sphere around the kart, with half the kart length plus
+ *  half the size of the flyable as radius. Hits at the current positions
+ *  are detected by the physics.
+ *  \return True if a kart was hit.
+ */
+bool Flyable::checkLagCompensatedHit()
+{
+    LagCompensation *lc = RewindManager::get()->getLagCompensation();
+    World *world = World::getWorld();
+    const int64_t ticks = world->getTimeTicks();
+    const int64_t view_ticks = lc->getViewTicks(m_owner->getWorldKartId(),
+                                                ticks);
+    if (view_ticks == ticks) return false;
+
+    const Vec3 &xyz = getXYZ();
+    const float size = 0.5f * std::max(m_extend.getX(), m_extend.getZ());
+    for (unsigned int i = 0; i < world->getNumKarts(); i++)
+    {
+        AbstractKart *kart = world->getKart(i);
+        if (kart == m_owner || kart->isEliminated()) continue;
+        // Same as in Physics::update
+        if (m_type == PowerupManager::POWERUP_BOWLING &&
+            kart->isInvulnerable())
+            continue;
+
+        Vec3 kart_xyz;
+        if (!lc->getKartXYZ(i, view_ticks, &kart_xyz)) continue;
+        const float radius = 0.5f * kart->getKartLength() + size;
+        if ((kart_xyz - xyz).length2() < radius * radius && hit(kart))
+            return true;
+    }
+    return false;
+}   // checkLagCompensatedHit
+
 // ----------------------------------------------------------------------------
 /** Returns true if the item hit the kart who shot it (to avoid that an item
  *  that's too close to the shooter hits the shooter).
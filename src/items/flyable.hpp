@@ -143,6 +143,7 @@ protected:
                                        float forw_offset,
                                        float *fire_angle, float *up_velocity);
 
+    bool checkLagCompensatedHit();
 
     /** init bullet for moving objects like projectiles */
     void              createPhysics(float y_offset,
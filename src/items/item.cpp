@@ -21,8 +21,10 @@
 
 #include "graphics/irr_driver.hpp"
 #include "graphics/lod_node.hpp"
+#include "items/item_manager.hpp"
 #include "karts/abstract_kart.hpp"
 #include "modes/easter_egg_hunt.hpp"
+#include "modes/profile_world.hpp"
 #include "modes/three_strikes_battle.hpp"
 #include "modes/world.hpp"
 #include "tracks/arena_graph.hpp"
@@ -48,6 +50,11 @@ Item::Item(ItemType type, const Vec3& xyz, const Vec3& normal,
     m_original_mesh     = mesh;
     m_original_lowmesh  = lowres_mesh;
     m_listener          = NULL;
+    m_node              = NULL;
+
+    // A server or profile run without graphics only simulates the item.
+    if (ProfileWorld::isNoGraphics())
+        return;
 
     LODNode* lodnode    = new LODNode("item",
                                       irr_driver->getSceneManager()->getRootSceneNode(),
@@ -73,7 +80,7 @@ Item::Item(ItemType type, const Vec3& xyz, const Vec3& normal,
     //m_node             = irr_driver->addMesh(mesh);
 #ifdef DEBUG
     std::string debug_name("item: ");
-    debug_name += m_type;
+    debug_name += type;
     m_node->setName(debug_name.c_str());
 #endif
 
@@ -106,30 +113,17 @@ Item::Item(const Vec3& xyz, float distance, TriggerItemListener* trigger)
 
 //-----------------------------------------------------------------------------
 /** Initialises the item. Note that m_distance_2 must be defined before calling
- *  this function, since it pre-computes some values based on this.
+ *  this function, since it pre-computes some values based on this. The
+ *  state of the item is initialised by the ItemManager when the item is
+ *  added (see ItemManager::insertItem).
  *  \param type Type of the item.
  */
 void Item::initItem(ItemType type, const Vec3 &xyz)
 {
-    m_type              = type;
     m_xyz               = xyz;
-    m_event_handler     = NULL;
     m_item_id           = -1;
-    m_collected         = false;
     m_original_type     = ITEM_NONE;
-    m_deactive_time     = 0;
-    m_time_till_return  = 0.0f;  // not strictly necessary, see isCollected()
     m_emitter           = NULL;
-    m_rotate            = (type!=ITEM_BUBBLEGUM) && (type!=ITEM_TRIGGER);
-    switch(m_type)
-    {
-    case ITEM_BUBBLEGUM:
-        m_disappear_counter = stk_config->m_bubblegum_counter; break;
-    case ITEM_EASTER_EGG:
-        m_disappear_counter = -1; break;
-    default:
-        m_disappear_counter = -1;
-    }
     // Now determine in which quad this item is, and its distance
     // from the center within this quad.
     m_graph_node = Graph::UNKNOWN_SECTOR;
@@ -161,15 +155,87 @@ void Item::initItem(ItemType type, const Vec3 &xyz)
 }   // initItem
 
 //-----------------------------------------------------------------------------
-/** Sets the type of the item (and also derived attributes lile m_rotate
+/** Sets the type of the item.
  *  \param type Type of the item.
  */
 void Item::setType(ItemType type)
 {
-    m_type   = type;
-    m_rotate = (type!=ITEM_BUBBLEGUM) && (type!=ITEM_TRIGGER);
+    ItemManager::get()->m_item_type[m_item_id] = (unsigned char)type;
 }   // setType
 
+//-----------------------------------------------------------------------------
+/** Returns the type of this item. */
+Item::ItemType Item::getType() const
+{
+    return (ItemType)ItemManager::get()->m_item_type[m_item_id];
+}   // getType
+
+//-----------------------------------------------------------------------------
+/** Returns true if this item is currently collected. */
+bool Item::wasCollected() const
+{
+    return ItemManager::get()->m_item_collected[m_item_id] != 0;
+}   // wasCollected
+
+//-----------------------------------------------------------------------------
+/** Returns true if this item is used up and can be removed. */
+bool Item::isUsedUp() const
+{
+    return ItemManager::get()->m_item_disappear_counter[m_item_id] == 0;
+}   // isUsedUp
+
+//-----------------------------------------------------------------------------
+/** Returns true if this item can be used up, and therefore needs to
+ *  be removed when the game is reset. */
+bool Item::canBeUsedUp() const
+{
+    return ItemManager::get()->m_item_disappear_counter[m_item_id] > -1;
+}   // canBeUsedUp
+
+//-----------------------------------------------------------------------------
+/** Sets how long an item should be disabled. While item itself sets
+ *  a default, this time is too short in case that a kart that has a bomb
+ *  hits a banana: by the time the explosion animation is ended and the
+ *  kart is back at its original position, the banana would be back again
+ *  and therefore hit the kart again. See Attachment::hitBanana for more
+ *  details.
+ *  \param f Time till the item can be used again.
+ */
+void Item::setDisableTime(float f)
+{
+    ItemManager::get()->m_item_time_till_return[m_item_id] = f;
+}   // setDisableTime
+
+//-----------------------------------------------------------------------------
+/** Returns the time the item is disabled for. */
+float Item::getDisableTime() const
+{
+    return ItemManager::get()->m_item_time_till_return[m_item_id];
+}   // getDisableTime
+
+//-----------------------------------------------------------------------------
+/** Returns true if the Kart is close enough to hit this item, the item is
+ *  not deactivated anymore, and it wasn't placed by this kart (this is
+ *  e.g. used to avoid that a kart hits a bubble gum it just dropped).
+ *  \param kart Kart to test.
+ *  \param xyz Location of kart (avoiding to use kart->getXYZ() so that
+ *         kart.hpp does not need to be included here).
+ */
+bool Item::hitKart(const Vec3 &xyz, const AbstractKart *kart) const
+{
+    return ItemManager::get()->hitKart(m_item_id, xyz, kart);
+}   // hitKart
+
+//-----------------------------------------------------------------------------
+/** Returns the value of the disappear counter of a new item of the given
+ *  type, see ItemManager::m_item_disappear_counter.
+ *  \param type Type of the item.
+ */
+int Item::getInitialDisappearCounter(ItemType type)
+{
+    return type == ITEM_BUBBLEGUM ? stk_config->m_bubblegum_counter : -1;
+}   // getInitialDisappearCounter
+
 //-----------------------------------------------------------------------------
 /** Changes this item to be a new type for a certain amount of time.
  *  \param type New type of this item.
@@ -178,11 +244,14 @@ void Item::setType(ItemType type)
 void Item::switchTo(ItemType type, scene::IMesh *mesh, scene::IMesh *lowmesh)
 {
     // triggers and easter eggs should not be switched
-    if (m_type == ITEM_TRIGGER || m_type == ITEM_EASTER_EGG) return;
+    const ItemType old_type = getType();
+    if (old_type == ITEM_TRIGGER || old_type == ITEM_EASTER_EGG) return;
 
-    m_original_type = m_type;
+    m_original_type = old_type;
     setType(type);
 
+    if (m_node == NULL) return;
+
     scene::ISceneNode* node = m_node->getAllNodes()[0];
     ((scene::IMeshSceneNode*)node)->setMesh(mesh);
     if (lowmesh != NULL)
@@ -203,7 +272,7 @@ void Item::switchTo(ItemType type, scene::IMesh *mesh, scene::IMesh *lowmesh)
 void Item::switchBack()
 {
     // triggers should not be switched
-    if (m_type == ITEM_TRIGGER) return;
+    if (getType() == ITEM_TRIGGER) return;
 
     // If the item is not switched, do nothing. This can happen if a bubble
     // gum is dropped while items are switched - when switching back, this
@@ -214,6 +283,8 @@ void Item::switchBack()
     setType(m_original_type);
     m_original_type = ITEM_NONE;
 
+    if (m_node == NULL) return;
+
     scene::ISceneNode* node = m_node->getAllNodes()[0];
     ((scene::IMeshSceneNode*)node)->setMesh(m_original_mesh);
     if (m_original_lowmesh != NULL)
@@ -249,29 +320,20 @@ Item::~Item()
  */
 void Item::reset()
 {
-    m_collected         = false;
-    m_time_till_return  = 0.0f;
-    m_deactive_time     = 0.0f;
-    switch(m_type)
-    {
-    case ITEM_BUBBLEGUM:
-        m_disappear_counter = stk_config->m_bubblegum_counter; break;
-    case ITEM_EASTER_EGG:
-        m_disappear_counter = -1; break;
-    default:
-        m_disappear_counter = -1;
-    }
+    ItemManager *im = ItemManager::get();
+    im->m_item_collected[m_item_id]        = 0;
+    im->m_item_time_till_return[m_item_id] = 0.0f;
+    im->m_item_deactive_time[m_item_id]    = 0.0f;
     if(m_original_type!=ITEM_NONE)
     {
         setType(m_original_type);
         m_original_type = ITEM_NONE;
     }
+    im->m_item_disappear_counter[m_item_id] =
+        getInitialDisappearCounter(getType());
 
-    if (m_node != NULL)
-    {
-        m_node->setScale(core::vector3df(1,1,1));
-        m_node->setVisible(true);
-    }
+    setScale(1.0f);
+    setVisible(true);
 }   // reset
 
 //-----------------------------------------------------------------------------
@@ -281,61 +343,55 @@ void Item::reset()
  */
 void Item::setParent(AbstractKart* parent)
 {
-    m_event_handler = parent;
+    ItemManager *im = ItemManager::get();
+    im->m_item_owner[m_item_id]         = parent;
+    im->m_item_deactive_time[m_item_id] = 1.5f;
     m_emitter       = parent;
-    m_deactive_time = 1.5f;
 }   // setParent
 
 //-----------------------------------------------------------------------------
-/** Updated the item - rotates it, takes care of items coming back into
- *  the game after it has been collected.
- *  \param dt Time step size.
+/** Sets the scale of the scene node (if there is one).
+ *  \param scale The scale.
  */
-void Item::update(float dt)
+void Item::setScale(float scale)
 {
-    if(m_deactive_time > 0) m_deactive_time -= dt;
+    if (m_node != NULL)
+        m_node->setScale(core::vector3df(1,1,1)*scale);
+}   // setScale
 
-    if(m_collected)
-    {
-        m_time_till_return -= dt;
-        if(m_time_till_return<0)
-        {
-            m_collected=false;
-
-            if (m_node != NULL)
-            {
-                m_node->setScale(core::vector3df(1,1,1));
-            }
-        }   // time till return <0 --> is fully visible again
-        else if ( m_time_till_return <=1.0f )
-        {
-            if (m_node != NULL)
-            {
-                // Make it visible by scaling it from 0 to 1:
-                m_node->setVisible(true);
-                m_node->setScale(core::vector3df(1,1,1)*(1-m_time_till_return));
-            }
-        }   // time till return < 1
-    }   // if collected
-    else
-    {   // not m_collected
+//-----------------------------------------------------------------------------
+/** Shows or hides the scene node (if there is one).
+ *  \param visible If the item should be visible.
+ */
+void Item::setVisible(bool visible)
+{
+    if (m_node != NULL)
+        m_node->setVisible(visible);
+}   // setVisible
+
+//-----------------------------------------------------------------------------
+/** Rotates the item. Called by the item manager for items that are not
+ *  collected and rotate. The rotation is only updated if the item is close
+ *  enough to the camera to be displayed, otherwise it just continues to
+ *  rotate once it becomes visible again.
+ *  \param dt Time step size.
+ */
+void Item::updateGraphics(float dt)
+{
+    if (m_node == NULL || m_node->getLevel() < 0) return;
 
-        if(!m_rotate || m_node == NULL) return;
-        // have it rotate
-        m_rotation_angle += dt * M_PI ;
-        if (m_rotation_angle > M_PI * 2) m_rotation_angle -= M_PI * 2;
+    m_rotation_angle += dt * M_PI ;
+    if (m_rotation_angle > M_PI * 2) m_rotation_angle -= M_PI * 2;
 
-        btMatrix3x3 m;
-        m.setRotation(m_original_rotation);
-        btQuaternion r = btQuaternion(m.getColumn(1), m_rotation_angle) *
-            m_original_rotation;
+    btMatrix3x3 m;
+    m.setRotation(m_original_rotation);
+    btQuaternion r = btQuaternion(m.getColumn(1), m_rotation_angle) *
+        m_original_rotation;
 
-        Vec3 hpr;
-        hpr.setHPR(r);
-        m_node->setRotation(hpr.toIrrHPR());
-        return;
-    }   // not m_collected
-}   // update
+    Vec3 hpr;
+    hpr.setHPR(r);
+    m_node->setRotation(hpr.toIrrHPR());
+}   // updateGraphics
 
 //-----------------------------------------------------------------------------
 /** Is called when the item is hit by a kart.  It sets the flag that the item
@@ -344,39 +400,36 @@ void Item::update(float dt)
  */
 void Item::collected(const AbstractKart *kart, float t)
 {
-    m_collected     = true;
-    m_event_handler = kart;
-    if(m_type==ITEM_EASTER_EGG)
+    ItemManager *im = ItemManager::get();
+    const unsigned int id = m_item_id;
+    im->m_item_collected[id] = 1;
+    im->m_item_owner[id]     = kart;
+    const ItemType type = getType();
+    if(type==ITEM_EASTER_EGG)
     {
-        m_time_till_return=99999;
+        im->m_item_time_till_return[id] = 99999;
         EasterEggHunt *world = dynamic_cast<EasterEggHunt*>(World::getWorld());
         assert(world);
         world->collectedEasterEgg(kart);
-        if (m_node != NULL)
-        {
-            m_node->setVisible(false);
-        }
+        setVisible(false);
     }
-    else if(m_type==ITEM_BUBBLEGUM && m_disappear_counter>0)
+    else if(type==ITEM_BUBBLEGUM && im->m_item_disappear_counter[id]>0)
     {
-        m_disappear_counter --;
+        im->m_item_disappear_counter[id]--;
         // Deactivates the item for a certain amount of time. It is used to
         // prevent bubble gum from hitting a kart over and over again (in each
         // frame) by giving it time to drive away.
-        m_deactive_time = 0.5f;
+        im->m_item_deactive_time[id] = 0.5f;
         // Set the time till reappear to -1 seconds --> the item will
         // reappear immediately.
-        m_time_till_return = -1;
+        im->m_item_time_till_return[id] = -1;
     }
     else
     {
-        // Note if the time is negative, in update the m_collected flag will
+        // Note if the time is negative, in update the collected flag will
         // be automatically set to false again.
-        m_time_till_return = t;
-        if (m_node != NULL)
-        {
-            m_node->setVisible(false);
-        }
+        im->m_item_time_till_return[id] = t;
+        setVisible(false);
     }
 
     if (m_listener != NULL)
@@ -386,7 +439,6 @@ void Item::collected(const AbstractKart *kart, float t)
 
     if (dynamic_cast<ThreeStrikesBattle*>(World::getWorld()) != NULL)
     {
-        m_time_till_return *= 3;
+        im->m_item_time_till_return[id] *= 3;
     }
 }   // isCollected
-
@@ -56,6 +56,13 @@ public:
 };
 
 /**
+  * \brief An item on the track.
+  * The state that is simulated each frame (type, collected flag, respawn
+  * timer, owner etc.) is stored in arrays in the ItemManager, indexed by
+  * the item id, so that updating items and testing for hits only touches
+  * contiguous data. This object stores the remaining data (mostly the
+  * graphical representation and data for the AI), and gives access to the
+  * state of this item.
   * \ingroup items
   */
 class Item : public NoCopy
@@ -90,9 +97,6 @@ public:
 private:
     LEAK_CHECK();
 
-    /** Item type. */
-    ItemType      m_type;
-
     /** If the item is switched, this contains the original type.
      *  It is ITEM_NONE if the item is not switched. */
     ItemType      m_original_type;
@@ -107,13 +111,8 @@ private:
     /** Used when rotating the item */
     float         m_rotation_angle;
 
-    /** True if item was collected & is not displayed. */
-    bool          m_collected;
-
-    /** Time till a collected item reappears. */
-    float         m_time_till_return;
-
-    /** Scene node of this item. */
+    /** Scene node of this item, NULL for trigger items and if graphics are
+     *  disabled. */
     LODNode *m_node;
 
     /** Stores the original mesh in order to reset it. */
@@ -124,29 +123,13 @@ private:
      * and then converting this value to a Vec3. */
     Vec3          m_xyz;
 
-    /** Index in item_manager field. */
+    /** Index in item_manager field, which is also the index of the state
+     *  of this item in the ItemManager. */
     unsigned int  m_item_id;
 
-    /** Set to false if item should not rotate. */
-    bool          m_rotate;
-
-    /** Optionally set this if this item was laid by a particular kart. in
-     *  this case the 'm_deactive_time' will also be set - see below. */
-    const AbstractKart   *m_event_handler;
-
     /** Kart that emitted this item if any */
     const AbstractKart   *m_emitter;
 
-    /** Optionally if item was placed by a kart, a timer can be used to
-     *  temporarly deactivate collision so a kart is not hit by its own item */
-    float         m_deactive_time;
-
-    /** Counts how often an item is used before it disappears. Used for
-     *  bubble gum to make them disappear after a while. A value >0
-     *  indicates that the item still exists, =0 that the item can be
-     *  deleted, and <0 that the item will never be deleted. */
-    int           m_disappear_counter;
-
     /** callback used if type == ITEM_TRIGGER */
     TriggerItemListener* m_listener;
 
@@ -168,6 +151,13 @@ private:
 
     void          initItem(ItemType type, const Vec3 &xyz);
     void          setType(ItemType type);
+    void          setScale(float scale);
+    void          setVisible(bool visible);
+    void          updateGraphics(float dt);
+    static int    getInitialDisappearCounter(ItemType type);
+
+    // The item manager updates the state and the graphics of all items.
+    friend class ItemManager;
 
 public:
                   Item(ItemType type, const Vec3& xyz, const Vec3& normal,
@@ -175,29 +165,21 @@ public:
                   Item(const Vec3& xyz, float distance,
                        TriggerItemListener* trigger);
     virtual       ~Item ();
-    void          update  (float delta);
     virtual void  collected(const AbstractKart *kart, float t=2.0f);
     void          setParent(AbstractKart* parent);
     void          reset();
     void          switchTo(ItemType type, scene::IMesh *mesh, scene::IMesh *lowmesh);
     void          switchBack();
+    bool          hitKart(const Vec3 &xyz, const AbstractKart *kart=NULL) const;
+    ItemType      getType() const;
+    bool          wasCollected() const;
+    bool          isUsedUp() const;
+    bool          canBeUsedUp() const;
+    void          setDisableTime(float f);
+    float         getDisableTime() const;
 
     const AbstractKart* getEmitter() const { return m_emitter; }
 
-    // ------------------------------------------------------------------------
-    /** Returns true if the Kart is close enough to hit this item, the item is
-     *  not deactivated anymore, and it wasn't placed by this kart (this is
-     *  e.g. used to avoid that a kart hits a bubble gum it just dropped).
-     *  \param kart Kart to test.
-     *  \param xyz Location of kart (avoiding to use kart->getXYZ() so that
-     *         kart.hpp does not need to be included here).
-     */
-    bool hitKart(const Vec3 &xyz, const AbstractKart *kart=NULL) const
-    {
-        return (m_event_handler!=kart || m_deactive_time <=0) &&
-               (xyz-m_xyz).length2()<m_distance_2;
-    }   // hitKart
-
 protected:
     // ------------------------------------------------------------------------
     // Some convenient functions for the AI only
@@ -211,8 +193,6 @@ protected:
     bool hitLine(const core::line3df &line,
                   const AbstractKart *kart=NULL) const
     {
-        if(m_event_handler==kart && m_deactive_time >0) return false;
-        
         Vec3 closest = line.getClosestPoint(m_xyz.toIrrVector());
         return hitKart(closest, kart);
     }   // hitLine
@@ -225,32 +205,6 @@ public:
     /** Returns the index of this item in the item manager list. */
     unsigned int  getItemId()    const { return m_item_id;  }
     // ------------------------------------------------------------------------
-    /** Returns the type of this item. */
-    ItemType      getType()      const { return m_type;     }
-    // ------------------------------------------------------------------------
-    /** Returns true if this item is currently collected. */
-    bool          wasCollected() const { return m_collected;}
-    // ------------------------------------------------------------------------
-    /** Returns true if this item is used up and can be removed. */
-    bool          isUsedUp()     const {return m_disappear_counter==0; }
-    // ------------------------------------------------------------------------
-    /** Returns true if this item can be used up, and therefore needs to
-     *  be removed when the game is reset. */
-    bool          canBeUsedUp()  const {return m_disappear_counter>-1; }
-    // ------------------------------------------------------------------------
-    /** Sets how long an item should be disabled. While item itself sets
-     *  a default, this time is too short in case that a kart that has a bomb
-     *  hits a banana: by the time the explosion animation is ended and the
-     *  kart is back at its original position, the banana would be back again
-     *  and therefore hit the kart again. See Attachment::hitBanana for more
-     *  details.
-     *  \param f Time till the item can be used again.
-     */
-    void          setDisableTime(float f) { m_time_till_return = f; }
-    // ------------------------------------------------------------------------
-    /** Returns the time the item is disabled for. */
-    float         getDisableTime() const { return m_time_till_return; }
-    // ------------------------------------------------------------------------
     /** Returns the XYZ position of the item. */
     const Vec3&   getXYZ() const { return m_xyz; }
     // ------------------------------------------------------------------------
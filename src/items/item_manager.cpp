@@ -31,8 +31,11 @@
 #include "karts/abstract_kart.hpp"
 #include "karts/controller/spare_tire_ai.hpp"
 #include "modes/linear_world.hpp"
+#include "modes/profile_world.hpp"
+#include "network/lag_compensation.hpp"
 #include "network/network_config.hpp"
 #include "network/race_event_manager.hpp"
+#include "network/rewind_manager.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "tracks/arena_graph.hpp"
 #include "tracks/arena_node.hpp"
@@ -203,10 +206,13 @@ ItemManager::~ItemManager()
 
 //-----------------------------------------------------------------------------
 /** Inserts the new item into the items management data structures, if possible
- *  reusing an existing, unused entry (e.g. due to a removed bubble gum). Then
- *  the item is also added to the quad-wise list of items.
+ *  reusing an existing, unused entry (e.g. due to a removed bubble gum), and
+ *  initialises the state of the item. Then the item is also added to the
+ *  quad-wise list of items.
+ *  \param item The new item.
+ *  \param type Type of the item.
  */
-void ItemManager::insertItem(Item *item)
+void ItemManager::insertItem(Item *item, Item::ItemType type)
 {
     // Find where the item can be stored in the index list: either in a
     // previously deleted entry, otherwise at the end.
@@ -218,9 +224,31 @@ void ItemManager::insertItem(Item *item)
     if(index<(int)m_all_items.size())
         m_all_items[index] = item;
     else
+    {
         m_all_items.push_back(item);
+        m_item_type.push_back(Item::ITEM_NONE);
+        m_item_collected.push_back(0);
+        m_item_xyz.resize(m_item_xyz.size()+3);
+        m_item_distance_2.push_back(0);
+        m_item_time_till_return.push_back(0);
+        m_item_deactive_time.push_back(0);
+        m_item_owner.push_back(NULL);
+        m_item_disappear_counter.push_back(-1);
+    }
     item->setItemId(index);
 
+    const Vec3 &xyz = item->getXYZ();
+    m_item_type[index]              = (unsigned char)type;
+    m_item_collected[index]         = 0;
+    m_item_xyz[3*index  ]           = xyz.getX();
+    m_item_xyz[3*index+1]           = xyz.getY();
+    m_item_xyz[3*index+2]           = xyz.getZ();
+    m_item_distance_2[index]        = item->m_distance_2;
+    m_item_time_till_return[index]  = 0.0f;
+    m_item_deactive_time[index]     = 0.0f;
+    m_item_owner[index]             = NULL;
+    m_item_disappear_counter[index] = Item::getInitialDisappearCounter(type);
+
     // Now insert into the appropriate quad list, if there is a quad list
     // (i.e. race mode has a quad graph).
     if(m_items_in_quads)
@@ -256,7 +284,7 @@ Item* ItemManager::newItem(Item::ItemType type, const Vec3& xyz,
     Item* item = new Item(type, xyz, normal, m_item_mesh[mesh_type],
                           m_item_lowres_mesh[mesh_type]);
 
-    insertItem(item);
+    insertItem(item, type);
     if(parent != NULL) item->setParent(parent);
     if(m_switch_time>=0)
     {
@@ -276,11 +304,32 @@ Item* ItemManager::newItem(const Vec3& xyz, float distance,
 {
     Item* item;
     item = new Item(xyz, distance, listener);
-    insertItem(item);
+    insertItem(item, Item::ITEM_TRIGGER);
 
     return item;
 }   // newItem
 
+//-----------------------------------------------------------------------------
+/** Returns true if a kart at the given position collects item n: the item
+ *  must be close enough, and if the kart placed (or just collected) the
+ *  item it must not be deactivated anymore. The kart and its position are
+ *  passed separately so that kart.hpp does not need to be included.
+ *  \param n Index of the item.
+ *  \param xyz Position of the kart.
+ *  \param kart The kart.
+ */
+bool ItemManager::hitKart(unsigned int n, const Vec3 &xyz,
+                          const AbstractKart *kart) const
+{
+    if (m_item_owner[n] == kart && m_item_deactive_time[n] > 0)
+        return false;
+    const float *p = &m_item_xyz[3*n];
+    const float dx = xyz.getX() - p[0];
+    const float dy = xyz.getY() - p[1];
+    const float dz = xyz.getZ() - p[2];
+    return dx*dx + dy*dy + dz*dz < m_item_distance_2[n];
+}   // hitKart
+
 //-----------------------------------------------------------------------------
 /** Set an item as collected.
  *  This function is called on the server when an item is collected, or on
@@ -314,31 +363,63 @@ void  ItemManager::checkItemHit(AbstractKart* kart)
     // it is possible that a quad is that short that we need to test adjacent
     // of adjacent quads. And check for items outside of the track.
     // Since at this stace item detection is by far not a bottle neck,
-    // the original, simple and stable algorithm is left in place.
+    // the original, simple and stable algorithm is left in place. It only
+    // looks at the state arrays, the item itself is only accessed if it
+    // is hit.
 
-    for(AllItemTypes::iterator i =m_all_items.begin();
-        i!=m_all_items.end();  i++)
+    const Vec3 &xyz = kart->getXYZ();
+    const unsigned int num_items = (unsigned int)m_all_items.size();
+    for(unsigned int n=0; n<num_items; n++)
     {
-        if((!*i) || (*i)->wasCollected()) continue;
-        // To allow inlining and avoid including kart.hpp in item.hpp,
-        // we pass the kart and the position separately.
-        if((*i)->hitKart(kart->getXYZ(), kart))
+        if(m_item_type[n]==Item::ITEM_NONE || m_item_collected[n]) continue;
+        if(hitKart(n, xyz, kart))
         {
+            Item *item = m_all_items[n];
             // if we're not playing online, pick the item.
             if (!RaceEventManager::getInstance()->isRunning())
-                collectedItem(*i, kart);
+                collectedItem(item, kart);
             else if (NetworkConfig::get()->isServer())
             {
                 // Only the server side detects item being collected
                 // A client does the collection upon receiving the 
                 // event from the server!
-                collectedItem(*i, kart);
-                RaceEventManager::getInstance()->collectedItem(*i, kart);
+                collectedItem(item, kart);
+                RaceEventManager::getInstance()->collectedItem(item, kart);
             }
         }   // if hit
-    }   // for m_all_items
+    }   // for n < num_items
 }   // checkItemHit
 
+//-----------------------------------------------------------------------------
+/** Checks if a kart collected an item anywhere on the path between two
+ *  positions. This is used on the server for the path between two
+ *  positions reported by a client, so that items the client drove through
+ *  are collected even if the kart on the server missed them (see
+ *  LagCompensation).
+ *  \param kart Pointer to the kart.
+ *  \param from Start of the path.
+ *  \param to End of the path.
+ */
+void ItemManager::checkItemHitOnPath(AbstractKart* kart, const Vec3 &from,
+                                     const Vec3 &to)
+{
+    const unsigned int num_items = (unsigned int)m_all_items.size();
+    for(unsigned int n=0; n<num_items; n++)
+    {
+        if(m_item_type[n]==Item::ITEM_NONE || m_item_collected[n]) continue;
+        const Vec3 item_xyz(m_item_xyz[3*n], m_item_xyz[3*n+1],
+                            m_item_xyz[3*n+2]);
+        const Vec3 closest =
+            LagCompensation::getClosestPoint(from, to, item_xyz);
+        if(hitKart(n, closest, kart))
+        {
+            collectedItem(m_all_items[n], kart);
+            RaceEventManager::getInstance()->collectedItem(m_all_items[n],
+                                                           kart);
+        }
+    }   // for n < num_items
+}   // checkItemHitOnPath
+
 //-----------------------------------------------------------------------------
 /** Resets all items and removes bubble gum that is stuck on the track.
  *  This is done when a race is (re)started.
@@ -404,20 +485,67 @@ void ItemManager::update(float dt)
         }   // m_switch_time < 0
     }   // m_switch_time>=0
 
-    for(AllItemTypes::iterator i =m_all_items.begin();
-        i!=m_all_items.end();  i++)
+    // Update the state of all items in one pass over the state arrays. The
+    // scene node of an item is only changed if its state changes, or to
+    // rotate it. The items are not rotated while resimulating after a
+    // rewind, see updateGraphics().
+    const bool graphics = !ProfileWorld::isNoGraphics();
+    const bool rotate   = graphics && !RewindManager::get()->isRewinding();
+    const unsigned int num_items = (unsigned int)m_all_items.size();
+    for(unsigned int n=0; n<num_items; n++)
     {
-        if(*i)
+        const unsigned char type = m_item_type[n];
+        if(type==Item::ITEM_NONE) continue;
+
+        if(m_item_deactive_time[n] > 0) m_item_deactive_time[n] -= dt;
+
+        if(m_item_collected[n])
         {
-            (*i)->update(dt);
-            if( (*i)->isUsedUp())
+            float &time_till_return = m_item_time_till_return[n];
+            time_till_return -= dt;
+            if(time_till_return<0)
             {
-                deleteItem( *i );
-            }   // if usedUp
-        }   // if *i
-    }   // for m_all_items
+                m_item_collected[n] = 0;
+                if(graphics)
+                    m_all_items[n]->setScale(1.0f);
+            }   // time till return <0 --> is fully visible again
+            else if(time_till_return<=1.0f && graphics)
+            {
+                // Make it visible by scaling it from 0 to 1:
+                m_all_items[n]->setVisible(true);
+                m_all_items[n]->setScale(1.0f-time_till_return);
+            }   // time till return < 1
+        }   // if collected
+        else if(rotate && type!=Item::ITEM_BUBBLEGUM &&
+                type!=Item::ITEM_TRIGGER)
+        {
+            m_all_items[n]->updateGraphics(dt);
+        }
+
+        if(m_item_disappear_counter[n]==0)
+            deleteItem(m_all_items[n]);
+    }   // for n < num_items
 }   // update
 
+//-----------------------------------------------------------------------------
+/** Rotates all visible items. This is called after resimulating a rewind,
+ *  since the items are not rotated during the resimulation.
+ *  \param dt The time that was resimulated.
+ */
+void ItemManager::updateGraphics(float dt)
+{
+    if (ProfileWorld::isNoGraphics()) return;
+    const unsigned int num_items = (unsigned int)m_all_items.size();
+    for(unsigned int n=0; n<num_items; n++)
+    {
+        const unsigned char type = m_item_type[n];
+        if(type==Item::ITEM_NONE || type==Item::ITEM_BUBBLEGUM ||
+           type==Item::ITEM_TRIGGER || m_item_collected[n])
+            continue;
+        m_all_items[n]->updateGraphics(dt);
+    }   // for n < num_items
+}   // updateGraphics
+
 //-----------------------------------------------------------------------------
 /** Removes an items from the items-in-quad list, from the list of all
  *  items, and then frees the item itself.
@@ -439,7 +567,9 @@ void ItemManager::deleteItem(Item *item)
     }   // if m_items_in_quads
 
     int index = item->getItemId();
-    m_all_items[index] = NULL;
+    m_all_items[index]  = NULL;
+    m_item_type[index]  = Item::ITEM_NONE;
+    m_item_owner[index] = NULL;
     delete item;
 }   // delete item
 
@@ -497,6 +627,7 @@ bool ItemManager::randomItemsForArena(const AlignedArray<btTransform>& pos)
     }
 
     RandomGenerator random;
+    random.seedForRace(RandomGenerator::RS_ITEMS);
     const unsigned int ALL_NODES = ag->getNumNodes();
     const unsigned int MIN_DIST = int(sqrt(ALL_NODES));
     const unsigned int TOTAL_ITEM = MIN_DIST / 2;
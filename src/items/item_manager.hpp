@@ -32,9 +32,18 @@
 #include <string>
 #include <vector>
 
+class AbstractKart;
 class Kart;
 
 /**
+  * \brief Manages all items of a race.
+  * The state of all items that changes during a race is stored here in
+  * arrays indexed by the item id (structure of arrays), so that update()
+  * and the hit tests can process all items in one pass over contiguous
+  * data, without calling each item. The graphical representation of an
+  * item is only updated if its state changes, or (for the rotation) if it
+  * is close enough to the camera to be displayed. With --no-graphics no
+  * scene nodes are created for items at all.
   * \ingroup items
   */
 class ItemManager : public NoCopy
@@ -92,8 +101,43 @@ private:
      *  value is <0, it indicates that the items are not switched atm. */
     float m_switch_time;
 
-    void  insertItem(Item *item);
+    /** The state of all items, indexed by item id. An unused entry (of a
+     *  deleted item) has the type ITEM_NONE. */
+    std::vector<unsigned char> m_item_type;
+
+    /** True (1) if an item was collected and is not displayed. */
+    std::vector<unsigned char> m_item_collected;
+
+    /** Position (3 entries per item) of each item. */
+    std::vector<float> m_item_xyz;
+
+    /** Square of the distance at which an item is collected. */
+    std::vector<float> m_item_distance_2;
+
+    /** Time till a collected item reappears. */
+    std::vector<float> m_item_time_till_return;
+
+    /** If an item was placed by a kart, the time during which this kart
+     *  can not collect it (so a kart is not hit by its own item). */
+    std::vector<float> m_item_deactive_time;
+
+    /** The kart that placed or last collected an item (see
+     *  m_item_deactive_time), or NULL. */
+    std::vector<const AbstractKart*> m_item_owner;
+
+    /** Counts how often an item is used before it disappears. Used for
+     *  bubble gum to make them disappear after a while. A value >0
+     *  indicates that the item still exists, =0 that the item can be
+     *  deleted, and <0 that the item will never be deleted. */
+    std::vector<int> m_item_disappear_counter;
+
+    // Items access their state directly.
+    friend class Item;
+
+    void  insertItem(Item *item, Item::ItemType type);
     void  deleteItem(Item *item);
+    bool  hitKart(unsigned int n, const Vec3 &xyz,
+                  const AbstractKart *kart) const;
 
     // Make those private so only create/destroy functions can call them.
                    ItemManager();
@@ -107,7 +151,10 @@ public:
     Item*          newItem         (const Vec3& xyz, float distance,
                                     TriggerItemListener* listener);
     void           update          (float delta);
+    void           updateGraphics  (float dt);
     void           checkItemHit    (AbstractKart* kart);
+    void           checkItemHitOnPath(AbstractKart* kart, const Vec3 &from,
+                                      const Vec3 &to);
     void           reset           ();
     void           collectedItem   (Item *item, AbstractKart *kart,
                                     int add_info=-1);
@@ -32,6 +32,7 @@
 #include "karts/controller/controller.hpp"
 #include "karts/kart_properties.hpp"
 #include "modes/world.hpp"
+#include "network/bit_string.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "tracks/track.hpp"
 #include "utils/string_utils.hpp"
@@ -63,6 +64,8 @@ void Powerup::reset()
 {
     m_type = PowerupManager::POWERUP_NOTHING;
     m_number = 0;
+    m_random.seedForRace(RandomGenerator::RS_POWERUP,
+                         m_kart->getWorldKartId());
 
     int type, number;
     World::getWorld()->getDefaultCollectibles( &type, &number );
@@ -76,11 +79,14 @@ void Powerup::reset()
  */
 void Powerup::saveState(BareNetworkString *buffer) const
 {
-    buffer->addUInt8(uint8_t(m_type));
+    // The type fits into TYPE_BITS bits, and the number (which is <=255)
+    // is usually small, so it is stored with a variable number of bits.
+    // Together this is usually one byte.
+    assert(PowerupManager::POWERUP_MAX <= (1 << TYPE_BITS));
+    BitWriter writer(buffer);
+    writer.addBits(m_type, TYPE_BITS);
     if(m_type!=PowerupManager::POWERUP_NOTHING)
-    {
-        buffer->addUInt8(m_number);   // number is <=255
-    }
+        writer.addVarUInt(m_number, NUMBER_CHUNK_BITS);
 }   // saveState
 
 //-----------------------------------------------------------------------------
@@ -90,15 +96,15 @@ void Powerup::saveState(BareNetworkString *buffer) const
  */
 void Powerup::rewindTo(BareNetworkString *buffer)
 {
+    BitReader reader(buffer);
     PowerupManager::PowerupType new_type = 
-        PowerupManager::PowerupType(buffer->getUInt8());
-    int n=0;
+        PowerupManager::PowerupType(reader.getBits(TYPE_BITS));
     if(new_type==PowerupManager::POWERUP_NOTHING)
     {
         set(new_type, 0);
         return;
     }
-    n = buffer->getUInt8();
+    int n = reader.getVarUInt(NUMBER_CHUNK_BITS);
     if(m_type == new_type)
         m_number = n;
     else
@@ -449,7 +455,8 @@ void Powerup::hitBonusBox(const Item &item, int add_info)
     {
         for(int i=0; i<20; i++)
         {
-            new_powerup = powerup_manager->getRandomPowerup(position, &n);
+            new_powerup = powerup_manager->getRandomPowerup(position, &n,
+                                                            &m_random);
             if(new_powerup != PowerupManager::POWERUP_RUBBERBALL ||
                 ( World::getWorld()->getTimeSinceStart() - powerup_manager->getBallCollectTime()) >
                   RubberBall::getTimeBetweenRubberBalls() )
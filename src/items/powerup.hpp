@@ -36,6 +36,13 @@ class SFXBase;
 class Powerup : public NoCopy
 {
 private:
+    /** Number of bits used to save the type in a state. */
+    static const unsigned int TYPE_BITS = 4;
+
+    /** Size of the chunks the number of powerups is saved in, see
+     *  BitWriter::addVarUInt. */
+    static const unsigned int NUMBER_CHUNK_BITS = 3;
+
     /** A synchronised random number generator for network games. */
     RandomGenerator             m_random;
 
@@ -71,6 +78,12 @@ public:
     PowerupManager::PowerupType
                     getType      () const {return m_type;  }
     // ------------------------------------------------------------------------
+    /** Returns the random number generator (which is part of the rewind
+     *  state of the kart). */
+    RandomGenerator* getRandom   ()       {return &m_random;}
+    // ------------------------------------------------------------------------
+    const RandomGenerator* getRandom() const {return &m_random;}
+    // ------------------------------------------------------------------------
 };
 
 #endif
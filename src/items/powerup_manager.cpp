@@ -350,9 +350,12 @@ PowerupManager::PositionClass
  *  \param pos Position of the kart (1<=pos<=number of karts) - ignored in
  *         case of a battle mode.
  *  \param n Number of times this item is given to the kart
+ *  \param random The random number generator to use (the one of the kart
+ *         collecting the item, so that the result is reproducible).
  */
 PowerupManager::PowerupType PowerupManager::getRandomPowerup(unsigned int pos,
-                                                             unsigned int *n)
+                                                             unsigned int *n,
+                                                      RandomGenerator *random)
 {
     // Positions start with 1, while the index starts with 0 - so subtract 1
     PositionClass pos_class =
@@ -361,8 +364,8 @@ PowerupManager::PowerupType PowerupManager::getRandomPowerup(unsigned int pos,
          (race_manager->isTutorialMode() ? POSITION_TUTORIAL_MODE :
                                      m_position_to_class[pos-1]));
 
-    int random = rand()%m_powerups_for_position[pos_class].size();
-    int i=m_powerups_for_position[pos_class][random];
+    int r = random->get((int)m_powerups_for_position[pos_class].size());
+    int i=m_powerups_for_position[pos_class][r];
     if(i>=POWERUP_MAX)
     {
         i -= POWERUP_MAX;
@@ -27,6 +27,7 @@
 #include <vector>
 
 class Material;
+class RandomGenerator;
 class XMLNode;
 namespace irr
 {
@@ -155,7 +156,8 @@ public:
     void          updateWeightsForRace(unsigned int num_karts);
     Material*     getIcon         (int type) const {return m_all_icons [type];}
     PowerupManager::PowerupType
-                  getRandomPowerup(unsigned int pos, unsigned int *n);
+                  getRandomPowerup(unsigned int pos, unsigned int *n,
+                                   RandomGenerator *random);
     /** Returns the mesh for a certain powerup.
      *  \param type Mesh type for which the model is returned. */
     irr::scene::IMesh
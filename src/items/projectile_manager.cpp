@@ -89,27 +89,42 @@ void ProjectileManager::update(float dt)
 }   // update
 
 // -----------------------------------------------------------------------------
-/** Updates all rockets on the server (or no networking). */
+/** Updates the graphics of all projectiles. This is called after resimulating
+ *  a rewind, since the graphics are not updated during the resimulation.
+ *  \param dt The time that was resimulated.
+ */
+void ProjectileManager::updateGraphics(float dt)
+{
+    for (unsigned int i = 0; i < m_active_projectiles.size(); i++)
+    {
+        m_active_projectiles[i]->updateGraphics(dt, Vec3(0, 0, 0),
+                                                btQuaternion(0, 0, 0, 1));
+    }
+}   // updateGraphics
+
+// -----------------------------------------------------------------------------
+/** Updates all rockets on the server (or no networking). The projectiles
+ *  that can be deleted are removed in the same pass, keeping the order of
+ *  the remaining projectiles, instead of erasing each one from the vector.
+ */
 void ProjectileManager::updateServer(float dt)
 {
-    Projectiles::iterator p = m_active_projectiles.begin();
-    while(p!=m_active_projectiles.end())
+    unsigned int num_active = 0;
+    // Use indices, since a projectile could be added during the update.
+    for (unsigned int i = 0; i < m_active_projectiles.size(); i++)
     {
-        bool can_be_deleted = (*p)->updateAndDelete(dt);
-        if(can_be_deleted)
+        Flyable *f = m_active_projectiles[i];
+        if (f->updateAndDelete(dt))
         {
-            HitEffect *he = (*p)->getHitEffect();
+            HitEffect *he = f->getHitEffect();
             if(he)
                 addHitEffect(he);
-            Flyable *f=*p;
-            Projectiles::iterator p_next=m_active_projectiles.erase(p);
             delete f;
-            p=p_next;
         }
         else
-            p++;
-    }   // while p!=m_active_projectiles.end()
-    
+            m_active_projectiles[num_active++] = f;
+    }   // for i < m_active_projectiles.size()
+    m_active_projectiles.resize(num_active);
 }   // updateServer
 
 // -----------------------------------------------------------------------------
@@ -59,6 +59,7 @@ public:
     void             loadData         ();
     void             cleanup          ();
     void             update           (float dt);
+    void             updateGraphics   (float dt);
     Flyable*         newProjectile    (AbstractKart *kart,
                                        PowerupManager::PowerupType type);
     void             Deactivate       (Flyable *p) {}
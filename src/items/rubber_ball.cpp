@@ -31,6 +31,7 @@
 #include "physics/triangle_mesh.hpp"
 #include "tracks/drive_graph.hpp"
 #include "tracks/drive_node.hpp"
+#include "tracks/rubber_ball_path.hpp"
 #include "tracks/track.hpp"
 
 #include "utils/log.hpp" //TODO: remove after debugging is done
@@ -191,10 +192,13 @@ void RubberBall::computeTarget()
  *  \param  node_index The node for which the successor is searched.
  *  \param  dist If not NULL a pointer to a float. The distance between
  *          node_index and the selected successor is added to this float.
+ *  \param  succ_index If not NULL, the index of the successor (i.e. the
+ *          returned node is the succ_index-th successor of node_index).
  *  \return The node index of a successor node.
  */
 unsigned int RubberBall::getSuccessorToHitTarget(unsigned int node_index,
-                                                 float *dist)
+                                                 float *dist,
+                                                 int *succ_index)
 {
     int succ = 0;
     LinearWorld *lin_world = dynamic_cast<LinearWorld*>(World::getWorld());
@@ -202,6 +206,8 @@ unsigned int RubberBall::getSuccessorToHitTarget(unsigned int node_index,
     unsigned int sect =
         lin_world->getSectorForKart(m_target);
     succ = DriveGraph::get()->getNode(node_index)->getSuccessorToReach(sect);
+    if(succ_index)
+        *succ_index = succ;
 
     if(dist)
         *dist += DriveGraph::get()->getNode(node_index)
@@ -215,7 +221,8 @@ unsigned int RubberBall::getSuccessorToHitTarget(unsigned int node_index,
  *  not smooth enough), so keep on picking graph nodes till the distance
  *  between the currently aimed at graph node and the next one is above a
  *  certain threshold. It uses getSuccessorToHitTarget to determine which
- *  graph node to select.
+ *  graph node to select. Unless there is a branch on the way, the result
+ *  is taken from the precomputed RubberBallPath of the graph.
  */
 void RubberBall::getNextControlPoint()
 {
@@ -226,7 +233,21 @@ void RubberBall::getNextControlPoint()
 
     float f = DriveGraph::get()->getDistanceFromStart(m_last_aimed_graph_node);
 
-    int next = getSuccessorToHitTarget(m_last_aimed_graph_node, &dist);
+    int succ_index;
+    int next = getSuccessorToHitTarget(m_last_aimed_graph_node, &dist,
+                                       &succ_index);
+    const RubberBallPath *path = DriveGraph::get()->getRubberBallPath();
+    if(path && path->getMinDistance()==m_st_min_interpolation_distance &&
+       path->getControlPoint(m_last_aimed_graph_node, succ_index, &next,
+                             &dist))
+    {
+        m_last_aimed_graph_node = next;
+        m_length_cp_2_3         = dist;
+        m_control_points[3]     =
+            DriveGraph::get()->getNode(m_last_aimed_graph_node)->getCenter();
+        return;
+    }
+
     float d = DriveGraph::get()->getDistanceFromStart(next)-f;
     while(d<m_st_min_interpolation_distance && d>=0)
     {
@@ -361,8 +382,22 @@ bool RubberBall::updateAndDelete(float dt)
     // No need to check for terrain height if the ball is low to the ground
     if(height > 0.5f)
     {
-        float tunnel_height = getTunnelHeight(next_xyz, vertical_offset)
-                             - m_extend.getY();
+        // If the precomputed ceiling above the current graph node and its
+        // successors (the new position might already be on a successor)
+        // is far enough above the ball, the raycast can be skipped. Within
+        // the margin the raycast is still done, since the ceiling is only
+        // sampled at some points of each node, and the ball is not exactly
+        // on the node.
+        const float margin = 4.0f;
+        const RubberBallPath *path = DriveGraph::get()->getRubberBallPath();
+        float tunnel_height = RubberBallPath::NO_CEILING;
+        const int node = getCurrentGraphNode();
+        if(!path || node<0 ||
+           path->getCeilingHeight(node) < height + m_extend.getY() + margin)
+        {
+            tunnel_height = getTunnelHeight(next_xyz, vertical_offset)
+                          - m_extend.getY();
+        }
         // If the current height of ball (above terrain) is higher than the 
         // tunnel height then set adjust max height and compute new height again.
         // Else reset the max height.
@@ -189,7 +189,8 @@ private:
     void         computeTarget();
     void         updateDistanceToTarget();
     unsigned int getSuccessorToHitTarget(unsigned int node_index,
-                                         float *f=NULL);
+                                         float *f=NULL,
+                                         int *succ_index=NULL);
     void         getNextControlPoint();
     float        updateHeight();
     void         interpolate(Vec3 *next_xyz, float dt);
@@ -206,6 +207,10 @@ public:
     virtual bool hit(AbstractKart* kart, PhysicalObject* obj=NULL);
     static float getTimeBetweenRubberBalls()    {return m_time_between_balls;}
     // ------------------------------------------------------------------------
+    /** Returns the minimum distance between two control points. */
+    static float getMinInterpolationDistance()
+                                     { return m_st_min_interpolation_distance; }
+    // ------------------------------------------------------------------------
     /** This object does not create an explosion, all affects on
      *  karts are handled by this hit() function. */
     //virtual HitEffect *getHitEffect() const {return NULL; }
@@ -228,6 +228,46 @@ void Swatter::onAnimationEnd()
     m_animation_phase = SWATTER_AIMING;
 }   // onAnimationEnd
 
+// ----------------------------------------------------------------------------
+namespace
+{
+    /** The cost of a kart as a target of the swatter, see
+     *  Swatter::chooseTarget: the squared distance from the kart holding the
+     *  swatter, or -1 if the kart can't be squashed. */
+    class SwatterTargetCost
+    {
+    private:
+        const AbstractKart *m_kart;
+        const SoccerWorld  *m_soccer_world;
+    public:
+        SwatterTargetCost(const AbstractKart *kart) : m_kart(kart)
+        {
+            m_soccer_world = dynamic_cast<SoccerWorld*>(World::getWorld());
+        }   // SwatterTargetCost
+        // --------------------------------------------------------------------
+        float operator()(unsigned int id) const
+        {
+            const AbstractKart *kart = World::getWorld()->getKart(id);
+            // TODO: isSwatterReady(), isSquashable()?
+            if(kart->isEliminated() || kart==m_kart)
+                return -1.0f;
+            // don't squash an already hurt kart
+            if (kart->isInvulnerable() || kart->isSquashed())
+                return -1.0f;
+
+            // Don't hit teammates in soccer world
+            if (m_soccer_world &&
+                m_soccer_world->getKartTeam(kart->getWorldKartId()) ==
+                m_soccer_world->getKartTeam(m_kart->getWorldKartId()))
+                return -1.0f;
+
+            return (kart->getXYZ()-m_kart->getXYZ()).length2();
+        }   // operator()
+        // --------------------------------------------------------------------
+        float getLowerBound(float distance) const { return distance*distance; }
+    };   // SwatterTargetCost
+}   // anonymous namespace
+
 // ----------------------------------------------------------------------------
 /** Determine the nearest kart or item and update the current target
  *  accordingly.
@@ -237,34 +277,14 @@ void Swatter::chooseTarget()
     // TODO: for the moment, only handle karts...
     const World*  world         = World::getWorld();
     AbstractKart* closest_kart  = NULL;
-    float         min_dist2     = FLT_MAX;
-
-    for(unsigned int i=0; i<world->getNumKarts(); i++)
-    {
-        AbstractKart *kart = world->getKart(i);
-        // TODO: isSwatterReady(), isSquashable()?
-        if(kart->isEliminated() || kart==m_kart)
-            continue;
-        // don't squash an already hurt kart
-        if (kart->isInvulnerable() || kart->isSquashed())
-            continue;
-
-        const SoccerWorld* sw = dynamic_cast<SoccerWorld*>(World::getWorld());
-        if (sw)
-        {
-            // Don't hit teammates in soccer world
-            if (sw->getKartTeam(kart->getWorldKartId()) == sw
-                ->getKartTeam(m_kart->getWorldKartId()))
-            continue;
-        }
-
-        float dist2 = (kart->getXYZ()-m_kart->getXYZ()).length2();
-        if(dist2<min_dist2)
-        {
-            min_dist2 = dist2;
-            closest_kart = kart;
-        }
-    }
+    float         min_dist2;
+
+    const int id = world->getKartIndex().findClosest(m_kart->getXYZ(),
+                                                     SwatterTargetCost(m_kart),
+                                                     /*prefer_last*/false,
+                                                     &min_dist2);
+    if(id >= 0 && min_dist2 < FLT_MAX)
+        closest_kart = world->getKart(id);
     m_target = closest_kart;    // may be NULL
     m_closest_kart = closest_kart;
 }
@@ -84,6 +84,7 @@ void AbstractKart::reset()
         delete m_kart_animation;
         m_kart_animation = NULL;
     }
+    m_random.seedForRace(RandomGenerator::RS_KART, m_world_kart_id);
 }   // reset
 
 // ----------------------------------------------------------------------------
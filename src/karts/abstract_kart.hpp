@@ -25,6 +25,7 @@
 #include "karts/moveable.hpp"
 #include "karts/controller/kart_control.hpp"
 #include "race/race_manager.hpp"
+#include "utils/random_generator.hpp"
 
 namespace irr
 {
@@ -94,6 +95,10 @@ protected:
     /** A kart animation object to handle rescue, explosion etc. */
     AbstractKartAnimation *m_kart_animation;
 
+    /** Random number generator for the effects of hits on this kart (e.g.
+     *  the bubblegum torque and the explosion rotation). */
+    RandomGenerator m_random;
+
     /** Node between wheels and kart. Allows kart to be scaled independent of wheels, when being squashed.*/
     irr::scene::IDummyTransformationSceneNode    *m_wheel_box;
 public:
@@ -117,6 +122,12 @@ public:
     // ------------------------------------------------------------------------
     /** Returns all controls of this kart - const version. */
     const KartControl& getControls() const { return m_controls; }
+    // ------------------------------------------------------------------------
+    /** Returns the random number generator for the effects of hits on this
+     *  kart (which is part of the rewind state of the kart). */
+    RandomGenerator* getRandom() { return &m_random; }
+    // ------------------------------------------------------------------------
+    const RandomGenerator* getRandom() const { return &m_random; }
 
     // ========================================================================
     // Access to the kart properties.
@@ -91,6 +91,8 @@ AIBaseLapController::AIBaseLapController(AbstractKart *kart)
     {
         m_world     = dynamic_cast<LinearWorld*>(World::getWorld());
         m_track     = m_world->getTrack();
+        m_random_path.seedForRace(RandomGenerator::RS_AI,
+                                  4*kart->getWorldKartId()+3);
         computePath();
     }
     else
@@ -158,10 +160,7 @@ void AIBaseLapController::computePath()
         // For now pick one part on random, which is not adjusted during the
         // race. Long term statistics might be gathered to determine the
         // best way, potentially depending on race position etc.
-        int r = rand();
-        int indx = (int)( r / ((float)(RAND_MAX)+1.0f) * next.size() );
-        // In case of rounding errors0
-        if(indx>=(int)next.size()) indx--;
+        int indx = m_random_path.get((int)next.size());
         m_successor_index[i] = indx;
         assert(indx <(int)next.size() && indx>=0);
         m_next_node_index[i] = next[indx];
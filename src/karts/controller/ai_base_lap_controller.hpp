@@ -19,6 +19,7 @@
 #define HEADER_AI_BASE_LAP_CONTROLLER_HPP
 
 #include "karts/controller/ai_base_controller.hpp"
+#include "utils/random_generator.hpp"
 
 class AIProperties;
 class LinearWorld;
@@ -53,6 +54,9 @@ protected:
      *  graph nodes. */
     std::vector<std::vector<int> > m_all_look_aheads;
 
+    /** Random number generator used to select the path. */
+    RandomGenerator m_random_path;
+
     virtual void update      (float delta) ;
     virtual unsigned int getNextSector(unsigned int index);
     virtual void  newLap             (int lap);
@@ -0,0 +1,38 @@
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "karts/controller/network_player_controller.hpp"
+
+#include "karts/abstract_kart.hpp"
+#include "karts/rescue_animation.hpp"
+
+// ----------------------------------------------------------------------------
+/** The controls of a network player are set from the messages received by
+ *  the ControllerEventsProtocol, and they already contain the steering,
+ *  start penalty etc. that was computed by the controller on the client
+ *  where the player is local. So this only needs to trigger the rescue,
+ *  it must not change the controls like PlayerController::update does.
+ *  \param dt Time step size.
+ */
+void NetworkPlayerController::update(float dt)
+{
+    if ( m_controls->getRescue() && !m_kart->getKartAnimation() )
+    {
+        new RescueAnimation(m_kart);
+        m_controls->setRescue(false);
+    }
+}   // update
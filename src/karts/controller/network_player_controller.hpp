@@ -35,6 +35,8 @@ public:
     {
     }   // ~NetworkPlayerController
     // ------------------------------------------------------------------------
+    virtual void update(float dt) OVERRIDE;
+    // ------------------------------------------------------------------------
     /** This player is not a local player. This affect e.g. special sfx and
      *  camera effects to be triggered. */
     virtual bool isLocalPlayerController() const OVERRIDE
@@ -41,6 +41,7 @@
 #include "modes/linear_world.hpp"
 #include "modes/profile_world.hpp"
 #include "race/race_manager.hpp"
+#include "tracks/ai_track_data.hpp"
 #include "tracks/drive_graph.hpp"
 #include "tracks/track.hpp"
 #include "utils/constants.hpp"
@@ -178,6 +179,12 @@ void SkiddingAI::reset()
     m_skid_probability_state     = SKID_PROBAB_NOT_YET;
     m_last_item_random           = NULL;
 
+    // All random decisions are reproducible for a given race seed.
+    const unsigned int id = 4*m_kart->getWorldKartId();
+    m_random.seedForRace(RandomGenerator::RS_AI, id);
+    m_random_skid.seedForRace(RandomGenerator::RS_AI, id+1);
+    m_random_collect_item.seedForRace(RandomGenerator::RS_AI, id+2);
+
     AIBaseLapController::reset();
     m_track_node               = Graph::UNKNOWN_SECTOR;
     DriveGraph::get()->findRoadSector(m_kart->getXYZ(), &m_track_node);
@@ -236,7 +243,7 @@ void SkiddingAI::update(float dt)
         {
             if (m_kart->getPosition() > 1)
             {
-                int r = rand() % 5;
+                int r = m_random.get(5);
                 if (r == 0 || r == 1)
                     m_kart->setPowerup(PowerupManager::POWERUP_ZIPPER, 1);
                 else if (r == 2 || r == 3)
@@ -246,7 +253,7 @@ void SkiddingAI::update(float dt)
             }
             else if (m_kart->getAttachment()->getType() == Attachment::ATTACH_SWATTER)
             {
-                int r = rand() % 4;
+                int r = m_random.get(4);
                 if (r < 3)
                     m_kart->setPowerup(PowerupManager::POWERUP_BUBBLEGUM, 1);
                 else
@@ -254,7 +261,7 @@ void SkiddingAI::update(float dt)
             }
             else
             {
-                int r = rand() % 5;
+                int r = m_random.get(5);
                 if (r == 0 || r == 1)
                     m_kart->setPowerup(PowerupManager::POWERUP_BUBBLEGUM, 1);
                 else if (r == 2 || r == 3)
@@ -370,7 +377,7 @@ void SkiddingAI::update(float dt)
         // time in time trial at start up, so during the first 5 seconds
         // this is done at random only.
         if(race_manager->getMinorMode()!=RaceManager::MINOR_MODE_TIME_TRIAL ||
-            (m_world->getTime()<3.0f && rand()%50==1) )
+            (m_world->getTime()<3.0f && m_random.get(50)==1) )
         {
             m_controls->setNitro(false);
             m_controls->setFire(true);
@@ -1164,7 +1171,7 @@ void SkiddingAI::handleItems(const float dt)
             else
             {
                 // to make things less predictable :)
-                m_time_since_last_shot = (rand() % 1000) / 1000.0f * 3.0f - 2.0f;
+                m_time_since_last_shot = m_random.get(1000) / 1000.0f * 3.0f - 2.0f;
             }
         }
         else
@@ -1542,7 +1549,7 @@ void SkiddingAI::handleRaceStart()
         // Each kart starts at a different, random time, and the time is
         // smaller depending on the difficulty.
         m_start_delay = m_ai_properties->m_min_start_delay
-                      + (float) rand() / RAND_MAX
+                      + m_random.getFloat()
                       * (m_ai_properties->m_max_start_delay -
                          m_ai_properties->m_min_start_delay);
 
@@ -1551,7 +1558,7 @@ void SkiddingAI::handleRaceStart()
                ? 0.0f  : m_ai_properties->m_false_start_probability;
 
         // Now check for a false start. If so, add 1 second penalty time.
-        if(rand() < RAND_MAX * false_start_probability)
+        if(m_random.getFloat() < false_start_probability)
         {
             m_start_delay+=stk_config->m_penalty_time;
             return;
@@ -1932,6 +1939,7 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
     Vec3 forw(0, 0, 50);
     m_curve[CURVE_KART]->addPoint(m_kart->getTrans()(forw)+eps);
 #endif
+    const AITrackData *ai_data = DriveGraph::get()->getAIData();
     *last_node = m_next_node_index[m_track_node];
 
     Vec3 direction;
@@ -1947,8 +1955,7 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
         int target_sector = m_next_node_index[*last_node];
 
         //direction is a vector from our kart to the sectors we are testing
-        direction = DriveGraph::get()->getNode(target_sector)->getCenter()
-                  - m_kart->getXYZ();
+        direction = ai_data->getCenter(target_sector) - m_kart->getXYZ();
 
         float len=direction.length();
         unsigned int steps = (unsigned int)( len / m_kart_length );
@@ -1977,16 +1984,15 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
 
             //If we are outside, the previous node is what we are looking for
             if ( distance + m_kart_width * 0.5f
-                 > DriveGraph::get()->getNode(*last_node)->getPathWidth()*0.5f )
+                 > ai_data->getPathWidth(*last_node)*0.5f )
             {
-                *aim_position = DriveGraph::get()->getNode(*last_node)
-                                                ->getCenter();
+                *aim_position = ai_data->getCenter(*last_node);
                 return;
             }
         }
         *last_node = target_sector;
     }   // for i<100
-    *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
+    *aim_position = ai_data->getCenter(*last_node);
 }   // findNonCrashingPointFixed
 
 //-----------------------------------------------------------------------------
@@ -2025,9 +2031,10 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
     Vec3 forw(0, 0, 50);
     m_curve[CURVE_KART]->addPoint(m_kart->getTrans()(forw)+eps);
 #endif
+    const AITrackData *ai_data = DriveGraph::get()->getAIData();
     *last_node = m_next_node_index[m_track_node];
-    float angle = DriveGraph::get()->getAngleToNext(m_track_node,
-                                              m_successor_index[m_track_node]);
+    float angle = ai_data->getAngleToNext(m_track_node,
+                                          m_successor_index[m_track_node]);
 
     Vec3 direction;
     Vec3 step_track_coord;
@@ -2040,22 +2047,20 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
         // target_sector is the sector at the longest distance that we can
         // drive to without crashing with the track.
         int target_sector = m_next_node_index[*last_node];
-        float angle1 = DriveGraph::get()->getAngleToNext(target_sector,
-                                                m_successor_index[target_sector]);
+        float angle1 = ai_data->getAngleToNext(target_sector,
+                                               m_successor_index[target_sector]);
         // In very sharp turns this algorithm tends to aim at off track points,
         // resulting in hitting a corner. So test for this special case and
         // prevent a too-far look-ahead in this case
         float diff = normalizeAngle(angle1-angle);
         if(fabsf(diff)>1.5f)
         {
-            *aim_position = DriveGraph::get()->getNode(target_sector)
-                                            ->getCenter();
+            *aim_position = ai_data->getCenter(target_sector);
             return;
         }
 
         //direction is a vector from our kart to the sectors we are testing
-        direction = DriveGraph::get()->getNode(target_sector)->getCenter()
-                  - m_kart->getXYZ();
+        direction = ai_data->getCenter(target_sector) - m_kart->getXYZ();
 
         float len=direction.length();
         unsigned int steps = (unsigned int)( len / m_kart_length );
@@ -2084,17 +2089,16 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
 
             //If we are outside, the previous node is what we are looking for
             if ( distance + m_kart_width * 0.5f
-                 > DriveGraph::get()->getNode(*last_node)->getPathWidth() )
+                 > ai_data->getPathWidth(*last_node) )
             {
-                *aim_position = DriveGraph::get()->getNode(*last_node)
-                                                ->getCenter();
+                *aim_position = ai_data->getCenter(*last_node);
                 return;
             }
         }
         angle = angle1;
         *last_node = target_sector;
     }   // for i<100
-    *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
+    *aim_position = ai_data->getCenter(*last_node);
 }   // findNonCrashingPoint
 
 //-----------------------------------------------------------------------------
@@ -2103,14 +2107,14 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
  */
 void SkiddingAI::determineTrackDirection()
 {
-    const DriveGraph *dg = DriveGraph::get();
+    const DriveGraph *dg      = DriveGraph::get();
+    const AITrackData *ai_data = dg->getAIData();
     unsigned int succ    = m_successor_index[m_track_node];
-    unsigned int next    = dg->getNode(m_track_node)->getSuccessor(succ);
+    unsigned int next    = ai_data->getSuccessor(m_track_node, succ);
     float angle_to_track = 0.0f;
     if (m_kart->getVelocity().length() > 0.0f)
     {
-        Vec3 track_direction = -dg->getNode(m_track_node)->getCenter()
-            + dg->getNode(next)->getCenter();
+        Vec3 track_direction = ai_data->getDirectionToNext(m_track_node, succ);
         angle_to_track =
             track_direction.angle(m_kart->getVelocity().normalized());
     }
@@ -2133,9 +2137,9 @@ void SkiddingAI::determineTrackDirection()
         return;
     }
 
-    dg->getNode(next)->getDirectionData(m_successor_index[next],
-                                        &m_current_track_direction,
-                                        &m_last_direction_node);
+    ai_data->getDirectionData(next, m_successor_index[next],
+                              &m_current_track_direction,
+                              &m_last_direction_node);
 
 #ifdef AI_DEBUG
     m_curve[CURVE_QG]->clear();
@@ -2172,7 +2176,7 @@ void SkiddingAI::handleCurve()
     // the case that the kart is facing wrong was already tested for before
 
     const DriveGraph *dg = DriveGraph::get();
-    const Vec3& last_xyz = dg->getNode(m_last_direction_node)->getCenter();
+    const Vec3 last_xyz = dg->getAIData()->getCenter(m_last_direction_node);
 
     determineTurnRadius(last_xyz, &m_curve_center, &m_current_curve_radius);
     assert(!std::isnan(m_curve_center.getX()));
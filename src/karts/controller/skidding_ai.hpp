@@ -204,6 +204,9 @@ private:
     /** A random number generator for collecting items. */
     RandomGenerator m_random_collect_item;
 
+    /** A random number generator for all other random decisions. */
+    RandomGenerator m_random;
+
     /** \brief Determines the algorithm to use to select the point-to-aim-for
      *  There are three different Point Selection Algorithms:
      *  1. findNonCrashingPoint() is the default (which is actually slightly
@@ -131,6 +131,43 @@ void SoccerAI::update(float dt)
     ArenaAI::update(dt);
 }   // update
 
+//-----------------------------------------------------------------------------
+namespace
+{
+    /** The cost used by SoccerAI::findClosestKart: the distance in the XZ
+     *  plane to all karts of the other team. */
+    class OpponentCost
+    {
+    private:
+        const AbstractKart *m_kart;
+        const SoccerWorld  *m_world;
+    public:
+        OpponentCost(const AbstractKart *kart) : m_kart(kart)
+        {
+            m_world = dynamic_cast<SoccerWorld*>(World::getWorld());
+        }   // OpponentCost
+        // --------------------------------------------------------------------
+        float operator()(unsigned int id) const
+        {
+            const AbstractKart* kart = m_world->getKart(id);
+            if (kart->isEliminated()) return -1.0f;
+
+            if (kart->getWorldKartId() == m_kart->getWorldKartId())
+                return -1.0f; // Skip the same kart
+
+            if (m_world->getKartTeam(kart
+                ->getWorldKartId()) == m_world->getKartTeam(m_kart
+                ->getWorldKartId()))
+                return -1.0f; // Skip the kart with the same team
+
+            Vec3 d = kart->getXYZ() - m_kart->getXYZ();
+            return d.length_2d();
+        }   // operator()
+        // --------------------------------------------------------------------
+        float getLowerBound(float distance) const { return distance; }
+    };   // OpponentCost
+}   // anonymous namespace
+
 //-----------------------------------------------------------------------------
 /** Find the closest kart around this AI, it won't find the kart with same
  *  team, consider_difficulty and find_sta are not used here.
@@ -139,30 +176,12 @@ void SoccerAI::update(float dt)
  */
 void SoccerAI::findClosestKart(bool consider_difficulty, bool find_sta)
 {
-    float distance = 99999.9f;
-    const unsigned int n = m_world->getNumKarts();
-    int closest_kart_num = 0;
-
-    for (unsigned int i = 0; i < n; i++)
-    {
-        const AbstractKart* kart = m_world->getKart(i);
-        if (kart->isEliminated()) continue;
-
-        if (kart->getWorldKartId() == m_kart->getWorldKartId())
-            continue; // Skip the same kart
-
-        if (m_world->getKartTeam(kart
-            ->getWorldKartId()) == m_world->getKartTeam(m_kart
-            ->getWorldKartId()))
-            continue; // Skip the kart with the same team
-
-        Vec3 d = kart->getXYZ() - m_kart->getXYZ();
-        if (d.length_2d() <= distance)
-        {
-            distance = d.length_2d();
-            closest_kart_num = i;
-        }
-    }
+    float distance;
+    int closest_kart_num = m_world->getKartIndex()
+                         .findClosest(m_kart->getXYZ(), OpponentCost(m_kart),
+                                      /*prefer_last*/true, &distance);
+    if (closest_kart_num < 0 || distance > 99999.9f)
+        closest_kart_num = 0;
 
     m_closest_kart = m_world->getKart(closest_kart_num);
     m_closest_kart_node = m_world->getSectorForKart(m_closest_kart);
@@ -58,6 +58,7 @@ void SpareTireAI::reset()
     BattleAI::reset();
     m_idx = 0;
     m_timer = 0.0f;
+    m_random.seedForRace(RandomGenerator::RS_AI, 4*m_kart->getWorldKartId());
 }   // reset
 
 //-----------------------------------------------------------------------------
@@ -82,8 +83,7 @@ void SpareTireAI::findDefaultPath()
 {
     assert(m_idx == -1);
 
-    RandomGenerator random;
-    m_idx = random.get(4);
+    m_idx = m_random.get(4);
     m_target_node = m_fixed_target_nodes[m_idx];
 
 }   // findDefaultPath
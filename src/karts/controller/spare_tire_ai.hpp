@@ -20,6 +20,7 @@
 #define HEADER_SPARE_TIRE_AI_HPP
 
 #include "karts/controller/battle_ai.hpp"
+#include "utils/random_generator.hpp"
 
 /** The AI for spare tire karts in battle mode, allowing kart to gain life.
  * \ingroup controller
@@ -37,6 +38,9 @@ private:
     /** Store the time before calling \ref unspawn. */
     float m_timer;
 
+    /** Random number generator used to select the start node. */
+    RandomGenerator m_random;
+
     // ------------------------------------------------------------------------
     virtual void  findTarget() OVERRIDE;
     // ------------------------------------------------------------------------
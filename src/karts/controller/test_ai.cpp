@@ -184,6 +184,12 @@ void SkiddingAI::reset()
     m_skid_probability_state     = SKID_PROBAB_NOT_YET;
     m_last_item_random           = NULL;
 
+    // All random decisions are reproducible for a given race seed.
+    const unsigned int id = 4*m_kart->getWorldKartId();
+    m_random.seedForRace(RandomGenerator::RS_AI, id);
+    m_random_skid.seedForRace(RandomGenerator::RS_AI, id+1);
+    m_random_collect_item.seedForRace(RandomGenerator::RS_AI, id+2);
+
     AIBaseLapController::reset();
     m_track_node               = Graph::UNKNOWN_SECTOR;
     DriveGraph::get()->findRoadSector(m_kart->getXYZ(), &m_track_node);
@@ -242,7 +248,7 @@ void SkiddingAI::update(float dt)
         {
             if (m_kart->getPosition() > 1)
             {
-                int r = rand() % 5;
+                int r = m_random.get(5);
                 if (r == 0 || r == 1)
                     m_kart->setPowerup(PowerupManager::POWERUP_ZIPPER, 1);
                 else if (r == 2 || r == 3)
@@ -252,7 +258,7 @@ void SkiddingAI::update(float dt)
             }
             else if (m_kart->getAttachment()->getType() == Attachment::ATTACH_SWATTER)
             {
-                int r = rand() % 4;
+                int r = m_random.get(4);
                 if (r < 3)
                     m_kart->setPowerup(PowerupManager::POWERUP_BUBBLEGUM, 1);
                 else
@@ -260,7 +266,7 @@ void SkiddingAI::update(float dt)
             }
             else
             {
-                int r = rand() % 5;
+                int r = m_random.get(5);
                 if (r == 0 || r == 1)
                     m_kart->setPowerup(PowerupManager::POWERUP_BUBBLEGUM, 1);
                 else if (r == 2 || r == 3)
@@ -376,7 +382,7 @@ void SkiddingAI::update(float dt)
         // time in time trial at start up, so during the first 5 seconds
         // this is done at random only.
         if(race_manager->getMinorMode()!=RaceManager::MINOR_MODE_TIME_TRIAL ||
-            (m_world->getTime()<3.0f && rand()%50==1) )
+            (m_world->getTime()<3.0f && m_random.get(50)==1) )
         {
             m_controls->setNitro(false);
             m_controls->setFire(true);
@@ -1170,7 +1176,7 @@ void SkiddingAI::handleItems(const float dt)
             else
             {
                 // to make things less predictable :)
-                m_time_since_last_shot = (rand() % 1000) / 1000.0f * 3.0f - 2.0f;
+                m_time_since_last_shot = m_random.get(1000) / 1000.0f * 3.0f - 2.0f;
             }
         }
         else
@@ -1552,7 +1558,7 @@ void SkiddingAI::handleRaceStart()
         // Each kart starts at a different, random time, and the time is
         // smaller depending on the difficulty.
         m_start_delay = m_ai_properties->m_min_start_delay
-                      + (float) rand() / RAND_MAX
+                      + m_random.getFloat()
                       * (m_ai_properties->m_max_start_delay -
                          m_ai_properties->m_min_start_delay);
 
@@ -1561,7 +1567,7 @@ void SkiddingAI::handleRaceStart()
                ? 0.0f  : m_ai_properties->m_false_start_probability;
 
         // Now check for a false start. If so, add 1 second penalty time.
-        if(rand() < RAND_MAX * false_start_probability)
+        if(m_random.getFloat() < false_start_probability)
         {
             m_start_delay+=stk_config->m_penalty_time;
             return;
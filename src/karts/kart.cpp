@@ -332,7 +332,7 @@ void Kart::reset()
         m_saved_controller = NULL;
     }
     m_kart_model->setAnimation(KartModel::AF_DEFAULT);
-    m_attachment->clear();
+    m_attachment->reset();
     m_kart_gfx->reset();
     m_skidding->reset();
 
@@ -391,6 +391,9 @@ void Kart::reset()
     }
 
     setTrans(m_reset_transform);
+    // World is NULL or does not contain this kart while karts are created
+    if (World::getWorld())
+        World::getWorld()->updateKartIndex(this);
 
     applyEngineForce (0.0f);
 
@@ -1000,7 +1003,7 @@ void Kart::collectedItem(Item *item, int add_info)
 
         // slow down
         m_bubblegum_time = m_kart_properties->getBubblegumDuration();
-        m_bubblegum_torque = ((rand()%2)
+        m_bubblegum_torque = (m_random.get(2)
                            ?  m_kart_properties->getBubblegumTorque()
                            : -m_kart_properties->getBubblegumTorque());
         m_max_speed->setSlowdown(MaxSpeed::MS_DECREASE_BUBBLE,
@@ -1184,8 +1187,13 @@ void Kart::update(float dt)
     // Reset any instand speed increase in the bullet kart
     m_vehicle->resetInstantSpeed();
 
+    // While resimulating after a rewind particles, sound effects and other
+    // purely graphical effects are not updated.
+    const bool is_rewinding = RewindManager::get()->isRewinding();
+
     // update star effect (call will do nothing if stars are not activated)
-    m_stars_effect->update(dt);
+    if(!is_rewinding)
+        m_stars_effect->update(dt);
 
     if(m_squash_time>=0)
     {
@@ -1224,7 +1232,7 @@ void Kart::update(float dt)
     // is used furthermore for engine power, camera distance etc
     updateSpeed();
 
-    if(!history->replayHistory() && !RewindManager::get()->isRewinding())
+    if(!history->replayHistory() && !is_rewinding)
         m_controller->update(dt);
 
 #undef DEBUG_CAMERA_SHAKE
@@ -1305,8 +1313,11 @@ void Kart::update(float dt)
 
     m_attachment->update(dt);
 
-    m_kart_gfx->update(dt);
-    if (m_collision_particles) m_collision_particles->update(dt);
+    if(!is_rewinding)
+    {
+        m_kart_gfx->update(dt);
+        if (m_collision_particles) m_collision_particles->update(dt);
+    }
 
     PROFILER_PUSH_CPU_MARKER("Kart::updatePhysics", 0x60, 0x34, 0x7F);
     updatePhysics(dt);
@@ -1330,11 +1341,14 @@ void Kart::update(float dt)
     }
      */
 
-    m_beep_sound->setPosition   ( getXYZ() );
-    m_crash_sound->setPosition  ( getXYZ() );
-    m_skid_sound->setPosition   ( getXYZ() );
-    m_boing_sound->setPosition  ( getXYZ() );
-    m_nitro_sound->setPosition  ( getXYZ() );
+    if(!is_rewinding)
+    {
+        m_beep_sound->setPosition   ( getXYZ() );
+        m_crash_sound->setPosition  ( getXYZ() );
+        m_skid_sound->setPosition   ( getXYZ() );
+        m_boing_sound->setPosition  ( getXYZ() );
+        m_nitro_sound->setPosition  ( getXYZ() );
+    }
 
     // Check if a kart is (nearly) upside down and not moving much -->
     // automatic rescue
@@ -1412,7 +1426,8 @@ void Kart::update(float dt)
     }
 
     PROFILER_PUSH_CPU_MARKER("Kart::Update (material)", 0x60, 0x34, 0x7F);
-    handleMaterialGFX();
+    if(!is_rewinding)
+        handleMaterialGFX();
     const Material* material=m_terrain_info->getMaterial();
     if (!material)   // kart falling off the track
     {
@@ -1446,7 +1461,8 @@ void Kart::update(float dt)
             }
             body->setGravity(gravity);
         }   // if !flying
-        handleMaterialSFX(material);
+        if(!is_rewinding)
+            handleMaterialSFX(material);
         if     (material->isDriveReset() && isOnGround())
             new RescueAnimation(this);
         else if(material->isZipper()     && isOnGround())
@@ -1483,7 +1499,7 @@ void Kart::update(float dt)
     static video::SColor green(255, 61, 87, 23);
 
     // draw skidmarks if relevant (we force pink skidmarks on when hitting a bubblegum)
-    if(m_kart_properties->getSkidEnabled())
+    if(m_kart_properties->getSkidEnabled() && !is_rewinding)
     {
         m_skidmarks->update(dt,
                             m_bubblegum_time > 0,
@@ -1541,7 +1557,7 @@ void Kart::update(float dt)
         m_is_jumping = false;
         m_kart_model->setAnimation(KartModel::AF_DEFAULT);
 
-        if (!getKartAnimation())
+        if (!getKartAnimation() && !is_rewinding)
         {
             HitEffect *effect =  new Explosion(getXYZ(), "jump",
                                               "jump_explosion.xml");
@@ -2274,7 +2290,8 @@ void Kart::updatePhysics(float dt)
     m_max_speed->update(dt);
 
 
-    updateEngineSFX();
+    if(!RewindManager::get()->isRewinding())
+        updateEngineSFX();
 #ifdef XX
     Log::info("Kart","angVel %f %f %f heading %f suspension %f %f %f %f"
        ,m_body->getAngularVelocity().getX()
@@ -37,6 +37,7 @@
 class AbstractKartAnimation;
 class Attachment;
 class btKart;
+class btKartRaycaster;
 class btUprightConstraint;
 class Controller;
 class HitEffect;
@@ -165,7 +166,7 @@ protected:
     // Bullet physics parameters
     // -------------------------
     btCompoundShape          m_kart_chassis;
-    btVehicleRaycaster      *m_vehicle_raycaster;
+    btKartRaycaster         *m_vehicle_raycaster;
     btKart                  *m_vehicle;
 
      /** The amount of energy collected by hitting coins. Note that it
@@ -228,7 +229,6 @@ protected:
     void          updateFlying();
     void          updateSliding();
     void          updateEnginePowerAndBrakes(float dt);
-    void          updateEngineSFX();
     void          updateSpeed();
     void          updateNitro(float dt);
     float         getActualWheelForce();
@@ -245,6 +245,7 @@ public:
     virtual void   kartIsInRestNow();
     virtual void   updateGraphics(float dt, const Vec3& off_xyz,
                                   const btQuaternion& off_rotation);
+    void           updateEngineSFX();
     virtual void   createPhysics    ();
     virtual void   updateWeight     ();
     virtual float  getSpeedForTurnRadius(float radius) const;
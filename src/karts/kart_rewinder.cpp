@@ -39,6 +39,7 @@ KartRewinder::KartRewinder(const std::string& ident,unsigned int world_kart_id,
             , Kart(ident, world_kart_id, position, init_transform, difficulty,
                    krt)
 {
+    m_saves_since_keyframe = 0;
 }   // KartRewinder
 
 // ----------------------------------------------------------------------------
@@ -48,101 +49,187 @@ void KartRewinder::reset()
 {
     Kart::reset();
     Rewinder::reset();
+    // The next state must be a keyframe
+    m_saves_since_keyframe = 0;
 }   // reset
 
 // ----------------------------------------------------------------------------
-/** Saves all state information for a kart in a memory buffer. The memory
+/** Saves the state information for a kart in a memory buffer. The memory
  *  is allocated here and the address returned. It will then be managed
- *  by the RewindManager. The size is used to keep track of memory usage
- *  for rewinding.
- *  \param[out] buffer  Address of the memory buffer.
- *  \returns    Size of allocated memory, or -1 in case of an error.
+ *  by the RewindManager. Each KEYFRAME_INTERVAL-th state contains all
+ *  sections, the others only the sections which differ from the last
+ *  keyframe.
+ *  \returns The buffer with the state.
  */
 BareNetworkString* KartRewinder::saveState() const
 {
-    const int MEMSIZE = 13*sizeof(float) + 9+3;
-
-    BareNetworkString *buffer = new BareNetworkString(MEMSIZE);
-    const btRigidBody *body = getBody();
+    for (unsigned int i = 0; i < NUM_SECTIONS; i++)
+        m_section[i].clear();
 
     // 1) Physics values: transform and velocities
     // -------------------------------------------
+    const btRigidBody *body = getBody();
     const btTransform &t = body->getWorldTransform();
-    buffer->add(t.getOrigin());
+    BareNetworkString &physics = m_section[SECTION_PHYSICS];
+    physics.add(t.getOrigin());
     btQuaternion q = t.getRotation();
-    buffer->add(q);
-    buffer->add(body->getLinearVelocity());
-    buffer->add(body->getAngularVelocity());
-    buffer->addUInt8(m_has_started);   // necessary for startup speed boost
-    buffer->addFloat(m_vehicle->getInstantSpeedIncrease());
+    physics.add(q);
+    physics.add(body->getLinearVelocity());
+    physics.add(body->getAngularVelocity());
+    physics.addUInt8(m_has_started);   // necessary for startup speed boost
+    physics.addFloat(m_vehicle->getInstantSpeedIncrease());
 
     // 2) Steering and other player controls
     // -------------------------------------
-    getControls().copyToBuffer(buffer);
+    getControls().copyToBuffer(&m_section[SECTION_CONTROLS]);
 
     // 3) Attachment
     // -------------
-    getAttachment()->saveState(buffer);
+    getAttachment()->saveState(&m_section[SECTION_ATTACHMENT]);
 
     // 4) Powerup
     // ----------
-    getPowerup()->saveState(buffer);
+    getPowerup()->saveState(&m_section[SECTION_POWERUP]);
 
     // 5) Max speed info
     // ------------------
-    m_max_speed->saveState(buffer);
+    m_max_speed->saveState(&m_section[SECTION_MAX_SPEED]);
 
     // 6) Skidding
     // -----------
-    m_skidding->saveState(buffer);
-
+    m_skidding->saveState(&m_section[SECTION_SKIDDING]);
+
+    // 7) Random number generators of attachment, powerup and kart
+    // ------------------------------------------------------------
+    const RandomGenerator *random[3] = { getAttachment()->getRandom(),
+                                         getPowerup()->getRandom(),
+                                         getRandom()                   };
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            const uint64_t s = random[i]->getState(j);
+            m_section[SECTION_RANDOM].addUInt32(uint32_t(s >> 32))
+                                     .addUInt32(uint32_t(s));
+        }
+    }
+
+    // Determine which sections need to be stored
+    // ------------------------------------------
+    const bool is_keyframe = m_saves_since_keyframe == 0;
+    m_saves_since_keyframe = (m_saves_since_keyframe + 1) % KEYFRAME_INTERVAL;
+    uint8_t sections = is_keyframe ? KEYFRAME_BIT : 0;
+    int size = 1;
+    for (unsigned int i = 0; i < NUM_SECTIONS; i++)
+    {
+        const BareNetworkString &s = m_section[i];
+        if (is_keyframe || s.size() != m_keyframe[i].size() ||
+            memcmp(s.getData(), m_keyframe[i].getData(), s.size()) != 0)
+        {
+            sections |= 1 << i;
+            size += s.size();
+        }
+        if (is_keyframe)
+            m_keyframe[i] = s;
+    }
+
+    BareNetworkString *buffer = new BareNetworkString(size);
+    buffer->addUInt8(sections);
+    for (unsigned int i = 0; i < NUM_SECTIONS; i++)
+    {
+        if (sections & (1 << i))
+            *buffer += m_section[i];
+    }
     return buffer;
 }   // saveState
 
 // ----------------------------------------------------------------------------
-/** Actually rewind to the specified state. */
+/** Returns if the given state (saved by saveState) is a keyframe, i.e.
+ *  contains the full state of the kart.
+ */
+bool KartRewinder::isKeyframe(const BareNetworkString *buffer) const
+{
+    return buffer->getTotalSize() > 0 &&
+           (buffer->getData()[0] & KEYFRAME_BIT) != 0;
+}   // isKeyframe
+
+// ----------------------------------------------------------------------------
+/** Actually rewind to the specified state. Only the sections contained in
+ *  the state are restored, the other sections must have been restored from
+ *  the previous keyframe before.
+ */
 void KartRewinder::rewindToState(BareNetworkString *buffer)
 {
     buffer->reset();   // make sure the buffer is read from the beginning
+    const uint8_t sections = buffer->getUInt8();
 
     // 1) Physics values: transform and velocities
     // -------------------------------------------
-    btTransform t;
-    t.setOrigin(buffer->getVec3());
-    t.setRotation(buffer->getQuat());
-    btRigidBody *body = getBody();
-    body->setLinearVelocity(buffer->getVec3());
-    body->setAngularVelocity(buffer->getVec3());
-    // This function also reads the velocity, so it must be called
-    // after the velocities are set
-    body->proceedToTransform(t);
-    // Update kart transform in case that there are access to its value
-    // before Moveable::update() is called (which updates the transform)
-    setTrans(t);
-    m_has_started = buffer->getUInt8()!=0;   // necessary for startup speed boost
-    m_vehicle->instantSpeedIncreaseTo(buffer->getFloat());
+    if (sections & (1 << SECTION_PHYSICS))
+    {
+        btTransform t;
+        t.setOrigin(buffer->getVec3());
+        t.setRotation(buffer->getQuat());
+        btRigidBody *body = getBody();
+        body->setLinearVelocity(buffer->getVec3());
+        body->setAngularVelocity(buffer->getVec3());
+        // This function also reads the velocity, so it must be called
+        // after the velocities are set
+        body->proceedToTransform(t);
+        // Update kart transform in case that there are access to its value
+        // before Moveable::update() is called (which updates the transform)
+        setTrans(t);
+        // necessary for startup speed boost
+        m_has_started = buffer->getUInt8()!=0;
+        m_vehicle->instantSpeedIncreaseTo(buffer->getFloat());
+    }
 
     // 2) Steering and other controls
     // ------------------------------
-    getControls().setFromBuffer(buffer);
+    if (sections & (1 << SECTION_CONTROLS))
+        getControls().setFromBuffer(buffer);
 
     // 3) Attachment
     // -------------
-    getAttachment()->rewindTo(buffer);
+    if (sections & (1 << SECTION_ATTACHMENT))
+        getAttachment()->rewindTo(buffer);
 
     // 4) Powerup
     // ----------
-    getPowerup()->rewindTo(buffer);
+    if (sections & (1 << SECTION_POWERUP))
+        getPowerup()->rewindTo(buffer);
 
     // 5) Max speed info
     // ------------------
-    m_max_speed->rewindTo(buffer);
-    m_max_speed->update(0);
+    if (sections & (1 << SECTION_MAX_SPEED))
+    {
+        m_max_speed->rewindTo(buffer);
+        m_max_speed->update(0);
+    }
 
     // 6) Skidding
     // -----------
-    m_skidding->rewindTo(buffer);
-    return;
+    if (sections & (1 << SECTION_SKIDDING))
+        m_skidding->rewindTo(buffer);
+
+    // 7) Random number generators
+    // ---------------------------
+    if (sections & (1 << SECTION_RANDOM))
+    {
+        RandomGenerator *random[3] = { getAttachment()->getRandom(),
+                                       getPowerup()->getRandom(),
+                                       getRandom()                   };
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            uint64_t s[2];
+            for (unsigned int j = 0; j < 2; j++)
+            {
+                s[j]  = uint64_t(buffer->getUInt32()) << 32;
+                s[j] |= buffer->getUInt32();
+            }
+            random[i]->setState(s[0], s[1]);
+        }
+    }
 }   // rewindToState
 
 // ----------------------------------------------------------------------------
@@ -21,12 +21,21 @@
 
 #include "graphics/render_info.hpp"
 #include "karts/kart.hpp"
+#include "network/network_string.hpp"
 #include "network/rewinder.hpp"
 #include "utils/cpp2011.hpp"
 
 class AbstractKart;
-class BareNetworkString;
 
+/** A kart that can save and restore its state for rewinding.
+ *  To reduce the memory used by the rewind history, only every
+ *  KEYFRAME_INTERVAL-th state is a full state (a keyframe). All other states
+ *  only contain the sections of the state (physics, controls, attachment,
+ *  ...) that differ from the last keyframe. The first byte of a state
+ *  contains a bit for each section that is stored, and the KEYFRAME_BIT.
+ *  The RewindManager restores the keyframe before restoring a partial
+ *  state (see isKeyframe()).
+ */
 class KartRewinder : public Rewinder, public Kart
 {
 private:
@@ -34,6 +43,29 @@ private:
     // Flags to indicate the different event types
     enum { EVENT_CONTROL = 0x01,
            EVENT_ATTACH  = 0x02 };
+
+    /** The sections a state consists of. Together with the KEYFRAME_BIT
+     *  they must fit into one byte. */
+    enum { SECTION_PHYSICS, SECTION_CONTROLS, SECTION_ATTACHMENT,
+           SECTION_POWERUP, SECTION_MAX_SPEED, SECTION_SKIDDING,
+           SECTION_RANDOM, NUM_SECTIONS };
+
+    /** Set in the first byte of a state if it is a keyframe. */
+    static const uint8_t KEYFRAME_BIT = 0x80;
+
+    /** Every KEYFRAME_INTERVAL-th saved state is a keyframe. */
+    static const int KEYFRAME_INTERVAL = 10;
+
+    /** The sections of the state being saved. They are kept to avoid
+     *  allocating memory for each save. */
+    mutable BareNetworkString m_section[NUM_SECTIONS];
+
+    /** The sections of the last keyframe. */
+    mutable BareNetworkString m_keyframe[NUM_SECTIONS];
+
+    /** Number of states saved since the last keyframe. */
+    mutable int m_saves_since_keyframe;
+
 public:
 	             KartRewinder(const std::string& ident,
                               unsigned int world_kart_id,
@@ -42,6 +74,7 @@ public:
                               KartRenderType krt = KRT_DEFAULT);
    virtual      ~KartRewinder() {};
    virtual BareNetworkString* saveState() const;
+   virtual bool  isKeyframe(const BareNetworkString *buffer) const OVERRIDE;
    void          reset();
    virtual void  rewindToState(BareNetworkString *p) OVERRIDE;
    virtual void  rewindToEvent(BareNetworkString *p) OVERRIDE;
@@ -0,0 +1,131 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#include "karts/kart_spatial_index.hpp"
+
+#include "karts/abstract_kart.hpp"
+#include "utils/log.hpp"
+
+// ----------------------------------------------------------------------------
+KartSpatialIndex::KartSpatialIndex()
+{
+    m_axis        = 0;
+    // A kart at top speed moves about 1m per frame, and is never supposed
+    // to be much faster.
+    m_margin      = 5.0f;
+    m_num_queries = 0;
+    m_num_tested  = 0;
+}   // KartSpatialIndex
+
+// ----------------------------------------------------------------------------
+/** Stores the current position of all karts. The karts are sorted along the
+ *  X or Z axis, whichever has the larger extent.
+ *  \param karts All karts of the world, indexed by world kart id.
+ */
+void KartSpatialIndex::build(const std::vector<AbstractKart*> &karts)
+{
+    m_entries.clear();
+    m_sorted_ids.clear();
+    m_sorted_coords.clear();
+    if (karts.empty()) return;
+
+    Vec3 min = karts[0]->getXYZ(), max = min;
+    for (unsigned int i = 1; i < karts.size(); i++)
+    {
+        min.min(karts[i]->getXYZ());
+        max.max(karts[i]->getXYZ());
+    }
+    m_axis = max.getX() - min.getX() >= max.getZ() - min.getZ() ? 0 : 2;
+
+    for (unsigned int i = 0; i < karts.size(); i++)
+    {
+        m_entries.push_back(std::make_pair(karts[i]->getXYZ()[m_axis], i));
+    }
+    std::sort(m_entries.begin(), m_entries.end());
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+    {
+        m_sorted_coords.push_back(m_entries[i].first);
+        m_sorted_ids.push_back(m_entries[i].second);
+    }
+}   // build
+
+// ----------------------------------------------------------------------------
+/** Moves the entry of one kart to a new position, e.g. when the kart is
+ *  teleported during the kart updates, which would otherwise be noticed only
+ *  after the next rebuild. The sort axis is not changed. Does nothing if the
+ *  kart is not in the index (yet).
+ *  \param id World kart id of the kart.
+ *  \param xyz New position of the kart.
+ */
+void KartSpatialIndex::updateKart(unsigned int id, const Vec3 &xyz)
+{
+    std::vector<unsigned int>::iterator i =
+        std::find(m_sorted_ids.begin(), m_sorted_ids.end(), id);
+    if (i == m_sorted_ids.end()) return;
+
+    const size_t old_index = i - m_sorted_ids.begin();
+    m_sorted_ids.erase(i);
+    m_sorted_coords.erase(m_sorted_coords.begin() + old_index);
+
+    const float c = xyz[m_axis];
+    const size_t new_index =
+        std::lower_bound(m_sorted_coords.begin(), m_sorted_coords.end(), c)
+        - m_sorted_coords.begin();
+    m_sorted_coords.insert(m_sorted_coords.begin() + new_index, c);
+    m_sorted_ids.insert(m_sorted_ids.begin() + new_index, id);
+}   // updateKart
+
+// ----------------------------------------------------------------------------
+/** Returns the world kart ids of all karts that might be within a given
+ *  distance of a point. The list can contain karts that are further away
+ *  (the exact distance must be checked by the caller), but it contains all
+ *  karts within the distance. The ids are sorted, so the caller can handle
+ *  them in the same order as when looping over all karts.
+ *  \param center The point.
+ *  \param radius The distance.
+ *  \param ids Returns the kart ids.
+ */
+void KartSpatialIndex::getKartsInRadius(const Vec3 &center, float radius,
+                                        std::vector<unsigned int> *ids) const
+{
+    m_num_queries++;
+    ids->clear();
+    const float c = center[m_axis];
+    const float r = radius + m_margin;
+    std::vector<float>::const_iterator start =
+        std::lower_bound(m_sorted_coords.begin(), m_sorted_coords.end(),
+                         c - r);
+    for (unsigned int i = unsigned(start - m_sorted_coords.begin());
+         i < m_sorted_coords.size() && m_sorted_coords[i] <= c + r; i++)
+    {
+        m_num_tested++;
+        ids->push_back(m_sorted_ids[i]);
+    }
+    std::sort(ids->begin(), ids->end());
+}   // getKartsInRadius
+
+// ----------------------------------------------------------------------------
+/** Prints the average number of karts tested per query. */
+void KartSpatialIndex::printStatistics() const
+{
+    Log::verbose("KartSpatialIndex", "%u queries, %f karts tested per query.",
+                 m_num_queries,
+                 m_num_queries > 0 ? float(m_num_tested) / m_num_queries
+                                   : 0.0f);
+}   // printStatistics
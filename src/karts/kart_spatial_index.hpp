@@ -0,0 +1,147 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#ifndef HEADER_KART_SPATIAL_INDEX_HPP
+#define HEADER_KART_SPATIAL_INDEX_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class AbstractKart;
+
+/**
+ *  \brief An index of the kart positions for proximity queries.
+ *  Projectiles, attachments and the AI look for the closest kart (or all
+ *  karts close to a point) each frame, which means testing every kart for
+ *  every query. This index stores the kart positions once per frame (it is
+ *  rebuilt by the world after the physics update), sorted along the
+ *  horizontal axis in which the karts are spread out the most, so that a
+ *  query only needs to test the karts whose coordinate on this axis is
+ *  close enough to the query point.
+ *  Since karts can still move a bit between the rebuild and a query (e.g.
+ *  during the kart updates of the next frame), all bounds are extended by
+ *  a safety margin, and the callers compute the final result using the
+ *  current kart positions. So the results are the same as testing all
+ *  karts, as long as no kart moves further than the margin between two
+ *  rebuilds. Karts that are teleported (e.g. at the end of a rescue or
+ *  when they are reset) must be updated with updateKart() immediately.
+ * \ingroup karts
+ */
+class KartSpatialIndex : public NoCopy
+{
+private:
+    /** Index of the coordinate (0 for X, 2 for Z) the karts are sorted by. */
+    int m_axis;
+
+    /** Maximum distance a kart is expected to move between two rebuilds. */
+    float m_margin;
+
+    /** World kart ids of all karts, sorted by their coordinate on m_axis. */
+    std::vector<unsigned int> m_sorted_ids;
+
+    /** Coordinate on m_axis of each kart in m_sorted_ids. */
+    std::vector<float> m_sorted_coords;
+
+    /** Temporary (kart coordinate, kart id) pairs used when sorting. */
+    std::vector<std::pair<float, unsigned int> > m_entries;
+
+    /** Number of queries and number of karts tested, for statistics. */
+    mutable unsigned int m_num_queries;
+    mutable unsigned int m_num_tested;
+
+public:
+         KartSpatialIndex();
+    void build(const std::vector<AbstractKart*> &karts);
+    void updateKart(unsigned int id, const Vec3 &xyz);
+    void getKartsInRadius(const Vec3 &center, float radius,
+                          std::vector<unsigned int> *ids) const;
+    void printStatistics() const;
+    // ------------------------------------------------------------------------
+    /** Finds the kart with the lowest cost, giving the same result as
+     *  computing the cost of every kart in order of the world kart ids.
+     *  The cost object must provide:
+     *  - float operator()(unsigned int id) const: the cost of a kart, or a
+     *    negative value if the kart must be ignored.
+     *  - float getLowerBound(float distance) const: a lower bound of the
+     *    cost of all karts whose distance from the center in the XZ plane
+     *    is at least distance.
+     *  \param center The point to search from.
+     *  \param cost The cost object.
+     *  \param prefer_last If karts with the same cost are found, the one
+     *         with the highest id is returned (like a linear search using
+     *         <=), otherwise the one with the lowest id (like a linear
+     *         search using <).
+     *  \param best_cost Returns the cost of the kart found.
+     *  \return The world kart id of the kart found, or -1 if no kart has a
+     *          non-negative cost.
+     */
+    template<class Cost>
+    int findClosest(const Vec3 &center, const Cost &cost, bool prefer_last,
+                    float *best_cost) const
+    {
+        m_num_queries++;
+        const float c = center[m_axis];
+        const int n   = (int)m_sorted_coords.size();
+        int hi = int(std::lower_bound(m_sorted_coords.begin(),
+                                      m_sorted_coords.end(), c)
+                     - m_sorted_coords.begin());
+        int lo = hi - 1;
+        int best_id = -1;
+        *best_cost  = 0.0f;
+
+        // Visit the karts in order of their distance on the sorted axis
+        // (towards both sides of the center), until the lower bound of
+        // the cost of all remaining karts is higher than the best cost.
+        while (lo >= 0 || hi < n)
+        {
+            int next;
+            if (hi >= n ||
+                (lo >= 0 && c - m_sorted_coords[lo] < m_sorted_coords[hi] - c))
+                next = lo--;
+            else
+                next = hi++;
+
+            if (best_id >= 0)
+            {
+                const float d = fabsf(m_sorted_coords[next] - c) - m_margin;
+                if (d > 0 && cost.getLowerBound(d) > *best_cost)
+                    break;
+            }
+
+            m_num_tested++;
+            const unsigned int id = m_sorted_ids[next];
+            const float f = cost(id);
+            if (f < 0) continue;
+            if (best_id < 0 || f < *best_cost ||
+                (f == *best_cost && (prefer_last ? (int)id > best_id
+                                                 : (int)id < best_id)))
+            {
+                *best_cost = f;
+                best_id    = id;
+            }
+        }   // while lo >= 0 || hi < n
+        return best_id;
+    }   // findClosest
+};   // KartSpatialIndex
+
+#endif
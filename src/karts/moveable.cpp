@@ -24,6 +24,7 @@
 #include "graphics/material.hpp"
 #include "graphics/material_manager.hpp"
 #include "modes/world.hpp"
+#include "network/rewind_manager.hpp"
 #include "tracks/track.hpp"
 
 #include "ISceneNode.h"
@@ -121,7 +122,8 @@ void Moveable::stopFlying()
 
 //-----------------------------------------------------------------------------
 /** Updates the current position and rotation from the corresponding physics
- *  body, and then calls updateGraphics to position the model correctly.
+ *  body, and then calls updateGraphics to position the model correctly
+ *  (unless a rewind is being resimulated).
  *  \param float dt Time step size.
  */
 void Moveable::update(float dt)
@@ -131,7 +133,9 @@ void Moveable::update(float dt)
     m_velocityLC = getVelocity()*m_transform.getBasis();
     updatePosition();
 
-    updateGraphics(dt, Vec3(0,0,0), btQuaternion(0, 0, 0, 1));
+    // The graphics are not updated while resimulating after a rewind.
+    if(!RewindManager::get()->isRewinding())
+        updateGraphics(dt, Vec3(0,0,0), btQuaternion(0, 0, 0, 1));
 }   // update
 
 //-----------------------------------------------------------------------------
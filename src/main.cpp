@@ -174,6 +174,7 @@
 #include "addons/news_manager.hpp"
 #include "audio/music_manager.hpp"
 #include "audio/sfx_manager.hpp"
+#include "audio/voice_manager.hpp"
 #include "challenges/unlock_manager.hpp"
 #include "config/hardware_stats.hpp"
 #include "config/player_manager.hpp"
@@ -207,6 +208,8 @@
 #include "modes/cutscene_world.hpp"
 #include "modes/demo_world.hpp"
 #include "modes/profile_world.hpp"
+#include "network/bit_string.hpp"
+#include "network/lag_compensation.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/rewind_manager.hpp"
@@ -234,6 +237,7 @@
 #include "utils/crash_reporting.hpp"
 #include "utils/leak_check.hpp"
 #include "utils/log.hpp"
+#include "utils/random_generator.hpp"
 #include "utils/translation.hpp"
 
 static void cleanSuperTuxKart();
@@ -544,6 +548,8 @@ void cmdLineHelp()
     "       --kart=NAME        Use kart number NAME.\n"
     "       --ai=a,b,...       Use the karts a, b, ... for the AI.\n"
     "       --laps=N           Define number of laps to N.\n"
+    "       --seed=N           Use the seed N for the random numbers of each\n"
+    "                          race, so that races can be reproduced.\n"
     "       --mode=N           N=1 novice, N=2 driver, N=3 racer.\n"
     "       --type=N           N=0 Normal, N=1 Time trial, N=2 FTL\n"
     "       --reverse          Play track in reverse (if allowed)\n"
@@ -557,6 +563,8 @@ void cmdLineHelp()
                               "laps.\n"
     "       --profile-time=n   Enable automatic driven profile mode for n "
                               "seconds.\n"
+    "       --profile-save-history Save the history of a profile race in "
+                              "history.dat.\n"
     "       --no-graphics      Do not display the actual race.\n"
     "       --demo-mode=t      Enables demo mode after t seconds idle time in "
                                "main menu.\n"
@@ -579,6 +587,10 @@ void cmdLineHelp()
     "       --port=n           Port number to use.\n"
     "       --my-address=1.1.1.1:1  Own IP address (can replace stun protocol)\n"
     "       --max-players=n    Maximum number of clients (server only).\n"
+    "       --network-impairment=s Simulate a bad network connection for all\n"
+    "                          packets sent, s is a profile (lan, dsl, wifi,\n"
+    "                          mobile, bad) and/or a list of values, e.g.\n"
+    "                          wifi,latency=50,jitter=20,loss=2,seed=3.\n"
     "       --no-console       Does not write messages in the console but to\n"
     "                          stdout.log.\n"
     "       --console          Write messages in the console and files\n"
@@ -977,6 +989,9 @@ int handleCmdLine()
     // Networking command lines
     NetworkConfig::get()->
         setMaxPlayers(UserConfigParams::m_server_max_players);
+    // Must be set before the STKHost is created
+    if(CommandLine::has("--network-impairment", &s))
+        NetworkConfig::get()->setNetworkImpairment(s);
     if(CommandLine::has("--server", &s))
     {
         NetworkConfig::get()->setServerName(core::stringw(s.c_str()));
@@ -1186,6 +1201,12 @@ int handleCmdLine()
         }
     }   // --laps
 
+    if(CommandLine::has("--seed", &n))
+    {
+        Log::verbose("main", "Using random seed %d for all races.", n);
+        race_manager->setRandomSeed(n);
+    }   // --seed
+
     if(CommandLine::has("--profile-laps",  &n))
     {
         if (n < 0)
@@ -1210,6 +1231,9 @@ int handleCmdLine()
         race_manager->setNumLaps(999999); // profile end depends on time
     }   // --profile-time
 
+    if(CommandLine::has("--profile-save-history"))
+        ProfileWorld::enableSaveHistory();
+
     if(CommandLine::has("--history",  &n))
     {
         history->doReplayHistory( (History::HistoryReplayMode)n);
@@ -1888,6 +1912,14 @@ void runUnitTests()
     GraphicsRestrictions::unitTesting();
     Log::info("UnitTest", "NetworkString");
     NetworkString::unitTesting();
+    Log::info("UnitTest", "BitWriter");
+    BitWriter::unitTesting();
+    Log::info("UnitTest", "LagCompensation");
+    LagCompensation::unitTesting();
+    Log::info("UnitTest", "VoiceManager");
+    VoiceManager::unitTesting();
+    Log::info("UnitTest", "RandomGenerator");
+    RandomGenerator::unitTesting();
 
     Log::info("UnitTest", "Easter detection");
     // Test easter mode: in 2015 Easter is 5th of April - check with 0 days
@@ -22,6 +22,7 @@
 #include <assert.h>
 
 #include "audio/sfx_manager.hpp"
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "graphics/irr_driver.hpp"
 #include "graphics/material_manager.hpp"
@@ -33,6 +34,7 @@
 #include "network/network_config.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/race_event_manager.hpp"
+#include "network/rewind_manager.hpp"
 #include "network/stk_host.hpp"
 #include "online/request_manager.hpp"
 #include "race/history.hpp"
@@ -47,6 +49,7 @@ m_abort(false)
 {
     m_curr_time = 0;
     m_prev_time = 0;
+    m_tick_time_left = 0;
     m_throttle_fps = true;
 }  // MainLoop
 
@@ -130,16 +133,64 @@ float MainLoop::getLimitedDt()
 }   // getLimitedDt
 
 //-----------------------------------------------------------------------------
-/** Updates all race related objects.
+/** Returns the number of ticks the world has to be simulated in this frame.
+ *  The time of a frame that does not fill a whole tick is kept and added
+ *  to the next frame.
+ *  \param dt Time step size of this frame.
+ */
+int MainLoop::getNumTicks(float dt)
+{
+    m_tick_time_left += dt;
+    // Allow for a small rounding error, otherwise a frame of exactly one
+    // tick could result in no tick followed by a frame with two ticks.
+    const int ticks = (int)(m_tick_time_left * stk_config->m_ticks_per_second
+                            + 0.001);
+    m_tick_time_left -= double(ticks) / stk_config->m_ticks_per_second;
+    return ticks;
+}   // getNumTicks
+
+//-----------------------------------------------------------------------------
+/** Returns true if the world is only simulated in fixed steps of one tick.
+ *  This is necessary in network races and when rewinding, so that all
+ *  computers simulate exactly the same steps. Other races are simulated
+ *  with the frame time (bullet still uses substeps of one tick and
+ *  interpolates the transforms in between), so that high frame rates are
+ *  displayed smoothly.
+ */
+bool MainLoop::useFixedTimeStep() const
+{
+    return NetworkConfig::get()->isNetworking() || RewindManager::isEnabled();
+}   // useFixedTimeStep
+
+//-----------------------------------------------------------------------------
+/** Updates all race related objects, and the world time.
  *  \param dt Time step size.
+ *  \param num_steps How often the world is updated with dt: the number of
+ *         ticks with a fixed time step, otherwise 1.
+ *  \param ticks Number of ticks the world clock advances with each step.
+ *  \return False if the world was not updated because a rewind is catching
+ *          up.
  */
-void MainLoop::updateRace(float dt)
+bool MainLoop::updateRace(float dt, int num_steps, int ticks)
 {
-    // The race event manager will update world in case of an online race
-    if (RaceEventManager::getInstance<RaceEventManager>()->isRunning())
-        RaceEventManager::getInstance<RaceEventManager>()->update(dt);
-    else
-        World::getWorld()->updateWorld(dt);
+    // While a rewind is catching up, the world is updated by the
+    // rewind manager at the end of the frame (see run()).
+    if (RewindManager::isEnabled() && RewindManager::get()->isCatchingUp())
+        return false;
+
+    for (int i = 0; i < num_steps && World::getWorld(); i++)
+    {
+        // The race event manager will update world in case of an online race
+        if (RaceEventManager::getInstance<RaceEventManager>()->isRunning())
+            RaceEventManager::getInstance<RaceEventManager>()->update(dt);
+        else
+            World::getWorld()->updateWorld(dt);
+
+        // The world might have been deleted (e.g. at the end of profiling)
+        if (World::getWorld())
+            World::getWorld()->updateTime(dt, ticks);
+    }
+    return true;
 }   // updateRace
 
 //-----------------------------------------------------------------------------
@@ -151,8 +202,10 @@ void MainLoop::updateRace(float dt)
  *    a second have passed, more than 3 physics time steps would be needed, 
  *    and physics do at most 3 time steps).
  *  - if a race is taking place (i.e. not only a menu being shown), call
- *    `updateRace()`, which is a thin wrapper around a call to
- *    `World::updateWorld()`:
+ *    `updateRace()`. In network races (and when rewinding) the world is
+ *    updated once for each tick (see `getNumTicks()`) with the fixed time
+ *    step of one tick, otherwise once with dt (see `useFixedTimeStep()`).
+ *    It is a thin wrapper around a call to `World::updateWorld()`:
  *    - Update history manager (which will either set the kart position and/or
  *      controls when replaying, or store the current info for a replay).
  *      This is mostly for debugging only (though available even in release
@@ -192,6 +245,11 @@ void MainLoop::updateRace(float dt)
  *      check if it's out of bounds), others (like basket ball) do all 
  *      their aiming and movement here.
  *    - Updates the rewind manager to store rewind states.
+ *    - Updates the world time (`World::updateTime()`), which also
+ *      increases the tick count of the world.
+ *    While a rewind is not finished (see `RewindManager::update()`) the
+ *    world is not updated here, instead the rewind is continued at the
+ *    end of the frame.
  *  - Updates the music manager.
  *  - Updates the input manager (which only updates internal time, actual
  *    input handling follows late)
@@ -231,12 +289,21 @@ void MainLoop::run()
             PROFILER_POP_CPU_MARKER();
         }
 
+        int  num_ticks    = 0;
+        bool race_updated = true;
         if (World::getWorld())  // race is active if world exists
         {
             PROFILER_PUSH_CPU_MARKER("Update race", 0, 255, 255);
-            updateRace(dt);
+            num_ticks = getNumTicks(dt);
+            if (useFixedTimeStep())
+                race_updated = updateRace(stk_config->ticks2Time(1),
+                                          num_ticks, 1);
+            else
+                race_updated = updateRace(dt, 1, num_ticks);
             PROFILER_POP_CPU_MARKER();
         }   // if race is active
+        else
+            m_tick_time_left = 0;
 
         // We need to check again because update_race may have requested
         // the main loop to abort; and it's not a good idea to continue
@@ -288,9 +355,15 @@ void MainLoop::run()
             PROFILER_POP_CPU_MARKER();
         }
 
-        if (World::getWorld() )
+        if (World::getWorld() && !race_updated)
         {
-            World::getWorld()->updateTime(dt);
+            // If a rewind could not be finished in its frame, the ticks of
+            // this frame are resimulated as part of the rewind instead.
+            if (RewindManager::isEnabled() &&
+                RewindManager::get()->isCatchingUp())
+                RewindManager::get()->update(num_ticks);
+            else
+                updateRace(stk_config->ticks2Time(1), num_ticks, 1);
         }
 
         PROFILER_POP_CPU_MARKER();
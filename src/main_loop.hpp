@@ -36,8 +36,15 @@ private:
 
     Uint32   m_curr_time;
     Uint32   m_prev_time;
+
+    /** Real time that has passed but was not simulated yet, since the
+     *  world is only updated in steps of whole ticks. */
+    double   m_tick_time_left;
+
     float    getLimitedDt();
-    void     updateRace(float dt);
+    int      getNumTicks(float dt);
+    bool     useFixedTimeStep() const;
+    bool     updateRace(float dt, int num_steps, int ticks);
 public:
          MainLoop();
         ~MainLoop();
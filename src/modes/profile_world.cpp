@@ -19,11 +19,29 @@
 #include "modes/profile_world.hpp"
 
 #include "main_loop.hpp"
+#include "audio/sfx_manager.hpp"
+#include "audio/voice_manager.hpp"
+#include "config/user_config.hpp"
 #include "graphics/camera.hpp"
 #include "graphics/irr_driver.hpp"
+#include "items/attachment.hpp"
+#include "items/powerup.hpp"
 #include "karts/kart_with_stats.hpp"
 #include "karts/controller/controller.hpp"
+#include "network/kart_update_scheduler.hpp"
+#include "network/network_string.hpp"
+#include "network/rewind_manager.hpp"
+#include "physics/btKart.hpp"
+#include "physics/btKartRaycast.hpp"
+#include "physics/physics.hpp"
+#include "physics/stk_dynamics_world.hpp"
+#include "race/history.hpp"
+#include "tracks/drive_graph.hpp"
+#include "tracks/drive_node.hpp"
 #include "tracks/track.hpp"
+#include "tracks/track_object_manager.hpp"
+#include "tracks/track_sector.hpp"
+#include "utils/time.hpp"
 
 #include <ISceneManager.h>
 
@@ -34,6 +52,7 @@ ProfileWorld::ProfileType ProfileWorld::m_profile_mode=PROFILE_NONE;
 int   ProfileWorld::m_num_laps    = 0;
 float ProfileWorld::m_time        = 0.0f;
 bool  ProfileWorld::m_no_graphics = false;
+bool  ProfileWorld::m_save_history = false;
 
 //-----------------------------------------------------------------------------
 /** The constructor sets the number of (local) players to 0, since only AI
@@ -164,7 +183,6 @@ void ProfileWorld::update(float dt)
     m_num_solid        += attr->getAttributeAsInt("drawn_solid" );
     m_num_transparent  += attr->getAttributeAsInt("drawn_transparent" );
     m_num_trans_effect += attr->getAttributeAsInt("drawn_transparent_effect" );
-
 }   // update
 
 //-----------------------------------------------------------------------------
@@ -190,6 +208,22 @@ void ProfileWorld::enterRaceOverState()
     }
 
     StandardRace::enterRaceOverState();
+    if(m_save_history)
+    {
+        history->Save();
+        // Hits on karts use random numbers, so a reproducibility test
+        // (see tools/check_race_reproducibility.sh) needs races with hits.
+        int explosions = 0, bubblegums = 0;
+        for (unsigned int i = 0; i < m_karts.size(); i++)
+        {
+            KartWithStats* kart = dynamic_cast<KartWithStats*>(m_karts[i]);
+            explosions += kart->getExplosionCount();
+            bubblegums += kart->getBubblegumCount();
+        }
+        Log::info("profile", "Hits: %d explosions %d bubblegums",
+                  explosions, bubblegums);
+    }
+
     // Estimate finish time and set all karts to be finished.
     for (unsigned int i=0; i<race_manager->getNumberOfKarts(); i++)
     {
@@ -203,6 +237,20 @@ void ProfileWorld::enterRaceOverState()
     float runtime = (irr_driver->getRealTime()-m_start_time)*0.001f;
     Log::verbose("profile", "Number of frames: %d time %f, Average FPS: %f",
                  m_frame_count, runtime, (float)m_frame_count/runtime);
+    btKartRaycaster::printStatistics();
+    benchmarkSuspensionRays();
+    getTrack()->getTrackObjectManager()->printStatistics();
+    benchmarkTrackSectors();
+    benchmarkTrackObjectRaycasts();
+    benchmarkTrackObjectLookup();
+    benchmarkKartQueries();
+    benchmarkKartUpdates();
+    benchmarkKartStates();
+    SFXManager::get()->printStatistics();
+    VoiceManager::benchmark(8 * (unsigned int)m_karts.size(),
+                            UserConfigParams::m_max_sfx_voices);
+    if (RewindManager::isEnabled())
+        RewindManager::get()->printStatistics();
 
     // Print geometry statistics if we're not in no-graphics mode
     if(!m_no_graphics)
@@ -348,3 +396,379 @@ void ProfileWorld::enterRaceOverState()
     delete this;
     main_loop->abort();
 }   // enterRaceOverState
+
+//-----------------------------------------------------------------------------
+/** Casts the suspension rays of all karts (at their position at the end of
+ *  the race) many times, once one ray at a time and once batched per kart,
+ *  and prints the time needed per kart. The ray statistics are reset
+ *  afterwards, since these rays are not part of the race.
+ */
+void ProfileWorld::benchmarkSuspensionRays()
+{
+    std::vector<btVector3> from, to;
+    std::vector<int> num_rays;
+    for (unsigned int i = 0; i < m_karts.size(); i++)
+    {
+        const btKart *vehicle = m_karts[i]->getVehicle();
+        if (!vehicle) continue;
+        num_rays.push_back(vehicle->getNumWheels());
+        for (int j = 0; j < vehicle->getNumWheels(); j++)
+        {
+            const btWheelInfo &wheel = vehicle->getWheelInfo(j);
+            const btScalar length = wheel.getSuspensionRestLength()
+                                  + wheel.m_maxSuspensionTravel + 0.5f;
+            from.push_back(wheel.m_raycastInfo.m_hardPointWS);
+            to.push_back(wheel.m_raycastInfo.m_hardPointWS
+                         + wheel.m_raycastInfo.m_wheelDirectionWS * length);
+        }
+    }
+    if (num_rays.empty()) return;
+
+    btKartRaycaster raycaster(getPhysics()->getPhysicsWorld());
+    btVehicleRaycaster::btVehicleRaycasterResult results[8];
+    void *objects[8];
+    const unsigned int num_rounds = 1000;
+    double time[2];
+    for (unsigned int batched = 0; batched < 2; batched++)
+    {
+        const double start = StkTime::getRealTime();
+        for (unsigned int r = 0; r < num_rounds; r++)
+        {
+            unsigned int first = 0;
+            for (unsigned int k = 0; k < num_rays.size(); k++)
+            {
+                if (batched)
+                {
+                    raycaster.castRays(num_rays[k], &from[first],
+                                       &to[first], results, objects);
+                }
+                else
+                {
+                    for (int j = 0; j < num_rays[k]; j++)
+                        raycaster.castRay(from[first + j], to[first + j],
+                                          results[j]);
+                }
+                first += num_rays[k];
+            }
+        }
+        time[batched] = StkTime::getRealTime() - start;
+    }
+    btKartRaycaster::resetStatistics();
+
+    const float num_karts = (float)(num_rays.size() * num_rounds);
+    Log::verbose("profile", "Suspension rays: %f us per kart casting each "
+                 "ray, %f us casting the rays of a kart as a batch.",
+                 time[0] * 1000000.0 / num_karts,
+                 time[1] * 1000000.0 / num_karts);
+}   // benchmarkSuspensionRays
+
+//-----------------------------------------------------------------------------
+/** Measures the time TrackSector::update takes for all karts. Each kart
+ *  moves along all drive nodes (starting at different nodes), and every
+ *  fourth position is off the road to include findOutOfRoadSector.
+ */
+void ProfileWorld::benchmarkTrackSectors()
+{
+    DriveGraph *dg = DriveGraph::get();
+    if (!dg || dg->getNumNodes() == 0 || m_karts.size() == 0) return;
+
+    const unsigned int num_nodes  = dg->getNumNodes();
+    const unsigned int num_karts  = (unsigned int)m_karts.size();
+    const unsigned int num_rounds = 20;
+    const double start = StkTime::getRealTime();
+    for (unsigned int k = 0; k < num_karts; k++)
+    {
+        TrackSector sector;
+        const unsigned int offset = k * num_nodes / num_karts;
+        for (unsigned int i = 0; i < num_nodes * num_rounds; i++)
+        {
+            const DriveNode *dn = dg->getNode((i + offset) % num_nodes);
+            const float side = i % 4 == 3 ? 1.0f : 0.25f;
+            sector.update(dn->getCenter() + dn->getRightUnitVector()
+                                          * dn->getPathWidth() * side);
+        }
+    }
+    const double time = StkTime::getRealTime() - start;
+
+    const float num_updates = (float)(num_karts * num_nodes * num_rounds);
+    Log::verbose("profile", "TrackSector::update for %d karts, %d nodes: "
+                 "%f us per update.", num_karts, num_nodes,
+                 time * 1000000.0 / num_updates);
+}   // benchmarkTrackSectors
+
+//-----------------------------------------------------------------------------
+/** Measures the time of raycasts against the driveable track objects. The
+ *  rays go down through the center and both sides of each drive node, like
+ *  the raycasts to determine the terrain below a kart. The number of objects
+ *  tested per ray is part of the statistics of the track object manager,
+ *  which are printed before (so they only include the race).
+ */
+void ProfileWorld::benchmarkTrackObjectRaycasts()
+{
+    DriveGraph *dg = DriveGraph::get();
+    if (!dg || dg->getNumNodes() == 0) return;
+
+    const TrackObjectManager *tom = m_track->getTrackObjectManager();
+    const unsigned int num_nodes  = dg->getNumNodes();
+    const unsigned int num_rounds = 10;
+    unsigned int num_hits = 0;
+    const double start = StkTime::getRealTime();
+    for (unsigned int r = 0; r < num_rounds; r++)
+    {
+        for (unsigned int i = 0; i < num_nodes * 3; i++)
+        {
+            const DriveNode *dn = dg->getNode(i / 3);
+            const float side = (float)(i % 3) - 1.0f;
+            const Vec3 xyz = dn->getCenter() + dn->getRightUnitVector()
+                                             * dn->getPathWidth() * side;
+            const Vec3 up = dn->getNormal() * 5.0f;
+            btVector3 hit_point, normal;
+            const Material *material = NULL;
+            tom->castRay(xyz + up, xyz - up * 4.0f, &hit_point,
+                         &material, &normal);
+            if (material) num_hits++;
+        }
+    }
+    const double time = StkTime::getRealTime() - start;
+
+    const float num_rays = (float)(3 * num_nodes * num_rounds);
+    Log::verbose("profile", "TrackObjectManager::castRay: %f us per ray, "
+                 "%d of %d rays hit an object.",
+                 time * 1000000.0 / num_rays, num_hits, (int)num_rays);
+}   // benchmarkTrackObjectRaycasts
+
+//-----------------------------------------------------------------------------
+/** Measures the time scripts need to find a track object by its IDs using
+ *  the object index of the track object manager. Each object of the track
+ *  is looked up several times.
+ */
+void ProfileWorld::benchmarkTrackObjectLookup()
+{
+    TrackObjectManager *tom = m_track->getTrackObjectManager();
+    PtrVector<TrackObject> &objects = tom->getObjects();
+    const unsigned int num_objects = objects.size();
+    if (num_objects == 0) return;
+
+    std::vector<std::string> library_ids, ids;
+    for (unsigned int i = 0; i < num_objects; i++)
+    {
+        TrackObject *library = objects.get(i)->getParentLibrary();
+        library_ids.push_back(library ? library->getID() : "");
+        ids.push_back(objects.get(i)->getID());
+    }
+
+    const unsigned int num_rounds = 20;
+    unsigned int num_found = 0;
+    const double start = StkTime::getRealTime();
+    for (unsigned int r = 0; r < num_rounds; r++)
+    {
+        for (unsigned int i = 0; i < num_objects; i++)
+        {
+            if (tom->getTrackObject(library_ids[i], ids[i]))
+                num_found++;
+        }
+    }
+    const double time = StkTime::getRealTime() - start;
+
+    const float num_lookups = (float)(num_objects * num_rounds);
+    Log::verbose("profile", "TrackObjectManager::getTrackObject for %d "
+                 "objects: %f us per lookup, %d of %d lookups found an "
+                 "object.", num_objects, time * 1000000.0 / num_lookups,
+                 num_found, (int)num_lookups);
+}   // benchmarkTrackObjectLookup
+
+//-----------------------------------------------------------------------------
+namespace
+{
+    /** Squared distance to a kart, used to benchmark the kart index. */
+    class Distance2Cost
+    {
+    private:
+        const World::KartList &m_karts;
+        Vec3                   m_xyz;
+    public:
+        Distance2Cost(const World::KartList &karts, const Vec3 &xyz)
+            : m_karts(karts), m_xyz(xyz) {}
+        float operator()(unsigned int id) const
+        {
+            return (m_karts[id]->getXYZ() - m_xyz).length2();
+        }   // operator()
+        float getLowerBound(float distance) const { return distance*distance; }
+    };   // Distance2Cost
+}   // anonymous namespace
+
+//-----------------------------------------------------------------------------
+/** Measures the time to find the closest kart to a point (like a projectile
+ *  looking for a target) by testing all karts, and by using the kart index
+ *  of the world. The points are the karts and points 10m in front of each
+ *  kart. Also checks that both ways find the same karts. Run with e.g.
+ *  --numkarts=32 to see the difference.
+ */
+void ProfileWorld::benchmarkKartQueries()
+{
+    if (m_karts.empty()) return;
+    updateKartIndex();
+
+    std::vector<Vec3> points;
+    for (unsigned int i = 0; i < m_karts.size(); i++)
+    {
+        points.push_back(m_karts[i]->getXYZ());
+        points.push_back(m_karts[i]->getTrans()(Vec3(0, 0, 10.0f)));
+    }
+
+    const unsigned int num_rounds = 100;
+    std::vector<int> closest[2];
+    double time[2];
+    for (unsigned int index = 0; index < 2; index++)
+    {
+        closest[index].clear();
+        const double start = StkTime::getRealTime();
+        for (unsigned int r = 0; r < num_rounds; r++)
+        {
+            for (unsigned int p = 0; p < points.size(); p++)
+            {
+                const Distance2Cost cost(m_karts, points[p]);
+                int id = -1;
+                if (index == 0)
+                {
+                    float min_distance2 = 0;
+                    for (unsigned int i = 0; i < m_karts.size(); i++)
+                    {
+                        const float distance2 = cost(i);
+                        if (id < 0 || distance2 < min_distance2)
+                        {
+                            min_distance2 = distance2;
+                            id            = i;
+                        }
+                    }
+                }
+                else
+                {
+                    float distance2;
+                    id = m_kart_index.findClosest(points[p], cost,
+                                                  /*prefer_last*/false,
+                                                  &distance2);
+                }
+                if (r == 0) closest[index].push_back(id);
+            }
+        }
+        time[index] = StkTime::getRealTime() - start;
+    }
+
+    unsigned int num_different = 0;
+    for (unsigned int p = 0; p < points.size(); p++)
+    {
+        if (closest[0][p] != closest[1][p])
+            num_different++;
+    }
+    const float num_queries = (float)(points.size() * num_rounds);
+    Log::verbose("profile", "Closest kart for %d karts: %f us per query "
+                 "testing all karts, %f us with the kart index, %d different "
+                 "results.", (int)m_karts.size(),
+                 time[0] * 1000000.0 / num_queries,
+                 time[1] * 1000000.0 / num_queries, num_different);
+    m_kart_index.printStatistics();
+}   // benchmarkKartQueries
+
+//-----------------------------------------------------------------------------
+/** Runs one kart update scheduler for each kart (i.e. assuming one client
+ *  per kart) for a simulated minute at 60 frames per second, using the kart
+ *  positions at the end of the race. Prints the average number of bytes of
+ *  kart updates per client and second a server would send, compared with
+ *  sending all karts 10 times per second, and the time the schedulers need
+ *  per server frame. Run e.g. with --numkarts=16 and --numkarts=32.
+ */
+void ProfileWorld::benchmarkKartUpdates()
+{
+    if (m_karts.empty()) return;
+
+    std::vector<KartUpdateScheduler> schedulers(m_karts.size());
+    for (unsigned int i = 0; i < m_karts.size(); i++)
+    {
+        schedulers[i].reset(m_karts.size());
+        schedulers[i].setOwnKarts(std::vector<int>(1, i));
+    }
+
+    const unsigned int num_frames = 60 * 60;
+    const float dt = 1.0f / 60.0f;
+    std::vector<int> karts;
+    const double start = StkTime::getRealTime();
+    for (unsigned int f = 0; f < num_frames; f++)
+    {
+        for (unsigned int i = 0; i < schedulers.size(); i++)
+            schedulers[i].selectKarts(dt, &karts);
+    }
+    const double time = StkTime::getRealTime() - start;
+
+    float bytes = 0;
+    for (unsigned int i = 0; i < schedulers.size(); i++)
+        bytes += schedulers[i].getBytesPerSecond();
+    bytes /= schedulers.size();
+    const float all_karts = 10.0f * (KartUpdateScheduler::HEADER_SIZE
+                                     + KartUpdateScheduler::KART_SIZE
+                                       * m_karts.size());
+    Log::verbose("profile", "Kart updates for %d karts: %f bytes per client "
+                 "and second, %f when sending all karts 10 times per second, "
+                 "%f us per frame for all clients.", (int)m_karts.size(),
+                 bytes, all_karts, time * 1000000.0 / num_frames);
+}   // benchmarkKartUpdates
+
+//-----------------------------------------------------------------------------
+/** Returns the number of bytes the attachment and powerup state of a kart
+ *  used before they were bit packed: one byte for each type, a float for
+ *  the time left of an attachment, a byte for the number of powerups and
+ *  for the previous owner of a bomb.
+ *  \param kart The kart.
+ */
+unsigned int ProfileWorld::getByteAlignedStateSize(const AbstractKart *kart)
+{
+    const Attachment *attachment = kart->getAttachment();
+    unsigned int size = 2;
+    if (attachment->getType() != Attachment::ATTACH_NOTHING)
+    {
+        size += 4;
+        if (attachment->getType() == Attachment::ATTACH_BOMB &&
+            attachment->getPreviousOwner())
+            size++;
+    }
+    if (kart->getPowerup()->getType() != PowerupManager::POWERUP_NOTHING)
+        size++;
+    return size;
+}   // getByteAlignedStateSize
+
+//-----------------------------------------------------------------------------
+/** Saves the attachment and powerup state of all karts as they are at the
+ *  end of the race, and prints the average number of bytes they use in a
+ *  rewind state (compared with byte-aligned values) and the time needed to
+ *  save them.
+ */
+void ProfileWorld::benchmarkKartStates()
+{
+    if (m_karts.empty()) return;
+
+    unsigned int bytes = 0, bytes_before = 0;
+    for (unsigned int i = 0; i < m_karts.size(); i++)
+        bytes_before += getByteAlignedStateSize(m_karts[i]);
+
+    const unsigned int num_rounds = 1000;
+    BareNetworkString state(16);
+    const double start = StkTime::getRealTime();
+    for (unsigned int r = 0; r < num_rounds; r++)
+    {
+        for (unsigned int i = 0; i < m_karts.size(); i++)
+        {
+            state.clear();
+            m_karts[i]->getAttachment()->saveState(&state);
+            m_karts[i]->getPowerup()->saveState(&state);
+            if (r == 0) bytes += state.size();
+        }
+    }
+    const double time = StkTime::getRealTime() - start;
+
+    const float num_karts = (float)m_karts.size();
+    Log::verbose("profile", "Attachment and powerup state: %f bytes per "
+                 "kart, %f bytes with byte-aligned values, %f us to save "
+                 "the state of one kart.", bytes / num_karts,
+                 bytes_before / num_karts,
+                 time * 1000000.0 / (num_rounds * num_karts));
+}   // benchmarkKartStates
@@ -21,6 +21,9 @@
 
 #include "modes/standard_race.hpp"
 
+#include <vector>
+
+class AbstractKart;
 class Kart;
 
 /**
@@ -43,6 +46,10 @@ private:
     /** In time based profiling only: time to run. */
     static float m_time;
 
+    /** If the history should be saved at the end of the race, e.g. to
+     *  compare two races with the same random seed. */
+    static bool  m_save_history;
+
     /** Return value of real time at start of race. */
     unsigned int m_start_time;
 
@@ -67,6 +74,15 @@ private:
     /** Number of calls to draw. */
     long long    m_num_calls;
 
+    void benchmarkSuspensionRays();
+    void benchmarkTrackSectors();
+    void benchmarkTrackObjectRaycasts();
+    void benchmarkTrackObjectLookup();
+    void benchmarkKartQueries();
+    void benchmarkKartUpdates();
+    void benchmarkKartStates();
+    static unsigned int getByteAlignedStateSize(const AbstractKart *kart);
+
 protected:
     /** In laps based profiling: number of laps to run. Also
      *  used by DemoWorld. */
@@ -97,6 +113,9 @@ public:
     // ------------------------------------------------------------------------
     /** Returns true if no graphics should be displayed. */
     static   bool isNoGraphics()  {return m_no_graphics; }
+    // ------------------------------------------------------------------------
+    /** Saves the history at the end of the race. */
+    static   void enableSaveHistory() { m_save_history = true; }
 };
 
 #endif
@@ -703,6 +703,7 @@ void ThreeStrikesBattle::loadCustomModels()
 
             // Find random nodes to pre-spawn spare tire karts
             RandomGenerator random;
+            random.seedForRace(RandomGenerator::RS_WORLD);
             while (true)
             {
                 const int node = random.get(all_nodes);
@@ -24,6 +24,7 @@
 #include "audio/sfx_manager.hpp"
 #include "config/player_manager.hpp"
 #include "challenges/unlock_manager.hpp"
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "graphics/camera.hpp"
 #include "graphics/irr_driver.hpp"
@@ -32,6 +33,7 @@
 #include "io/file_manager.hpp"
 #include "input/device_manager.hpp"
 #include "input/keyboard_device.hpp"
+#include "items/item_manager.hpp"
 #include "items/projectile_manager.hpp"
 #include "karts/controller/battle_ai.hpp"
 #include "karts/controller/soccer_ai.hpp"
@@ -48,8 +50,10 @@
 #include "modes/profile_world.hpp"
 #include "modes/soccer_world.hpp"
 #include "network/network_config.hpp"
+#include "network/race_event_manager.hpp"
 #include "network/rewind_manager.hpp"
 #include "physics/btKart.hpp"
+#include "physics/btKartRaycast.hpp"
 #include "physics/physics.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "race/highscore_manager.hpp"
@@ -68,6 +72,7 @@
 #include "tracks/track_manager.hpp"
 #include "utils/constants.hpp"
 #include "utils/profiler.hpp"
+#include "utils/random_generator.hpp"
 #include "utils/translation.hpp"
 #include "utils/string_utils.hpp"
 
@@ -168,6 +173,14 @@ void World::init()
 
     RewindManager::create();
 
+    // All random numbers of the simulation are derived from the seed of
+    // the race. In a network game the server sends the seed to the clients
+    // when the race is started.
+    if (!NetworkConfig::get()->isNetworking())
+        RandomGenerator::setRaceSeed(race_manager->getRandomSeed());
+    Log::verbose("World", "Random seed of the race: %u.",
+                 RandomGenerator::getRaceSeed());
+
     // Grab the track file
     m_track = track_manager->getTrack(race_manager->getTrackName());
     m_script_engine = new Scripting::ScriptEngine();
@@ -278,6 +291,9 @@ void World::reset()
         ReplayPlay::get()->reset();
 
     resetAllKarts();
+    // The ray statistics (see ProfileWorld) should only count the rays of
+    // this race, not of previous races or of the settling of the karts.
+    btKartRaycaster::resetStatistics();
     // Note: track reset must be called after all karts exist, since check
     // objects need to allocate data structures depending on the number
     // of karts.
@@ -731,6 +747,7 @@ void World::resetAllKarts()
     {
         (*i)->kartIsInRestNow();
     }
+    updateKartIndex();
 
     // Initialise the cameras, now that the correct kart positions are set
     for(unsigned int i=0; i<Camera::getNumCameras(); i++)
@@ -781,8 +798,22 @@ void World::moveKartTo(AbstractKart* kart, const btTransform &transform)
     // This will set the physics transform
     m_track->findGround(kart);
 
+    // Other karts updated in this frame must find the kart at its new
+    // position, not where it was before the last physics update.
+    updateKartIndex(kart);
 }   // moveKartTo
 
+// ----------------------------------------------------------------------------
+/** Updates the position of one kart in the kart index. This must be done
+ *  when a kart is teleported (e.g. after a rescue or a reset), since other
+ *  karts might look for it before the index is rebuilt.
+ *  \param kart The kart that was moved.
+ */
+void World::updateKartIndex(const AbstractKart *kart)
+{
+    m_kart_index.updateKart(kart->getWorldKartId(), kart->getXYZ());
+}   // updateKartIndex
+
 // ----------------------------------------------------------------------------
 void World::schedulePause(Phase phase)
 {
@@ -988,8 +1019,12 @@ void World::update(float dt)
     }
     PROFILER_POP_CPU_MARKER();
 
+    // Cameras and weather are only graphical effects, which are not updated
+    // while resimulating after a rewind.
+    const bool is_rewinding = RewindManager::get()->isRewinding();
+
     PROFILER_PUSH_CPU_MARKER("World::update (camera)", 0x60, 0x7F, 0x00);
-    for(unsigned int i=0; i<Camera::getNumCameras(); i++)
+    for(unsigned int i=0; i<Camera::getNumCameras() && !is_rewinding; i++)
     {
         Camera::getCamera(i)->update(dt);
     }
@@ -1002,9 +1037,10 @@ void World::update(float dt)
     {
         m_physics->update(dt);
     }
+    updateKartIndex();
 
     PROFILER_PUSH_CPU_MARKER("World::update (weather)", 0x80, 0x7F, 0x00);
-    if (UserConfigParams::m_graphical_effects && m_weather)
+    if (UserConfigParams::m_graphical_effects && m_weather && !is_rewinding)
     {
         m_weather->update(dt);
     }
@@ -1022,14 +1058,57 @@ void World::update(float dt)
 }   // update
 
 // ----------------------------------------------------------------------------
-/** Compute the new time, and set this new time to be used in the rewind
- *  manager.
+/** Updates the kart models, engine sounds, projectiles, items and cameras.
+ *  These are not updated while resimulating after a rewind, so this is
+ *  called once the resimulation of a frame is done. The cameras follow the
+ *  karts with a delay that depends on the time step, so they are updated
+ *  once per tick to avoid a jump.
+ *  \param ticks Number of ticks that were resimulated.
+ */
+void World::updateGraphics(int ticks)
+{
+    const float dt = stk_config->ticks2Time(ticks);
+    for (unsigned int i = 0; i < m_karts.size(); i++)
+    {
+        if (m_karts[i]->isEliminated()) continue;
+        m_karts[i]->updateGraphics(dt, Vec3(0, 0, 0),
+                                   btQuaternion(0, 0, 0, 1));
+        Kart *kart = dynamic_cast<Kart*>(m_karts[i]);
+        if (kart)
+            kart->updateEngineSFX();
+    }
+    projectile_manager->updateGraphics(dt);
+    ItemManager::get()->updateGraphics(dt);
+
+    const float tick_dt = stk_config->ticks2Time(1);
+    for (int t = 0; t < ticks; t++)
+    {
+        for (unsigned int i = 0; i < Camera::getNumCameras(); i++)
+            Camera::getCamera(i)->update(tick_dt);
+    }
+}   // updateGraphics
+
+// ----------------------------------------------------------------------------
+/** Compute the new time, and set the new tick count to be used in the
+ *  rewind manager. On a server the kart positions are recorded for lag
+ *  compensation.
  *  \param dt Time step size.
+ *  \param ticks Number of ticks the simulation clock advances.
  */
-void World::updateTime(const float dt)
+void World::updateTime(const float dt, const int ticks)
 {
-    WorldStatus::updateTime(dt);
-    RewindManager::get()->setCurrentTime(getTime(), dt);
+    WorldStatus::updateTime(dt, ticks);
+    RewindManager::get()->setCurrentTicks(getTimeTicks(), dt);
+
+    if (RaceEventManager::getInstance()->isRunning() &&
+        NetworkConfig::get()->isServer())
+    {
+        m_lag_compensation_xyz.resize(m_karts.size());
+        for (unsigned int i = 0; i < m_karts.size(); i++)
+            m_lag_compensation_xyz[i] = m_karts[i]->getXYZ();
+        RewindManager::get()->getLagCompensation()
+            ->recordKartPositions(getTimeTicks(), m_lag_compensation_xyz);
+    }
 }   // updateTime
 
 // ----------------------------------------------------------------------------
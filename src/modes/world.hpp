@@ -29,6 +29,7 @@
 #include <stdexcept>
 
 #include "graphics/weather.hpp"
+#include "karts/kart_spatial_index.hpp"
 #include "modes/world_status.hpp"
 #include "race/highscores.hpp"
 #include "states_screens/race_gui_base.hpp"
@@ -96,6 +97,14 @@ protected:
     KartList                  m_karts;
     RandomGenerator           m_random;
 
+    /** Positions of all karts for proximity queries, rebuilt once per
+     *  update after the physics. */
+    KartSpatialIndex          m_kart_index;
+
+    /** Positions of all karts recorded for lag compensation on a server,
+     *  reused to avoid memory allocations. */
+    std::vector<Vec3>         m_lag_compensation_xyz;
+
     Physics*      m_physics;
     bool          m_force_disable_fog;
     AbstractKart* m_fastest_kart;
@@ -255,7 +264,7 @@ public:
     virtual void    reset() OVERRIDE;
     virtual void    pause(Phase phase) OVERRIDE;
     virtual void    unpause() OVERRIDE;
-    virtual void    updateTime(const float dt) OVERRIDE;
+    virtual void    updateTime(const float dt, const int ticks) OVERRIDE;
     virtual void    getDefaultCollectibles(int *collectible_type,
                                            int *amount );
     virtual void    endRaceEarly() { return; }
@@ -289,6 +298,7 @@ public:
     void            scheduleExitRace() { m_schedule_exit_race = true; }
     void            scheduleTutorial();
     void            updateWorld(float dt);
+    void            updateGraphics(int ticks);
     void            handleExplosion(const Vec3 &xyz, AbstractKart *kart_hit,
                                     PhysicalObject *object);
     AbstractKart*   getPlayerKart(unsigned int player) const;
@@ -309,6 +319,16 @@ public:
     /** Returns all karts. */
     const KartList & getKarts() const { return m_karts; }
     // ------------------------------------------------------------------------
+    /** Returns the index of the kart positions for proximity queries. */
+    const KartSpatialIndex &getKartIndex() const { return m_kart_index; }
+    // ------------------------------------------------------------------------
+    /** Stores the current kart positions in the kart index. This is done
+     *  after each physics update, but must also be done when karts are
+     *  moved otherwise (e.g. when restoring a state in a rewind). */
+    void updateKartIndex() { m_kart_index.build(m_karts); }
+    // ------------------------------------------------------------------------
+    void updateKartIndex(const AbstractKart *kart);
+    // ------------------------------------------------------------------------
     /** Returns the number of currently active (i.e.non-elikminated) karts. */
     unsigned int    getCurrentNumKarts() const { return (int)m_karts.size() -
                                                          m_eliminated_karts; }
@@ -37,6 +37,11 @@
 WorldStatus::WorldStatus()
 {
     m_clock_mode        = CLOCK_CHRONO;
+    m_time_ticks        = 0;
+    m_tick_time_left    = 0.0;
+    m_clock_start_time  = 0.0f;
+    m_clock_start_ticks = 0;
+    m_clock_start_time_left = 0.0;
 
     m_prestart_sound    = SFXManager::get()->createSoundSource("pre_start_race");
     m_start_sound       = SFXManager::get()->createSoundSource("start_race");
@@ -59,9 +64,14 @@ WorldStatus::WorldStatus()
  */
 void WorldStatus::reset()
 {
-    m_time            = 0.0f;
-    m_auxiliary_timer = 0.0f;
-    m_count_up_timer  = 0.0f;
+    m_time              = 0.0f;
+    m_auxiliary_timer   = 0.0f;
+    m_count_up_timer    = 0.0f;
+    m_time_ticks        = 0;
+    m_tick_time_left    = 0.0;
+    m_clock_start_time  = 0.0f;
+    m_clock_start_ticks = 0;
+    m_clock_start_time_left = 0.0;
 
     m_engines_started = false;
     
@@ -135,7 +145,7 @@ void WorldStatus::startEngines()
 void WorldStatus::setClockMode(const ClockType mode, const float initial_time)
 {
     m_clock_mode = mode;
-    m_time = initial_time;
+    setTime(initial_time);
 }   // setClockMode
 
 //-----------------------------------------------------------------------------
@@ -176,8 +186,12 @@ void WorldStatus::update(float dt)
  *  all status information, called once per frame at the end of the main
  *  loop.
  *  \param dt Duration of time step.
+ *  \param ticks Number of ticks the simulation clock advances. This is 1
+ *         with a fixed time step, otherwise the number of whole ticks that
+ *         passed (see MainLoop::getNumTicks), which can be 0. The rest of
+ *         dt is kept in m_tick_time_left, so the clock still advances by dt.
  */
-void WorldStatus::updateTime(const float dt)
+void WorldStatus::updateTime(const float dt, const int ticks)
 {
     // In case of a networked race wait till all necessary protocols are
     // ready before progressing the timer
@@ -394,13 +408,18 @@ void WorldStatus::updateTime(const float dt)
     }
 
     IrrlichtDevice *device = irr_driver->getDevice();
+    if (!device->getTimer()->isStopped())
+    {
+        m_time_ticks     += ticks;
+        m_tick_time_left += dt - stk_config->ticks2Time(ticks);
+    }
 
     switch (m_clock_mode)
     {
         case CLOCK_CHRONO:
             if (!device->getTimer()->isStopped())
             {
-                m_time += dt;
+                updateClock();
                 m_count_up_timer += dt;
             }
             break;
@@ -408,14 +427,14 @@ void WorldStatus::updateTime(const float dt)
             // stop countdown when race is over
             if (m_phase == RESULT_DISPLAY_PHASE || m_phase == FINISH_PHASE)
             {
-                m_time = 0.0f;
+                setTime(0.0f);
                 m_count_up_timer = 0.0f;
                 break;
             }
 
             if (!device->getTimer()->isStopped())
             {
-                m_time -= dt;
+                updateClock();
                 m_count_up_timer += dt;
             }
 
@@ -446,9 +465,35 @@ void WorldStatus::startReadySetGo()
  */
 void WorldStatus::setTime(const float time)
 {
-    m_time = time;
+    m_time                  = time;
+    m_clock_start_time      = time;
+    m_clock_start_ticks     = m_time_ticks;
+    m_clock_start_time_left = m_tick_time_left;
 }   // setTime
 
+//-----------------------------------------------------------------------------
+/** Sets the simulation clock to the specified tick, and the race time
+ *  accordingly. This is used when rewinding.
+ *  \param ticks The new tick count.
+ */
+void WorldStatus::setTimeTicks(int64_t ticks)
+{
+    m_time_ticks = ticks;
+    updateClock();
+}   // setTimeTicks
+
+//-----------------------------------------------------------------------------
+/** Computes the race time from the ticks since the clock was last set. */
+void WorldStatus::updateClock()
+{
+    const float t = stk_config->ticks2Time(m_time_ticks - m_clock_start_ticks)
+                  + float(m_tick_time_left - m_clock_start_time_left);
+    if (m_clock_mode == CLOCK_CHRONO)
+        m_time = m_clock_start_time + t;
+    else if (m_clock_mode == CLOCK_COUNTDOWN)
+        m_time = m_clock_start_time - t;
+}   // updateClock
+
 //-----------------------------------------------------------------------------
 /** Pauses the game and switches to the specified phase.
  *  \param phase Phase to switch to.
@@ -19,6 +19,7 @@
 #define HEADER_WORLD_STATUS_HPP
 
 #include "utils/cpp2011.hpp"
+#include "utils/types.hpp"
 
 class SFXBase;
 
@@ -88,7 +89,10 @@ public:
     };
 
 protected:
-    /** Elasped/remaining time in seconds. */
+    /** Elasped/remaining time in seconds. In chrono and countdown mode
+     *  this is computed from the number of ticks since the clock was set
+     *  (plus the time since the last whole tick without a fixed time step),
+     *  so it does not accumulate rounding errors. */
     double          m_time;
 
     /** If the start race should be played, disabled in cutscenes. */
@@ -128,6 +132,24 @@ private:
 
     float           m_count_up_timer;
 
+    /** Number of ticks the world was simulated for. This is the actual
+     *  simulation clock, all other times are derived from it. */
+    int64_t         m_time_ticks;
+
+    /** Time that passed since the last whole tick counted in m_time_ticks.
+     *  This is only non-zero in races without a fixed time step, where a
+     *  frame is usually not a whole number of ticks. It is added to the
+     *  clock, so that the clock follows the frame time. */
+    double          m_tick_time_left;
+
+    /** Value of the clock (m_time), the tick count and m_tick_time_left at
+     *  the time the clock was last set, see setTime(). */
+    float           m_clock_start_time;
+    int64_t         m_clock_start_ticks;
+    double          m_clock_start_time_left;
+
+    void            updateClock();
+
     bool            m_engines_started;
     void            startEngines();
     /** In networked game the client must wait for the server to start 'ready set go'
@@ -141,7 +163,7 @@ public:
     virtual ~WorldStatus();
 
     virtual void reset();
-    virtual void updateTime(const float dt);
+    virtual void updateTime(const float dt, const int ticks);
     virtual void update(float dt);
     void         startReadySetGo();
     virtual void pause(Phase phase);
@@ -149,6 +171,7 @@ public:
     virtual void enterRaceOverState();
     virtual void terminateRace();
     void         setTime(const float time);
+    void         setTimeTicks(int64_t ticks);
 
     // ------------------------------------------------------------------------
     // Note: GO_PHASE is both: start phase and race phase
@@ -185,6 +208,10 @@ public:
     /** Returns the current race time. */
     float   getTime() const      { return (float)m_time; }
 
+    // ------------------------------------------------------------------------
+    /** Returns the number of ticks the world was simulated for. */
+    int64_t getTimeTicks() const { return m_time_ticks; }
+
     // ------------------------------------------------------------------------
     /** Will be called to notify your derived class that the clock,
      *  which is in COUNTDOWN mode, has reached zero. */
@@ -0,0 +1,67 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#include "network/bit_string.hpp"
+
+#include <assert.h>
+
+// ----------------------------------------------------------------------------
+/** Writes and reads back values of different sizes.
+ */
+void BitWriter::unitTesting()
+{
+    assert(getNumBits(0) == 1);
+    assert(getNumBits(1) == 1);
+    assert(getNumBits(9) == 4);
+    assert(getNumBits(255) == 8);
+    assert(getNumBits(256) == 9);
+
+    BareNetworkString s;
+    {
+        BitWriter writer(&s);
+        writer.addBits(5, 3);
+        writer.addBool(true);
+        writer.addBits(0xbeef, 16);
+        writer.addVarUInt(3, 3);
+        writer.addVarUInt(1000, 6);
+        writer.addVarInt(-1, 6);
+        writer.addVarInt(-1800, 6);
+        writer.addVarInt(1800, 6);
+        writer.addVarUInt(0xffffffff, 7);
+    }
+    // Data after the bits must be byte aligned and readable as usual
+    s.addUInt16(12345);
+
+    // 3+1+16 bits, 4, 2*7, 7, 2*7, 2*7, 5*8 bits = 113 bits = 15 bytes
+    assert(s.size() == 15 + 2);
+
+    {
+        BitReader reader(&s);
+        assert(reader.getBits(3) == 5);
+        assert(reader.getBool());
+        assert(reader.getBits(16) == 0xbeef);
+        assert(reader.getVarUInt(3) == 3);
+        assert(reader.getVarUInt(6) == 1000);
+        assert(reader.getVarInt(6) == -1);
+        assert(reader.getVarInt(6) == -1800);
+        assert(reader.getVarInt(6) == 1800);
+        assert(reader.getVarUInt(7) == 0xffffffff);
+    }
+    assert(s.getUInt16() == 12345);
+}   // unitTesting
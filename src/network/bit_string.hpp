@@ -0,0 +1,204 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#ifndef HEADER_BIT_STRING_HPP
+#define HEADER_BIT_STRING_HPP
+
+#include "network/network_string.hpp"
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <assert.h>
+
+/** \ingroup network
+ *  Writes values with an arbitrary number of bits into a BareNetworkString.
+ *  This is used for states that are saved very often (e.g. the attachment
+ *  and powerup of each kart in every rewind state), where most values only
+ *  need a few bits. The bits are written most significant bit first, full
+ *  bytes are appended to the string immediately. The last partial byte is
+ *  padded with zeros and appended by flush() (or the destructor), so the
+ *  data written by one BitWriter always uses a whole number of bytes, and
+ *  other data can be added to the string afterwards as usual.
+ */
+class BitWriter : public NoCopy
+{
+private:
+    /** The string the bytes are appended to. */
+    BareNetworkString *m_buffer;
+
+    /** Bits not yet appended to the buffer, in the lowest m_num_bits bits. */
+    uint32_t m_bits;
+
+    /** Number of bits in m_bits, always less than 8 between calls. */
+    unsigned int m_num_bits;
+
+public:
+    // ------------------------------------------------------------------------
+    BitWriter(BareNetworkString *buffer)
+    {
+        m_buffer   = buffer;
+        m_bits     = 0;
+        m_num_bits = 0;
+    }   // BitWriter
+    // ------------------------------------------------------------------------
+    ~BitWriter() { flush(); }
+    // ------------------------------------------------------------------------
+    /** Adds the lowest n bits of a value.
+     *  \param value The value, which must fit into n bits.
+     *  \param n Number of bits, at most 16.
+     */
+    void addBits(uint32_t value, unsigned int n)
+    {
+        assert(n <= 16 && (n == 16 || value < (1u << n)));
+        m_bits      = (m_bits << n) | value;
+        m_num_bits += n;
+        while (m_num_bits >= 8)
+        {
+            m_num_bits -= 8;
+            m_buffer->addUInt8(uint8_t(m_bits >> m_num_bits));
+        }
+        m_bits &= (1u << m_num_bits) - 1;
+    }   // addBits
+    // ------------------------------------------------------------------------
+    /** Adds a boolean value as a single bit. */
+    void addBool(bool b) { addBits(b ? 1 : 0, 1); }
+    // ------------------------------------------------------------------------
+    /** Adds an unsigned value of variable size, so that small values need
+     *  fewer bits: the value is split into chunks of chunk_bits bits (lowest
+     *  chunk first), each followed by one bit indicating if another chunk
+     *  follows.
+     *  \param value The value to add.
+     *  \param chunk_bits Number of bits in each chunk.
+     */
+    void addVarUInt(uint32_t value, unsigned int chunk_bits)
+    {
+        assert(chunk_bits > 0 && chunk_bits <= 15);
+        do
+        {
+            addBits(value & ((1u << chunk_bits) - 1), chunk_bits);
+            value >>= chunk_bits;
+            addBool(value != 0);
+        } while (value != 0);
+    }   // addVarUInt
+    // ------------------------------------------------------------------------
+    /** Adds a signed value of variable size. The value is zig-zag encoded
+     *  (0, -1, 1, -2, ... are mapped to 0, 1, 2, 3, ...), so that small
+     *  negative values need few bits as well, see addVarUInt().
+     */
+    void addVarInt(int32_t value, unsigned int chunk_bits)
+    {
+        const uint32_t u = value < 0 ? ((uint32_t(-(value + 1))) << 1) | 1
+                                     :   uint32_t(value) << 1;
+        addVarUInt(u, chunk_bits);
+    }   // addVarInt
+    // ------------------------------------------------------------------------
+    /** Appends the remaining bits (padded with zeros to a full byte). */
+    void flush()
+    {
+        if (m_num_bits == 0) return;
+        m_buffer->addUInt8(uint8_t(m_bits << (8 - m_num_bits)));
+        m_bits     = 0;
+        m_num_bits = 0;
+    }   // flush
+    // ------------------------------------------------------------------------
+    /** Returns the number of bits needed to store all values from 0 to
+     *  max_value. */
+    static unsigned int getNumBits(uint32_t max_value)
+    {
+        unsigned int n = 1;
+        while (n < 32 && (max_value >> n) != 0)
+            n++;
+        return n;
+    }   // getNumBits
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+};   // BitWriter
+
+// ============================================================================
+/** \ingroup network
+ *  Reads values written by a BitWriter from a BareNetworkString. Bytes are
+ *  only taken from the string when they are needed, so after all values
+ *  written by a BitWriter have been read, the string is positioned at the
+ *  data following them. Note that this means that all values must be read,
+ *  even if they are not needed.
+ */
+class BitReader : public NoCopy
+{
+private:
+    /** The string the bytes are read from. */
+    const BareNetworkString *m_buffer;
+
+    /** Bits read from the buffer but not yet returned, in the lowest
+     *  m_num_bits bits. */
+    uint32_t m_bits;
+
+    /** Number of bits in m_bits. */
+    unsigned int m_num_bits;
+
+public:
+    // ------------------------------------------------------------------------
+    BitReader(const BareNetworkString *buffer)
+    {
+        m_buffer   = buffer;
+        m_bits     = 0;
+        m_num_bits = 0;
+    }   // BitReader
+    // ------------------------------------------------------------------------
+    /** Returns the next n bits as an unsigned value.
+     *  \param n Number of bits, at most 16.
+     */
+    uint32_t getBits(unsigned int n)
+    {
+        assert(n <= 16);
+        while (m_num_bits < n)
+        {
+            m_bits      = (m_bits << 8) | m_buffer->getUInt8();
+            m_num_bits += 8;
+        }
+        m_num_bits -= n;
+        const uint32_t value = (m_bits >> m_num_bits) & ((1u << n) - 1);
+        m_bits &= (1u << m_num_bits) - 1;
+        return value;
+    }   // getBits
+    // ------------------------------------------------------------------------
+    /** Returns the next bit as a boolean value. */
+    bool getBool() { return getBits(1) != 0; }
+    // ------------------------------------------------------------------------
+    /** Returns a value added with BitWriter::addVarUInt. */
+    uint32_t getVarUInt(unsigned int chunk_bits)
+    {
+        uint32_t value = 0;
+        unsigned int shift = 0;
+        do
+        {
+            value |= getBits(chunk_bits) << shift;
+            shift += chunk_bits;
+        } while (getBool() && shift < 32);
+        return value;
+    }   // getVarUInt
+    // ------------------------------------------------------------------------
+    /** Returns a value added with BitWriter::addVarInt. */
+    int32_t getVarInt(unsigned int chunk_bits)
+    {
+        const uint32_t u = getVarUInt(chunk_bits);
+        return (u & 1) ? -int32_t(u >> 1) - 1 : int32_t(u >> 1);
+    }   // getVarInt
+};   // BitReader
+
+#endif
@@ -0,0 +1,144 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/kart_update_scheduler.hpp"
+
+#include "config/stk_config.hpp"
+#include "karts/abstract_kart.hpp"
+#include "modes/world.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+KartUpdateScheduler::KartUpdateScheduler()
+{
+    reset(0);
+}   // KartUpdateScheduler
+
+// ----------------------------------------------------------------------------
+/** Resets the scheduler, so that all karts are sent as soon as possible.
+ *  \param num_karts Number of karts in the world.
+ */
+void KartUpdateScheduler::reset(unsigned int num_karts)
+{
+    m_time_since_update.clear();
+    m_time_since_update.resize(num_karts, 0.0f);
+    m_own_karts.clear();
+    m_available_bytes = 0.0f;
+    m_total_bytes     = 0;
+    m_total_time      = 0.0f;
+}   // reset
+
+// ----------------------------------------------------------------------------
+/** Sets the world kart ids of the karts of the client. These karts are not
+ *  sent, and the relevance of all other karts is determined relative to
+ *  them. A client without karts gets all karts with the default interval.
+ */
+void KartUpdateScheduler::setOwnKarts(const std::vector<int> &karts)
+{
+    m_own_karts = karts;
+}   // setOwnKarts
+
+// ----------------------------------------------------------------------------
+/** Returns the update interval of a kart for this client: the near interval
+ *  if the kart is close to one of the client's karts or next to it in the
+ *  race, the far interval if it is far away from all of them (or has
+ *  finished the race), otherwise the default interval.
+ *  \param kart_id World kart id of the kart.
+ */
+float KartUpdateScheduler::getUpdateInterval(unsigned int kart_id) const
+{
+    const AbstractKart *kart = World::getWorld()->getKart(kart_id);
+    if (kart->isEliminated() || kart->hasFinishedRace())
+        return stk_config->m_kart_update_far_interval;
+    if (m_own_karts.empty())
+        return stk_config->m_kart_update_interval;
+
+    const float near2 = stk_config->m_kart_update_near_distance
+                      * stk_config->m_kart_update_near_distance;
+    float min_distance2 = -1.0f;
+    for (unsigned int i = 0; i < m_own_karts.size(); i++)
+    {
+        const AbstractKart *own = World::getWorld()->getKart(m_own_karts[i]);
+        const float d2 = (own->getXYZ() - kart->getXYZ()).length2();
+        if (d2 < near2 || abs(own->getPosition() - kart->getPosition()) <= 1)
+            return stk_config->m_kart_update_near_interval;
+        if (min_distance2 < 0 || d2 < min_distance2)
+            min_distance2 = d2;
+    }
+    const float far = stk_config->m_kart_update_far_distance;
+    if (min_distance2 > far*far)
+        return stk_config->m_kart_update_far_interval;
+    return stk_config->m_kart_update_interval;
+}   // getUpdateInterval
+
+// ----------------------------------------------------------------------------
+/** Determines the karts to send to the client in this frame. Karts are due
+ *  once their update interval has passed, and are added in order of
+ *  urgency as long as the bandwidth budget allows. Karts that do not fit
+ *  stay due and become more urgent in the next frames.
+ *  \param dt Time since the last call.
+ *  \param karts On return contains the world kart ids of the karts to
+ *         send (empty if no message should be sent).
+ */
+void KartUpdateScheduler::selectKarts(float dt, std::vector<int> *karts)
+{
+    karts->clear();
+    World *world = World::getWorld();
+    const unsigned int num_karts = world->getNumKarts();
+    if (m_time_since_update.size() != num_karts)
+        m_time_since_update.resize(num_karts, 0.0f);
+
+    // Allow a burst of up to the far interval worth of data, but at least
+    // one message with one kart.
+    const float bandwidth = stk_config->m_kart_update_bandwidth;
+    const float max_bytes = std::max(bandwidth
+                                     * stk_config->m_kart_update_far_interval,
+                                     (float)(HEADER_SIZE + KART_SIZE));
+    m_available_bytes = std::min(m_available_bytes + bandwidth*dt, max_bytes);
+    m_total_time += dt;
+
+    std::vector<std::pair<float, int> > due;
+    for (unsigned int i = 0; i < num_karts; i++)
+    {
+        if (std::find(m_own_karts.begin(), m_own_karts.end(), (int)i)
+            != m_own_karts.end())
+            continue;
+        m_time_since_update[i] += dt;
+        const float urgency = m_time_since_update[i] / getUpdateInterval(i);
+        if (urgency >= 1.0f)
+            due.push_back(std::make_pair(urgency, (int)i));
+    }
+    if (due.empty() || m_available_bytes < HEADER_SIZE + KART_SIZE)
+        return;
+
+    std::sort(due.begin(), due.end(),
+              std::greater<std::pair<float, int> >());
+    int size = HEADER_SIZE;
+    for (unsigned int i = 0; i < due.size(); i++)
+    {
+        if (size + KART_SIZE > m_available_bytes)
+            break;
+        size += KART_SIZE;
+        karts->push_back(due[i].second);
+        m_time_since_update[due[i].second] = 0.0f;
+    }
+    m_available_bytes -= size;
+    m_total_bytes     += size;
+}   // selectKarts
@@ -0,0 +1,79 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_KART_UPDATE_SCHEDULER_HPP
+#define HEADER_KART_UPDATE_SCHEDULER_HPP
+
+#include "utils/types.hpp"
+
+#include <vector>
+
+/** \ingroup network
+ *  Decides which kart positions the server sends to one client. Instead of
+ *  sending all karts with a fixed frequency, each kart gets an update
+ *  interval depending on its relevance for the client: karts close to one
+ *  of the client's karts, or directly ahead or behind it in the race, are
+ *  updated more often than karts far away. Karts that are due for an
+ *  update are sent in order of urgency (time since the last update divided
+ *  by the interval) as long as the bandwidth budget of the client allows.
+ *  The distances, intervals and the budget are defined in stk_config.xml.
+ *  The scheduler only depends on the world, so it can also be used to
+ *  estimate the bandwidth without network (see ProfileWorld).
+ */
+class KartUpdateScheduler
+{
+public:
+    /** Size of the message header: protocol type, token and tick. */
+    static const int HEADER_SIZE = 9;
+
+    /** Size of the update of one kart: id, position and rotation. */
+    static const int KART_SIZE   = 29;
+
+private:
+    /** World kart ids of the karts of the client, which are not sent. */
+    std::vector<int> m_own_karts;
+
+    /** Time since the last update was sent for each kart. */
+    std::vector<float> m_time_since_update;
+
+    /** Number of bytes that can currently be sent (token bucket). */
+    float m_available_bytes;
+
+    /** Statistics: total bytes sent and time this scheduler was used. */
+    uint64_t m_total_bytes;
+    float    m_total_time;
+
+    float getUpdateInterval(unsigned int kart_id) const;
+
+public:
+          KartUpdateScheduler();
+    void  reset(unsigned int num_karts);
+    void  setOwnKarts(const std::vector<int> &karts);
+    void  selectKarts(float dt, std::vector<int> *karts);
+    // ------------------------------------------------------------------------
+    /** Returns the total number of bytes sent by this scheduler. */
+    uint64_t getTotalBytes() const { return m_total_bytes; }
+    // ------------------------------------------------------------------------
+    /** Returns the average number of bytes sent per second. */
+    float getBytesPerSecond() const
+    {
+        return m_total_time > 0 ? m_total_bytes / m_total_time : 0.0f;
+    }   // getBytesPerSecond
+};   // KartUpdateScheduler
+
+#endif
@@ -0,0 +1,287 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#include "network/lag_compensation.hpp"
+
+#include <assert.h>
+
+LagCompensation::LagCompensation()
+{
+    reset(0);
+}   // LagCompensation
+
+// ----------------------------------------------------------------------------
+/** Removes all data.
+ *  \param history_ticks Number of ticks for which kart positions are kept,
+ *         which is the maximum delay that is compensated. 0 disables the
+ *         lag compensation.
+ */
+void LagCompensation::reset(int history_ticks)
+{
+    m_history_ticks = history_ticks;
+    m_num_karts     = 0;
+    m_oldest_ticks  = 0;
+    m_newest_ticks  = -1;
+    m_history.clear();
+    m_delay_ticks.clear();
+    m_client_xyz.clear();
+    m_client_ticks.clear();
+    m_client_server_ticks.clear();
+}   // reset
+
+// ----------------------------------------------------------------------------
+/** Allocates the data for a number of karts and removes the history.
+ *  \param num_karts Number of karts.
+ */
+void LagCompensation::resize(unsigned int num_karts)
+{
+    m_num_karts    = num_karts;
+    m_newest_ticks = -1;
+    m_history.clear();
+    m_history.resize(num_karts * m_history_ticks);
+    m_delay_ticks.resize(num_karts, -1.0f);
+    m_client_xyz.resize(num_karts);
+    m_client_ticks.resize(num_karts, -1);
+    m_client_server_ticks.resize(num_karts, -1);
+}   // resize
+
+// ----------------------------------------------------------------------------
+/** Stores the positions of all karts at a tick. This is called on the
+ *  server once per tick. If ticks are missing (or the clock was reset), the
+ *  old history is discarded.
+ *  \param ticks The world tick.
+ *  \param xyz The position of each kart.
+ */
+void LagCompensation::recordKartPositions(int64_t ticks,
+                                          const std::vector<Vec3> &xyz)
+{
+    if (m_history_ticks <= 0) return;
+    if (xyz.size() != m_num_karts)
+        resize((unsigned int)xyz.size());
+
+    if (m_newest_ticks < 0 || ticks != m_newest_ticks + 1)
+        m_oldest_ticks = ticks;
+    else if (ticks - m_oldest_ticks >= m_history_ticks)
+        m_oldest_ticks = ticks - m_history_ticks + 1;
+    m_newest_ticks = ticks;
+
+    const int slot = (int)(ticks % m_history_ticks);
+    for (unsigned int i = 0; i < m_num_karts; i++)
+        m_history[i * m_history_ticks + slot] = xyz[i];
+}   // recordKartPositions
+
+// ----------------------------------------------------------------------------
+/** Returns the position a kart had at a tick. Ticks outside of the history
+ *  are clamped to the oldest or newest recorded tick.
+ *  \param kart_id World id of the kart.
+ *  \param ticks The tick.
+ *  \param xyz On return the position of the kart.
+ *  \return False if there is no position for this kart.
+ */
+bool LagCompensation::getKartXYZ(unsigned int kart_id, int64_t ticks,
+                                 Vec3 *xyz) const
+{
+    if (kart_id >= m_num_karts || m_newest_ticks < 0) return false;
+    if (ticks < m_oldest_ticks)
+        ticks = m_oldest_ticks;
+    else if (ticks > m_newest_ticks)
+        ticks = m_newest_ticks;
+    *xyz = m_history[kart_id * m_history_ticks
+                     + (int)(ticks % m_history_ticks)];
+    return true;
+}   // getKartXYZ
+
+// ----------------------------------------------------------------------------
+/** Called on the server when a client reported the position of one of its
+ *  karts. Updates the delay of the client, and returns the previously
+ *  reported position, so that the path in between can be tested for item
+ *  hits.
+ *  \param kart_id World id of the kart.
+ *  \param server_ticks Current server tick.
+ *  \param client_ticks Client tick of the reported position.
+ *  \param xyz Reported position.
+ *  \param max_tick_distance Maximum distance the kart can drive in one
+ *         tick. The returned path is shortened (at the previous position)
+ *         to the distance the kart can drive in the server ticks since the
+ *         previous report, so a client can not collect items on a path it
+ *         can not have driven.
+ *  \param previous On return the previously reported position, or the
+ *         start of the shortened path.
+ *  \return True if the path from the previous position should be tested,
+ *          false if there is no previous position, if the delay or the
+ *          time between the two positions are more than the maximum
+ *          compensation, or if the client tick is ahead of the server.
+ */
+bool LagCompensation::getClientPath(unsigned int kart_id, int64_t server_ticks,
+                                    int64_t client_ticks, const Vec3 &xyz,
+                                    float max_tick_distance, Vec3 *previous)
+{
+    if (m_history_ticks <= 0) return false;
+    if (kart_id >= m_num_karts)
+        resize(kart_id + 1);
+    // The client clock runs behind the server clock, so a tick ahead of the
+    // server can only come from a modified client.
+    if (client_ticks <= m_client_ticks[kart_id] ||
+        client_ticks > server_ticks                ) return false;
+
+    float delay = (float)(server_ticks - client_ticks);
+    if (delay < 0)
+        delay = 0;
+    if (m_delay_ticks[kart_id] < 0)
+        m_delay_ticks[kart_id] = delay;
+    else
+        m_delay_ticks[kart_id] = 0.9f * m_delay_ticks[kart_id] + 0.1f * delay;
+
+    const bool valid = m_client_ticks[kart_id] >= 0                      &&
+                       server_ticks - client_ticks <= m_history_ticks    &&
+                       client_ticks - m_client_ticks[kart_id] <= m_history_ticks;
+    *previous = m_client_xyz[kart_id];
+    const float max_distance = max_tick_distance
+                     * (float)(server_ticks - m_client_server_ticks[kart_id]);
+    const Vec3 path = *previous - xyz;
+    if (valid && path.length() > max_distance)
+        *previous = xyz + path * (max_distance / path.length());
+
+    m_client_xyz[kart_id]          = xyz;
+    m_client_ticks[kart_id]        = client_ticks;
+    m_client_server_ticks[kart_id] = server_ticks;
+    return valid;
+}   // getClientPath
+
+// ----------------------------------------------------------------------------
+/** Returns the server tick whose state the client controlling a kart sees
+ *  at the current server tick. For karts not controlled by a client this is
+ *  the current tick. The delay is limited to the length of the history.
+ *  \param kart_id World id of the kart.
+ *  \param server_ticks Current server tick.
+ */
+int64_t LagCompensation::getViewTicks(unsigned int kart_id,
+                                      int64_t server_ticks) const
+{
+    if (!isClientKart(kart_id) || m_history_ticks <= 0) return server_ticks;
+    int64_t delay = (int64_t)(m_delay_ticks[kart_id] + 0.5f);
+    if (delay > m_history_ticks - 1)
+        delay = m_history_ticks - 1;
+    return server_ticks - delay;
+}   // getViewTicks
+
+// ----------------------------------------------------------------------------
+/** Returns the point on the line segment from 'from' to 'to' that is
+ *  closest to xyz.
+ */
+Vec3 LagCompensation::getClosestPoint(const Vec3 &from, const Vec3 &to,
+                                      const Vec3 &xyz)
+{
+    const Vec3 d = to - from;
+    const float length2 = d.length2();
+    if (length2 <= 0) return from;
+    float t = (xyz - from).dot(d) / length2;
+    if (t < 0)
+        t = 0;
+    else if (t > 1)
+        t = 1;
+    return from + d * t;
+}   // getClosestPoint
+
+// ============================================================================
+/** Unit testing: a client kart drives with 30 m/s along the x axis through
+ *  an item, with a one way latency of 150 ms. The kart on the server only
+ *  follows the client with delayed controls, and is 2.5 m to the side of
+ *  the client's path. The client reports its position every 6 ticks, so
+ *  neither the server positions nor the reported positions hit the item,
+ *  only the path between two reported positions does.
+ */
+void LagCompensation::unitTesting()
+{
+    const int   latency     = 9;        // 150 ms at 60 ticks per second
+    const float speed       = 0.5f;     // 30 m/s at 60 ticks per second
+    const Vec3  item(10.5f, 0, 0);
+    const float item_radius = 1.0f;
+
+    LagCompensation lc;
+    lc.reset(30);
+    bool server_hit = false, report_hit = false, path_hit = false;
+    std::vector<Vec3> server_xyz(1);
+    for (int64_t t = 0; t < 60; t++)
+    {
+        server_xyz[0] = Vec3((t - 2 * latency) * speed, 0, 2.5f);
+        lc.recordKartPositions(t, server_xyz);
+        if ((server_xyz[0] - item).length() < item_radius)
+            server_hit = true;
+
+        // The client clock is 'latency' behind the server clock, and its
+        // message needs another 'latency' ticks to arrive.
+        const int64_t client_ticks = t - 2 * latency;
+        if (client_ticks < 0 || client_ticks % 6 != 0) continue;
+        const Vec3 client_xyz(client_ticks * speed, 0, 0);
+        if ((client_xyz - item).length() < item_radius)
+            report_hit = true;
+        Vec3 previous;
+        if (lc.getClientPath(0, t, client_ticks, client_xyz, speed,
+                             &previous))
+        {
+            const Vec3 closest = getClosestPoint(previous, client_xyz, item);
+            if ((closest - item).length() < item_radius)
+                path_hit = true;
+        }
+    }
+    assert(!server_hit);
+    assert(!report_hit);
+    assert(path_hit);
+    (void)server_hit; (void)report_hit; (void)path_hit;   // for NDEBUG
+
+    // The client sees the state of the server 18 ticks ago.
+    assert(lc.isClientKart(0));
+    assert(lc.getViewTicks(0, 59) == 59 - 2 * latency);
+    Vec3 xyz;
+    assert(lc.getKartXYZ(0, 59 - 2 * latency, &xyz));
+    assert(xyz == Vec3((59 - 4 * latency) * speed, 0, 2.5f));
+    // Ticks before the history are clamped to the oldest tick (30).
+    assert(lc.getKartXYZ(0, 0, &xyz));
+    assert(xyz == Vec3((30 - 2 * latency) * speed, 0, 2.5f));
+    assert(!lc.getKartXYZ(1, 59, &xyz));
+
+    // A delay of more than the maximum compensation is not compensated.
+    LagCompensation short_lc;
+    short_lc.reset(10);
+    Vec3 previous;
+    assert(!short_lc.getClientPath(0, 18, 0, Vec3(0, 0, 0), speed,
+                                   &previous));
+    assert(!short_lc.getClientPath(0, 24, 6, Vec3(3, 0, 0), speed,
+                                   &previous));
+    assert(short_lc.getViewTicks(0, 24) == 24 - 9);
+
+    // A path longer than the kart can drive in the server ticks between
+    // the reports is shortened, and ticks ahead of the server are ignored.
+    LagCompensation cheat_lc;
+    cheat_lc.reset(30);
+    assert(!cheat_lc.getClientPath(0, 10, 5, Vec3(0, 0, 0), speed,
+                                   &previous));
+    assert(cheat_lc.getClientPath(0, 16, 11, Vec3(100, 0, 0), speed,
+                                  &previous));
+    assert((previous - Vec3(100 - 6 * speed, 0, 0)).length() < 0.001f);
+    assert(!cheat_lc.getClientPath(0, 17, 30, Vec3(200, 0, 0), speed,
+                                   &previous));
+
+    // Without history nothing is compensated.
+    LagCompensation disabled;
+    assert(!disabled.getClientPath(0, 18, 0, Vec3(0, 0, 0), speed,
+                                   &previous));
+    assert(disabled.getViewTicks(0, 24) == 24);
+}   // unitTesting
@@ -0,0 +1,106 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+
+#ifndef HEADER_LAG_COMPENSATION_HPP
+#define HEADER_LAG_COMPENSATION_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+#include "utils/vec3.hpp"
+
+#include <vector>
+
+/** \ingroup network
+ *  Keeps a short history of kart positions on the server, so that hits can
+ *  be tested against the positions a client saw instead of the current
+ *  server positions. A client starts its world clock when the start message
+ *  from the server arrives, so its clock runs behind the server clock by
+ *  about the latency, and at a client tick t the client shows the server
+ *  state of about tick t. When a kart update of a client arrives, the
+ *  difference between the server tick and the tick in the message is the
+ *  delay between the view of that client and the current server state.
+ *  Two hit tests use this:
+ *  - Items are tested against the path between two positions reported by
+ *    the client (see getClientPath), so items a client drove through are
+ *    collected even if the kart on the server went past them.
+ *  - Flyables of a client are tested against the positions the other karts
+ *    had at the time the client saw them (see getViewTicks and getKartXYZ).
+ *  The compensation is limited to a maximum delay, older client data is
+ *  not compensated. Since the reported positions and ticks come from the
+ *  client, a reported path is limited to the distance the kart can drive
+ *  in the server ticks between the two reports, and reports with a tick
+ *  ahead of the server are ignored.
+ */
+class LagCompensation : public NoCopy
+{
+private:
+    /** Number of ticks for which the kart positions are kept. */
+    int m_history_ticks;
+
+    /** Number of karts in the history. */
+    unsigned int m_num_karts;
+
+    /** Positions of all karts in the last m_history_ticks ticks. The entry
+     *  of kart k at tick t is at index k*m_history_ticks + t%m_history_ticks.
+     */
+    std::vector<Vec3> m_history;
+
+    /** First and last tick in the history, m_newest_ticks is -1 if nothing
+     *  was recorded yet. */
+    int64_t m_oldest_ticks;
+    int64_t m_newest_ticks;
+
+    /** Smoothed delay in ticks between the view of the client controlling
+     *  a kart and the server, or -1 if no update was received for a kart. */
+    std::vector<float> m_delay_ticks;
+
+    /** The last position a client reported for each kart, its tick (-1 if
+     *  none), and the server tick at which the report arrived. */
+    std::vector<Vec3>    m_client_xyz;
+    std::vector<int64_t> m_client_ticks;
+    std::vector<int64_t> m_client_server_ticks;
+
+    void resize(unsigned int num_karts);
+
+public:
+             LagCompensation();
+    void     reset(int history_ticks);
+    void     recordKartPositions(int64_t ticks, const std::vector<Vec3> &xyz);
+    bool     getKartXYZ(unsigned int kart_id, int64_t ticks, Vec3 *xyz) const;
+    bool     getClientPath(unsigned int kart_id, int64_t server_ticks,
+                           int64_t client_ticks, const Vec3 &xyz,
+                           float max_tick_distance, Vec3 *previous);
+    int64_t  getViewTicks(unsigned int kart_id, int64_t server_ticks) const;
+    static Vec3 getClosestPoint(const Vec3 &from, const Vec3 &to,
+                                const Vec3 &xyz);
+    static void unitTesting();
+
+    // ------------------------------------------------------------------------
+    /** Returns true if a kart was updated by a client, i.e. its positions
+     *  should be compensated. */
+    bool isClientKart(unsigned int kart_id) const
+    {
+        return kart_id < m_delay_ticks.size() && m_delay_ticks[kart_id] >= 0;
+    }   // isClientKart
+    // ------------------------------------------------------------------------
+    /** Returns the number of ticks for which positions are kept. */
+    int getHistoryTicks() const { return m_history_ticks; }
+};   // LagCompensation
+
+#endif
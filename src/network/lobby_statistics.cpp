@@ -0,0 +1,125 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/lobby_statistics.hpp"
+
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+// ----------------------------------------------------------------------------
+LobbyStatistics::LobbyStatistics()
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    reset();
+}   // LobbyStatistics
+
+// ----------------------------------------------------------------------------
+LobbyStatistics::~LobbyStatistics()
+{
+    pthread_mutex_destroy(&m_mutex);
+}   // ~LobbyStatistics
+
+// ----------------------------------------------------------------------------
+/** Sets all counters to zero. */
+void LobbyStatistics::reset()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_packets_sent     = 0;
+    m_bytes_sent       = 0;
+    m_packets_received = 0;
+    m_bytes_received   = 0;
+    m_world_updates    = 0;
+    m_world_time       = 0.0;
+    m_protocol_time    = 0.0;
+    m_start_time       = StkTime::getRealTime();
+    pthread_mutex_unlock(&m_mutex);
+}   // reset
+
+// ----------------------------------------------------------------------------
+/** Counts a packet that was sent.
+ *  \param bytes Size of the packet.
+ */
+void LobbyStatistics::addPacketSent(unsigned int bytes)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_packets_sent++;
+    m_bytes_sent += bytes;
+    pthread_mutex_unlock(&m_mutex);
+}   // addPacketSent
+
+// ----------------------------------------------------------------------------
+/** Counts a packet that was received.
+ *  \param bytes Size of the packet.
+ */
+void LobbyStatistics::addPacketReceived(unsigned int bytes)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_packets_received++;
+    m_bytes_received += bytes;
+    pthread_mutex_unlock(&m_mutex);
+}   // addPacketReceived
+
+// ----------------------------------------------------------------------------
+/** Adds the time used for one world update.
+ *  \param time Time in seconds.
+ */
+void LobbyStatistics::addWorldUpdate(double time)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_world_updates++;
+    m_world_time += time;
+    pthread_mutex_unlock(&m_mutex);
+}   // addWorldUpdate
+
+// ----------------------------------------------------------------------------
+/** Adds the time used for one update of all protocols.
+ *  \param time Time in seconds.
+ */
+void LobbyStatistics::addProtocolUpdate(double time)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_protocol_time += time;
+    pthread_mutex_unlock(&m_mutex);
+}   // addProtocolUpdate
+
+// ----------------------------------------------------------------------------
+/** Prints all counters, and the resulting bandwidth and load.
+ *  \param title Printed in front of the statistics (e.g. the lobby name).
+ */
+void LobbyStatistics::print(const std::string &title) const
+{
+    pthread_mutex_lock(&m_mutex);
+    double duration = StkTime::getRealTime() - m_start_time;
+    if (duration <= 0) duration = 1.0;
+    Log::info("LobbyStatistics", "%s: %.1f s, sent %lu packets (%lu bytes, "
+              "%.1f kB/s), received %lu packets (%lu bytes, %.1f kB/s).",
+              title.c_str(), duration,
+              (unsigned long)m_packets_sent, (unsigned long)m_bytes_sent,
+              m_bytes_sent/duration/1024.0,
+              (unsigned long)m_packets_received,
+              (unsigned long)m_bytes_received,
+              m_bytes_received/duration/1024.0);
+    Log::info("LobbyStatistics", "%s: %lu world updates in %.1f ms (%.2f ms "
+              "each), protocols %.1f ms, load %.1f%%.",
+              title.c_str(), (unsigned long)m_world_updates,
+              m_world_time*1000.0,
+              m_world_updates ? m_world_time*1000.0/m_world_updates : 0.0,
+              m_protocol_time*1000.0,
+              (m_world_time+m_protocol_time)*100.0/duration);
+    pthread_mutex_unlock(&m_mutex);
+}   // print
@@ -0,0 +1,70 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_LOBBY_STATISTICS_HPP
+#define HEADER_LOBBY_STATISTICS_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <pthread.h>
+#include <string>
+
+/** \ingroup network
+ *  Counts the network traffic and the time used by the race and the
+ *  protocols of the lobby hosted by this STKHost, so that the cost of a
+ *  lobby can be measured on a server. Packets are counted when they are
+ *  sent by STKPeer and received by the listening thread of STKHost, the
+ *  time when updating the world in a network race (RaceEventManager) and
+ *  when updating the protocols (ProtocolManager). Since these happen in
+ *  different threads, all counters are protected by a mutex.
+ */
+class LobbyStatistics : public NoCopy
+{
+private:
+    /** Number of packets and bytes sent and received. */
+    uint64_t m_packets_sent;
+    uint64_t m_bytes_sent;
+    uint64_t m_packets_received;
+    uint64_t m_bytes_received;
+
+    /** Number of world updates, and the time used for them. */
+    uint64_t m_world_updates;
+    double   m_world_time;
+
+    /** Time used for updating the protocols. */
+    double   m_protocol_time;
+
+    /** Real time at which the counters were reset. */
+    double   m_start_time;
+
+    /** Protects all counters. */
+    mutable pthread_mutex_t m_mutex;
+
+public:
+         LobbyStatistics();
+        ~LobbyStatistics();
+    void reset();
+    void addPacketSent(unsigned int bytes);
+    void addPacketReceived(unsigned int bytes);
+    void addWorldUpdate(double time);
+    void addProtocolUpdate(double time);
+    void print(const std::string &title) const;
+};   // LobbyStatistics
+
+#endif
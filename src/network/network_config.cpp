@@ -40,6 +40,7 @@ NetworkConfig::NetworkConfig()
     m_is_registered         = false;
     m_server_name           = "";
     m_password              = "";
+    m_network_impairment    = "";
     m_server_discovery_port = 2757;
     m_server_port           = 2758;
     m_client_port           = 2759;
@@ -69,6 +69,11 @@ private:
     /** If this is a server, the server name. */
     irr::core::stringw m_server_name;
 
+    /** Specification of the simulated network impairment (see
+     *  NetworkImpairment::setProfile), empty if the network is not to be
+     *  impaired. */
+    std::string m_network_impairment;
+
     NetworkConfig();
 
 public:
@@ -176,6 +181,19 @@ public:
         return m_is_registered;
     }   // isRegistered
 
+    // --------------------------------------------------------------------
+    /** Sets the specification of the simulated network impairment. */
+    void setNetworkImpairment(const std::string &spec)
+    {
+        m_network_impairment = spec;
+    }   // setNetworkImpairment
+    // --------------------------------------------------------------------
+    /** Returns the specification of the simulated network impairment, or
+     *  an empty string if the network is not to be impaired. */
+    const std::string& getNetworkImpairment() const
+    {
+        return m_network_impairment;
+    }   // getNetworkImpairment
     // --------------------------------------------------------------------
     /** Returns the IP address of this host. We need to return a copy
      *  to make sure the address is thread safe (otherwise it could happen
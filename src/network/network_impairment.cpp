@@ -0,0 +1,378 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/network_impairment.hpp"
+
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+    /** The predefined profiles. Times are in ms, probabilities in percent.
+     */
+    struct ImpairmentProfile
+    {
+        const char *m_name;
+        const char *m_spec;
+    };
+    const ImpairmentProfile g_profiles[] =
+    {
+        { "none",   "latency=0,jitter=0,loss=0,burst=0,duplicate=0,reorder=0" },
+        { "lan",    "latency=1,jitter=1,jitter-dist=uniform"                   },
+        { "dsl",    "latency=25,jitter=5,jitter-dist=uniform,loss=0.5"          },
+        { "wifi",   "latency=15,jitter=10,jitter-dist=normal,loss=1,"
+                    "burst=0.5,burst-length=3"                                 },
+        { "mobile", "latency=60,jitter=30,jitter-dist=normal,loss=2,"
+                    "burst=1,burst-length=5,duplicate=0.5,reorder=1"           },
+        { "bad",    "latency=150,jitter=60,jitter-dist=normal,loss=5,"
+                    "burst=2,burst-length=8,duplicate=1,reorder=3"             },
+    };
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Creates an impairment which does not change any packet. Use setProfile()
+ *  to configure it.
+ */
+NetworkImpairment::NetworkImpairment()
+{
+    m_latency             = 0.0f;
+    m_jitter              = 0.0f;
+    m_jitter_distribution = JD_UNIFORM;
+    m_loss                = 0.0f;
+    m_burst_probability   = 0.0f;
+    m_burst_length        = 1.0f;
+    m_duplicate           = 0.0f;
+    m_reorder             = 0.0f;
+    m_seed                = 1;
+    m_random_state        = m_seed;
+    m_in_burst            = false;
+    m_last_reliable_time  = 0.0;
+    m_num_packets         = 0;
+    m_num_dropped         = 0;
+    m_num_duplicated      = 0;
+    m_num_reordered       = 0;
+    m_num_sent            = 0;
+    m_num_bytes_sent      = 0;
+    m_total_delay         = 0.0;
+    pthread_mutex_init(&m_mutex, NULL);
+}   // NetworkImpairment
+
+// ----------------------------------------------------------------------------
+/** Frees all packets which have not been sent yet.
+ */
+NetworkImpairment::~NetworkImpairment()
+{
+    printStatistics();
+    for (unsigned int i = 0; i < m_delayed_packets.size(); i++)
+        enet_packet_destroy(m_delayed_packets[i].m_packet);
+    m_delayed_packets.clear();
+    pthread_mutex_destroy(&m_mutex);
+}   // ~NetworkImpairment
+
+// ----------------------------------------------------------------------------
+/** Sets the impairment from a specification, which is a comma separated
+ *  list of a profile name (none, lan, dsl, wifi, mobile, bad) and/or
+ *  key=value pairs, which overwrite values of the profile, e.g.
+ *  "wifi,loss=3,seed=7". The keys are: latency and jitter (in ms),
+ *  jitter-dist (uniform or normal), loss, burst (the probability that a
+ *  loss burst starts), duplicate and reorder (all in percent), burst-length
+ *  (average number of packets lost in a burst) and seed.
+ *  \param spec The specification.
+ *  \return False if the specification contains an error.
+ */
+bool NetworkImpairment::setProfile(const std::string &spec)
+{
+    std::vector<std::string> parts = StringUtils::split(spec, ',');
+    for (unsigned int i = 0; i < parts.size(); i++)
+    {
+        if (parts[i].empty()) continue;
+        std::string::size_type equal = parts[i].find('=');
+        if (equal != std::string::npos)
+        {
+            if (!setParameter(parts[i].substr(0, equal),
+                              parts[i].substr(equal + 1)))
+                return false;
+            continue;
+        }
+
+        // Otherwise it must be a profile name
+        bool found = false;
+        for (unsigned int j = 0; j < sizeof(g_profiles)/sizeof(g_profiles[0]);
+             j++)
+        {
+            if (parts[i] != g_profiles[j].m_name) continue;
+            setProfile(g_profiles[j].m_spec);
+            found = true;
+            break;
+        }
+        if (!found)
+        {
+            Log::error("NetworkImpairment", "Unknown profile '%s'.",
+                       parts[i].c_str());
+            return false;
+        }
+    }   // for i < parts.size()
+    m_random_state = m_seed;
+    return true;
+}   // setProfile
+
+// ----------------------------------------------------------------------------
+/** Sets one parameter of the impairment, see setProfile().
+ *  \param key Name of the parameter.
+ *  \param value Value of the parameter.
+ *  \return False if the key or value is invalid.
+ */
+bool NetworkImpairment::setParameter(const std::string &key,
+                                     const std::string &value)
+{
+    if (key == "jitter-dist")
+    {
+        if (value == "uniform")
+            m_jitter_distribution = JD_UNIFORM;
+        else if (value == "normal")
+            m_jitter_distribution = JD_NORMAL;
+        else
+        {
+            Log::error("NetworkImpairment", "Unknown jitter distribution "
+                       "'%s'.", value.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    float f;
+    if (!StringUtils::fromString(value, f) || f < 0)
+    {
+        Log::error("NetworkImpairment", "Invalid value '%s' for '%s'.",
+                   value.c_str(), key.c_str());
+        return false;
+    }
+    if      (key == "latency"     ) m_latency           = f * 0.001f;
+    else if (key == "jitter"      ) m_jitter            = f * 0.001f;
+    else if (key == "loss"        ) m_loss              = f * 0.01f;
+    else if (key == "burst"       ) m_burst_probability = f * 0.01f;
+    else if (key == "burst-length") m_burst_length      = std::max(f, 1.0f);
+    else if (key == "duplicate"   ) m_duplicate         = f * 0.01f;
+    else if (key == "reorder"     ) m_reorder           = f * 0.01f;
+    else if (key == "seed"        ) m_seed              = (uint32_t)f;
+    else
+    {
+        Log::error("NetworkImpairment", "Unknown parameter '%s'.",
+                   key.c_str());
+        return false;
+    }
+    return true;
+}   // setParameter
+
+// ----------------------------------------------------------------------------
+/** Returns a description of the current settings. */
+std::string NetworkImpairment::toString() const
+{
+    char s[256];
+    snprintf(s, sizeof(s), "latency %.1f ms, jitter %.1f ms (%s), loss %.1f%%,"
+             " burst %.1f%% (length %.1f), duplicate %.1f%%, reorder %.1f%%,"
+             " seed %u",
+             m_latency*1000.0f, m_jitter*1000.0f,
+             m_jitter_distribution == JD_NORMAL ? "normal" : "uniform",
+             m_loss*100.0f, m_burst_probability*100.0f, m_burst_length,
+             m_duplicate*100.0f, m_reorder*100.0f, m_seed);
+    return s;
+}   // toString
+
+// ----------------------------------------------------------------------------
+/** Returns a random number in [0, 1). It uses a simple linear congruential
+ *  generator with its own state, so the impairment does not depend on (or
+ *  change) the random numbers used by the game.
+ */
+float NetworkImpairment::random()
+{
+    m_random_state = 1103515245u * m_random_state + 12345u;
+    return (m_random_state >> 8) / 16777216.0f;
+}   // random
+
+// ----------------------------------------------------------------------------
+/** Returns a normally distributed random number with mean 0 and standard
+ *  deviation 1 (Box-Muller transform).
+ */
+float NetworkImpairment::randomNormal()
+{
+    const float u1 = std::max(random(), 1.0e-7f);
+    const float u2 = random();
+    return sqrtf(-2.0f*logf(u1)) * cosf(2.0f*3.14159265f*u2);
+}   // randomNormal
+
+// ----------------------------------------------------------------------------
+/** Adds a packet to the list of delayed packets, sorted by send time.
+ *  The mutex must be locked.
+ */
+void NetworkImpairment::addPacket(ENetPeer *peer, ENetPacket *packet,
+                                  uint8_t channel, double queue_time,
+                                  double send_time)
+{
+    DelayedPacket dp;
+    dp.m_queue_time = queue_time;
+    dp.m_send_time  = send_time;
+    dp.m_peer       = peer;
+    dp.m_packet     = packet;
+    dp.m_channel    = channel;
+    std::vector<DelayedPacket>::iterator i = m_delayed_packets.end();
+    while (i != m_delayed_packets.begin() && (i-1)->m_send_time > send_time)
+        i--;
+    m_delayed_packets.insert(i, dp);
+}   // addPacket
+
+// ----------------------------------------------------------------------------
+/** Takes a packet that would be sent with enet_peer_send, and decides
+ *  if it is dropped, duplicated and when it will be sent.
+ *  \param peer The peer to send the packet to.
+ *  \param channel The enet channel to use.
+ *  \param packet The packet. It is owned by this object afterwards.
+ *  \param reliable If the packet is reliable.
+ */
+void NetworkImpairment::sendPacket(ENetPeer *peer, uint8_t channel,
+                                   ENetPacket *packet, bool reliable)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_num_packets++;
+    const double now = StkTime::getRealTime();
+
+    if (reliable)
+    {
+        // Keep the order of reliable packets, only delay them
+        double t = std::max(now + m_latency, m_last_reliable_time);
+        m_last_reliable_time = t;
+        addPacket(peer, packet, channel, now, t);
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    // Loss bursts: a burst starts with probability m_burst_probability,
+    // and ends with probability 1/m_burst_length after each packet.
+    if (m_in_burst)
+        m_in_burst = random() >= 1.0f / m_burst_length;
+    else
+        m_in_burst = random() < m_burst_probability;
+
+    if (m_in_burst || random() < m_loss)
+    {
+        m_num_dropped++;
+        enet_packet_destroy(packet);
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    const int copies = random() < m_duplicate ? 2 : 1;
+    for (int i = 0; i < copies; i++)
+    {
+        float delay = m_latency;
+        if (m_jitter > 0)
+        {
+            if (m_jitter_distribution == JD_NORMAL)
+                delay += m_jitter * randomNormal();
+            else
+                delay += m_jitter * (2.0f*random() - 1.0f);
+        }
+        if (random() < m_reorder)
+        {
+            // Delay it long enough that packets sent later overtake it
+            delay += 2.0f*m_jitter + 0.01f;
+            m_num_reordered++;
+        }
+        if (delay < 0) delay = 0;
+
+        ENetPacket *p = packet;
+        if (i > 0)
+        {
+            p = enet_packet_create(packet->data, packet->dataLength,
+                                   packet->flags);
+            m_num_duplicated++;
+        }
+        addPacket(peer, p, channel, now, now + delay);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // sendPacket
+
+// ----------------------------------------------------------------------------
+/** Sends all packets whose delay is over. This is called from the listening
+ *  thread of STKHost before calling enet_host_service.
+ */
+void NetworkImpairment::update()
+{
+    pthread_mutex_lock(&m_mutex);
+    const double now = StkTime::getRealTime();
+    unsigned int n = 0;
+    while (n < m_delayed_packets.size() &&
+           m_delayed_packets[n].m_send_time <= now)
+    {
+        DelayedPacket &dp = m_delayed_packets[n];
+        m_num_sent++;
+        m_num_bytes_sent += dp.m_packet->dataLength;
+        m_total_delay    += now - dp.m_queue_time;
+        if (enet_peer_send(dp.m_peer, dp.m_channel, dp.m_packet) < 0)
+            enet_packet_destroy(dp.m_packet);
+        n++;
+    }
+    m_delayed_packets.erase(m_delayed_packets.begin(),
+                            m_delayed_packets.begin() + n);
+    pthread_mutex_unlock(&m_mutex);
+}   // update
+
+// ----------------------------------------------------------------------------
+/** Discards all packets for a peer that is being removed.
+ *  \param peer The peer.
+ */
+void NetworkImpairment::removePeer(const ENetPeer *peer)
+{
+    pthread_mutex_lock(&m_mutex);
+    std::vector<DelayedPacket>::iterator i = m_delayed_packets.begin();
+    while (i != m_delayed_packets.end())
+    {
+        if (i->m_peer == peer)
+        {
+            enet_packet_destroy(i->m_packet);
+            i = m_delayed_packets.erase(i);
+        }
+        else
+            i++;
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // removePeer
+
+// ----------------------------------------------------------------------------
+/** Prints the number of packets and bytes handled.
+ */
+void NetworkImpairment::printStatistics()
+{
+    pthread_mutex_lock(&m_mutex);
+    Log::info("NetworkImpairment", "%s", toString().c_str());
+    Log::info("NetworkImpairment",
+              "%d packets: %d sent (%lu bytes), %d dropped, %d duplicated, "
+              "%d reordered, %d waiting.",
+              m_num_packets, m_num_sent, (unsigned long)m_num_bytes_sent,
+              m_num_dropped, m_num_duplicated, m_num_reordered,
+              (int)m_delayed_packets.size());
+    if (m_num_sent > 0)
+        Log::info("NetworkImpairment", "Average delay %f ms.",
+                  m_total_delay*1000.0/m_num_sent);
+    pthread_mutex_unlock(&m_mutex);
+}   // printStatistics
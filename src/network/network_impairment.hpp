@@ -0,0 +1,139 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_NETWORK_IMPAIRMENT_HPP
+#define HEADER_NETWORK_IMPAIRMENT_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include "enet/enet.h"
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+/** \ingroup network
+ *  Simulates a bad network connection for testing. If enabled (see the
+ *  --network-impairment command line option), all packets sent by STKPeer
+ *  are passed to this object instead of to enet, which delays, reorders,
+ *  duplicates and drops them according to a profile, and hands the
+ *  remaining packets to enet once their delay is over (see update(), which
+ *  is called from the listening thread of STKHost). Since only outgoing
+ *  packets are affected, both the server and the clients should use it to
+ *  impair both directions, e.g. when running all of them on localhost.
+ *  Reliable packets are only delayed (by the fixed latency, in order), since
+ *  enet would not resend a packet that was dropped before it was sent.
+ *  All random decisions use their own random number generator, so a given
+ *  seed and sequence of packets results in the same impairment.
+ */
+class NetworkImpairment : public NoCopy
+{
+public:
+    /** Distribution of the random part of the delay. */
+    enum JitterDistribution { JD_UNIFORM, JD_NORMAL };
+
+private:
+    /** A packet waiting to be sent. */
+    struct DelayedPacket
+    {
+        /** Real time at which the packet was given to this object. */
+        double       m_queue_time;
+        /** Real time at which the packet is to be sent. */
+        double       m_send_time;
+        ENetPeer    *m_peer;
+        ENetPacket  *m_packet;
+        uint8_t      m_channel;
+    };   // DelayedPacket
+
+    /** Fixed latency in seconds. */
+    float m_latency;
+
+    /** Jitter (half width of the uniform, or standard deviation of the
+     *  normal distribution) in seconds. */
+    float m_jitter;
+
+    /** The distribution of the jitter. */
+    JitterDistribution m_jitter_distribution;
+
+    /** Probability that a packet is dropped outside of a loss burst. */
+    float m_loss;
+
+    /** Probability that a loss burst starts with a packet. All packets are
+     *  dropped during a burst. */
+    float m_burst_probability;
+
+    /** Average number of packets dropped in a burst. */
+    float m_burst_length;
+
+    /** Probability that a packet is sent twice. */
+    float m_duplicate;
+
+    /** Probability that a packet is held back for an additional delay, so
+     *  that it arrives after packets sent later. */
+    float m_reorder;
+
+    /** The seed of the random number generator. */
+    uint32_t m_seed;
+
+    /** State of the random number generator. */
+    uint32_t m_random_state;
+
+    /** True while a loss burst is happening. */
+    bool m_in_burst;
+
+    /** Send time of the last reliable packet, used to keep the order of
+     *  reliable packets. */
+    double m_last_reliable_time;
+
+    /** All packets waiting to be sent, sorted by send time. */
+    std::vector<DelayedPacket> m_delayed_packets;
+
+    /** Protects m_delayed_packets and the statistics: packets are added
+     *  from the main and protocol manager threads, and sent from the
+     *  listening thread. */
+    pthread_mutex_t m_mutex;
+
+    /** Statistics. */
+    int    m_num_packets;
+    int    m_num_dropped;
+    int    m_num_duplicated;
+    int    m_num_reordered;
+    int    m_num_sent;
+    size_t m_num_bytes_sent;
+    double m_total_delay;
+
+    float random();
+    float randomNormal();
+    bool  setParameter(const std::string &key, const std::string &value);
+    void  addPacket(ENetPeer *peer, ENetPacket *packet, uint8_t channel,
+                    double queue_time, double send_time);
+
+public:
+          NetworkImpairment();
+         ~NetworkImpairment();
+    bool  setProfile(const std::string &spec);
+    void  sendPacket(ENetPeer *peer, uint8_t channel, ENetPacket *packet,
+                     bool reliable);
+    void  update();
+    void  removePeer(const ENetPeer *peer);
+    void  printStatistics();
+    std::string toString() const;
+};   // NetworkImpairment
+
+#endif
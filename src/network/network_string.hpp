@@ -140,6 +140,10 @@ public:
     // ------------------------------------------------------------------------
     /** Allows to read a buffer from the beginning again. */
     void reset() { m_current_offset = 0; }
+
+    // ------------------------------------------------------------------------
+    /** Removes all data, but keeps the allocated memory. */
+    void clear() { m_buffer.clear(); m_current_offset = 0; }
     // ------------------------------------------------------------------------
     BareNetworkString& encodeString(const std::string &value);
     BareNetworkString& encodeString(const irr::core::stringw &value);
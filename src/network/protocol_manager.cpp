@@ -19,6 +19,7 @@
 #include "network/protocol_manager.hpp"
 
 #include "network/event.hpp"
+#include "network/lobby_statistics.hpp"
 #include "network/protocol.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
@@ -323,6 +324,7 @@ bool ProtocolManager::sendEvent(Event* event)
  */
 void ProtocolManager::update(float dt)
 {
+    const double start = StkTime::getRealTime();
     // before updating, notify protocols that they have received events
     m_events_to_process.lock();
     int size = (int)m_events_to_process.getData().size();
@@ -349,6 +351,11 @@ void ProtocolManager::update(float dt)
             m_protocols.getData()[i]->update(dt);
     }
     m_protocols.unlock();
+    if (STKHost::existHost())
+    {
+        STKHost::get()->getLobbyStatistics()
+                      ->addProtocolUpdate(StkTime::getRealTime() - start);
+    }
 }   // update
 
 // ----------------------------------------------------------------------------
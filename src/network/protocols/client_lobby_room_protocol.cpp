@@ -34,6 +34,7 @@
 #include "states_screens/race_result_gui.hpp"
 #include "states_screens/state_manager.hpp"
 #include "utils/log.hpp"
+#include "utils/random_generator.hpp"
 
 ClientLobbyRoomProtocol::
 ClientLobbyRoomProtocol(const TransportAddress& server_address)
@@ -585,6 +586,8 @@ void ClientLobbyRoomProtocol::kartSelectionUpdate(Event* event)
 void ClientLobbyRoomProtocol::startGame(Event* event)
 {
     const NetworkString &data = event->data();
+    // Use the same random numbers as the server.
+    RandomGenerator::setRaceSeed(data.getUInt32());
     m_state = PLAYING;
     ProtocolManager::getInstance()
         ->requestStart(new StartGameProtocol(m_setup));
@@ -24,12 +24,15 @@
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
 #include "network/game_setup.hpp"
-#include "network/network_config.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
+#include "race/race_manager.hpp"
 #include "utils/log.hpp"
 
+#include <algorithm>
+#include <string.h>
+
 //-----------------------------------------------------------------------------
 
 ControllerEventsProtocol::ControllerEventsProtocol()
@@ -44,61 +47,229 @@ ControllerEventsProtocol::~ControllerEventsProtocol()
 }   // ~ControllerEventsProtocol
 
 //-----------------------------------------------------------------------------
+/** Allocates the per kart data. The world exists at this stage.
+ */
+void ControllerEventsProtocol::setup()
+{
+    const unsigned int num_karts = World::getWorld()->getNumKarts();
+    m_tick = World::getWorld()->getTimeTicks();
+    m_recent_controls.clear();
+    m_recent_controls.resize(num_karts,
+                 std::vector<uint8_t>(INPUT_REDUNDANCY*CONTROL_SIZE, 0));
+    // Make sure the initial controls are sent
+    m_ticks_since_change.clear();
+    m_ticks_since_change.resize(num_karts, 0);
+    m_pressed_buttons.clear();
+    m_pressed_buttons.resize(num_karts, 0);
+    m_last_applied_tick.clear();
+    m_last_applied_tick.resize(num_karts, -1);
+}   // setup
+
+//-----------------------------------------------------------------------------
+/** Compresses the state of a KartControl into CONTROL_SIZE bytes.
+ *  \param controls The controls to compress.
+ *  \param out Where to store the compressed state.
+ */
+void ControllerEventsProtocol::compressControls(const KartControl *controls,
+                                                uint8_t *out) const
+{
+    out[0] = (uint8_t)controls->getButtonsCompressed();
+    out[1] = (uint8_t)(controls->getAccel()*255.0f);
+    out[2] = (uint8_t)(int8_t)(controls->getSteer()*127.0f);
+}   // compressControls
+
+//-----------------------------------------------------------------------------
+/** Sets a KartControl from a compressed state.
+ *  \param data The compressed state.
+ *  \param controls The controls to set.
+ */
+void ControllerEventsProtocol::applyControls(const uint8_t *data,
+                                             KartControl *controls) const
+{
+    const char buttons = (char)data[0];
+    controls->setBrake(   (buttons &  1)!=0);
+    controls->setNitro(   (buttons &  2)!=0);
+    controls->setRescue(  (buttons &  4)!=0);
+    controls->setFire(    (buttons &  8)!=0);
+    controls->setLookBack((buttons & 16)!=0);
+    controls->setSkidControl(KartControl::SkidControl((buttons & 96) >> 5));
+    controls->setAccel(data[1]/255.0f);
+    controls->setSteer(((int8_t)data[2])/127.0f);
+}   // applyControls
 
+//-----------------------------------------------------------------------------
+/** Receives the controls of karts of another client (if this is a client),
+ *  or of the karts of a client (if this is the server, which forwards the
+ *  message to all other clients). The message format is:
+ *
+ *    Size  |   4  |        1         |    1    | 3 * num_ticks | ...
+ *    Data | tick | num_ticks (N)    | kart id | controls      | ...
+ *
+ *  For each kart the controls of tick, tick-1, ..., tick-N+1 are stored,
+ *  newest first. Only the newest controls are applied, together with the
+ *  short button presses (rescue, fire) of all ticks that were not applied
+ *  before, so that they are not lost when several ticks are received at
+ *  once. Kart entries whose ticks were all applied before are ignored, and
+ *  the server only forwards the kart entries with new ticks.
+ */
 bool ControllerEventsProtocol::notifyEventAsynchronous(Event* event)
 {
-    if(!checkDataSize(event, 13)) return true;
+    if(!checkDataSize(event, 5)) return true;
 
     NetworkString &data = event->data();
-    float time = data.getFloat();
+    const uint32_t tick      = data.getUInt32();
+    const uint8_t  num_ticks = data.getUInt8();
+    if (num_ticks == 0 || num_ticks > tick + 1)
+    {
+        Log::warn("ControllerEventProtocol", "Invalid number of ticks %d.",
+                  num_ticks);
+        return true;
+    }
+    const unsigned int kart_size = 1 + num_ticks*CONTROL_SIZE;
 
-    uint8_t client_index = -1;
-    while (data.size() >= 9)
+    // The kart entries with new ticks that the server forwards
+    NetworkString *forward = NULL;
+    while (data.size() >= kart_size)
     {
         uint8_t kart_id = data.getUInt8();
-        if (kart_id >=World::getWorld()->getNumKarts())
+        uint8_t controls[256*CONTROL_SIZE];
+        for (unsigned int i = 0; i < num_ticks*CONTROL_SIZE; i++)
+            controls[i] = data.getUInt8();
+
+        if (kart_id >= World::getWorld()->getNumKarts() ||
+            kart_id >= m_last_applied_tick.size()          )
         {
-            Log::warn("ControllerEventProtocol", "No valid kart id (%s).",
+            Log::warn("ControllerEventProtocol", "No valid kart id (%d).",
                       kart_id);
             continue;
         }
-        uint8_t serialized_1   = data.getUInt8();
-        uint8_t serialized_2   = data.getUInt8();
-        uint8_t serialized_3   = data.getUInt8();
-        PlayerAction action    = (PlayerAction)(data.getUInt8());
-        int action_value       = data.getUInt32();
-        Log::info("ControllerEventsProtocol", "KartID %d action %d value %d",
-                  kart_id, action, action_value);
+        // Ignore the message if all ticks in it have been applied already
+        if ((int64_t)tick <= m_last_applied_tick[kart_id])
+            continue;
+
+        if (NetworkConfig::get()->isServer())
+        {
+            if (!forward)
+            {
+                forward = getNetworkString(5 + data.size() + kart_size);
+                forward->addUInt32(tick).addUInt8(num_ticks);
+            }
+            forward->addUInt8(kart_id);
+            for (unsigned int i = 0; i < num_ticks*CONTROL_SIZE; i++)
+                forward->addUInt8(controls[i]);
+        }
+
         Controller *controller = World::getWorld()->getKart(kart_id)
                                                   ->getController();
-        KartControl *controls  = controller->getControls();
-        controls->setBrake(   (serialized_1 & 0x40)!=0);
-        controls->setNitro(   (serialized_1 & 0x20)!=0);
-        controls->setRescue(  (serialized_1 & 0x10)!=0);
-        controls->setFire(    (serialized_1 & 0x08)!=0);
-        controls->setLookBack((serialized_1 & 0x04)!=0);
-        controls->setSkidControl(KartControl::SkidControl(serialized_1 & 0x03));
-
-        controller->action(action, action_value);
+        if (controller->isLocalPlayerController())
+            continue;
+
+        // Index of the oldest tick in this message that was not applied
+        int oldest = num_ticks - 1;
+        if (m_last_applied_tick[kart_id] >= (int64_t)tick - oldest)
+            oldest = int(tick - m_last_applied_tick[kart_id] - 1);
+        m_last_applied_tick[kart_id] = tick;
+
+        // Only the newest controls are applied, plus any short button
+        // presses from the ticks before.
+        uint8_t newest[CONTROL_SIZE];
+        memcpy(newest, controls, CONTROL_SIZE);
+        for (int i = 1; i <= oldest; i++)
+            newest[0] |= controls[i*CONTROL_SIZE] & (4 | 8);  // rescue, fire
+        applyControls(newest, controller->getControls());
     }
     if (data.size() > 0 )
     {
         Log::warn("ControllerEventProtocol",
                   "The data seems corrupted. Remains %d", data.size());
     }
-    if (NetworkConfig::get()->isServer())
+    if (forward)
     {
         // Send update to all clients except the original sender.
-        STKHost::get()->sendPacketExcept(event->getPeer(), 
-                                         &data, false);
-    }   // if server
+        STKHost::get()->sendPacketExcept(event->getPeer(), forward, false);
+        delete forward;
+    }   // if forward
     return true;
 }   // notifyEventAsynchronous
 
+//-----------------------------------------------------------------------------
+/** Called once per frame on a client. It records the current controls of
+ *  all local karts for each world tick simulated since the last call, and
+ *  sends the controls of the last INPUT_REDUNDANCY ticks to the server if
+ *  any of them changed in that time.
+ *  \param dt Time step size.
+ */
+void ControllerEventsProtocol::update(float dt)
+{
+    World *world = World::getWorld();
+    if (!world || NetworkConfig::get()->isServer() ||
+        !world->isNetworkWorld())
+        return;
+
+    // Nothing to record if the world was not simulated since the last
+    // update (e.g. while a rewind is being resimulated).
+    const int64_t ticks = world->getTimeTicks();
+    if (ticks <= m_tick)
+        return;
+    const unsigned int new_ticks =
+        (unsigned int)std::min<int64_t>(ticks - m_tick, INPUT_REDUNDANCY);
+    m_tick = ticks;
+
+    const unsigned int num_local = race_manager->getNumLocalPlayers();
+    bool needs_sending = false;
+    for (unsigned int i = 0; i < num_local; i++)
+    {
+        AbstractKart *kart = world->getLocalPlayerKart(i);
+        const unsigned int id = kart->getWorldKartId();
+        std::vector<uint8_t> &recent = m_recent_controls[id];
+
+        uint8_t current[CONTROL_SIZE];
+        compressControls(kart->getController()->getControls(), current);
+        current[0] |= m_pressed_buttons[id];
+        m_pressed_buttons[id] = 0;
+
+        if (memcmp(current, recent.data(), CONTROL_SIZE) != 0)
+            m_ticks_since_change[id] = new_ticks - 1;
+        else
+            m_ticks_since_change[id] += new_ticks;
+        if (m_ticks_since_change[id] > INPUT_REDUNDANCY)
+            m_ticks_since_change[id] = INPUT_REDUNDANCY;
+
+        // Shift the older controls and store the current ones for all
+        // new ticks first.
+        memmove(recent.data() + new_ticks*CONTROL_SIZE, recent.data(),
+                (INPUT_REDUNDANCY-new_ticks)*CONTROL_SIZE);
+        for (unsigned int j = 0; j < new_ticks; j++)
+            memcpy(recent.data() + j*CONTROL_SIZE, current, CONTROL_SIZE);
+
+        if (m_ticks_since_change[id] < INPUT_REDUNDANCY)
+            needs_sending = true;
+    }   // for i < num_local
+
+    if (!needs_sending)
+        return;
+
+    const uint8_t num_ticks = (uint8_t)std::min<int64_t>(INPUT_REDUNDANCY,
+                                                         m_tick);
+    NetworkString *ns =
+        getNetworkString(5 + num_local*(1 + INPUT_REDUNDANCY*CONTROL_SIZE));
+    ns->addUInt32((uint32_t)m_tick).addUInt8(num_ticks);
+    for (unsigned int i = 0; i < num_local; i++)
+    {
+        const unsigned int id = world->getLocalPlayerKart(i)->getWorldKartId();
+        ns->addUInt8(id);
+        for (unsigned int j = 0; j < num_ticks*CONTROL_SIZE; j++)
+            ns->addUInt8(m_recent_controls[id][j]);
+    }
+    sendToServer(ns, false); // send message to server
+    delete ns;
+}   // update
+
 //-----------------------------------------------------------------------------
 /** Called from the local kart controller when an action (like steering,
- *  acceleration, ...) was triggered. It compresses the current kart control
- *  state and sends a message with the new info to the server.
+ *  acceleration, ...) was triggered. The controls themselves are sent in
+ *  the next update, this only records buttons that were pressed, so that
+ *  they are sent even if they are released again in the same frame.
  *  \param controller The controller that triggered the action.
  *  \param action Which action was triggered.
  *  \param value New value for the given action.
@@ -108,29 +279,10 @@ void ControllerEventsProtocol::controllerAction(Controller* controller,
 {
     assert(!NetworkConfig::get()->isServer());
 
-    KartControl* controls = controller->getControls();
-    uint8_t serialized_1 = 0;
-    serialized_1 |= (controls->getBrake()==true);
-    serialized_1 <<= 1;
-    serialized_1 |= (controls->getNitro()==true);
-    serialized_1 <<= 1;
-    serialized_1 |= (controls->getRescue()==true);
-    serialized_1 <<= 1;
-    serialized_1 |= (controls->getFire()==true);
-    serialized_1 <<= 1;
-    serialized_1 |= (controls->getLookBack()==true);
-    serialized_1 <<= 2;
-    serialized_1 += controls->getSkidControl();
-    uint8_t serialized_2 = (uint8_t)(controls->getAccel()*255.0);
-    uint8_t serialized_3 = (uint8_t)(controls->getSteer()*127.0);
-
-    NetworkString *ns = getNetworkString(13);
-    ns->addFloat(World::getWorld()->getTime());
-    ns->addUInt8(controller->getKart()->getWorldKartId());
-    ns->addUInt8(serialized_1).addUInt8(serialized_2).addUInt8(serialized_3);
-    ns->addUInt8((uint8_t)(action)).addUInt32(value);
-    sendToServer(ns, false); // send message to server
-    delete ns;
-
-    Log::info("ControllerEventsProtocol", "Action %d value %d", action, value);
+    const unsigned int id = controller->getKart()->getWorldKartId();
+    if (id >= m_pressed_buttons.size())
+        return;
+    // Rescue and fire
+    m_pressed_buttons[id] |=
+        controller->getControls()->getButtonsCompressed() & (4 | 8);
 }   // controllerAction
@@ -23,20 +23,64 @@
 
 #include "input/input.hpp"
 #include "utils/cpp2011.hpp"
+#include "utils/types.hpp"
+
+#include <vector>
 
 class Controller;
+class KartControl;
 class STKPeer;
 
+/** \ingroup network
+ *  Sends the controls of the local karts to the server, which applies them
+ *  to the corresponding karts and forwards them to all other clients.
+ *  Each tick (i.e. each protocol update) the compressed KartControl state
+ *  of each local kart is recorded. A packet contains the states of the last
+ *  INPUT_REDUNDANCY ticks, so a lost packet is covered by one of the
+ *  following packets instead of needing a retransmission. Packets are only
+ *  sent as long as one of the states they contain differs from the state
+ *  before. The receiver keeps the last tick it has applied for each kart
+ *  and ignores states it has already seen.
+ */
 class ControllerEventsProtocol : public Protocol
 {
+private:
+    /** Number of ticks of controls each packet contains. */
+    static const unsigned int INPUT_REDUNDANCY = 8;
+
+    /** Size of one compressed KartControl state in bytes. */
+    static const unsigned int CONTROL_SIZE = 3;
+
+    /** The last world tick for which the local controls were recorded. */
+    int64_t m_tick;
+
+    /** For each local kart (indexed by world kart id) the compressed
+     *  states of the last INPUT_REDUNDANCY ticks, newest first. */
+    std::vector<std::vector<uint8_t> > m_recent_controls;
+
+    /** For each local kart the number of ticks since its controls were
+     *  last changed. */
+    std::vector<unsigned int> m_ticks_since_change;
+
+    /** Buttons that were pressed by an action since the last tick. This
+     *  makes sure that short button presses (like rescue, which is reset
+     *  by the controller in the same frame) are sent. */
+    std::vector<uint8_t> m_pressed_buttons;
+
+    /** For each kart the sender tick of the last state that was applied.
+     *  Only used in notifyEventAsynchronous. */
+    std::vector<int64_t> m_last_applied_tick;
+
+    void compressControls(const KartControl *controls, uint8_t *out) const;
+    void applyControls(const uint8_t *data, KartControl *controls) const;
 
 public:
              ControllerEventsProtocol();
     virtual ~ControllerEventsProtocol();
 
     virtual bool notifyEventAsynchronous(Event* event) OVERRIDE;
-    virtual void update(float dt) OVERRIDE {};
-    virtual void setup() OVERRIDE {};
+    virtual void update(float dt) OVERRIDE;
+    virtual void setup() OVERRIDE;
     virtual void asynchronousUpdate() OVERRIDE {}
 
     void controllerAction(Controller* controller, PlayerAction action,
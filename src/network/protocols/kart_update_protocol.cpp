@@ -1,11 +1,18 @@
 #include "network/protocols/kart_update_protocol.hpp"
 
+#include "config/stk_config.hpp"
+#include "items/item_manager.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/controller/controller.hpp"
+#include "karts/kart_properties.hpp"
 #include "modes/world.hpp"
 #include "network/event.hpp"
 #include "network/network_config.hpp"
+#include "network/network_player_profile.hpp"
 #include "network/protocol_manager.hpp"
+#include "network/rewind_manager.hpp"
+#include "network/stk_host.hpp"
+#include "network/stk_peer.hpp"
 #include "utils/time.hpp"
 
 KartUpdateProtocol::KartUpdateProtocol() : Protocol(PROTOCOL_KART_UPDATE)
@@ -25,11 +32,15 @@ void KartUpdateProtocol::setup()
     m_next_positions.resize(World::getWorld()->getNumKarts());
     m_next_quaternions.resize(World::getWorld()->getNumKarts());
 
-    // This flag keeps track if valid data for an update is in
+    // These flags keep track if valid data for an update is in
     // the arrays
-    m_was_updated = false;
+    m_was_updated.clear();
+    m_was_updated.resize(World::getWorld()->getNumKarts(), false);
+    m_last_update_ticks.clear();
+    m_last_update_ticks.resize(World::getWorld()->getNumKarts(), -1);
 
     m_previous_time = 0;
+    m_schedulers.clear();
 }   // setup
 
 // ----------------------------------------------------------------------------
@@ -48,24 +59,82 @@ bool KartUpdateProtocol::notifyEvent(Event* event)
         Log::info("KartUpdateProtocol", "Message too short.");
         return true;
     }
-    float time = ns.getFloat();
+    const int64_t ticks = ns.getUInt32();
     while(ns.size() >= 29)
     {
         uint8_t kart_id             = ns.getUInt8();
         Vec3 xyz                    = ns.getVec3();
         btQuaternion quat           = ns.getQuat();
+        if (kart_id >= m_next_positions.size() ||
+            ticks < m_last_update_ticks[kart_id])
+            continue;
+        m_last_update_ticks[kart_id] = ticks;
         m_next_positions  [kart_id] = xyz;
         m_next_quaternions[kart_id] = quat;
+        // Set the flag that a new update was received
+        m_was_updated     [kart_id] = true;
     }   // while ns.size()>29
 
-    // Set the flag that a new update was received
-    m_was_updated = true;
     return true;
 }   // notifyEvent
 
 // ----------------------------------------------------------------------------
-/** Sends regular update events from the server to all clients and from the
- *  clients to the server (FIXME - is that actually necessary??)
+/** Sends the kart updates from the server to each client. The karts to
+ *  send are chosen by the KartUpdateScheduler of each client, so that
+ *  karts relevant for a client are updated more often than others, and
+ *  the bandwidth used per client is limited. The client's own karts are
+ *  not sent.
+ *  \param dt Time step size.
+ */
+void KartUpdateProtocol::sendUpdatesToClients(float dt)
+{
+    World *world = World::getWorld();
+    const std::vector<STKPeer*> &peers = STKHost::get()->getPeers();
+    std::vector<int> karts;
+    for (unsigned int i = 0; i < peers.size(); i++)
+    {
+        STKPeer *peer = peers[i];
+        std::map<int, KartUpdateScheduler>::iterator it =
+                                        m_schedulers.find(peer->getHostId());
+        if (it == m_schedulers.end())
+        {
+            KartUpdateScheduler &scheduler = m_schedulers[peer->getHostId()];
+            scheduler.reset(world->getNumKarts());
+            std::vector<NetworkPlayerProfile*> players =
+                                                 peer->getAllPlayerProfiles();
+            std::vector<int> own_karts;
+            for (unsigned int j = 0; j < players.size(); j++)
+            {
+                if (players[j]->getWorldKartID() >= 0)
+                    own_karts.push_back(players[j]->getWorldKartID());
+            }
+            scheduler.setOwnKarts(own_karts);
+            it = m_schedulers.find(peer->getHostId());
+        }
+
+        it->second.selectKarts(dt, &karts);
+        if (karts.empty())
+            continue;
+
+        NetworkString *ns = getNetworkString(4 + (int)karts.size()
+                                               * KartUpdateScheduler::KART_SIZE);
+        ns->setSynchronous(true);
+        ns->addUInt32((uint32_t)world->getTimeTicks());
+        for (unsigned int j = 0; j < karts.size(); j++)
+        {
+            AbstractKart* kart = world->getKart(karts[j]);
+            ns->addUInt8(kart->getWorldKartId());
+            ns->add(kart->getXYZ()).add(kart->getRotation());
+        }
+        peer->sendPacket(ns, /*reliable*/false);
+        delete ns;
+    }   // for i < peers.size()
+}   // sendUpdatesToClients
+
+// ----------------------------------------------------------------------------
+/** Sends regular update events from the server to all clients (see
+ *  sendUpdatesToClients) and from the clients to the server (FIXME - is
+ *  that actually necessary??).
  *  Then it applies all update events that have been received in notifyEvent.
  *  This two-part implementation means that if the server should send two
  *  or more updates before this client handles them, only the last one will
@@ -76,35 +145,20 @@ void KartUpdateProtocol::update(float dt)
     if (!World::getWorld())
         return;
 
-    double current_time = StkTime::getRealTime();
-    if (current_time > m_previous_time + 0.1) // 10 updates per second
+    if (NetworkConfig::get()->isServer())
     {
-        m_previous_time = current_time;
-        if (NetworkConfig::get()->isServer())
-        {
-            World *world = World::getWorld();
-            NetworkString *ns = getNetworkString(4+world->getNumKarts()*29);
-            ns->setSynchronous(true);
-            ns->addFloat( world->getTime() );
-            for (unsigned int i = 0; i < world->getNumKarts(); i++)
-            {
-                AbstractKart* kart = world->getKart(i);
-                Vec3 xyz = kart->getXYZ();
-                ns->addUInt8( kart->getWorldKartId());
-                ns->add(xyz).add(kart->getRotation());
-                Log::verbose("KartUpdateProtocol",
-                             "Sending %d's positions %f %f %f",
-                             kart->getWorldKartId(), xyz[0], xyz[1], xyz[2]);
-            }
-            sendMessageToPeersChangingToken(ns, /*reliable*/false);
-            delete ns;
-        }
-        else
+        sendUpdatesToClients(dt);
+    }
+    else
+    {
+        double current_time = StkTime::getRealTime();
+        if (current_time > m_previous_time + 0.1) // 10 updates per second
         {
+            m_previous_time = current_time;
             NetworkString *ns =
                      getNetworkString(4+29*race_manager->getNumLocalPlayers());
             ns->setSynchronous(true);
-            ns->addFloat(World::getWorld()->getTime());
+            ns->addUInt32((uint32_t)World::getWorld()->getTimeTicks());
             for(unsigned int i=0; i<race_manager->getNumLocalPlayers(); i++)
             {
                 AbstractKart *kart = World::getWorld()->getLocalPlayerKart(i);
@@ -117,31 +171,49 @@ void KartUpdateProtocol::update(float dt)
             }
             sendToServer(ns, /*reliable*/false);
             delete ns;
-        }   // if server
-    }   // if (current_time > time + 0.1)
+        }   // if (current_time > time + 0.1)
+    }   // if server
 
 
     // Now handle all update events that have been received.
     // There is no lock necessary, since receiving new positions is done in
     // notifyEvent, which is called from the same thread that calls this
     // function.
-    if(m_was_updated)
+    for (unsigned id = 0; id < m_next_positions.size(); id++)
     {
-        for (unsigned id = 0; id < m_next_positions.size(); id++)
+        if (!m_was_updated[id])
+            continue;
+        AbstractKart *kart = World::getWorld()->getKart(id);
+        if (!kart->getController()->isLocalPlayerController())
         {
-            AbstractKart *kart = World::getWorld()->getKart(id);
-            if (!kart->getController()->isLocalPlayerController())
+            // The server collects the items on the path the client drove
+            // since its previous update (lag compensation). The path is
+            // limited by the highest speed the kart can reach (with all
+            // speed increases).
+            const KartProperties *kp = kart->getKartProperties();
+            const float max_speed = kp->getEngineMaxSpeed()
+                                  + kp->getZipperMaxSpeedIncrease()
+                                  + kp->getNitroMaxSpeedIncrease()
+                                  + kp->getSlipstreamMaxSpeedIncrease();
+            Vec3 previous;
+            if (NetworkConfig::get()->isServer() &&
+                RewindManager::get()->getLagCompensation()
+                    ->getClientPath(id, World::getWorld()->getTimeTicks(),
+                                    m_last_update_ticks[id],
+                                    m_next_positions[id],
+                                    max_speed * stk_config->ticks2Time(1),
+                                    &previous))
             {
-                btTransform transform = kart->getBody()
-                                      ->getInterpolationWorldTransform();
-                transform.setOrigin(m_next_positions[id]);
-                transform.setRotation(m_next_quaternions[id]);
-                kart->getBody()->setCenterOfMassTransform(transform);
-                Log::verbose("KartUpdateProtocol", "Update kart %i pos",
-                             id);
-            }   // if not local player
-        }   // for id < num_karts
-        m_was_updated = false;  // mark that all updates were applied
-    }   // if m_was_updated
+                ItemManager::get()->checkItemHitOnPath(kart, previous,
+                                                       m_next_positions[id]);
+            }
+            btTransform transform = kart->getBody()
+                                  ->getInterpolationWorldTransform();
+            transform.setOrigin(m_next_positions[id]);
+            transform.setRotation(m_next_quaternions[id]);
+            kart->getBody()->setCenterOfMassTransform(transform);
+            Log::verbose("KartUpdateProtocol", "Update kart %i pos", id);
+        }   // if not local player
+        m_was_updated[id] = false;  // mark that the update was applied
+    }   // for id < num_karts
 }   // update
-
@@ -1,12 +1,14 @@
 #ifndef KART_UPDATE_PROTOCOL_HPP
 #define KART_UPDATE_PROTOCOL_HPP
 
+#include "network/kart_update_scheduler.hpp"
 #include "network/protocol.hpp"
 #include "utils/cpp2011.hpp"
 #include "utils/vec3.hpp"
 
 #include "LinearMath/btQuaternion.h"
 
+#include <map>
 #include <vector>
 #include "pthread.h"
 
@@ -22,13 +24,23 @@ private:
     /** Stores the last updated rotation for a kart. */
     std::vector<btQuaternion> m_next_quaternions;
 
-    /** True if a new update for the kart positions was received. */
-    bool m_was_updated;
+    /** True for each kart for which a new update was received. */
+    std::vector<bool> m_was_updated;
 
-    /** Time the last kart update was sent. Used to send updates with
-     * a fixed frequency. */
+    /** World tick of the last update received for each kart, used to
+     *  ignore updates that arrive out of order. */
+    std::vector<int64_t> m_last_update_ticks;
+
+    /** Time the last kart update was sent by a client. Used to send
+     *  updates with a fixed frequency. */
     double m_previous_time;
 
+    /** Server only: decides which karts are sent to each client, indexed
+     *  by host id. */
+    std::map<int, KartUpdateScheduler> m_schedulers;
+
+    void sendUpdatesToClients(float dt);
+
 public:
              KartUpdateProtocol();
     virtual ~KartUpdateProtocol();
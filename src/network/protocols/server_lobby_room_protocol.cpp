@@ -22,6 +22,7 @@
 #include "config/user_config.hpp"
 #include "modes/world.hpp"
 #include "network/event.hpp"
+#include "network/lobby_statistics.hpp"
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
 #include "network/protocols/get_public_address.hpp"
@@ -242,13 +243,18 @@ void ServerLobbyRoomProtocol::registerServer()
 void ServerLobbyRoomProtocol::startGame()
 {
     const std::vector<STKPeer*> &peers = STKHost::get()->getPeers();
-    NetworkString *ns = getNetworkString(1);
-    ns->addUInt8(LE_START_RACE);
+    // The seed of all random numbers of the race, so that the clients
+    // simulate the race the same way as the server.
+    RandomGenerator::setRaceSeed(race_manager->getRandomSeed());
+    NetworkString *ns = getNetworkString(5);
+    ns->addUInt8(LE_START_RACE).addUInt32(RandomGenerator::getRaceSeed());
     sendMessageToPeersChangingToken(ns, /*reliable*/true);
     delete ns;
     Protocol *p = new StartGameProtocol(m_setup);
     p->requestStart();
     m_state = RACING;
+    // Measure the cost of each race separately
+    STKHost::get()->getLobbyStatistics()->reset();
 }   // startGame
 
 //-----------------------------------------------------------------------------
@@ -374,6 +380,7 @@ void ServerLobbyRoomProtocol::checkIncomingConnectionRequests()
     sendMessageToPeersChangingToken(total, /*reliable*/ true);
     delete total;
     Log::info("ServerLobbyRoomProtocol", "End of game message sent");
+    STKHost::get()->getLobbyStatistics()->print("Race");
         
 }   // checkRaceFinished
 
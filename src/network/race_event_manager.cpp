@@ -3,11 +3,14 @@
 
 #include "karts/controller/controller.hpp"
 #include "modes/world.hpp"
+#include "network/lobby_statistics.hpp"
 #include "network/network_config.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/protocols/synchronization_protocol.hpp"
 #include "network/protocols/controller_events_protocol.hpp"
 #include "network/protocols/game_events_protocol.hpp"
+#include "network/stk_host.hpp"
+#include "utils/time.hpp"
 
 
 RaceEventManager::RaceEventManager()
@@ -45,7 +48,13 @@ void RaceEventManager::update(float dt)
         }
         World::getWorld()->setNetworkWorld(true);
     }
+    const double start = StkTime::getRealTime();
     World::getWorld()->updateWorld(dt);
+    if (STKHost::existHost())
+    {
+        STKHost::get()->getLobbyStatistics()
+                      ->addWorldUpdate(StkTime::getRealTime() - start);
+    }
 
     // if the race is over
     if (World::getWorld()->getPhase() >= WorldStatus::RESULT_DISPLAY_PHASE)
@@ -25,31 +25,32 @@
  *  for all state info.
  *  \param size Necessary buffer size for a state.
  */
-RewindInfo::RewindInfo(float time, bool is_confirmed)
+RewindInfo::RewindInfo(int64_t ticks, bool is_confirmed)
 {
-    m_time         = time;
+    m_ticks        = ticks;
     m_is_confirmed = is_confirmed;
 }   // RewindInfo
 
 // ============================================================================
-RewindInfoTime::RewindInfoTime(float time)
-              : RewindInfo(time, /*is_confirmed*/true)
+RewindInfoTime::RewindInfoTime(int64_t ticks)
+              : RewindInfo(ticks, /*is_confirmed*/true)
 {
 }   // RewindInfoTime
 
 // ============================================================================
-RewindInfoState::RewindInfoState(float time, Rewinder *rewinder, 
+RewindInfoState::RewindInfoState(int64_t ticks, Rewinder *rewinder,
                                  BareNetworkString *buffer, bool is_confirmed)
-    : RewindInfoRewinder(time, rewinder, buffer, is_confirmed)
+    : RewindInfoRewinder(ticks, rewinder, buffer, is_confirmed)
 {
     m_local_physics_time = World::getWorld()->getPhysics()->getPhysicsWorld()
                                             ->getLocalTime();
 }   // RewindInfoState
 
 // ============================================================================
-RewindInfoEvent::RewindInfoEvent(float time, EventRewinder *event_rewinder,
+RewindInfoEvent::RewindInfoEvent(int64_t ticks,
+                                 EventRewinder *event_rewinder,
                                  BareNetworkString *buffer, bool is_confirmed)
-    : RewindInfo(time, is_confirmed)
+    : RewindInfo(ticks, is_confirmed)
 {
     m_event_rewinder = event_rewinder;
     m_buffer         = buffer;
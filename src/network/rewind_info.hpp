@@ -24,6 +24,7 @@
 #include "network/rewinder.hpp"
 #include "utils/leak_check.hpp"
 #include "utils/ptr_vector.hpp"
+#include "utils/types.hpp"
 
 #include <assert.h>
 #include <vector>
@@ -44,8 +45,8 @@ class RewindInfo
 private:
     LEAK_CHECK();
 
-    /** Time when this state was taken. */
-    float m_time;
+    /** World tick at which this state was taken. */
+    int64_t m_ticks;
 
     /** A confirmed event is one that was sent from the server. When
      *  rewinding we have to start with a confirmed state for each
@@ -53,7 +54,7 @@ private:
     bool m_is_confirmed;
 
 public:
-    RewindInfo(float time, bool is_confirmed);
+    RewindInfo(int64_t ticks, bool is_confirmed);
 
     /** Called when going back in time to undo any rewind information. */
     virtual void undo() = 0;
@@ -65,8 +66,8 @@ public:
     // ------------------------------------------------------------------------
     virtual ~RewindInfo() { }
     // ------------------------------------------------------------------------
-    /** Returns the time at which this rewind state was saved. */
-    float getTime() const { return m_time; }
+    /** Returns the world tick at which this rewind state was saved. */
+    int64_t getTicks() const { return m_ticks; }
     // ------------------------------------------------------------------------
     /** Sets if this RewindInfo is confirmed or not. */
     void setConfirmed(bool b) { m_is_confirmed = b; }
@@ -100,9 +101,9 @@ protected:
     Rewinder *m_rewinder;
 
 public:
-    RewindInfoRewinder(float time, Rewinder *rewinder,
+    RewindInfoRewinder(int64_t ticks, Rewinder *rewinder,
                        BareNetworkString *buffer, bool is_confirmed)
-        : RewindInfo(time, is_confirmed)
+        : RewindInfo(ticks, is_confirmed)
     {
         m_rewinder = rewinder;
         m_buffer = buffer;
@@ -123,7 +124,7 @@ class RewindInfoTime : public RewindInfo
 private:
 
 public:
-             RewindInfoTime(float time);
+             RewindInfoTime(int64_t ticks);
     virtual ~RewindInfoTime() {};
 
     // ------------------------------------------------------------------------
@@ -145,7 +146,7 @@ private:
     float m_local_physics_time;
 
 public:
-             RewindInfoState(float time, Rewinder *rewinder, 
+             RewindInfoState(int64_t ticks, Rewinder *rewinder,
                              BareNetworkString *buffer, bool is_confirmed);
     virtual ~RewindInfoState() {};
 
@@ -155,6 +156,12 @@ public:
     // ------------------------------------------------------------------------
     virtual bool isState() const { return true; }
     // ------------------------------------------------------------------------
+    /** Returns the rewinder this state belongs to. */
+    const Rewinder *getRewinder() const { return m_rewinder; }
+    // ------------------------------------------------------------------------
+    /** Returns if this state is a full state, see Rewinder::isKeyframe. */
+    bool isKeyframe() const { return m_rewinder->isKeyframe(getBuffer()); }
+    // ------------------------------------------------------------------------
     /** Called when going back in time to undo any rewind information.
      *  It calls undoState in the rewinder. */
     virtual void undo()
@@ -187,7 +194,7 @@ private:
     /** Buffer with the event data. */
     BareNetworkString *m_buffer;
 public:
-             RewindInfoEvent(float time, EventRewinder *event_rewinder,
+             RewindInfoEvent(int64_t ticks, EventRewinder *event_rewinder,
                              BareNetworkString *buffer, bool is_confirmed);
     virtual ~RewindInfoEvent()
     {
@@ -18,7 +18,8 @@
 
 #include "network/rewind_manager.hpp"
 
-#include "graphics/irr_driver.hpp"
+#include "config/stk_config.hpp"
+#include "config/user_config.hpp"
 #include "modes/world.hpp"
 #include "network/network_string.hpp"
 #include "network/rewinder.hpp"
@@ -26,6 +27,9 @@
 #include "physics/physics.hpp"
 #include "race/history.hpp"
 #include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
 
 RewindManager* RewindManager::m_rewind_manager        = NULL;
 bool           RewindManager::m_enable_rewind_manager = false;
@@ -68,6 +72,9 @@ RewindManager::~RewindManager()
         m_rewind_info[i] = NULL;
     }
     m_rewind_info.clear();
+    for(unsigned int i=0; i<m_pending_events.size(); i++)
+        delete m_pending_events[i];
+    m_pending_events.clear();
 }   // ~RewindManager
 
 // ----------------------------------------------------------------------------
@@ -79,10 +86,28 @@ void RewindManager::reset()
     m_count_of_comparisons = 0;
     m_count_of_searches    = 0;
 #endif
-    m_is_rewinding         = false;
+    m_is_rewinding          = false;
+    m_is_catching_up        = false;
+    m_rewind_index          = 0;
+    m_rewind_end_ticks      = 0;
+    m_rewind_duration       = 0.0;
+    m_rewind_frames         = 0;
+    m_num_rewinds           = 0;
+    m_num_rewind_steps      = 0;
+    m_num_rewind_frames     = 0;
+    m_num_deferred_rewinds  = 0;
+    m_total_rewind_duration = 0.0;
+    m_max_rewind_duration   = 0.0;
+    m_max_rewind_distance   = 0.0f;
     m_overall_state_size   = 0;
-    m_state_frequency      = 0.1f;   // save 10 states a second
-    m_last_saved_state     = -9999.9f;  // forces initial state save
+    m_num_states           = 0;
+    // Save 10 states a second
+    m_state_frequency      = std::max<int64_t>(stk_config->time2Ticks(0.1f), 1);
+    m_last_saved_state     = -m_state_frequency;  // forces initial state save
+    m_current_ticks        = 0;
+    m_time_step            = stk_config->ticks2Time(1);
+    m_lag_compensation.reset(
+             (int)stk_config->time2Ticks(stk_config->m_lag_compensation_max));
 
     if(!m_enable_rewind_manager) return;
 
@@ -105,6 +130,9 @@ void RewindManager::reset()
         delete m_rewind_info[i];
     }
     m_rewind_info.clear();
+    for(unsigned int i=0; i<m_pending_events.size(); i++)
+        delete m_pending_events[i];
+    m_pending_events.clear();
 }   // reset
 
 // ----------------------------------------------------------------------------
@@ -113,7 +141,7 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
 #ifdef REWIND_SEARCH_STATS
     m_count_of_searches++;
 #endif
-    float t = ri->getTime();
+    int64_t t = ri->getTicks();
 
     if(ri->isEvent())
     {
@@ -121,7 +149,7 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
         // events must be inserted at the end 
         AllRewindInfo::reverse_iterator i = m_rewind_info.rbegin();
         while(i!=m_rewind_info.rend() && 
-            (*i)->getTime() > t)
+            (*i)->getTicks() > t)
         {
 #ifdef REWIND_SEARCH_STATS
             m_count_of_comparisons++;
@@ -138,7 +166,7 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
         // If there are several infos for the same time t,
         // a state must be inserted first
         AllRewindInfo::reverse_iterator i = m_rewind_info.rbegin();
-        while(i!=m_rewind_info.rend() && (*i)->getTime() >= t)
+        while(i!=m_rewind_info.rend() && (*i)->getTicks() >= t)
         {
 #ifdef REWIND_SEARCH_STATS
             m_count_of_comparisons++;
@@ -146,20 +174,25 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
             i++;
         }
         AllRewindInfo::iterator insert_point = i.base();
+        // States saved while resimulating are inserted before the infos
+        // of the same tick, which were already handled.
+        if(m_is_rewinding &&
+           insert_point - m_rewind_info.begin() < (int)m_rewind_index)
+            m_rewind_index++;
         m_rewind_info.insert(insert_point,ri);
         return;
     }
 }   // insertRewindInfo
 
 // ----------------------------------------------------------------------------
-/** Returns the first (i.e. lowest) index i in m_rewind_info which fulfills 
- *  time(i) < target_time <= time(i+1) and is a state. This is the state
+/** Returns the first (i.e. lowest) index i in m_rewind_info which fulfills
+ *  ticks(i) < target_ticks <= ticks(i+1) and is a state. This is the state
  *  from which a rewind can start - all states for the karts will be well
  *  defined.
- *  \param time Time for which an index is searched.
+ *  \param target_ticks Tick for which an index is searched.
  *  \return Index in m_rewind_info after which to add rewind data.
  */
-unsigned int RewindManager::findFirstIndex(float target_time) const
+unsigned int RewindManager::findFirstIndex(int64_t target_ticks) const
 {
     // For now do a linear search, even though m_rewind_info is sorted
     // I would expect that most insertions will be towards the (very)
@@ -181,7 +214,7 @@ unsigned int RewindManager::findFirstIndex(float target_time) const
 #endif
         if(m_rewind_info[index]->isState())
         {
-            if(m_rewind_info[index]->getTime()<target_time)
+            if(m_rewind_info[index]->getTicks()<target_ticks)
             {
                 return index;
             }
@@ -193,21 +226,46 @@ unsigned int RewindManager::findFirstIndex(float target_time) const
     if(index_last_state<0)
     {
         Log::fatal("RewindManager",
-                   "Can't find any state when rewinding to %f - aborting.",
-                   target_time);
+                   "Can't find any state when rewinding to %d - aborting.",
+                   (int)target_ticks);
     }
 
     // Otherwise use the last found state - not much we can do in this case.
     Log::error("RewindManager",
-               "Can't find state to rewind to for time %f, using %f.",
-               target_time, m_rewind_info[index_last_state]->getTime());
+               "Can't find state to rewind to for tick %d, using %d.",
+               (int)target_ticks,
+               (int)m_rewind_info[index_last_state]->getTicks());
     return index_last_state;  // avoid compiler warning
 }   // findFirstIndex
 
+// ----------------------------------------------------------------------------
+/** Returns the last keyframe before the (partial) state with the given index
+ *  that was saved by the same rewinder, or NULL if there is none.
+ *  \param index Index of a state in m_rewind_info.
+ */
+RewindInfoState *RewindManager::findKeyframe(unsigned int index) const
+{
+    const RewindInfoState *state =
+                     static_cast<const RewindInfoState*>(m_rewind_info[index]);
+    for(int i=(int)index-1; i>=0; i--)
+    {
+        if(!m_rewind_info[i]->isState()) continue;
+        RewindInfoState *ri = static_cast<RewindInfoState*>(m_rewind_info[i]);
+        if(ri->getRewinder()==state->getRewinder() && ri->isKeyframe())
+            return ri;
+    }
+    return NULL;
+}   // findKeyframe
+
 // ----------------------------------------------------------------------------
 /** Adds an event to the rewind data. The data to be stored must be allocated
- *  and not freed by the caller!
- *  \param time Time at which the event was recorded.
+ *  and not freed by the caller! While a rewind is catching up over several
+ *  frames, the world tick is behind the real time, so the event is recorded
+ *  at the tick the world will catch up to at the end of this frame. It is
+ *  kept in m_pending_events and inserted before the resimulation continues
+ *  (see insertPendingEvents()), so that it is used when the resimulation
+ *  reaches that tick.
+ *  \param event_rewinder The rewinder the event belongs to.
  *  \param buffer Pointer to the event data. 
  */
 void RewindManager::addEvent(EventRewinder *event_rewinder,
@@ -219,11 +277,30 @@ void RewindManager::addEvent(EventRewinder *event_rewinder,
         Log::error("RewindManager", "Adding event when rewinding");
         return;
     }
-    RewindInfo *ri = new RewindInfoEvent(getCurrentTime(), event_rewinder,
+    if(m_is_catching_up)
+    {
+        m_pending_events.push_back(
+            new RewindInfoEvent(m_rewind_end_ticks, event_rewinder, buffer,
+                                /*is confirmed*/true));
+        return;
+    }
+    RewindInfo *ri = new RewindInfoEvent(getCurrentTicks(), event_rewinder,
                                          buffer, /*is confirmed*/true);
     insertRewindInfo(ri);
 }   // addEvent
 
+// ----------------------------------------------------------------------------
+/** Inserts all events that were added while a rewind was catching up. Their
+ *  ticks are not before the current world tick, so they are handled by the
+ *  resimulation.
+ */
+void RewindManager::insertPendingEvents()
+{
+    for(unsigned int i=0; i<m_pending_events.size(); i++)
+        insertRewindInfo(m_pending_events[i]);
+    m_pending_events.clear();
+}   // insertPendingEvents
+
 // ----------------------------------------------------------------------------
 /** Determines if a new state snapshot should be taken, and if so calls all
  *  rewinder to do so.
@@ -232,18 +309,15 @@ void RewindManager::addEvent(EventRewinder *event_rewinder,
 void RewindManager::saveStates()
 {
     if(!m_enable_rewind_manager  || 
-        m_all_rewinder.size()==0 ||
-        m_is_rewinding              )  return;
+        m_all_rewinder.size()==0    )  return;
    
-    float time = World::getWorld()->getTime();
-    if(time - m_last_saved_state < m_state_frequency)
-    {
-        // No full state necessary, add a dummy entry for the time
-        // which increases replay precision (same time step size)
-        RewindInfo *ri = new RewindInfoTime(getCurrentTime());
-        insertRewindInfo(ri);
+    int64_t ticks = World::getWorld()->getTimeTicks();
+    // No full state necessary. Since the resimulation always uses steps of
+    // one tick, no dummy time entries are needed in between. While
+    // resimulating, the ticks before the last saved state already have
+    // states, but the ticks a rewind catches up with need new ones.
+    if(ticks - m_last_saved_state < m_state_frequency)
         return;
-    }
 
     // For now always create a snapshot.
     for(unsigned int i=0; i<m_all_rewinder.size(); i++)
@@ -252,7 +326,8 @@ void RewindManager::saveStates()
         if(buffer && buffer->size()>=0)
         {
             m_overall_state_size += buffer->size();
-            RewindInfo *ri = new RewindInfoState(getCurrentTime(),
+            m_num_states++;
+            RewindInfo *ri = new RewindInfoState(getCurrentTicks(),
                                                  m_all_rewinder[i], buffer,
                                                  /*is_confirmed*/true);
             assert(ri);
@@ -262,144 +337,255 @@ void RewindManager::saveStates()
             delete buffer;   // NULL or 0 byte buffer
     }
 
-    Log::verbose("RewindManager", "%f allocated %ld bytes search %d/%d=%f",
-                 World::getWorld()->getTime(), m_overall_state_size,
+    Log::verbose("RewindManager", "%d allocated %ld bytes search %d/%d=%f",
+                 (int)ticks, m_overall_state_size,
                  m_count_of_comparisons, m_count_of_searches,
                  float(m_count_of_comparisons)/ float(m_count_of_searches) );
 
-    m_last_saved_state = time;
+    m_last_saved_state = ticks;
 }   // saveStates
 
 // ----------------------------------------------------------------------------
-/** Rewinds to the specified time.
- *  \param t Time to rewind to.
+/** Rewinds to the specified tick. The world is set back to the last state
+ *  before that tick, and then resimulated up to the current tick, but only
+ *  as much as fits into the time budget of this frame. The rest of the
+ *  resimulation is done in the next frames, see update().
+ *  \param rewind_ticks World tick to rewind to.
  */
-void RewindManager::rewindTo(float rewind_time)
+void RewindManager::rewindTo(int64_t rewind_ticks)
 {
+    World *world = World::getWorld();
+
+    // A new rewind while the previous one is still catching up: the world
+    // was only resimulated up to its current tick, so it can't be rewound
+    // to a later tick, and it must still catch up to the same end tick.
+    int64_t current_ticks = world->getTimeTicks();
+    if(m_is_catching_up)
+    {
+        insertPendingEvents();
+        rewind_ticks  = std::min(rewind_ticks, current_ticks);
+        current_ticks = m_rewind_end_ticks;
+    }
+
     assert(!m_is_rewinding);
     m_is_rewinding = true;
-    Log::info("rewind", "Rewinding to %f", rewind_time);
+    Log::info("rewind", "Rewinding to tick %d", (int)rewind_ticks);
     history->doReplayHistory(History::HISTORY_NONE);
 
+    const double start = StkTime::getRealTime();
+
     // First find the state to which we need to rewind
     // ------------------------------------------------
-    unsigned int index = findFirstIndex(rewind_time);
+    unsigned int index = findFirstIndex(rewind_ticks);
 
     if(!m_rewind_info[index]->isState())
     {
-        Log::error("RewindManager", "No state for rewind to %f, state %d.",
-                   rewind_time, index);
+        Log::error("RewindManager", "No state for rewind to %d, state %d.",
+                   (int)rewind_ticks, index);
+        m_is_rewinding = false;
+        // A rewind that is catching up continues as before
         return;
     }
 
-    // Then undo the rewind infos going backwards in time
+    // Then undo the rewind infos going backwards in time. If a previous
+    // rewind is catching up, the infos from m_rewind_index on were not
+    // handled again yet, so they must not be undone.
     // --------------------------------------------------
+    const int last_done = m_is_catching_up ? (int)m_rewind_index - 1
+                                           : (int)m_rewind_info.size() - 1;
     for(int i=m_rewind_info.size()-1; i>=(int)index; i--)
     {
-        m_rewind_info[i]->undo();
+        if(i<=last_done)
+            m_rewind_info[i]->undo();
 
         // Now all states after the time we rewind to are not confirmed
         // anymore. They need to be rewritten when going forward during
         // the rewind.
         if(m_rewind_info[i]->isState() && 
-            m_rewind_info[i]->getTime() > m_rewind_info[index]->getTime() )
+            m_rewind_info[i]->getTicks() > m_rewind_info[index]->getTicks() )
             m_rewind_info[i]->setConfirmed(false);
     }   // for i>state
 
 
     // Rewind the required state(s)
     // ----------------------------
-    World *world = World::getWorld();
-    float current_time = world->getTime();
-
     // Get the (first) full state to which we have to rewind
     RewindInfoState *state =
                     dynamic_cast<RewindInfoState*>(m_rewind_info[index]);
 
-    // Store the time to which we have to replay to
-    float exact_rewind_time = state->getTime();
+    // Store the tick to which we have to replay to
+    const int64_t exact_rewind_ticks = state->getTicks();
 
     // Now start the rewind with the full state:
-    world->setTime(exact_rewind_time);
+    world->setTimeTicks(exact_rewind_ticks);
     float local_physics_time = state->getLocalPhysicsTime();
     world->getPhysics()->getPhysicsWorld()->setLocalTime(local_physics_time);
 
     // Restore all states from the current time - the full state of a race
     // will be potentially stored in several state objects. State can be NULL
-    // if the next event is not a state
-    while(state && state->getTime()==exact_rewind_time)
+    // if the next event is not a state. A partial state is applied on top
+    // of the last keyframe of its rewinder.
+    while(state && state->getTicks()==exact_rewind_ticks)
     {
+        if(!state->isKeyframe())
+        {
+            RewindInfoState *keyframe = findKeyframe(index);
+            if(keyframe)
+                keyframe->rewind();
+            else
+                Log::error("RewindManager", "No keyframe for state %d.",
+                           index);
+        }
         state->rewind();
         index++;
         if(index>=m_rewind_info.size()) break;
         state = dynamic_cast<RewindInfoState*>(m_rewind_info[index]);
     }
 
+    // The karts were moved to their state at the rewind time.
+    world->updateKartIndex();
+
+    m_rewind_index     = index;
+    m_rewind_end_ticks = current_ticks;
+    if(!m_is_catching_up)
+    {
+        m_rewind_duration = 0.0;
+        m_rewind_frames   = 0;
+    }
+    m_rewind_duration += StkTime::getRealTime() - start;
+    m_num_rewinds++;
+    m_max_rewind_distance = std::max(m_max_rewind_distance,
+                 stk_config->ticks2Time(current_ticks - exact_rewind_ticks));
+
+    // Now go forward through the list of rewind infos:
+    resimulate(/*use_budget*/true);
+}   // rewindTo
+
+// ----------------------------------------------------------------------------
+/** Called once per frame instead of updating the world while a rewind is
+ *  catching up: the ticks of this frame are added to the ticks that need
+ *  to be resimulated, and the resimulation is continued.
+ *  \param ticks Number of ticks of this frame.
+ */
+void RewindManager::update(int ticks)
+{
+    assert(m_is_catching_up);
+    insertPendingEvents();
+    m_rewind_end_ticks += ticks;
+    resimulate(/*use_budget*/true);
+}   // update
+
+// ----------------------------------------------------------------------------
+/** Resimulates the world one tick at a time from the current world tick
+ *  towards m_rewind_end_ticks, handling all rewind infos on the way. If
+ *  use_budget is set, it stops once the real time used in this frame
+ *  exceeds UserConfigParams::m_rewind_max_frame_time, but it always
+ *  resimulates at least two ticks, so that a rewind catches up even on slow
+ *  machines. isRewinding() is only true while this function resimulates,
+ *  if the end tick is not reached the rewind is catching up (see
+ *  isCatchingUp()) till a later call reaches it. Since the graphics are
+ *  not updated while resimulating, they are updated once at the end.
+ *  \param use_budget If the time budget per frame should be used.
+ */
+void RewindManager::resimulate(bool use_budget)
+{
+    World *world = World::getWorld();
+    m_is_rewinding = true;
+    const double  start       = StkTime::getRealTime();
+    const double  budget      = UserConfigParams::m_rewind_max_frame_time
+                              * 0.001;
+    const int64_t start_ticks = world->getTimeTicks();
+    const float   dt          = stk_config->ticks2Time(1);
+
     // Now go forward through the list of rewind infos:
     // ------------------------------------------------
-    while( world->getTime() < current_time &&
-          index < (int)m_rewind_info.size()                 )
+    while(world->getTimeTicks() < m_rewind_end_ticks)
     {
-        // Now handle all states and events at the current time before
+        if(use_budget && world->getTimeTicks() - start_ticks >= 2 &&
+           StkTime::getRealTime() - start > budget                  )
+            break;
+
+        // Now handle all states and events at the current tick before
         // updating the world:
-        while(index < (int)m_rewind_info.size() &&
-              m_rewind_info[index]->getTime()<=world->getTime()+0.001f)
+        while(m_rewind_index < m_rewind_info.size() &&
+              m_rewind_info[m_rewind_index]->getTicks()<=world->getTimeTicks())
         {
-            if(m_rewind_info[index]->isState())
+            RewindInfo *ri = m_rewind_info[m_rewind_index];
+            if(ri->isState())
             {
                 // TOOD: replace the old state with a new state. 
                 // For now just set it to confirmed
-                m_rewind_info[index]->setConfirmed(true);
+                ri->setConfirmed(true);
             }
-            else if(m_rewind_info[index]->isEvent())
+            else if(ri->isEvent())
             {
-                m_rewind_info[index]->rewind();
+                ri->rewind();
             }
-            index++;
+            m_rewind_index++;
         }
-        float dt = determineTimeStepSize(index, current_time);
+        const int64_t ticks = world->getTimeTicks();
         world->updateWorld(dt);
-#define SHOW_ROLLBACK
-#ifdef SHOW_ROLLBACK
-        irr_driver->update(dt);
-#endif
-        world->updateTime(dt);
-
+        world->updateTime(dt, 1);
+        m_num_rewind_steps++;
+        if(world->getTimeTicks() == ticks)
+        {
+            // The world clock is not running (e.g. the race is paused),
+            // so the end tick can't be reached: stop the rewind here.
+            m_rewind_end_ticks = ticks;
+            break;
+        }
     }
+
     m_is_rewinding = false;
+    world->updateGraphics(int(world->getTimeTicks() - start_ticks));
 
-}   // rewindTo
+    m_rewind_duration += StkTime::getRealTime() - start;
+    m_rewind_frames++;
+    m_num_rewind_frames++;
+    m_is_catching_up = world->getTimeTicks() < m_rewind_end_ticks;
+    if(m_is_catching_up)
+        return;
+
+    insertPendingEvents();
+    m_total_rewind_duration += m_rewind_duration;
+    m_max_rewind_duration = std::max(m_max_rewind_duration,
+                                     m_rewind_duration);
+    if(m_rewind_frames>1)
+        m_num_deferred_rewinds++;
+    Log::verbose("RewindManager", "Rewind finished after %f ms in %d frames.",
+                 m_rewind_duration*1000.0, m_rewind_frames);
+}   // resimulate
 
 // ----------------------------------------------------------------------------
-/** Determines the next time step size to use when recomputing the physics.
- *  The time step size is either 1/60 (default physics), or less, if there
- *  is an even to handle before that time.
- *  \param next_state The next state to replay.
- *  \param end_time The end time to which we must replay forward. Don't
- *         return a dt that would be bigger tham this value.
- *  \return The time step size to use in the next simulation step.
+/** Prints statistics about the memory used by the saved states (run e.g.
+ *  with --rewind --profile-laps=1 --numkarts=8 and --numkarts=32) and about
+ *  the rewinds done in this race.
  */
-float RewindManager::determineTimeStepSize(int next_state, float end_time)
+void RewindManager::printStatistics() const
 {
-    // If there is a next state (which is known to have a different time)
-    // use the time difference to determine the time step size.
-    if(next_state < (int)m_rewind_info.size())
-        return m_rewind_info[next_state]->getTime() - World::getWorld()->getTime();
-
-    // Otherwise, i.e. we are rewinding the last state/event, take the
-    // difference between that time and the world time at which the rewind
-    // was triggered.
-    return end_time -  m_rewind_info[next_state-1]->getTime();
-
-
-
-    float dt = 1.0f/60.0f;
-    float t = World::getWorld()->getTime();
-    if(m_rewind_info[next_state]->getTime() < t + dt)
+    const float time = stk_config->ticks2Time(World::getWorld()
+                                              ->getTimeTicks());
+    Log::info("RewindManager",
+              "%d karts: %d states with %u bytes, %f bytes per state, "
+              "%f bytes per second.",
+              World::getWorld()->getNumKarts(), m_num_states,
+              m_overall_state_size,
+              m_num_states > 0 ? float(m_overall_state_size) / m_num_states
+                               : 0.0f,
+              time > 0 ? m_overall_state_size / time : 0.0f);
+    if(m_num_rewinds==0)
     {
-        // Since we have RewindInfo at that time, it is certain that
-        /// this time is before (or at) end_time, not after.
-        return m_rewind_info[next_state]->getTime()-t;
+        Log::info("RewindManager", "No rewinds.");
+        return;
     }
-    return t+dt < end_time ? dt : end_time - t;
-}   // determineTimeStepSize
+    Log::info("RewindManager",
+              "%d rewinds (max %f s back), %d resimulated steps in %d frames, "
+              "%d rewinds needed more than one frame.",
+              m_num_rewinds, m_max_rewind_distance, m_num_rewind_steps,
+              m_num_rewind_frames, m_num_deferred_rewinds);
+    Log::info("RewindManager",
+              "Rewind time: total %f ms, average %f ms, max %f ms.",
+              m_total_rewind_duration*1000.0,
+              m_total_rewind_duration*1000.0/m_num_rewinds,
+              m_max_rewind_duration*1000.0);
+}   // printStatistics
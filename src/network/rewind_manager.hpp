@@ -19,13 +19,16 @@
 #ifndef HEADER_REWIND_MANAGER_HPP
 #define HEADER_REWIND_MANAGER_HPP
 
+#include "network/lag_compensation.hpp"
 #include "network/rewinder.hpp"
 #include "utils/ptr_vector.hpp"
+#include "utils/types.hpp"
 
 #include <assert.h>
 #include <vector>
 
 class RewindInfo;
+class RewindInfoState;
 class EventRewinder;
 
 /** \ingroup network
@@ -43,7 +46,8 @@ class EventRewinder;
  *  declared (usually inside of the object it can rewind). This instance
  *  is automatically registered with the RewindManager.
  *  All states and events are stored in a RewindInfo object. All RewindInfo
- *  objects are stored in a list sorted by time.
+ *  objects are stored in a list sorted by time. Time is measured in world
+ *  ticks (see WorldStatus::getTimeTicks()), so all comparisons are exact.
  *  When a rewind to time T is requested, the following takes place:
  *  1. Go back in time:
  *     Determine the latest time t_min < T so that each rewindable objects
@@ -57,20 +61,28 @@ class EventRewinder;
  *     at a given time. We either need to work around that, or make sure
  *     to store at least an unconfirmed state whenever we receive a 
  *     confirmed state.
- *  3. Rerun the simulation till the current time t_current is reached:
- *     1. Determine the time `t_next` of the next frame. This is either
- *        current_time + 1/60 (physics default time step size), or less
- *        if RewindInfo at an earlier time is available).
- *        This determines the time step size for the next frame (i.e.
- *        `t_next - t_current`).
- *     2. For all RewindInfo at time t_next call:
+ *  3. Rerun the simulation till the current time t_current is reached,
+ *     one tick at a time:
+ *     1. For all RewindInfo at the current tick call:
  *        - `restoreState()` if the RewindInfo is a confirmed state
  *        - `discardState()` if the RewindInfo is an unconfirmed state
  *          TODO: still missing, and instead of discard perhaps
  *                store a new state??
  *        - `rewindToEvent()` if the RewindInfo is an event
- *     3. Do one step of world simulation, using the updated (confirmed)
+ *     2. Do one tick of world simulation, using the updated (confirmed)
  *        states and newly set events (e.g. kart input).
+ *  The resimulation does not render anything, and kart graphics, particles
+ *  and sound effects are not updated while isRewinding() is true. To avoid
+ *  a long stall when a lot of time must be resimulated, each frame only
+ *  resimulates as much as fits into the time budget
+ *  UserConfigParams::m_rewind_max_frame_time, and then updates the kart
+ *  graphics, engine sounds and cameras once. A rewind that does not fit
+ *  is catching up (see isCatchingUp()): it is continued in the next frames
+ *  by update(), which replaces the normal world update till the rewind is
+ *  finished (the time of these frames is resimulated as well, so the world
+ *  catches up). Between these frames isRewinding() is false, so input
+ *  events are still recorded (they are inserted at the end tick of the
+ *  frame), and new states are saved for the ticks that are caught up.
  */
 
 class RewindManager
@@ -96,24 +108,68 @@ private:
     /** Overall amount of memory allocated by states. */
     unsigned int m_overall_state_size;
 
+    /** Number of states saved. */
+    unsigned int m_num_states;
+
     /** Indicates if currently a rewind is happening. */
     bool m_is_rewinding;
 
-    /** How much time between consecutive state saves. */
-    float m_state_frequency;
+    /** Indicates if a rewind did not reach its end tick in the time budget
+     *  of a frame, and must be continued in the next frames. */
+    bool m_is_catching_up;
+
+    /** Events added while a rewind is catching up. They are inserted into
+     *  m_rewind_info before the resimulation is continued. */
+    AllRewindInfo m_pending_events;
+
+    /** How many ticks between consecutive state saves. */
+    int64_t m_state_frequency;
 
-    /** Time at which the last state was saved. */
-    float m_last_saved_state;
+    /** Tick at which the last state was saved. */
+    int64_t m_last_saved_state;
 
-    /** The current time to be used in all states/events. This is used to
+    /** The current tick to be used in all states/events. This is used to
      *  give all states and events during one frame the same time, even
      *  if e.g. states are saved before world time is increased, other
      *  events later. */
-    float m_current_time;
+    int64_t m_current_ticks;
 
     /** The current time step size. */
     float m_time_step;
 
+    /** Index of the next rewind info to handle while a rewind is in
+     *  progress. */
+    unsigned int m_rewind_index;
+
+    /** World tick up to which a rewind in progress must resimulate. This
+     *  is increased by the ticks of each frame the rewind is not finished. */
+    int64_t m_rewind_end_ticks;
+
+    /** Real time spent on the rewind in progress. */
+    double m_rewind_duration;
+
+    /** Number of frames the rewind in progress took so far. */
+    int m_rewind_frames;
+
+    /** Statistics: number of rewinds, resimulated steps, frames used for
+     *  rewinding (a rewind that did not fit into the budget of one frame
+     *  uses several), and rewinds which needed more than one frame. */
+    int m_num_rewinds;
+    int m_num_rewind_steps;
+    int m_num_rewind_frames;
+    int m_num_deferred_rewinds;
+
+    /** Statistics: overall and maximum real time spent on one rewind, and
+     *  maximum world time rewound. */
+    double m_total_rewind_duration;
+    double m_max_rewind_duration;
+    float  m_max_rewind_distance;
+
+    /** History of the kart positions for lag compensated hit tests on the
+     *  server. Unlike the states this is kept for each tick, and is also
+     *  used if rewinding is disabled. */
+    LagCompensation m_lag_compensation;
+
 #define REWIND_SEARCH_STATS
 
 #ifdef REWIND_SEARCH_STATS
@@ -125,30 +181,32 @@ private:
 
     RewindManager();
     ~RewindManager();
-    unsigned int findFirstIndex(float time) const;
+    unsigned int findFirstIndex(int64_t ticks) const;
     void insertRewindInfo(RewindInfo *ri);
-    float determineTimeStepSize(int state, float max_time);
+    RewindInfoState *findKeyframe(unsigned int index) const;
+    void resimulate(bool use_budget);
+    void insertPendingEvents();
 public:
     // First static functions to manage rewinding.
     // ===========================================
     static RewindManager *create();
     static void destroy();
     // ------------------------------------------------------------------------
-    /** Sets the time that is to be used for all further states or events,
-     *  and the time step size. This is necessary so that states/events before 
-     *  and after World::m_time is increased have the same time stamp. 
-     *  \param t Time.
+    /** Sets the tick that is to be used for all further states or events,
+     *  and the time step size. This is necessary so that states/events before
+     *  and after the world time is increased have the same time stamp.
+     *  \param ticks World tick.
      *  \param dt Time step size.
      */
-    void setCurrentTime(float t, float dt)
+    void setCurrentTicks(int64_t ticks, float dt)
     {
-        m_current_time = t;
-        m_time_step    = dt;
-    }   // setCurrentTime
+        m_current_ticks = ticks;
+        m_time_step     = dt;
+    }   // setCurrentTicks
 
     // ------------------------------------------------------------------------
-    /** Returns the current time. */
-    float getCurrentTime() const { return m_current_time; }
+    /** Returns the current tick. */
+    int64_t getCurrentTicks() const { return m_current_ticks; }
     // ------------------------------------------------------------------------
     float getCurrentTimeStep() const { return m_time_step; }
     // ------------------------------------------------------------------------
@@ -172,7 +230,9 @@ public:
 
     void reset();
     void saveStates();
-    void rewindTo(float target_time);
+    void rewindTo(int64_t target_ticks);
+    void update(int ticks);
+    void printStatistics() const;
     void addEvent(EventRewinder *event_rewinder, BareNetworkString *buffer);
     // ------------------------------------------------------------------------
     /** Adds a Rewinder to the list of all rewinders.
@@ -187,6 +247,13 @@ public:
     // ------------------------------------------------------------------------
     /** Returns true if currently a rewind is happening. */
     bool isRewinding() const { return m_is_rewinding; }
+    // ------------------------------------------------------------------------
+    /** Returns true if a rewind is not finished and continued in the next
+     *  frames instead of the normal world update. */
+    bool isCatchingUp() const { return m_is_catching_up; }
+    // ------------------------------------------------------------------------
+    /** Returns the kart position history used for lag compensation. */
+    LagCompensation *getLagCompensation() { return &m_lag_compensation; }
 };   // RewindManager
 
 
@@ -58,6 +58,15 @@ public:
     */
    virtual void undoState(BareNetworkString *buffer) = 0;
 
+   // -------------------------------------------------------------------------
+   /** Returns if a state saved by this rewinder contains the full state.
+    *  A rewinder can save partial states that only contain the changes
+    *  since the last full state (keyframe), in which case the RewindManager
+    *  restores the keyframe before the partial state. */
+   virtual bool isKeyframe(const BareNetworkString *buffer) const
+   {
+       return true;
+   }   // isKeyframe
    // -------------------------------------------------------------------------
    /** Nothing to do here. */
    virtual void reset() {};
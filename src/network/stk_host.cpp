@@ -21,8 +21,10 @@
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
 #include "network/event.hpp"
+#include "network/lobby_statistics.hpp"
 #include "network/network_config.hpp"
 #include "network/network_console.hpp"
+#include "network/network_impairment.hpp"
 #include "network/network_string.hpp"
 #include "network/protocols/connect_to_peer.hpp"
 #include "network/protocols/connect_to_server.hpp"
@@ -307,6 +309,8 @@ void STKHost::init()
     m_game_setup       = NULL;
     m_is_registered    = false;
     m_error_message    = "";
+    m_network_impairment = NULL;
+    m_lobby_statistics   = new LobbyStatistics();
 
     pthread_mutex_init(&m_exit_mutex, NULL);
 
@@ -319,6 +323,23 @@ void STKHost::init()
     }
 
     Log::info("STKHost", "Host initialized.");
+
+    const std::string &impairment =
+        NetworkConfig::get()->getNetworkImpairment();
+    if (!impairment.empty())
+    {
+        m_network_impairment = new NetworkImpairment();
+        if (m_network_impairment->setProfile(impairment))
+        {
+            Log::info("STKHost", "Simulating network impairment: %s",
+                      m_network_impairment->toString().c_str());
+        }
+        else
+        {
+            delete m_network_impairment;
+            m_network_impairment = NULL;
+        }
+    }
     Network::openLog();  // Open packet log file
     ProtocolManager::getInstance<ProtocolManager>();
 
@@ -353,7 +374,12 @@ STKHost::~STKHost()
     Network::closeLog();
     stopListening();
 
+    // Delete remaining packets before the enet host is destroyed
+    delete m_network_impairment;
     delete m_network;
+
+    m_lobby_statistics->print("Host");
+    delete m_lobby_statistics;
 }   // ~STKHost
 
 //-----------------------------------------------------------------------------
@@ -543,7 +569,13 @@ void* STKHost::mainLoop(void* self)
             myself->handleLANRequests();
         }   // if discovery host
 
-        while (enet_host_service(host, &event, 20) != 0)
+        // Send delayed packets. Don't wait as long for events, so that
+        // they are sent with the right delay.
+        if (myself->m_network_impairment)
+            myself->m_network_impairment->update();
+        const int timeout = myself->m_network_impairment ? 1 : 20;
+
+        while (enet_host_service(host, &event, timeout) != 0)
         {
             if (event.type == ENET_EVENT_TYPE_NONE)
                 continue;
@@ -563,6 +595,8 @@ void* STKHost::mainLoop(void* self)
             }   // EVENT_TYPE_CONNECTED
             else if (stk_event->getType() == EVENT_TYPE_MESSAGE)
             {
+                myself->m_lobby_statistics
+                      ->addPacketReceived(stk_event->data().getTotalSize());
                 Network::logPacket(stk_event->data(), true);
                 TransportAddress stk_addr(peer->getAddress());
                 Log::verbose("NetworkManager",
@@ -717,6 +751,9 @@ void STKHost::removePeer(const STKPeer* peer)
 
     TransportAddress addr(peer->getAddress());
     Log::debug("STKHost", "Disconnected host: %s", addr.toString().c_str());
+
+    if (m_network_impairment)
+        peer->removeDelayedPackets(m_network_impairment);
             
     // remove the peer:
     bool removed = false;
@@ -41,7 +41,9 @@
 #include <pthread.h>
 
 class GameSetup;
+class LobbyStatistics;
 class NetworkConsole;
+class NetworkImpairment;
 
 class STKHost
 {
@@ -72,6 +74,12 @@ private:
     /** Network console */
     NetworkConsole *m_network_console;
 
+    /** Simulates a bad network connection if not NULL. */
+    NetworkImpairment *m_network_impairment;
+
+    /** Traffic and time used by the lobby of this host. */
+    LobbyStatistics *m_lobby_statistics;
+
     /** The list of peers connected to this instance. */
     std::vector<STKPeer*> m_peers;
 
@@ -175,6 +183,13 @@ public:
      *  requested. */
     bool requestedShutdown() const { return m_shutdown; }
     // --------------------------------------------------------------------
+    /** Returns the network impairment simulation, or NULL if the network
+     *  is not impaired. */
+    NetworkImpairment* getNetworkImpairment() { return m_network_impairment; }
+    // --------------------------------------------------------------------
+    /** Returns the traffic and time statistics of this host. */
+    LobbyStatistics* getLobbyStatistics() { return m_lobby_statistics; }
+    // --------------------------------------------------------------------
     /** Returns the current game setup. */
     GameSetup* getGameSetup() { return m_game_setup; }
     // --------------------------------------------------------------------
@@ -18,6 +18,8 @@
 
 #include "network/stk_peer.hpp"
 #include "network/game_setup.hpp"
+#include "network/lobby_statistics.hpp"
+#include "network/network_impairment.hpp"
 #include "network/network_string.hpp"
 #include "network/network_player_profile.hpp"
 #include "network/stk_host.hpp"
@@ -70,9 +72,25 @@ void STKPeer::sendPacket(NetworkString *data, bool reliable)
                                             data->getTotalSize(),
                                     (reliable ? ENET_PACKET_FLAG_RELIABLE
                                               : ENET_PACKET_FLAG_UNSEQUENCED));
-    enet_peer_send(m_enet_peer, 0, packet);
+    STKHost::get()->getLobbyStatistics()
+                  ->addPacketSent(data->getTotalSize());
+    NetworkImpairment *impairment = STKHost::get()->getNetworkImpairment();
+    if (impairment)
+        impairment->sendPacket(m_enet_peer, 0, packet, reliable);
+    else
+        enet_peer_send(m_enet_peer, 0, packet);
 }   // sendPacket
 
+//-----------------------------------------------------------------------------
+/** Discards all packets to this peer that are delayed by the network
+ *  impairment simulation (used when the peer is removed).
+ *  \param impairment The network impairment simulation.
+ */
+void STKPeer::removeDelayedPackets(NetworkImpairment *impairment) const
+{
+    impairment->removePeer(m_enet_peer);
+}   // removeDelayedPackets
+
 //-----------------------------------------------------------------------------
 /** Returns the IP address (in host format) of this client.
  */
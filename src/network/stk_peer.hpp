@@ -30,6 +30,7 @@
 
 #include <vector>
 
+class NetworkImpairment;
 class NetworkPlayerProfile;
 class NetworkString;
 class TransportAddress;
@@ -61,6 +62,7 @@ public:
 
     virtual void sendPacket(NetworkString *data,
                             bool reliable = true);
+    void removeDelayedPackets(NetworkImpairment *impairment) const;
     void disconnect();
     bool isConnected() const;
     bool exists() const;
@@ -41,7 +41,7 @@ btRigidBody& btKart::getFixedBody()
 }
 
 // ============================================================================
-btKart::btKart(btRigidBody* chassis, btVehicleRaycaster* raycaster,
+btKart::btKart(btRigidBody* chassis, btKartRaycaster* raycaster,
                Kart *kart)
       : m_vehicleRaycaster(raycaster)
 {
@@ -212,12 +212,13 @@ void btKart::updateWheelTransformsWS(btWheelInfo& wheel,
 }   // updateWheelTransformsWS
 
 // ----------------------------------------------------------------------------
-/**
+/** Casts the suspension rays of all wheels, and the rays used to determine
+ *  the visual contact points of the two rear wheels, as one batch (which
+ *  only needs a single broadphase query), and then updates the contact
+ *  information of each wheel.
  */
-btScalar btKart::rayCast(unsigned int index)
+void btKart::rayCastAllWheels()
 {
-    btWheelInfo &wheel = m_wheelInfo[index];
-
     // Work around a bullet problem: when using a convex hull the raycast
     // would sometimes hit the chassis (which does not happen when using a
     // box shape). Therefore set the collision mask in the chassis body so
@@ -230,29 +231,107 @@ btScalar btKart::rayCast(unsigned int index)
         m_chassisBody->getBroadphaseHandle()->m_collisionFilterGroup = 0;
     }
 
-    updateWheelTransformsWS( wheel,false);
+    const int num_wheels = m_wheelInfo.size();
+    assert(num_wheels <= 4);
 
-    btScalar max_susp_len = wheel.getSuspensionRestLength()
-                          + wheel.m_maxSuspensionTravel;
+    // The suspension rays of all wheels, followed by the two visual rays
+    btVector3 from[6], to[6];
+    btScalar  raylen[4];
+    for (int i = 0; i < num_wheels; i++)
+    {
+        btWheelInfo &wheel = m_wheelInfo[i];
+        updateWheelTransformsWS( wheel,false);
 
-    // Do a slightly longer raycast to see if the kart might soon hit the 
-    // ground and some 'cushioning' is needed to avoid that the chassis
-    // hits the ground.
-    btScalar raylen = max_susp_len + 0.5f;
+        btScalar max_susp_len = wheel.getSuspensionRestLength()
+                              + wheel.m_maxSuspensionTravel;
 
-    btVector3 rayvector = wheel.m_raycastInfo.m_wheelDirectionWS * (raylen);
-    const btVector3& source = wheel.m_raycastInfo.m_hardPointWS;
-    wheel.m_raycastInfo.m_contactPointWS = source + rayvector;
-    const btVector3& target = wheel.m_raycastInfo.m_contactPointWS;
+        // Do a slightly longer raycast to see if the kart might soon hit the 
+        // ground and some 'cushioning' is needed to avoid that the chassis
+        // hits the ground.
+        raylen[i] = max_susp_len + 0.5f;
+
+        btVector3 rayvector = wheel.m_raycastInfo.m_wheelDirectionWS
+                            * raylen[i];
+        from[i] = wheel.m_raycastInfo.m_hardPointWS;
+        wheel.m_raycastInfo.m_contactPointWS = from[i] + rayvector;
+        to[i] = wheel.m_raycastInfo.m_contactPointWS;
+    }
+    int num_rays = num_wheels;
+
+#define USE_VISUAL
+#ifdef USE_VISUAL
+    if (num_wheels == 4)
+    {
+        btTransform chassisTrans = getChassisWorldTransform();
+        if (getRigidBody()->getMotionState())
+        {
+            getRigidBody()->getMotionState()->getWorldTransform(chassisTrans);
+        }
+        btQuaternion q(m_visual_rotation, 0, 0);
+        btQuaternion rot_new = chassisTrans.getRotation() * q;
+        chassisTrans.setRotation(rot_new);
+        for (int i = 2; i < 4; i++)
+        {
+            btVector3 pos = m_kart->getKartModel()->getWheelGraphicsPosition(i);
+            pos.setZ(pos.getZ()*0.9f);
+            from[num_rays] = chassisTrans( pos );
+            to[num_rays]   = from[num_rays] + (to[i] - from[i]);
+            num_rays++;
+        }
+    }
+#endif
 
-    btVehicleRaycaster::btVehicleRaycasterResult rayResults;
+    btVehicleRaycaster::btVehicleRaycasterResult results[6];
+    void* objects[6];
 
     btAssert(m_vehicleRaycaster);
+    m_vehicleRaycaster->castRays(num_rays, from, to, results, objects);
 
-    void* object = m_vehicleRaycaster->castRay(source,target,rayResults);
+    for (int i = 0; i < num_wheels; i++)
+    {
+        updateWheelContact(i, raylen[i], results[i], objects[i]);
+#ifndef USE_VISUAL
+        m_visual_contact_point[i] = results[i].m_hitPointInWorld;
+#endif
+    }
 
-    wheel.m_raycastInfo.m_groundObject = 0;
+#ifdef USE_VISUAL
+    if (num_wheels == 4)
+    {
+        for (int i = 2; i < 4; i++)
+        {
+            m_visual_contact_point[i]   = results[i + 2].m_hitPointInWorld;
+            m_visual_contact_point[i-2] = from[i + 2];
+            m_visual_wheels_touch_ground &= (objects[i + 2]!=NULL);
+        }
+    }
+#endif
 
+    if(m_chassisBody->getBroadphaseHandle())
+    {
+        m_chassisBody->getBroadphaseHandle()->m_collisionFilterGroup
+            = old_group;
+    }
+}   // rayCastAllWheels
+
+// ----------------------------------------------------------------------------
+/** Updates the contact information of one wheel from the result of its
+ *  suspension ray.
+ *  \param index Index of the wheel.
+ *  \param raylen Length of the ray that was cast.
+ *  \param rayResults The result of the raycast.
+ *  \param object The object hit, or NULL if nothing was hit.
+ */
+void btKart::updateWheelContact(unsigned int index, btScalar raylen,
+                        const btVehicleRaycaster::btVehicleRaycasterResult
+                                                                 &rayResults,
+                                void *object)
+{
+    btWheelInfo &wheel = m_wheelInfo[index];
+    btScalar max_susp_len = wheel.getSuspensionRestLength()
+                          + wheel.m_maxSuspensionTravel;
+
+    wheel.m_raycastInfo.m_groundObject = 0;
     btScalar depth =  raylen * rayResults.m_distFraction;
     if (object &&  depth < max_susp_len)
     {
@@ -316,44 +395,7 @@ btScalar btKart::rayCast(unsigned int index)
             - wheel.m_raycastInfo.m_wheelDirectionWS;
         wheel.m_clippedInvContactDotSuspension = btScalar(1.0);
     }
-
-#define USE_VISUAL
-#ifndef USE_VISUAL
-    m_visual_contact_point[index] = rayResults.m_hitPointInWorld;
-#else
-    if(index==2 || index==3)
-    {
-        btTransform chassisTrans = getChassisWorldTransform();
-        if (getRigidBody()->getMotionState())
-        {
-            getRigidBody()->getMotionState()->getWorldTransform(chassisTrans);
-        }
-        btQuaternion q(m_visual_rotation, 0, 0);
-        btQuaternion rot_new = chassisTrans.getRotation() * q;
-        chassisTrans.setRotation(rot_new);
-        btVector3 pos = m_kart->getKartModel()->getWheelGraphicsPosition(index);
-        pos.setZ(pos.getZ()*0.9f);
-        btVector3 source = chassisTrans( pos );
-        btVector3 target = source + rayvector;
-        btVehicleRaycaster::btVehicleRaycasterResult rayResults;
-
-        void* object = m_vehicleRaycaster->castRay(source,target,rayResults);
-        m_visual_contact_point[index] = rayResults.m_hitPointInWorld;
-        m_visual_contact_point[index-2] = source;
-        m_visual_wheels_touch_ground &= (object!=NULL);
-    }
-#endif
-
-    if(m_chassisBody->getBroadphaseHandle())
-    {
-        m_chassisBody->getBroadphaseHandle()->m_collisionFilterGroup
-            = old_group;
-    }
-
-
-    return depth;
-
-}   // rayCast
+}   // updateWheelContact
 
 // ----------------------------------------------------------------------------
 const btTransform& btKart::getChassisWorldTransform() const
@@ -387,9 +429,9 @@ void btKart::updateVehicle( btScalar step )
 
     m_num_wheels_on_ground       = 0;
     m_visual_wheels_touch_ground = true;
+    rayCastAllWheels();
     for (int i=0;i<m_wheelInfo.size();i++)
     {
-        rayCast( i);
         if(m_wheelInfo[i].m_raycastInfo.m_isInContact)
             m_num_wheels_on_ground++;
     }
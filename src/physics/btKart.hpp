@@ -67,7 +67,7 @@ private:
     btScalar calcRollingFriction(btWheelContactPoint& contactPoint);
 
     btScalar            m_damping;
-    btVehicleRaycaster *m_vehicleRaycaster;
+    btKartRaycaster    *m_vehicleRaycaster;
 
     /** The zipper speed (i.e. the velocity the kart should reach in
      *  the first frame that the zipper is active). */
@@ -134,6 +134,11 @@ private:
 
     void     defaultInit();
     btScalar rayCast(btWheelInfo& wheel, const btVector3& ray);
+    void     rayCastAllWheels();
+    void     updateWheelContact(unsigned int index, btScalar raylen,
+                        const btVehicleRaycaster::btVehicleRaycasterResult
+                                                                 &rayResults,
+                                void *object);
 
 public:
 
@@ -144,13 +149,12 @@ public:
      *         (this is used to get access to the kart properties).
      */
                        btKart(btRigidBody* chassis,
-                              btVehicleRaycaster* raycaster,
+                              btKartRaycaster* raycaster,
                               Kart *kart);
      virtual          ~btKart();
     void               reset();
     void               debugDraw(btIDebugDraw* debugDrawer);
     const btTransform& getChassisWorldTransform() const;
-    btScalar           rayCast(unsigned int index);
     virtual void       updateVehicle(btScalar step);
     void               resetSuspension();
     btScalar           getSteeringValue(int wheel) const;
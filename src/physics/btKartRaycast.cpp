@@ -14,15 +14,18 @@
 
 #include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
 #include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "LinearMath/btAabbUtil2.h"
 
 #include "modes/world.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "tracks/track.hpp"
+#include "utils/log.hpp"
 
-void* btKartRaycaster::castRay(const btVector3& from, const btVector3& to,
-                               btVehicleRaycasterResult& result)
+// ============================================================================
+namespace
 {
-    // ========================================================================
+    /** A closest ray result callback that also stores the index of the
+     *  triangle that was hit. */
     class ClosestWithNormal : public btCollisionWorld::ClosestRayResultCallback
     {
     private:
@@ -55,46 +58,170 @@ void* btKartRaycaster::castRay(const btVector3& from, const btVector3& to,
         int getTriangleIndex() const { return m_triangle_index; }
 
     };   // CloestWithNormal
+
     // ========================================================================
+    /** Collects all collision objects whose broadphase bounding box overlaps
+     *  a given box. */
+    class CollectCandidates : public btBroadphaseAabbCallback
+    {
+    private:
+        btAlignedObjectArray<btCollisionObject*> *m_candidates;
+    public:
+        CollectCandidates(btAlignedObjectArray<btCollisionObject*> *c)
+            : m_candidates(c) {}
+        // --------------------------------------------------------------------
+        virtual bool process(const btBroadphaseProxy* proxy)
+        {
+            m_candidates->push_back((btCollisionObject*)proxy->m_clientObject);
+            return true;
+        }   // process
+    };   // CollectCandidates
+}   // anonymous namespace
 
+// ============================================================================
+unsigned int btKartRaycaster::m_num_rays               = 0;
+unsigned int btKartRaycaster::m_num_broadphase_queries = 0;
+
+// ----------------------------------------------------------------------------
+void* btKartRaycaster::castRay(const btVector3& from, const btVector3& to,
+                               btVehicleRaycasterResult& result)
+{
     ClosestWithNormal rayCallback(from,to);
 
     m_dynamicsWorld->rayTest(from, to, rayCallback);
+    m_num_rays++;
+    m_num_broadphase_queries++;
+
+    if (!rayCallback.hasHit())
+        return 0;
+    return processResult(rayCallback.m_collisionObject,
+                         rayCallback.m_hitPointWorld,
+                         rayCallback.m_hitNormalWorld,
+                         rayCallback.m_closestHitFraction,
+                         rayCallback.getTriangleIndex(), result);
+}   // castRay
 
-    if (rayCallback.hasHit())
+// ----------------------------------------------------------------------------
+/** Casts a batch of rays, e.g. all suspension rays of one kart. Instead of
+ *  traversing the broadphase once per ray, the broadphase is queried only
+ *  once with the bounding box of all rays, and each ray is then only tested
+ *  against the objects found that way whose bounding box it intersects.
+ *  The results are the same as calling castRay for each ray.
+ *  \param num_rays Number of rays.
+ *  \param from Start points of the rays.
+ *  \param to End points of the rays.
+ *  \param results Receives the hit information for each ray.
+ *  \param objects Receives for each ray the body hit, or NULL (same as the
+ *         return value of castRay).
+ */
+void btKartRaycaster::castRays(int num_rays, const btVector3 *from,
+                               const btVector3 *to,
+                               btVehicleRaycasterResult *results,
+                               void **objects)
+{
+    if (num_rays <= 0) return;
+
+    btVector3 aabb_min = from[0], aabb_max = from[0];
+    for (int i = 0; i < num_rays; i++)
     {
-        btRigidBody* body = btRigidBody::upcast(rayCallback.m_collisionObject);
-        if (body && body->hasContactResponse())
+        aabb_min.setMin(from[i]);
+        aabb_min.setMin(to[i]);
+        aabb_max.setMax(from[i]);
+        aabb_max.setMax(to[i]);
+    }
+
+    m_candidates.resize(0);
+    CollectCandidates collect(&m_candidates);
+    m_dynamicsWorld->getBroadphase()->aabbTest(aabb_min, aabb_max, collect);
+    m_num_broadphase_queries++;
+    m_num_rays += num_rays;
+
+    for (int i = 0; i < num_rays; i++)
+    {
+        btTransform from_trans, to_trans;
+        from_trans.setIdentity();
+        from_trans.setOrigin(from[i]);
+        to_trans.setIdentity();
+        to_trans.setOrigin(to[i]);
+
+        ClosestWithNormal rayCallback(from[i], to[i]);
+        for (int j = 0; j < m_candidates.size(); j++)
         {
-            result.m_hitPointInWorld = rayCallback.m_hitPointWorld;
-            result.m_hitNormalInWorld = rayCallback.m_hitNormalWorld;
-            result.m_hitNormalInWorld.normalize();
-            result.m_distFraction = rayCallback.m_closestHitFraction;
-            result.m_triangle_index = -1;
-            const TriangleMesh &tm =
-                World::getWorld()->getTrack()->getTriangleMesh();
-            if(m_smooth_normals &&
-                rayCallback.getTriangleIndex()>-1)
-            {
+            // Same early abort as in btCollisionWorld::rayTest
+            if (rayCallback.m_closestHitFraction == btScalar(0.f))
+                break;
+            btCollisionObject *object = m_candidates[j];
+            btBroadphaseProxy *proxy = object->getBroadphaseHandle();
+            if (!rayCallback.needsCollision(proxy))
+                continue;
+            btScalar param = 1.0f;
+            btVector3 normal;
+            if (!btRayAabb(from[i], to[i], proxy->m_aabbMin,
+                           proxy->m_aabbMax, param, normal))
+                continue;
+            btCollisionWorld::rayTestSingle(from_trans, to_trans, object,
+                                            object->getCollisionShape(),
+                                            object->getWorldTransform(),
+                                            rayCallback);
+        }   // for j < m_candidates.size()
+
+        objects[i] = rayCallback.hasHit()
+                   ? processResult(rayCallback.m_collisionObject,
+                                   rayCallback.m_hitPointWorld,
+                                   rayCallback.m_hitNormalWorld,
+                                   rayCallback.m_closestHitFraction,
+                                   rayCallback.getTriangleIndex(), results[i])
+                   : NULL;
+    }   // for i < num_rays
+}   // castRays
+
+// ----------------------------------------------------------------------------
+/** Converts the closest hit of a ray into a raycaster result, smoothing the
+ *  normal if supported by the track.
+ *  \return The body hit, or NULL if the object hit does not have a contact
+ *          response.
+ */
+void* btKartRaycaster::processResult(const btCollisionObject *object,
+                                     const btVector3 &hit_point,
+                                     const btVector3 &normal,
+                                     btScalar fraction, int triangle_index,
+                                     btVehicleRaycasterResult& result)
+{
+    const btRigidBody* body = btRigidBody::upcast(object);
+    if (!body || !body->hasContactResponse())
+        return 0;
+
+    result.m_hitPointInWorld = hit_point;
+    result.m_hitNormalInWorld = normal;
+    result.m_hitNormalInWorld.normalize();
+    result.m_distFraction = fraction;
+    result.m_triangle_index = -1;
+    const TriangleMesh &tm =
+        World::getWorld()->getTrack()->getTriangleMesh();
+    if(m_smooth_normals && triangle_index>-1)
+    {
 #undef DEBUG_NORMALS
 #ifdef DEBUG_NORMALS
-                btVector3 n=result.m_hitNormalInWorld;
+        btVector3 n=result.m_hitNormalInWorld;
 #endif
-                result.m_triangle_index = rayCallback.getTriangleIndex();
-                result.m_hitNormalInWorld =
-                    tm.getInterpolatedNormal(rayCallback.getTriangleIndex(),
-                                             result.m_hitPointInWorld);
+        result.m_triangle_index = triangle_index;
+        result.m_hitNormalInWorld =
+            tm.getInterpolatedNormal(triangle_index,
+                                     result.m_hitPointInWorld);
 #ifdef DEBUG_NORMALS
-                printf("old %f %f %f new %f %f %f\n",
-                    n.getX(), n.getY(), n.getZ(),
-                    result.m_hitNormalInWorld.getX(),
-                    result.m_hitNormalInWorld.getY(),
-                    result.m_hitNormalInWorld.getZ());
+        printf("old %f %f %f new %f %f %f\n",
+            n.getX(), n.getY(), n.getZ(),
+            result.m_hitNormalInWorld.getX(),
+            result.m_hitNormalInWorld.getY(),
+            result.m_hitNormalInWorld.getZ());
 #endif
-            }
-            return body;
-        }
     }
-    return 0;
-}
+    return (void*)body;
+}   // processResult
 
+// ----------------------------------------------------------------------------
+void btKartRaycaster::printStatistics()
+{
+    Log::verbose("btKartRaycaster", "%u rays cast with %u broadphase "
+                 "queries.", m_num_rays, m_num_broadphase_queries);
+}   // printStatistics
@@ -20,6 +20,8 @@ class btDynamicsWorld;
 #include "BulletDynamics/Dynamics/btActionInterface.h"
 
 
+class btCollisionObject;
+
 class btKartRaycaster : public btVehicleRaycaster
 {
 private:
@@ -27,6 +29,21 @@ private:
     /** True if the normals should be smoothed. Not all tracks support this,
     *  so this flag is set depending on track when constructing this object. */
     bool                m_smooth_normals;
+
+    /** All collision objects whose bounding box overlaps the bounding box
+     *  of the current batch of rays. Kept as a member to avoid allocations
+     *  in each physics step. */
+    btAlignedObjectArray<btCollisionObject*> m_candidates;
+
+    /** Number of rays cast (for statistics only). */
+    static unsigned int m_num_rays;
+    /** Number of broadphase queries done (for statistics only). */
+    static unsigned int m_num_broadphase_queries;
+
+    void* processResult(const btCollisionObject *object,
+                        const btVector3 &hit_point, const btVector3 &normal,
+                        btScalar fraction, int triangle_index,
+                        btVehicleRaycasterResult& result);
 public:
     btKartRaycaster(btDynamicsWorld* world, bool smooth_normals=false)
         :m_dynamicsWorld(world), m_smooth_normals(smooth_normals)
@@ -35,7 +52,18 @@ public:
 
     virtual void* castRay(const btVector3& from,const btVector3& to,
                           btVehicleRaycasterResult& result);
-
+    void          castRays(int num_rays, const btVector3 *from,
+                           const btVector3 *to,
+                           btVehicleRaycasterResult *results,
+                           void **objects);
+    static void   printStatistics();
+    // ------------------------------------------------------------------------
+    /** Resets the ray statistics. */
+    static void   resetStatistics()
+    {
+        m_num_rays               = 0;
+        m_num_broadphase_queries = 0;
+    }   // resetStatistics
 };
 
 
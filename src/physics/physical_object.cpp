@@ -144,6 +144,9 @@ PhysicalObject::PhysicalObject(bool is_dynamic,
     m_explode_kart       = false;
     m_flatten_kart       = false;
     m_triangle_mesh      = NULL;
+    m_was_active         = true;
+    m_is_frozen          = false;
+    m_frozen_while_active = false;
 
     m_object             = object;
     m_init_xyz           = object->getAbsoluteCenterPosition();
@@ -551,6 +554,12 @@ void PhysicalObject::update(float dt)
 {
     if (!m_is_dynamic) return;
 
+    // A sleeping (or frozen) body does not move. The first update after
+    // the body went to sleep is still done to get its final position.
+    const bool is_active = m_body->isActive();
+    if (!is_active && !m_was_active) return;
+    m_was_active = is_active;
+
     btTransform t;
     m_motion_state->getWorldTransform(t);
 
@@ -610,9 +619,37 @@ void PhysicalObject::reset()
     m_body->setCenterOfMassTransform(m_init_pos);
     m_body->setAngularVelocity(btVector3(0,0,0));
     m_body->setLinearVelocity(btVector3(0,0,0));
+    setFrozen(false);
     m_body->activate();
+    m_was_active = true;
 }   // reset
 
+// ----------------------------------------------------------------------------
+/** Freezes or unfreezes a dynamic body. A frozen body is not simulated by
+ *  bullet at all (it still acts as an obstacle), which is used for objects
+ *  that are far away from all karts. When unfrozen, the body continues to
+ *  move if it was moving before, or stays asleep otherwise.
+ *  \param frozen True to freeze the body, false to unfreeze it.
+ */
+void PhysicalObject::setFrozen(bool frozen)
+{
+    if (!m_is_dynamic || frozen == m_is_frozen) return;
+
+    m_is_frozen = frozen;
+    if (frozen)
+    {
+        m_frozen_while_active = m_body->isActive();
+        m_body->forceActivationState(DISABLE_SIMULATION);
+    }
+    else if (m_frozen_while_active)
+    {
+        m_body->forceActivationState(ACTIVE_TAG);
+        m_body->setDeactivationTime(0.0f);
+    }
+    else
+        m_body->forceActivationState(ISLAND_SLEEPING);
+}   // setFrozen
+
 // ----------------------------------------------------------------------------
 void PhysicalObject::handleExplosion(const Vec3& pos, bool direct_hit)
 {
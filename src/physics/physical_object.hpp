@@ -181,6 +181,17 @@ private:
     /** Non-null only if the shape is exact */
     TriangleMesh         *m_triangle_mesh;
 
+    /** True if the body was active in the last update. A sleeping body
+     *  does not move, so its graphical position needs no updates. */
+    bool                  m_was_active;
+
+    /** True if the body is frozen because no kart is close to it. */
+    bool                  m_is_frozen;
+
+    /** True if the body was active when it was frozen, so that it can
+     *  continue moving once it is unfrozen. */
+    bool                  m_frozen_while_active;
+
 public:
                     PhysicalObject(bool is_dynamic, const Settings& settings,
                                    TrackObject* object);
@@ -192,6 +203,7 @@ public:
     virtual void reset          ();
     virtual void handleExplosion(const Vec3& pos, bool directHit);
     void         update         (float dt);
+    void         setFrozen      (bool frozen);
     void         init           (const Settings &settings);
     void         move           (const Vec3& xyz, const core::vector3df& hpr);
     void         hit            (const Material *m, const Vec3 &normal);
@@ -209,6 +221,18 @@ public:
     /** Returns the rigid body of this physical object. */
     btRigidBody *getBody        ()          { return m_body; }
     // ------------------------------------------------------------------------
+    /** Returns the rigid body of this physical object. */
+    const btRigidBody *getBody  () const    { return m_body; }
+    // ------------------------------------------------------------------------
+    /** Returns the collision shape type of this object. */
+    BodyTypes getBodyType() const { return m_body_type; }
+    // ------------------------------------------------------------------------
+    /** Returns true if this object is simulated by bullet. */
+    bool isDynamic() const { return m_is_dynamic; }
+    // ------------------------------------------------------------------------
+    /** Returns true if this object is frozen because no kart is close. */
+    bool isFrozen() const { return m_is_frozen; }
+    // ------------------------------------------------------------------------
     /** Returns true if this object should trigger a rescue in a kart that
      *  hits it. */
     bool isCrashReset() const { return m_crash_reset; }
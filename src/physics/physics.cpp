@@ -22,6 +22,7 @@
 #include "animations/three_d_animation.hpp"
 #include "config/player_manager.hpp"
 #include "config/player_profile.hpp"
+#include "config/stk_config.hpp"
 #include "karts/abstract_kart.hpp"
 #include "graphics/irr_driver.hpp"
 #include "graphics/stars.hpp"
@@ -150,9 +151,11 @@ void Physics::update(float dt)
     // of objects.
     m_all_collisions.clear();
 
-    // Maximum of three substeps. This will work for framerate down to
-    // 20 FPS (bullet default frequency is 60 HZ).
-    m_dynamics_world->stepSimulation(dt, 3);
+    // Bullet uses a fixed internal step size of one tick. In network races
+    // dt is exactly one tick, otherwise dt is the frame time, and bullet
+    // interpolates the transforms between its substeps (at most three
+    // substeps, which works for frame rates down to 20 FPS at 60 ticks).
+    m_dynamics_world->stepSimulation(dt, 3, stk_config->ticks2Time(1));
 
     // Now handle the actual collision. Note: flyables can not be removed
     // inside of this loop, since the same flyables might hit more than one
@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 
+#include "config/stk_config.hpp"
 #include "io/file_manager.hpp"
 #include "modes/world.hpp"
 #include "karts/abstract_kart.hpp"
@@ -123,7 +124,7 @@ float History::updateReplayAndGetDT()
         // replay it with history, for debugging only
 #undef DO_REWIND_AT_END_OF_HISTORY
 #ifdef DO_REWIND_AT_END_OF_HISTORY
-        RewindManager::get()->rewindTo(5.0f);
+        RewindManager::get()->rewindTo(stk_config->time2Ticks(5.0f));
         exit(-1);
 #else
         // Note that for physics replay all physics parameters
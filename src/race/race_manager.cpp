@@ -73,6 +73,7 @@ RaceManager::RaceManager()
     m_ai_superpower      = SUPERPOWER_NONE;
     m_track_number       = 0;
     m_coin_target        = 0;
+    m_random_seed        = 0;
     m_started_from_overworld = false;
     m_have_kart_last_position_on_overworld = false;
     setMaxGoal(0);
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <stdlib.h>
 #include <string>
 
 #include "network/remote_kart_info.hpp"
@@ -334,6 +335,11 @@ private:
     unsigned int                     m_num_finished_karts;
     unsigned int                     m_num_finished_players;
     int                              m_coin_target;
+
+    /** Seed of the random number streams of each race (see
+     *  RandomGenerator::seedForRace), 0 if a new seed is chosen for each
+     *  race. */
+    unsigned int                     m_random_seed;
     float                            m_time_target;
     int                              m_goal_target;
 
@@ -609,6 +615,17 @@ public:
     // ------------------------------------------------------------------------
     int getCoinTarget() const { return m_coin_target; }
     // ------------------------------------------------------------------------
+    /** Sets the seed of the random numbers used in each race, 0 to use a
+     *  new seed for each race. */
+    void setRandomSeed(unsigned int seed) { m_random_seed = seed; }
+    // ------------------------------------------------------------------------
+    /** Returns the seed for the random numbers of the next race. If no
+     *  seed was set, a new one is chosen. */
+    unsigned int getRandomSeed() const
+    {
+        return m_random_seed != 0 ? m_random_seed : (unsigned int)rand();
+    }   // getRandomSeed
+    // ------------------------------------------------------------------------
     float getTimeTarget() const { return m_time_target; }
     // ------------------------------------------------------------------------
     int getTrackNumber() const { return m_track_number; }
@@ -62,7 +62,9 @@ namespace Scripting
         }*/
 
         /**
-          * Get a track object by ID.
+          * Get a track object by ID. The lookup uses a hash table, but
+          * scripts that use an object in each update should still get it
+          * once (e.g. in onStart) and keep the handle.
           * @return An object of type @ref Scripting_TrackObject
           */
         ::TrackObject* getTrackObject(std::string* libraryInstance, std::string* objID)
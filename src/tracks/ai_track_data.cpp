@@ -0,0 +1,78 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "tracks/ai_track_data.hpp"
+
+#include "tracks/drive_graph.hpp"
+
+// ----------------------------------------------------------------------------
+/** Copies the AI relevant data of all nodes. This must be called after the
+ *  direction data of the graph was computed.
+ *  \param graph The drive graph.
+ */
+AITrackData::AITrackData(const DriveGraph *graph)
+{
+    const unsigned int num_nodes = graph->getNumNodes();
+    m_center.resize(3*num_nodes);
+    m_path_width.resize(num_nodes);
+    m_first_successor.resize(num_nodes+1);
+
+    for (unsigned int n = 0; n < num_nodes; n++)
+    {
+        const DriveNode *dn = graph->getNode(n);
+        for (unsigned int i = 0; i < 3; i++)
+            m_center[3*n+i] = dn->getCenter()[i];
+        m_path_width[n] = dn->getPathWidth();
+
+        m_first_successor[n] = (int)m_successor.size();
+        for (unsigned int i = 0; i < dn->getNumberOfSuccessors(); i++)
+        {
+            const unsigned int succ = dn->getSuccessor(i);
+            m_successor.push_back(succ);
+            m_angle_to_next.push_back(dn->getAngleToSuccessor(i));
+
+            Vec3 direction = graph->getNode(succ)->getCenter()
+                           - dn->getCenter();
+            const float length = direction.length();
+            if (length > 0)
+                direction /= length;
+            m_direction_to_next.push_back(direction.getX());
+            m_direction_to_next.push_back(direction.getY());
+            m_direction_to_next.push_back(direction.getZ());
+
+            DriveNode::DirectionType dir;
+            unsigned int last;
+            dn->getDirectionData(i, &dir, &last);
+            m_direction.push_back((unsigned char)dir);
+            m_last_index_same_direction.push_back(last);
+        }
+    }
+    m_first_successor[num_nodes] = (int)m_successor.size();
+}   // AITrackData
+
+// ----------------------------------------------------------------------------
+/** Returns the memory used by this object in bytes. */
+size_t AITrackData::getMemoryUsage() const
+{
+    return sizeof(*this)
+         + (m_center.size() + m_path_width.size() + m_angle_to_next.size()
+            + m_direction_to_next.size()) * sizeof(float)
+         + (m_first_successor.size() + m_successor.size()
+            + m_last_index_same_direction.size()) * sizeof(int)
+         + m_direction.size();
+}   // getMemoryUsage
@@ -0,0 +1,113 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_AI_TRACK_DATA_HPP
+#define HEADER_AI_TRACK_DATA_HPP
+
+#include "tracks/drive_node.hpp"
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <vector>
+
+class DriveGraph;
+
+/**
+ *  \brief Tables of the drive graph data the AI needs every frame.
+ *  The lap AI determines the direction of the track ahead and the point
+ *  to aim at each frame by following successors from its current node.
+ *  All the data it looks at on the way (successors, angles, direction of
+ *  the track ahead, centers and widths of the nodes) only depends on the
+ *  track, so it is stored here once per drive graph in contiguous arrays,
+ *  indexed by node (and successor), instead of being fetched from the
+ *  drive nodes. The data is created when the drive graph is loaded, and
+ *  is kept together with the graph in the TrackDataCache.
+ * \ingroup tracks
+ */
+class AITrackData : public NoCopy
+{
+private:
+    /** Center (3 entries per node) of each node. */
+    std::vector<float> m_center;
+
+    /** Width of the path of each node. */
+    std::vector<float> m_path_width;
+
+    /** Index of the first successor entry of each node, with an additional
+     *  entry at the end, so node n has the successor entries from
+     *  m_first_successor[n] to m_first_successor[n+1]-1. */
+    std::vector<int> m_first_successor;
+
+    /** Node index of each successor entry. */
+    std::vector<int> m_successor;
+
+    /** Angle from a node to each of its successors. */
+    std::vector<float> m_angle_to_next;
+
+    /** Unit vector (3 entries per successor entry) from the center of a
+     *  node to the center of each successor. */
+    std::vector<float> m_direction_to_next;
+
+    /** Direction of the track when following each successor. */
+    std::vector<unsigned char> m_direction;
+
+    /** Last node with the same direction when following each successor. */
+    std::vector<unsigned int> m_last_index_same_direction;
+
+public:
+         AITrackData(const DriveGraph *graph);
+    size_t getMemoryUsage() const;
+    // ------------------------------------------------------------------------
+    /** Returns the center of node n. */
+    Vec3 getCenter(int n) const
+    {
+        return Vec3(m_center[3*n], m_center[3*n+1], m_center[3*n+2]);
+    }   // getCenter
+    // ------------------------------------------------------------------------
+    /** Returns the width of the path of node n. */
+    float getPathWidth(int n) const               { return m_path_width[n]; }
+    // ------------------------------------------------------------------------
+    /** Returns the node index of the i-th successor of node n. */
+    int getSuccessor(int n, int i) const
+                           { return m_successor[m_first_successor[n] + i]; }
+    // ------------------------------------------------------------------------
+    /** Returns the angle from node n to its i-th successor. */
+    float getAngleToNext(int n, int i) const
+                       { return m_angle_to_next[m_first_successor[n] + i]; }
+    // ------------------------------------------------------------------------
+    /** Returns a unit vector from the center of node n to the center of its
+     *  i-th successor. */
+    Vec3 getDirectionToNext(int n, int i) const
+    {
+        const int k = 3*(m_first_successor[n] + i);
+        return Vec3(m_direction_to_next[k], m_direction_to_next[k+1],
+                    m_direction_to_next[k+2]);
+    }   // getDirectionToNext
+    // ------------------------------------------------------------------------
+    /** Returns the direction of the track when going from node n to its
+     *  i-th successor, and the last node that has the same direction. */
+    void getDirectionData(int n, int i, DriveNode::DirectionType *dir,
+                          unsigned int *last) const
+    {
+        const int k = m_first_successor[n] + i;
+        *dir  = (DriveNode::DirectionType)m_direction[k];
+        *last = m_last_index_same_direction[k];
+    }   // getDirectionData
+};   // AITrackData
+
+#endif
@@ -74,6 +74,13 @@ public:
     // ------------------------------------------------------------------------
     virtual ~ArenaGraph() {}
     // ------------------------------------------------------------------------
+    virtual size_t getMemoryUsage() const OVERRIDE
+    {
+        const size_t n = getNumNodes();
+        return Graph::getMemoryUsage()
+             + n * n * (sizeof(float) + sizeof(int16_t));
+    }   // getMemoryUsage
+    // ------------------------------------------------------------------------
     ArenaNode* getNode(unsigned int i) const;
     // ------------------------------------------------------------------------
     /** Returns the next node on the shortest path from i to j.
@@ -78,6 +78,18 @@ public:
         }
         return true;
     }
+    // ------------------------------------------------------------------------
+    /** Returns the plane of the i-th face of the box in the form used by
+     *  pointInside: a point p is on the side normal.dot(p) - offset.
+     *  \param i Index of the face (0 to 5).
+     *  \param normal On return the (not normalised) normal of the face.
+     *  \param offset On return the offset of the plane. */
+    void getFacePlane(unsigned int i, Vec3 *normal, float *offset) const
+    {
+        const Vec3 &p0 = m_box_faces[i][0];
+        *normal = (m_box_faces[i][1] - p0).cross(m_box_faces[i][2] - p0);
+        *offset = normal->dot(p0);
+    }   // getFacePlane
 
 };
 
@@ -0,0 +1,250 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "tracks/compact_drive_graph.hpp"
+
+#include "tracks/bounding_box_3d.hpp"
+#include "tracks/drive_graph.hpp"
+#include "tracks/drive_node.hpp"
+#include "tracks/drive_node_3d.hpp"
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------
+/** Copies the data of all nodes of the drive graph. The graph must be
+ *  completely loaded (including the distances from start).
+ *  \param graph The drive graph.
+ */
+CompactDriveGraph::CompactDriveGraph(const DriveGraph *graph)
+{
+    m_num_nodes = graph->getNumNodes();
+    m_corner_x.resize(4*m_num_nodes);
+    m_corner_z.resize(4*m_num_nodes);
+    m_min_height.resize(m_num_nodes);
+    m_max_height.resize(m_num_nodes);
+    m_line_start.resize(3*m_num_nodes);
+    m_line_dir.resize(3*m_num_nodes);
+    m_line_length.resize(m_num_nodes);
+    m_normal.resize(3*m_num_nodes);
+    m_distance_from_start.resize(m_num_nodes);
+    m_flags.resize(m_num_nodes);
+    m_box_index.resize(m_num_nodes);
+    m_first_successor.resize(m_num_nodes+1);
+
+    for (unsigned int n = 0; n < m_num_nodes; n++)
+    {
+        const DriveNode *dn = graph->getNode(n);
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            m_corner_x[4*n+i] = (*dn)[i].getX();
+            m_corner_z[4*n+i] = (*dn)[i].getZ();
+        }
+        m_min_height[n]          = dn->getMinHeight();
+        m_max_height[n]          = dn->getMaxHeight();
+        m_distance_from_start[n] = dn->getDistanceFromStart();
+        for (unsigned int i = 0; i < 3; i++)
+            m_normal[3*n+i] = dn->getNormal()[i];
+
+        m_flags[n] = 0;
+        if (dn->isIgnored()) m_flags[n] |= NF_IGNORED;
+
+        // DriveNode2D uses a 2d line from the upper to the lower center,
+        // DriveNode3D a 3d line from the lower to the upper center.
+        Vec3 start, end;
+        if (dn->is3DQuad())
+        {
+            m_flags[n] |= NF_3D;
+            start = dn->getLowerCenter();
+            end   = dn->getUpperCenter();
+        }
+        else
+        {
+            start = dn->getUpperCenter();
+            end   = dn->getLowerCenter();
+            start.setY(0);
+            end.setY(0);
+        }
+        Vec3 dir = end - start;
+        const float length = dir.length();
+        if (length > 0)
+            dir /= length;
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            m_line_start[3*n+i] = start[i];
+            m_line_dir[3*n+i]   = dir[i];
+        }
+        m_line_length[n] = length;
+
+        const DriveNode3D *dn3d = dynamic_cast<const DriveNode3D*>(dn);
+        if (dn3d)
+        {
+            m_box_index[n] = (int)m_box_planes.size();
+            for (unsigned int i = 0; i < 6; i++)
+            {
+                Vec3 normal;
+                float offset;
+                dn3d->getFacePlane(i, &normal, &offset);
+                m_box_planes.push_back(normal.getX());
+                m_box_planes.push_back(normal.getY());
+                m_box_planes.push_back(normal.getZ());
+                m_box_planes.push_back(offset);
+            }
+        }
+        else
+            m_box_index[n] = -1;
+
+        m_first_successor[n] = (int)m_successors.size();
+        for (unsigned int i = 0; i < dn->getNumberOfSuccessors(); i++)
+            m_successors.push_back(dn->getSuccessor(i));
+    }
+    m_first_successor[m_num_nodes] = (int)m_successors.size();
+}   // CompactDriveGraph
+
+// ----------------------------------------------------------------------------
+/** Returns true if a point is inside of node n, see Quad::pointInside and
+ *  BoundingBox3D::pointInside.
+ *  \param n Index of the node.
+ *  \param xyz The point to test.
+ *  \param ignore_vertical If the height test should be skipped (2d only).
+ */
+bool CompactDriveGraph::pointInside(int n, const Vec3 &xyz,
+                                    bool ignore_vertical) const
+{
+    const float x = xyz.getX(), y = xyz.getY(), z = xyz.getZ();
+    if (m_box_index[n] >= 0)
+    {
+        const float *plane = &m_box_planes[m_box_index[n]];
+        const float side = plane[0]*x + plane[1]*y + plane[2]*z - plane[3];
+        for (unsigned int i = 1; i < 6; i++)
+        {
+            plane += 4;
+            if (side * (plane[0]*x + plane[1]*y + plane[2]*z - plane[3]) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    if (!ignore_vertical                  &&
+        (y - m_max_height[n] >  5.0f ||
+         y - m_min_height[n] < -1.0f    )   )
+        return false;
+
+    // Same as Vec3::sideOfLine2D, see Quad::pointInside for the details.
+    const float *cx = &m_corner_x[4*n];
+    const float *cz = &m_corner_z[4*n];
+#define SIDE(a, b) ((cx[b]-cx[a])*(z-cz[a]) - (cz[b]-cz[a])*(x-cx[a]))
+    if (SIDE(0, 2) < 0)
+        return SIDE(0, 1) >= 0.0f && SIDE(1, 2) >= 0.0f;
+    else
+        return SIDE(2, 3) >  0.0f && SIDE(3, 0) >= 0.0f;
+#undef SIDE
+}   // pointInside
+
+// ----------------------------------------------------------------------------
+/** Returns the square of the distance between a point and the center line
+ *  of node n (in 2d for 2d nodes), see DriveNode2D::getDistance2FromPoint.
+ *  \param n Index of the node.
+ *  \param xyz The point.
+ */
+float CompactDriveGraph::getDistance2FromPoint(int n, const Vec3 &xyz) const
+{
+    const float *start = &m_line_start[3*n];
+    const float *dir   = &m_line_dir[3*n];
+    const float cy     = is3D(n) ? xyz.getY() - start[1] : 0.0f;
+    const float cx     = xyz.getX() - start[0];
+    const float cz     = xyz.getZ() - start[2];
+    float t = cx*dir[0] + cy*dir[1] + cz*dir[2];
+    if (t < 0)
+        t = 0;
+    else if (t > m_line_length[n])
+        t = m_line_length[n];
+    const float dx = cx - t*dir[0];
+    const float dy = cy - t*dir[1];
+    const float dz = cz - t*dir[2];
+    return dx*dx + dy*dy + dz*dz;
+}   // getDistance2FromPoint
+
+// ----------------------------------------------------------------------------
+/** Returns the distance a point has from node n in forward and sidewards
+ *  direction, see DriveNode2D::getDistances and DriveNode3D::getDistances.
+ *  \param n Index of the node.
+ *  \param xyz The coordinates of the point.
+ *  \param result The X coordinate contains the sidewards distance, the
+ *                Z coordinate the forward distance.
+ */
+void CompactDriveGraph::getDistances(int n, const Vec3 &xyz,
+                                     Vec3 *result) const
+{
+    const float *start  = &m_line_start[3*n];
+    const float *dir    = &m_line_dir[3*n];
+    const float  length = m_line_length[n];
+    const bool   is_3d  = is3D(n);
+    const float cx = xyz.getX() - start[0];
+    const float cy = is_3d ? xyz.getY() - start[1] : 0.0f;
+    const float cz = xyz.getZ() - start[2];
+    float t = cx*dir[0] + cy*dir[1] + cz*dir[2];
+    if (t < 0)
+        t = 0;
+    else if (t > length)
+        t = length;
+    // Vector from the closest point on the line to xyz
+    const float dx = cx - t*dir[0];
+    const float dy = cy - t*dir[1];
+    const float dz = cz - t*dir[2];
+    const float side_distance = sqrtf(dx*dx + dy*dy + dz*dz);
+
+    bool right;
+    if (is_3d)
+    {
+        // Same as xyz.sideofPlane(closest, closest+normal, end): the
+        // plane normal is normal x (end-closest), which points in the
+        // direction of normal x dir.
+        const float *normal = &m_normal[3*n];
+        const float rest = length - t;
+        const float px = (normal[1]*dir[2] - normal[2]*dir[1])*rest;
+        const float py = (normal[2]*dir[0] - normal[0]*dir[2])*rest;
+        const float pz = (normal[0]*dir[1] - normal[1]*dir[0])*rest;
+        right = px*dx + py*dy + pz*dz < 0;
+    }
+    else
+    {
+        // Same as line2df::getPointOrientation, the line goes from the
+        // upper to the lower center.
+        right = dir[0]*cz - cx*dir[2] > 0;
+    }
+    result->setX(right ? side_distance : -side_distance);
+
+    // For 2d nodes the line starts at the upper center, so the distance
+    // from the lower center is the remaining part of the line.
+    result->setZ(m_distance_from_start[n] + (is_3d ? t : length - t));
+}   // getDistances
+
+// ----------------------------------------------------------------------------
+/** Returns the memory used by this object in bytes. */
+size_t CompactDriveGraph::getMemoryUsage() const
+{
+    return sizeof(*this)
+         + (m_corner_x.size() + m_corner_z.size() + m_min_height.size()
+            + m_max_height.size() + m_line_start.size() + m_line_dir.size()
+            + m_line_length.size() + m_normal.size()
+            + m_distance_from_start.size() + m_box_planes.size())
+           * sizeof(float)
+         + m_flags.size()
+         + (m_box_index.size() + m_first_successor.size()
+            + m_successors.size()) * sizeof(int);
+}   // getMemoryUsage
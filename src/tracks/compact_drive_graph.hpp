@@ -0,0 +1,127 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_COMPACT_DRIVE_GRAPH_HPP
+#define HEADER_COMPACT_DRIVE_GRAPH_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <vector>
+
+class DriveGraph;
+
+/**
+ *  \brief A copy of the data of all drive nodes that is needed to find the
+ *  node a point is on, stored as a structure of arrays.
+ *  The drive nodes themselves are separately allocated objects with virtual
+ *  functions, so searching all of them (which happens for each kart and
+ *  each AI lookahead point every frame) jumps all over memory. This class
+ *  stores the same data in a few contiguous arrays, indexed by node index,
+ *  and implements the same tests as DriveNode2D and DriveNode3D. It is
+ *  created once the drive graph is completely loaded, and is read only
+ *  afterwards.
+ * \ingroup tracks
+ */
+class CompactDriveGraph : public NoCopy
+{
+private:
+    /** Number of nodes. */
+    unsigned int m_num_nodes;
+
+    /** X and Z coordinates of the four corners of each node (4 entries per
+     *  node), used in the 2d point inside test. */
+    std::vector<float> m_corner_x;
+    std::vector<float> m_corner_z;
+
+    /** Minimum and maximum height of each node. */
+    std::vector<float> m_min_height;
+    std::vector<float> m_max_height;
+
+    /** Start point (3 entries per node) of the center line of each node.
+     *  For 2d nodes this is the upper center (which is what DriveNode2D
+     *  uses), for 3d nodes the lower center. */
+    std::vector<float> m_line_start;
+
+    /** Unit direction (3 entries per node) of the center line. */
+    std::vector<float> m_line_dir;
+
+    /** Length of the center line of each node. */
+    std::vector<float> m_line_length;
+
+    /** Normal (3 entries per node) of each node. */
+    std::vector<float> m_normal;
+
+    /** Distance from start to the beginning of each node. */
+    std::vector<float> m_distance_from_start;
+
+    /** Flags for each node, see NodeFlags. */
+    std::vector<unsigned char> m_flags;
+
+    /** For 3d nodes the index of its six planes in m_box_planes, -1 for
+     *  2d nodes. */
+    std::vector<int> m_box_index;
+
+    /** Normal and offset of the six planes of the bounding box of each 3d
+     *  node (4 entries per plane). */
+    std::vector<float> m_box_planes;
+
+    /** Index of the first successor of each node in m_successors, with an
+     *  additional entry at the end, so node n has the successors from
+     *  m_first_successor[n] to m_first_successor[n+1]-1. */
+    std::vector<int> m_first_successor;
+
+    /** Successor indices of all nodes. */
+    std::vector<int> m_successors;
+
+    enum NodeFlags { NF_3D = 1, NF_IGNORED = 2 };
+
+public:
+         CompactDriveGraph(const DriveGraph *graph);
+    bool pointInside(int n, const Vec3 &xyz, bool ignore_vertical) const;
+    float getDistance2FromPoint(int n, const Vec3 &xyz) const;
+    void getDistances(int n, const Vec3 &xyz, Vec3 *result) const;
+    size_t getMemoryUsage() const;
+    // ------------------------------------------------------------------------
+    /** Returns the number of nodes. */
+    unsigned int getNumNodes() const                  { return m_num_nodes; }
+    // ------------------------------------------------------------------------
+    /** Returns true if node n is a 3d node. */
+    bool is3D(int n) const                 { return (m_flags[n] & NF_3D)!=0; }
+    // ------------------------------------------------------------------------
+    /** Returns true if node n should be ignored (e.g. it is only used in
+     *  the other driving direction). */
+    bool isIgnored(int n) const       { return (m_flags[n] & NF_IGNORED)!=0; }
+    // ------------------------------------------------------------------------
+    /** Returns the minimum height of node n. */
+    float getMinHeight(int n) const               { return m_min_height[n]; }
+    // ------------------------------------------------------------------------
+    /** Returns the distance from start to the beginning of node n. */
+    float getDistanceFromStart(int n) const
+                                         { return m_distance_from_start[n]; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of successors of node n. */
+    int getNumberOfSuccessors(int n) const
+                   { return m_first_successor[n+1] - m_first_successor[n]; }
+    // ------------------------------------------------------------------------
+    /** Returns the i-th successor of node n. */
+    int getSuccessor(int n, int i) const
+                          { return m_successors[m_first_successor[n] + i]; }
+};   // CompactDriveGraph
+
+#endif
@@ -22,10 +22,13 @@
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "modes/world.hpp"
+#include "tracks/ai_track_data.hpp"
 #include "tracks/check_lap.hpp"
 #include "tracks/check_line.hpp"
 #include "tracks/check_manager.hpp"
+#include "tracks/compact_drive_graph.hpp"
 #include "tracks/drive_node.hpp"
+#include "tracks/rubber_ball_path.hpp"
 #include "tracks/track.hpp"
 
 // ----------------------------------------------------------------------------
@@ -40,10 +43,19 @@ DriveGraph::DriveGraph(const std::string &quad_file_name,
 {
     m_lap_length    = 0;
     m_quad_filename = quad_file_name;
+    m_ai_data       = NULL;
+    m_rubber_ball_path = NULL;
     Graph::setGraph(this);
     load(quad_file_name, graph_file_name);
 }   // DriveGraph
 
+// ----------------------------------------------------------------------------
+DriveGraph::~DriveGraph()
+{
+    delete m_ai_data;
+    delete m_rubber_ball_path;
+}   // ~DriveGraph
+
 // ----------------------------------------------------------------------------
 void DriveGraph::addSuccessor(unsigned int from, unsigned int to)
 {
@@ -163,6 +175,8 @@ void DriveGraph::load(const std::string &quad_file_name,
             m_lap_length = 10.0f;
         }
 
+        m_compact_graph = new CompactDriveGraph(this);
+        m_ai_data       = new AITrackData(this);
         return;
     }
 
@@ -242,6 +256,10 @@ void DriveGraph::load(const std::string &quad_file_name,
 
     loadBoundingBoxNodes();
 
+    // All node data is known now, so the compact copy used by the frequent
+    // queries can be created.
+    m_compact_graph = new CompactDriveGraph(this);
+    m_ai_data       = new AITrackData(this);
 }   // load
 
 // ----------------------------------------------------------------------------
@@ -258,10 +276,14 @@ unsigned int DriveGraph::getStartNode() const
 }   // getStartNode
 
 // ----------------------------------------------------------------------------
-/** Sets the checkline requirements for all nodes in the graph.
+/** Sets the checkline requirements for all nodes in the graph. Existing
+ *  requirements are removed first, since a graph taken from the
+ *  TrackDataCache still has the requirements of its previous race.
  */
 void DriveGraph::computeChecklineRequirements()
 {
+    for (unsigned int i = 0; i < getNumNodes(); i++)
+        getNode(i)->clearChecklineRequirements();
     computeChecklineRequirements(getNode(0),
                                  CheckManager::get()->getLapLineIndex());
 }   // computeChecklineRequirements
@@ -304,6 +326,29 @@ void DriveGraph::computeChecklineRequirements(DriveNode* node,
     }
 }   // computeChecklineRequirements
 
+// ----------------------------------------------------------------------------
+/** Returns an estimate of the memory used by this graph in bytes. Nodes with
+ *  more than one successor also store the path to every other node.
+ */
+size_t DriveGraph::getMemoryUsage() const
+{
+    size_t memory = Graph::getMemoryUsage();
+    const unsigned int num_nodes = getNumNodes();
+    for (unsigned int i = 0; i < num_nodes; i++)
+    {
+        const DriveNode *dn = getNode(i);
+        const unsigned int num_succ = dn->getNumberOfSuccessors();
+        memory += num_succ * (2 * sizeof(int) + 2 * sizeof(float));
+        if (num_succ > 1)
+            memory += num_nodes * sizeof(int);
+    }
+    if (m_ai_data)
+        memory += m_ai_data->getMemoryUsage();
+    if (m_rubber_ball_path)
+        memory += m_rubber_ball_path->getMemoryUsage();
+    return memory;
+}   // getMemoryUsage
+
 // ----------------------------------------------------------------------------
 /** This function defines the "path-to-nodes" for each graph node that has
  *  more than one successor. The path-to-nodes indicates which successor to
@@ -326,6 +371,23 @@ void DriveGraph::setupPaths()
     }
 }   // setupPaths
 
+// -----------------------------------------------------------------------------
+/** Creates the tables used by rubber balls, if they do not exist yet (a
+ *  graph taken from the TrackDataCache still has them). This must be
+ *  called after setupPaths, and once the physics of the track exists.
+ *  \param mesh The triangle mesh of the track.
+ *  \param min_distance Minimum distance between control points of a ball.
+ */
+void DriveGraph::createRubberBallPath(const TriangleMesh &mesh,
+                                      float min_distance)
+{
+    if (m_rubber_ball_path &&
+        m_rubber_ball_path->getMinDistance() == min_distance)
+        return;
+    delete m_rubber_ball_path;
+    m_rubber_ball_path = new RubberBallPath(this, mesh, min_distance);
+}   // createRubberBallPath
+
 // -----------------------------------------------------------------------------
 /** This function sets a default successor for all graph nodes that currently
  *  don't have a successor defined. The default successor of node X is X+1.
@@ -663,7 +725,11 @@ void DriveGraph::spatialToTrack(Vec3 *dst, const Vec3& xyz,
         return;
     }
 
-    getNode(sector)->getDistances(xyz, dst);
+    const CompactDriveGraph *cg = getCompactGraph();
+    if (cg)
+        cg->getDistances(sector, xyz, dst);
+    else
+        getNode(sector)->getDistances(xyz, dst);
 }   // spatialToTrack
 
 //-----------------------------------------------------------------------------
@@ -681,12 +747,18 @@ float DriveGraph::getAngleToNext(int n, int j) const
 //-----------------------------------------------------------------------------
 int DriveGraph::getNumberOfSuccessors(int n) const
 {
+    const CompactDriveGraph *cg = getCompactGraph();
+    if (cg)
+        return cg->getNumberOfSuccessors(n);
     return getNode(n)->getNumberOfSuccessors();
 }   // getNumberOfSuccessors
 
 //-----------------------------------------------------------------------------
 float DriveGraph::getDistanceFromStart(int j) const
 {
+    const CompactDriveGraph *cg = getCompactGraph();
+    if (cg)
+        return cg->getDistanceFromStart(j);
     return getNode(j)->getDistanceFromStart();
 }   // getDistanceFromStart
 
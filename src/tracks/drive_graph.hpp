@@ -28,7 +28,10 @@
 
 #include "LinearMath/btTransform.h"
 
+class AITrackData;
 class DriveNode;
+class RubberBallPath;
+class TriangleMesh;
 class XMLNode;
 
 /**
@@ -47,6 +50,13 @@ private:
     /** Wether the graph should be reverted or not */
     bool m_reverse;
 
+    /** The data used by the AI each frame. */
+    AITrackData* m_ai_data;
+
+    /** The data used by rubber balls, NULL till the physics of the track
+     *  was loaded. */
+    RubberBallPath* m_rubber_ball_path;
+
     // ------------------------------------------------------------------------
     void setDefaultSuccessors();
     // ------------------------------------------------------------------------
@@ -79,7 +89,7 @@ public:
     DriveGraph(const std::string &quad_file_name,
                const std::string &graph_file_name, const bool reverse);
     // ------------------------------------------------------------------------
-    virtual ~DriveGraph() {}
+    virtual ~DriveGraph();
     // ------------------------------------------------------------------------
     void getSuccessors(int node_number, std::vector<unsigned int>& succ,
                        bool for_ai=false) const;
@@ -99,6 +109,10 @@ public:
     // ------------------------------------------------------------------------
     void computeChecklineRequirements();
     // ------------------------------------------------------------------------
+    void createRubberBallPath(const TriangleMesh &mesh, float min_distance);
+    // ------------------------------------------------------------------------
+    virtual size_t getMemoryUsage() const OVERRIDE;
+    // ------------------------------------------------------------------------
     /** Return the distance to the j-th successor of node n. */
     float getDistanceToNext(int n, int j) const;
     // ------------------------------------------------------------------------
@@ -119,6 +133,13 @@ public:
     float getLapLength() const                         { return m_lap_length; }
     // ------------------------------------------------------------------------
     bool isReverse() const                                { return m_reverse; }
+    // ------------------------------------------------------------------------
+    /** Returns the tables used by the AI. */
+    const AITrackData* getAIData() const                  { return m_ai_data; }
+    // ------------------------------------------------------------------------
+    /** Returns the tables used by rubber balls (or NULL). */
+    const RubberBallPath* getRubberBallPath() const
+                                                   { return m_rubber_ball_path; }
 
 };   // DriveGraph
 
@@ -30,6 +30,7 @@
 #include "graphics/rtts.hpp"
 #include "modes/profile_world.hpp"
 #include "tracks/arena_node_3d.hpp"
+#include "tracks/compact_drive_graph.hpp"
 #include "tracks/drive_node_2d.hpp"
 #include "tracks/drive_node_3d.hpp"
 #include "utils/log.hpp"
@@ -44,6 +45,7 @@ Graph::Graph()
     m_mesh        = NULL;
     m_mesh_buffer = NULL;
     m_new_rtt     = NULL;
+    m_compact_graph = NULL;
     m_bb_min      = Vec3( 99999,  99999,  99999);
     m_bb_max      = Vec3(-99999, -99999, -99999);
     memset(m_bb_nodes, 0, 4 * sizeof(int));
@@ -66,6 +68,7 @@ Graph::~Graph()
         delete m_all_nodes[i];
     }
     m_all_nodes.clear();
+    delete m_compact_graph;
 }  // ~Graph
 
 // -----------------------------------------------------------------------------
@@ -101,10 +104,41 @@ void Graph::cleanupDebugMesh()
     m_node = NULL;
     // No need to call irr_driber->removeMeshFromCache, since the mesh
     // was manually made and so never added to the mesh cache.
-    m_mesh->drop();
+    if (m_mesh != NULL)
+        m_mesh->drop();
     m_mesh = NULL;
 }   // cleanupDebugMesh
 
+// -----------------------------------------------------------------------------
+/** Removes everything that belongs to the current race only (the minimap
+ *  render target and the debug mesh), so that the graph itself can be
+ *  reused in another race on the same track.
+ */
+void Graph::cleanupRaceData()
+{
+    if (m_new_rtt != NULL)
+    {
+        delete m_new_rtt;
+        m_new_rtt = NULL;
+    }
+
+    if (UserConfigParams::m_track_debug)
+        cleanupDebugMesh();
+}   // cleanupRaceData
+
+// -----------------------------------------------------------------------------
+/** Returns an estimate of the memory used by this graph in bytes. It is used
+ *  by the TrackDataCache to stay within its memory budget.
+ */
+size_t Graph::getMemoryUsage() const
+{
+    size_t memory = sizeof(*this)
+                  + m_all_nodes.size() * (sizeof(Quad*)+sizeof(Quad));
+    if (m_compact_graph)
+        memory += m_compact_graph->getMemoryUsage();
+    return memory;
+}   // getMemoryUsage
+
 // -----------------------------------------------------------------------------
 /** Creates the actual mesh that is used by createDebugMesh() or makeMiniMap()
  */
@@ -452,6 +486,29 @@ void Graph::createQuad(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2,
 
 }   // createQuad
 
+//-----------------------------------------------------------------------------
+/** Returns true if the point is inside node n, using the compact graph data
+ *  if available.
+ */
+inline bool Graph::pointInsideNode(int n, const Vec3 &xyz,
+                                   bool ignore_vertical) const
+{
+    const CompactDriveGraph *cg = getCompactGraph();
+    return cg ? cg->pointInside(n, xyz, ignore_vertical)
+              : m_all_nodes[n]->pointInside(xyz, ignore_vertical);
+}   // pointInsideNode
+
+//-----------------------------------------------------------------------------
+/** Returns the square of the distance of a point to the center line of node
+ *  n, using the compact graph data if available.
+ */
+inline float Graph::getDistance2FromNode(int n, const Vec3 &xyz) const
+{
+    const CompactDriveGraph *cg = getCompactGraph();
+    return cg ? cg->getDistance2FromPoint(n, xyz)
+              : m_all_nodes[n]->getDistance2FromPoint(xyz);
+}   // getDistance2FromNode
+
 //-----------------------------------------------------------------------------
 /** findRoadSector returns in which sector on the road the position
  *  xyz is. If xyz is not on top of the road, it sets UNKNOWN_SECTOR as sector.
@@ -471,7 +528,7 @@ void Graph::findRoadSector(const Vec3& xyz, int *sector,
     // Most likely the kart will still be on the sector it was before,
     // so this simple case is tested first.
     if (*sector!=UNKNOWN_SECTOR &&
-        getQuad(*sector)->pointInside(xyz, ignore_vertical))
+        pointInsideNode(*sector, xyz, ignore_vertical))
     {
         return;
     }   // if still on same quad
@@ -499,8 +556,7 @@ void Graph::findRoadSector(const Vec3& xyz, int *sector,
             indx = (*all_sectors)[i];
         else
             indx = indx<(int)m_all_nodes.size()-1 ? indx +1 : 0;
-        const Quad* q = getQuad(indx);
-        if (q->pointInside(xyz, ignore_vertical))
+        if (pointInsideNode(indx, xyz, ignore_vertical))
         {
             *sector  = indx;
             return;
@@ -568,6 +624,7 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
 
     int   min_sector = UNKNOWN_SECTOR;
     float min_dist_2 = 999999.0f*999999.0f;
+    const CompactDriveGraph *cg = getCompactGraph();
 
     // If a kart is falling and in between (or too far below)
     // a driveline point it might not fulfill
@@ -586,23 +643,25 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
                 ? 0
                 : current_sector+1;
 
-            const Quad* q = getQuad(next_sector);
-            if (!q->isIgnored())
+            const Quad* q = cg ? NULL : getQuad(next_sector);
+            if (cg ? !cg->isIgnored(next_sector) : !q->isIgnored())
             {
                 // A first simple test uses the 2d distance to the center of the
                 // quad.
-                float dist_2 =
-                    m_all_nodes[next_sector]->getDistance2FromPoint(xyz);
+                float dist_2 = getDistance2FromNode(next_sector, xyz);
                 if (dist_2 < min_dist_2)
                 {
-                    float dist = xyz.getY() - q->getMinHeight();
+                    float min_height = cg ? cg->getMinHeight(next_sector)
+                                          : q->getMinHeight();
+                    bool is_3d = cg ? cg->is3D(next_sector) : q->is3DQuad();
+                    float dist = xyz.getY() - min_height;
                     // While negative distances are unlikely, we allow some small
                     // negative numbers in case that the kart is partly in the
                     // track. Only do the height test in phase==0, in phase==1
                     // accept any point, independent of height, or this node is 3d
                     // which already takes height into account
                     if (phase == 1 || (dist < 5.0f && dist>-1.0f) ||
-                        q->is3DQuad() || ignore_vertical)
+                        is_3d || ignore_vertical)
                     {
                         min_dist_2 = dist_2;
                         min_sector = next_sector;
@@ -35,6 +35,7 @@ namespace irr
 
 using namespace irr;
 
+class CompactDriveGraph;
 class FrameBuffer;
 class Quad;
 class RTT;
@@ -56,6 +57,10 @@ protected:
 
     std::vector<Quad*> m_all_nodes;
 
+    /** A compact copy of the node data used by findRoadSector and
+     *  findOutOfRoadSector, only created for drive graphs. */
+    CompactDriveGraph* m_compact_graph;
+
     // ------------------------------------------------------------------------
     /** Factory method to dynamic create 2d / 3d quad for drive and arena
      *  graph. */
@@ -95,6 +100,10 @@ private:
     // ------------------------------------------------------------------------
     void cleanupDebugMesh();
     // ------------------------------------------------------------------------
+    bool pointInsideNode(int n, const Vec3 &xyz, bool ignore_vertical) const;
+    // ------------------------------------------------------------------------
+    float getDistance2FromNode(int n, const Vec3 &xyz) const;
+    // ------------------------------------------------------------------------
     virtual bool hasLapLine() const = 0;
     // ------------------------------------------------------------------------
     virtual void differentNodeColor(int n, video::SColor* c) const = 0;
@@ -126,12 +135,25 @@ public:
         }
     }   // destroy
     // ------------------------------------------------------------------------
+    /** Removes the current graph without deleting it, e.g. to keep it in
+     *  the TrackDataCache. The caller becomes the owner of the graph. */
+    static Graph* detach()
+    {
+        Graph* graph = m_graph;
+        m_graph = NULL;
+        return graph;
+    }   // detach
+    // ------------------------------------------------------------------------
     Graph();
     // ------------------------------------------------------------------------
     virtual ~Graph();
     // ------------------------------------------------------------------------
     void createDebugMesh();
     // ------------------------------------------------------------------------
+    void cleanupRaceData();
+    // ------------------------------------------------------------------------
+    virtual size_t getMemoryUsage() const;
+    // ------------------------------------------------------------------------
     void makeMiniMap(const core::dimension2du &where, const std::string &name,
                      const video::SColor &fill_color,
                      video::ITexture** oldRttMinimap,
@@ -161,6 +183,11 @@ public:
     const Vec3& getBBMax() const                           { return m_bb_max; }
     // ------------------------------------------------------------------------
     const int* getBBNodes() const                        { return m_bb_nodes; }
+    // ------------------------------------------------------------------------
+    /** Returns the compact copy of the graph data, or NULL if there is
+     *  none. */
+    const CompactDriveGraph* getCompactGraph() const
+                                                  { return m_compact_graph; }
 
 };   // Graph
 
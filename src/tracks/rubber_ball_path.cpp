@@ -0,0 +1,152 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "tracks/rubber_ball_path.hpp"
+
+#include "physics/triangle_mesh.hpp"
+#include "tracks/drive_graph.hpp"
+#include "tracks/drive_node.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+const float RubberBallPath::NO_CEILING = 99999.0f;
+
+// ----------------------------------------------------------------------------
+/** Computes the control points and ceiling heights of all nodes. This must
+ *  be called after the paths of the graph were set up and the physics of
+ *  the track was created.
+ *  \param graph The drive graph.
+ *  \param mesh The triangle mesh of the track, used for the ceilings.
+ *  \param min_distance Minimum distance between two control points, see
+ *         RubberBall::getNextControlPoint.
+ */
+RubberBallPath::RubberBallPath(const DriveGraph *graph,
+                               const TriangleMesh &mesh, float min_distance)
+{
+    m_min_distance = min_distance;
+    const unsigned int num_nodes = graph->getNumNodes();
+    m_first_successor.resize(num_nodes+1);
+    m_ceiling_height.resize(num_nodes);
+
+    for (unsigned int n = 0; n < num_nodes; n++)
+    {
+        const DriveNode *dn = graph->getNode(n);
+        m_first_successor[n] = (int)m_control_node.size();
+        const float f = dn->getDistanceFromStart();
+        for (unsigned int i = 0; i < dn->getNumberOfSuccessors(); i++)
+        {
+            // Same walk as in RubberBall::getNextControlPoint, but it stops
+            // at the first node which has more than one successor.
+            float dist = dn->getDistanceToSuccessor(i);
+            int next   = dn->getSuccessor(i);
+            float d    = graph->getDistanceFromStart(next) - f;
+            unsigned int count = 0;
+            while (d < min_distance && d >= 0)
+            {
+                const DriveNode *next_node = graph->getNode(next);
+                if (next_node->getNumberOfSuccessors() != 1 ||
+                    ++count > num_nodes)
+                {
+                    next = -1;
+                    break;
+                }
+                dist += next_node->getDistanceToSuccessor(0);
+                next  = next_node->getSuccessor(0);
+                d     = graph->getDistanceFromStart(next) - f;
+            }
+            m_control_node.push_back(next);
+            m_control_distance.push_back(dist);
+        }
+        m_ceiling_height[n] = computeCeilingHeight(graph, n, mesh);
+    }
+    m_first_successor[num_nodes] = (int)m_control_node.size();
+
+    // A ball uses the node it is on before it moves, so its new position
+    // can already be on a successor: use the lowest ceiling of a node and
+    // its successors.
+    std::vector<float> node_ceiling = m_ceiling_height;
+    for (unsigned int n = 0; n < num_nodes; n++)
+    {
+        const DriveNode *dn = graph->getNode(n);
+        for (unsigned int i = 0; i < dn->getNumberOfSuccessors(); i++)
+        {
+            m_ceiling_height[n] = std::min(m_ceiling_height[n],
+                                           node_ceiling[dn->getSuccessor(i)]);
+        }
+    }
+}   // RubberBallPath
+
+// ----------------------------------------------------------------------------
+/** Returns the lowest ceiling above node n. The ceiling is searched with
+ *  raycasts along the normal of the node, starting from a grid of points
+ *  (at most 1m apart, including the edges) on the node. The rays start a
+ *  bit above the node, the same way a rubber ball tests for tunnels. Like
+ *  the raycast of a ball, this only tests the triangle mesh of the track,
+ *  which does not contain animated track objects. If a node is too large
+ *  for the grid, 0 is returned, so that a ball always does the raycast.
+ *  \param graph The drive graph.
+ *  \param n Index of the node.
+ *  \param mesh The triangle mesh of the track.
+ */
+float RubberBallPath::computeCeilingHeight(const DriveGraph *graph,
+                                           unsigned int n,
+                                           const TriangleMesh &mesh) const
+{
+    const DriveNode *dn  = graph->getNode(n);
+    const Vec3 &normal   = dn->getNormal();
+    const float spacing  = 1.0f;
+    const int max_steps  = 64;
+    const float length   = std::max(((*dn)[1] - (*dn)[2]).length(),
+                                    ((*dn)[0] - (*dn)[3]).length());
+    const float width    = std::max(((*dn)[0] - (*dn)[1]).length(),
+                                    ((*dn)[3] - (*dn)[2]).length());
+    const int num_length = 1 + (int)ceilf(length / spacing);
+    const int num_width  = 1 + (int)ceilf(width  / spacing);
+    if (num_length > max_steps || num_width > max_steps)
+        return 0.0f;
+
+    float ceiling = NO_CEILING;
+    for (int i = 0; i <= num_length; i++)
+    {
+        const float v = float(i) / num_length;
+        const Vec3 lower = (*dn)[0] + ((*dn)[3] - (*dn)[0]) * v;
+        const Vec3 upper = (*dn)[1] + ((*dn)[2] - (*dn)[1]) * v;
+        for (int j = 0; j <= num_width; j++)
+        {
+            const Vec3 xyz = lower + (upper - lower) * (float(j) / num_width);
+            Vec3 hit_point;
+            const Material *material;
+            mesh.castRay(xyz + 2.0f*normal, xyz + 100.0f*normal, &hit_point,
+                         &material);
+            if (material)
+                ceiling = std::min(ceiling, (hit_point - xyz).length());
+        }
+    }
+    return ceiling;
+}   // computeCeilingHeight
+
+// ----------------------------------------------------------------------------
+/** Returns the memory used by this object in bytes. */
+size_t RubberBallPath::getMemoryUsage() const
+{
+    return sizeof(*this)
+         + (m_first_successor.size() + m_control_node.size()) * sizeof(int)
+         + (m_control_distance.size() + m_ceiling_height.size())
+           * sizeof(float);
+}   // getMemoryUsage
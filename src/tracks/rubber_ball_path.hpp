@@ -0,0 +1,105 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_RUBBER_BALL_PATH_HPP
+#define HEADER_RUBBER_BALL_PATH_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/vec3.hpp"
+
+#include <vector>
+
+class DriveGraph;
+class TriangleMesh;
+
+/**
+ *  \brief Tables of the drive graph data a rubber ball needs while flying.
+ *  A rubber ball follows the drive graph by picking control points (graph
+ *  nodes that are at least a minimum distance apart) and raycasts upwards
+ *  each frame to avoid flying into the ceiling of a tunnel. Both only
+ *  depend on the track, so they are computed once per drive graph and
+ *  shared by all balls:
+ *  - for each successor of each node the next control point when
+ *    following this successor. This is only stored if there is no further
+ *    branch before the control point is reached, otherwise the choice
+ *    depends on the target of the ball and the ball has to follow the
+ *    graph itself.
+ *  - for each node the lowest ceiling found by raycasts from a grid of
+ *    points on the node and its successors. If there is no ceiling close
+ *    to a node, the ball does not need to raycast at all.
+ *  The data is created once the physics of the track is loaded, and is
+ *  kept together with the graph in the TrackDataCache.
+ * \ingroup tracks
+ */
+class RubberBallPath : public NoCopy
+{
+private:
+    /** Index of the first successor entry of each node, with an additional
+     *  entry at the end, see AITrackData::m_first_successor. */
+    std::vector<int> m_first_successor;
+
+    /** The node of the next control point for each successor entry, or -1
+     *  if there is a branch before the control point is reached. */
+    std::vector<int> m_control_node;
+
+    /** The distance along the graph to the control point for each
+     *  successor entry. */
+    std::vector<float> m_control_distance;
+
+    /** Lowest ceiling (distance along the normal of the node) above each
+     *  node and its successors, or NO_CEILING if none was found. */
+    std::vector<float> m_ceiling_height;
+
+    /** The minimum distance between control points this object was
+     *  created for. */
+    float m_min_distance;
+
+    float computeCeilingHeight(const DriveGraph *graph, unsigned int n,
+                               const TriangleMesh &mesh) const;
+
+public:
+    /** Height returned if there is no ceiling above a node. */
+    static const float NO_CEILING;
+
+         RubberBallPath(const DriveGraph *graph, const TriangleMesh &mesh,
+                        float min_distance);
+    size_t getMemoryUsage() const;
+    // ------------------------------------------------------------------------
+    /** Returns the next control point when following the i-th successor of
+     *  node n, and the distance to it.
+     *  \return False if the control point depends on the target (i.e.
+     *          there is a branch on the way), in which case node and
+     *          distance are not changed. */
+    bool getControlPoint(int n, int i, int *node, float *distance) const
+    {
+        const int k = m_first_successor[n] + i;
+        if (m_control_node[k] < 0) return false;
+        *node     = m_control_node[k];
+        *distance = m_control_distance[k];
+        return true;
+    }   // getControlPoint
+    // ------------------------------------------------------------------------
+    /** Returns the lowest ceiling above node n and its successors, or
+     *  NO_CEILING. */
+    float getCeilingHeight(int n) const         { return m_ceiling_height[n]; }
+    // ------------------------------------------------------------------------
+    /** Returns the minimum distance between control points. */
+    float getMinDistance() const                   { return m_min_distance; }
+};   // RubberBallPath
+
+#endif
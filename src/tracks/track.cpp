@@ -43,6 +43,7 @@
 #include "io/xml_node.hpp"
 #include "items/item.hpp"
 #include "items/item_manager.hpp"
+#include "items/rubber_ball.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/kart_properties.hpp"
 #include "modes/linear_world.hpp"
@@ -59,6 +60,7 @@
 #include "tracks/drive_graph.hpp"
 #include "tracks/drive_node.hpp"
 #include "tracks/model_definition_loader.hpp"
+#include "tracks/track_data_cache.hpp"
 #include "tracks/track_manager.hpp"
 #include "tracks/track_object_manager.hpp"
 #include "utils/constants.hpp"
@@ -277,7 +279,15 @@ void Track::reset()
  */
 void Track::cleanup()
 {
-    Graph::destroy();
+    // The graph only depends on the track files, so keep it for the next
+    // race on this track instead of loading it again.
+    if (Graph::get())
+    {
+        Graph::get()->cleanupRaceData();
+        TrackDataCache *cache = track_manager->getDataCache();
+        cache->storeGraph(m_graph_cache_key, Graph::detach());
+        cache->printStatistics();
+    }
     ItemManager::destroy();
     VAOManager::kill();
 
@@ -373,7 +383,7 @@ void Track::cleanup()
     }
     if (m_new_rtt_mini_map)
     {
-        m_new_rtt_mini_map = NULL; // already deleted by Graph::~Graph
+        m_new_rtt_mini_map = NULL; // already deleted by Graph::cleanupRaceData
     }
 
     for(unsigned int i=0; i<m_sky_textures.size(); i++)
@@ -669,9 +679,15 @@ void Track::startMusic() const
 /** Loads the quad graph for arena, i.e. the definition of all quads, and the
  *  way they are connected to each other. Input file name is hardcoded for now
  */
-void Track::loadArenaGraph(const XMLNode &node)
+void Track::loadArenaGraph(const XMLNode &node, unsigned int mode_id)
 {
-    ArenaGraph* graph = new ArenaGraph(m_root+"navmesh.xml", &node);
+    m_graph_cache_key = m_root + "navmesh.xml|" + m_all_modes[mode_id].m_scene;
+    // The goal nodes are only loaded in soccer mode
+    if (race_manager->getMinorMode() == RaceManager::MINOR_MODE_SOCCER)
+        m_graph_cache_key += "|goals";
+    Graph *graph = track_manager->getDataCache()->takeGraph(m_graph_cache_key);
+    if (!graph)
+        graph = new ArenaGraph(m_root+"navmesh.xml", &node);
     Graph::setGraph(graph);
 
     if(Graph::get()->getNumNodes()==0)
@@ -715,12 +731,28 @@ btQuaternion Track::getArenaStartRotation(const Vec3& xyz, float heading)
  */
 void Track::loadDriveGraph(unsigned int mode_id, const bool reverse)
 {
-    new DriveGraph(m_root+m_all_modes[mode_id].m_quad_name,
-        m_root+m_all_modes[mode_id].m_graph_name, reverse);
+    // The quads that are ignored depend on the race direction, the
+    // successors on whether the graph is reversed.
+    m_graph_cache_key = m_root + m_all_modes[mode_id].m_quad_name;
+    if (reverse)
+        m_graph_cache_key += "|reverse";
+    if (race_manager->getReverseTrack())
+        m_graph_cache_key += "|reverse-quads";
+
+    Graph *graph = track_manager->getDataCache()->takeGraph(m_graph_cache_key);
+    if (graph)
+    {
+        Graph::setGraph(graph);
+    }
+    else
+    {
+        new DriveGraph(m_root+m_all_modes[mode_id].m_quad_name,
+            m_root+m_all_modes[mode_id].m_graph_name, reverse);
 
-    // setGraph is done in DriveGraph constructor
-    assert(DriveGraph::get());
-    DriveGraph::get()->setupPaths();
+        // setGraph is done in DriveGraph constructor
+        assert(DriveGraph::get());
+        DriveGraph::get()->setupPaths();
+    }
 #ifdef DEBUG
     for(unsigned int i=0; i<DriveGraph::get()->getNumNodes(); i++)
     {
@@ -1673,7 +1705,7 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
     // map to.
     if (!m_is_arena && !m_is_soccer && !m_is_cutscene) loadDriveGraph(mode_id, reverse_track);
     else if ((m_is_arena || m_is_soccer) && !m_is_cutscene && m_has_navmesh)
-        loadArenaGraph(*root);
+        loadArenaGraph(*root, mode_id);
 
     ItemManager::create();
 
@@ -1919,6 +1951,13 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         DriveGraph::get()->computeChecklineRequirements();
     }
 
+    // The tables of the rubber ball need the physics of the track.
+    if (DriveGraph::get())
+    {
+        DriveGraph::get()->createRubberBallPath(*m_track_mesh,
+                                 RubberBall::getMinInterpolationDistance());
+    }
+
     EasterEggHunt *easter_world = dynamic_cast<EasterEggHunt*>(world);
     if(easter_world)
     {
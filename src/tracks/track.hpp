@@ -166,6 +166,10 @@ private:
      *  for the overworld. */
     bool m_cache_track;
 
+    /** The key under which the graph of the current race is stored in the
+     *  TrackDataCache at the end of the race. */
+    std::string m_graph_cache_key;
+
 
 #ifdef DEBUG
     /** A list of textures that were cached before the track is loaded.
@@ -374,7 +378,7 @@ private:
 
     void loadTrackInfo();
     void loadDriveGraph(unsigned int mode_id, const bool reverse);
-    void loadArenaGraph(const XMLNode &node);
+    void loadArenaGraph(const XMLNode &node, unsigned int mode_id);
     btQuaternion getArenaStartRotation(const Vec3& xyz, float heading);
     void convertTrackToBullet(scene::ISceneNode *node);
     bool loadMainTrack(const XMLNode &node);
@@ -0,0 +1,141 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "tracks/track_data_cache.hpp"
+
+#include "config/user_config.hpp"
+#include "tracks/graph.hpp"
+#include "utils/log.hpp"
+
+// ----------------------------------------------------------------------------
+TrackDataCache::TrackDataCache()
+{
+    m_memory_usage = 0;
+    m_hits         = 0;
+    m_misses       = 0;
+    m_evictions    = 0;
+}   // TrackDataCache
+
+// ----------------------------------------------------------------------------
+TrackDataCache::~TrackDataCache()
+{
+    clear();
+}   // ~TrackDataCache
+
+// ----------------------------------------------------------------------------
+/** Deletes all cached graphs. */
+void TrackDataCache::clear()
+{
+    std::list<CachedGraph>::iterator i;
+    for (i = m_all_graphs.begin(); i != m_all_graphs.end(); i++)
+        delete i->m_graph;
+    m_all_graphs.clear();
+    m_memory_usage = 0;
+}   // clear
+
+// ----------------------------------------------------------------------------
+/** Returns the memory budget in bytes. A budget of 0 disables the cache. */
+size_t TrackDataCache::getMemoryBudget() const
+{
+    if (UserConfigParams::m_track_data_cache_size <= 0)
+        return 0;
+    return (size_t)UserConfigParams::m_track_data_cache_size * 1024 * 1024;
+}   // getMemoryBudget
+
+// ----------------------------------------------------------------------------
+/** Removes the graph with the given key from the cache and returns it. The
+ *  caller becomes the owner of the graph (and is expected to give it back
+ *  with storeGraph at the end of the race).
+ *  \param key The key the graph was stored with.
+ *  \return The graph, or NULL if no graph for this key is cached.
+ */
+Graph* TrackDataCache::takeGraph(const std::string &key)
+{
+    std::list<CachedGraph>::iterator i;
+    for (i = m_all_graphs.begin(); i != m_all_graphs.end(); i++)
+    {
+        if (i->m_key != key) continue;
+        Graph *graph = i->m_graph;
+        m_memory_usage -= i->m_memory;
+        m_all_graphs.erase(i);
+        m_hits++;
+        Log::debug("TrackDataCache", "Reusing graph '%s'.", key.c_str());
+        return graph;
+    }
+    m_misses++;
+    return NULL;
+}   // takeGraph
+
+// ----------------------------------------------------------------------------
+/** Stores a graph in the cache, making it the most recently used entry.
+ *  All per-race data (minimap, debug mesh) must have been removed already.
+ *  If the cache is disabled or the graph alone exceeds the budget, the graph
+ *  is deleted.
+ *  \param key Key identifying the track, mode and direction of the graph.
+ *  \param graph The graph, the cache becomes its owner.
+ */
+void TrackDataCache::storeGraph(const std::string &key, Graph *graph)
+{
+    if (!graph) return;
+
+    const size_t budget = getMemoryBudget();
+    const size_t memory = graph->getMemoryUsage();
+    if (memory > budget)
+    {
+        delete graph;
+        return;
+    }
+
+    CachedGraph cg;
+    cg.m_key    = key;
+    cg.m_graph  = graph;
+    cg.m_memory = memory;
+    m_all_graphs.push_front(cg);
+    m_memory_usage += memory;
+    enforceBudget(budget);
+}   // storeGraph
+
+// ----------------------------------------------------------------------------
+/** Deletes the least recently used graphs till the memory used is within
+ *  the budget.
+ *  \param budget Memory budget in bytes.
+ */
+void TrackDataCache::enforceBudget(size_t budget)
+{
+    while (m_memory_usage > budget && !m_all_graphs.empty())
+    {
+        const CachedGraph &cg = m_all_graphs.back();
+        Log::debug("TrackDataCache", "Evicting graph '%s' (%d bytes).",
+                   cg.m_key.c_str(), (int)cg.m_memory);
+        m_memory_usage -= cg.m_memory;
+        delete cg.m_graph;
+        m_all_graphs.pop_back();
+        m_evictions++;
+    }
+}   // enforceBudget
+
+// ----------------------------------------------------------------------------
+void TrackDataCache::printStatistics() const
+{
+    Log::verbose("TrackDataCache",
+                 "%d graphs cached, %d KB of %d KB, hits %d misses %d "
+                 "evictions %d.", (int)m_all_graphs.size(),
+                 (int)(m_memory_usage / 1024),
+                 (int)(getMemoryBudget() / 1024), m_hits, m_misses,
+                 m_evictions);
+}   // printStatistics
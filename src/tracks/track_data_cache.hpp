@@ -0,0 +1,95 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TRACK_DATA_CACHE_HPP
+#define HEADER_TRACK_DATA_CACHE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <list>
+#include <string>
+
+class Graph;
+
+/**
+ *  \brief Keeps the track data that only depends on the track files (the
+ *  drive graph or arena graph) alive between races.
+ *  A dedicated server often rotates between the same few tracks, and
+ *  loading a graph (and in case of an arena graph computing all shortest
+ *  paths) every race is wasted time. At the end of a race the graph is
+ *  handed to this cache instead of being deleted, and the next race on the
+ *  same track and mode takes it out again. The least recently used graphs
+ *  are deleted once the memory budget is exceeded.
+ *  A graph is only ever used by one race, so while a graph is in use it is
+ *  not part of the cache.
+ * \ingroup tracks
+ */
+class TrackDataCache : public NoCopy
+{
+private:
+    /** One cached graph. */
+    struct CachedGraph
+    {
+        /** Key identifying track directory, mode and direction. */
+        std::string  m_key;
+        /** The graph, owned by the cache. */
+        Graph       *m_graph;
+        /** Estimated memory used by the graph in bytes. */
+        size_t       m_memory;
+    };   // CachedGraph
+
+    /** All cached graphs, the most recently used one first. */
+    std::list<CachedGraph> m_all_graphs;
+
+    /** Sum of the estimated memory of all cached graphs. */
+    size_t       m_memory_usage;
+
+    /** Number of successful lookups. */
+    unsigned int m_hits;
+
+    /** Number of lookups that did not find a graph. */
+    unsigned int m_misses;
+
+    /** Number of graphs deleted to stay within the budget. */
+    unsigned int m_evictions;
+
+    void   enforceBudget(size_t budget);
+
+public:
+                 TrackDataCache();
+                ~TrackDataCache();
+    Graph       *takeGraph(const std::string &key);
+    void         storeGraph(const std::string &key, Graph *graph);
+    void         clear();
+    void         printStatistics() const;
+    size_t       getMemoryBudget() const;
+    // ------------------------------------------------------------------------
+    /** Returns the number of lookups that found a cached graph. */
+    unsigned int getHits() const                           { return m_hits; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of lookups that had to load the graph. */
+    unsigned int getMisses() const                       { return m_misses; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of graphs deleted because of the budget. */
+    unsigned int getEvictions() const                 { return m_evictions; }
+    // ------------------------------------------------------------------------
+    /** Returns the estimated memory used by all cached graphs. */
+    size_t       getMemoryUsage() const            { return m_memory_usage; }
+};   // TrackDataCache
+
+#endif
@@ -22,6 +22,7 @@
 #include "graphics/irr_driver.hpp"
 #include "io/file_manager.hpp"
 #include "tracks/track.hpp"
+#include "tracks/track_data_cache.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -32,10 +33,12 @@
 TrackManager* track_manager = 0;
 std::vector<std::string>  TrackManager::m_track_search_path;
 
-/** Constructor (currently empty). The real work happens in loadTrackList.
+/** Constructor. The real work happens in loadTrackList.
  */
 TrackManager::TrackManager()
-{}   // TrackManager
+{
+    m_data_cache = new TrackDataCache();
+}   // TrackManager
 
 //-----------------------------------------------------------------------------
 /** Delete all tracks.
@@ -44,6 +47,7 @@ TrackManager::~TrackManager()
 {
     for(Tracks::iterator i = m_tracks.begin(); i != m_tracks.end(); ++i)
         delete *i;
+    delete m_data_cache;
 }   // ~TrackManager
 
 //-----------------------------------------------------------------------------
@@ -88,13 +92,15 @@ Track* TrackManager::getTrack(const std::string& ident) const
 }   // getTrack
 
 //-----------------------------------------------------------------------------
-/** Removes all cached data from all tracks. This is called when the screen
- *  resolution is changed and all textures need to be bound again.
+/** Removes all cached data from all tracks, and all graphs kept between
+ *  races. This is called when the screen resolution is changed and all
+ *  textures need to be bound again, and when addons are reloaded.
  */
 void TrackManager::removeAllCachedData()
 {
     for(Tracks::const_iterator i = m_tracks.begin(); i != m_tracks.end(); ++i)
         (*i)->removeCachedData();
+    m_data_cache->clear();
 }   // removeAllCachedData
 //-----------------------------------------------------------------------------
 /** Sets all tracks that are not in the list a to be unavailable. This is used
@@ -145,6 +151,8 @@ void TrackManager::loadTrackList()
     m_soccer_arena_groups.clear();
     m_track_avail.clear();
     m_tracks.clear();
+    // Installed or updated addons might replace the graph of a track
+    m_data_cache->clear();
 
     for(unsigned int i=0; i<m_track_search_path.size(); i++)
     {
@@ -227,6 +235,7 @@ void TrackManager::removeTrack(const std::string &ident)
         Log::fatal("TrackManager", "There is no track named '%s'!!", ident.c_str());
 
     if (track->isInternal()) return;
+    m_data_cache->clear();
 
     std::vector<Track*>::iterator it = std::find(m_tracks.begin(),
                                                  m_tracks.end(), track);
@@ -24,6 +24,7 @@
 #include <map>
 
 class Track;
+class TrackDataCache;
 
 /**
   * \brief Simple class to load and manage track data, track names and such
@@ -67,6 +68,9 @@ private:
      */
     std::vector<bool>                        m_track_avail;
 
+    /** Keeps graphs of recently used tracks alive between races. */
+    TrackDataCache                          *m_data_cache;
+
     void          updateGroups(const Track* track);
 
 public:
@@ -90,6 +94,9 @@ public:
      *  \param tracks List of tracks to mark as unavilable. */
     void setUnavailableTracks(const std::vector<std::string> &tracks);
     // ------------------------------------------------------------------------
+    /** Returns the cache for track data that is kept between races. */
+    TrackDataCache* getDataCache() const              { return m_data_cache; }
+    // ------------------------------------------------------------------------
     /** \brief Returns a list of all directories that contain a track. */
     const std::vector<std::string>* getAllTrackDirs() const
     {
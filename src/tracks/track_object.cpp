@@ -27,6 +27,7 @@
 #include "io/xml_node.hpp"
 #include "input/device_manager.hpp"
 #include "items/item_manager.hpp"
+#include "modes/profile_world.hpp"
 #include "modes/world.hpp"
 #include "physics/physical_object.hpp"
 #include "race/race_manager.hpp"
@@ -77,6 +78,9 @@ TrackObject::TrackObject(const core::vector3df& xyz, const core::vector3df& hpr,
     m_soccer_ball     = false;
     m_initially_visible = false;
     m_type            = "";
+    m_simulation_level = SIM_FULL;
+    m_pending_dt      = 0.0f;
+    m_last_time_slot  = -1;
 
     if (m_interaction != "ghost" && m_interaction != "none" &&
         physics_settings )
@@ -109,6 +113,9 @@ void TrackObject::init(const XMLNode &xml_node, scene::ISceneNode* parent,
     m_animator = NULL;
     m_parent_library = parent_library;
     m_physical_object = NULL;
+    m_simulation_level = SIM_FULL;
+    m_pending_dt = 0.0f;
+    m_last_time_slot = -1;
 
     xml_node.get("id",      &m_id        );
     xml_node.get("model",   &m_name      );
@@ -396,6 +403,9 @@ TrackObject::~TrackObject()
  */
 void TrackObject::reset()
 {
+    setSimulationLevel(SIM_FULL);
+    m_pending_dt     = 0.0f;
+    m_last_time_slot = -1;
     if (m_presentation   ) m_presentation->reset();
     if (m_animator       ) m_animator->reset();
     if (m_physical_object) m_physical_object->reset();
@@ -462,10 +472,67 @@ void TrackObject::update(float dt)
 {
     if (m_presentation) m_presentation->update(dt);
 
+    m_pending_dt += dt;
+    if (m_simulation_level == SIM_FULL)
+        updateSimulation();
+}   // update
+
+// ----------------------------------------------------------------------------
+/** Updates physics and animation of this object with all the time that
+ *  passed since the last update. Objects at reduced simulation level are
+ *  updated by the TrackObjectManager only every few frames.
+ */
+void TrackObject::updateSimulation()
+{
+    const float dt = m_pending_dt;
+    m_pending_dt = 0.0f;
+
     if (m_physical_object) m_physical_object->update(dt);
 
     if (m_animator) m_animator->update(dt);
-}   // update
+}   // updateSimulation
+
+// ----------------------------------------------------------------------------
+/** Sets how often physics and animation of this object are updated.
+ *  Frozen dynamic objects are also taken out of the physics simulation.
+ *  \param level The new simulation level.
+ */
+void TrackObject::setSimulationLevel(SimulationLevel level)
+{
+    if (level == m_simulation_level) return;
+
+    if (m_physical_object)
+        m_physical_object->setFrozen(level == SIM_FROZEN);
+    m_simulation_level = level;
+}   // setSimulationLevel
+
+// ----------------------------------------------------------------------------
+/** Returns true if updates of this object can be reduced or frozen when it
+ *  is far away from all karts. This is the case for dynamic physical
+ *  objects (except the soccer ball, which is important for the game).
+ *  Animations are only reduced when nothing is rendered (e.g. on a server),
+ *  since otherwise far away animations would visibly stop. Positions of
+ *  animated objects do not depend on this, since the skipped time is used
+ *  in the next update.
+ */
+bool TrackObject::canReduceSimulation() const
+{
+    if (m_soccer_ball) return false;
+    if (m_animator)
+        return ProfileWorld::isNoGraphics();
+    return m_physical_object && m_physical_object->isDynamic();
+}   // canReduceSimulation
+
+// ----------------------------------------------------------------------------
+/** Returns true if this object can be updated at a reduced rate (instead of
+ *  only being frozen). This only applies to animations: bullet simulates a
+ *  dynamic body in every physics step anyway, so a reduced update rate
+ *  would not save any physics work and only make the scene node stutter.
+ */
+bool TrackObject::canReduceUpdateRate() const
+{
+    return m_animator && canReduceSimulation();
+}   // canReduceUpdateRate
 
 
 // ----------------------------------------------------------------------------
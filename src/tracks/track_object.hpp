@@ -44,6 +44,17 @@ class XMLNode;
  */
 class TrackObject : public NoCopy
 {
+public:
+    /** How often physics and animation of an object are updated. This
+     *  depends on the distance to the closest kart, see
+     *  TrackObjectManager::update(). */
+    enum SimulationLevel
+    {
+        SIM_FULL,          //!< Updated every frame.
+        SIM_REDUCED,       //!< Updated every few frames only.
+        SIM_FROZEN         //!< Not updated at all.
+    };
+
 //public:
     // The different type of track objects: physical objects, graphical
     // objects (without a physical representation) - the latter might be
@@ -62,6 +73,18 @@ private:
 
     RenderInfo*              m_render_info;
 
+    /** How often physics and animation of this object are updated. */
+    SimulationLevel          m_simulation_level;
+
+    /** Time that passed since physics and animation were last updated. It
+     *  is used in the next update, so that skipped frames do not change
+     *  the timing of animations. */
+    float                    m_pending_dt;
+
+    /** The time slot in which this object was last updated at reduced
+     *  rate. */
+    int                      m_last_time_slot;
+
 protected:
 
     /** The initial XYZ position of the object. */
@@ -117,6 +140,10 @@ public:
                              const PhysicalObject::Settings* physicsSettings);
     virtual      ~TrackObject();
     virtual void update(float dt);
+    void updateSimulation();
+    void setSimulationLevel(SimulationLevel level);
+    bool canReduceSimulation() const;
+    bool canReduceUpdateRate() const;
     void move(const core::vector3df& xyz, const core::vector3df& hpr,
               const core::vector3df& scale, bool updateRigidBody,
               bool isAbsoluteCoord);
@@ -160,6 +187,19 @@ public:
     // ------------------------------------------------------------------------
 	bool isEnabled() const { return m_enabled; }
     // ------------------------------------------------------------------------
+    /** Returns how often physics and animation of this object are updated. */
+    SimulationLevel getSimulationLevel() const { return m_simulation_level; }
+    // ------------------------------------------------------------------------
+    /** Checks if an object updated at reduced rate should be updated in
+     *  the given time slot (i.e. if it was not yet updated in this slot).
+     *  \param slot Current time slot of this object. */
+    bool isNewTimeSlot(int slot)
+    {
+        if (slot == m_last_time_slot) return false;
+        m_last_time_slot = slot;
+        return true;
+    }   // isNewTimeSlot
+    // ------------------------------------------------------------------------
     bool isSoccerBall() const { return m_soccer_ball; }
     // ------------------------------------------------------------------------
     const PhysicalObject* getPhysicalObject() const { return m_physical_object; }
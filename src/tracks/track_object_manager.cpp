@@ -20,9 +20,12 @@
 
 #include "animations/ipo.hpp"
 #include "animations/three_d_animation.hpp"
+#include "config/stk_config.hpp"
 #include "graphics/lod_node.hpp"
 #include "graphics/material_manager.hpp"
 #include "io/xml_node.hpp"
+#include "karts/abstract_kart.hpp"
+#include "modes/world.hpp"
 #include "physics/physical_object.hpp"
 #include "tracks/track_object.hpp"
 #include "utils/log.hpp"
@@ -30,8 +33,35 @@
 #include <IMeshSceneNode.h>
 #include <ISceneManager.h>
 
+#include <algorithm>
+
+namespace
+{
+    /** Collects the indices of all objects whose leaf is hit by a ray. */
+    class RayCandidateCollector : public btDbvt::ICollide
+    {
+    private:
+        std::vector<int> *m_candidates;
+    public:
+        RayCandidateCollector(std::vector<int> *candidates)
+            : m_candidates(candidates) {}
+        virtual void Process(const btDbvtNode *leaf)
+        {
+            m_candidates->push_back(leaf->dataAsInt);
+        }   // Process
+    };   // RayCandidateCollector
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
 TrackObjectManager::TrackObjectManager()
 {
+    m_num_skipped        = 0;
+    m_num_frozen         = 0;
+    m_num_updates        = 0;
+    m_total_skipped      = 0;
+    m_total_frozen       = 0;
+    m_num_rays           = 0;
+    m_num_ray_tests      = 0;
 }   // TrackObjectManager
 
 // ----------------------------------------------------------------------------
@@ -51,6 +81,7 @@ void TrackObjectManager::add(const XMLNode &xml_node, scene::ISceneNode* parent,
     {
         TrackObject *obj = new TrackObject(xml_node, parent, model_def_loader, parent_library);
         m_all_objects.push_back(obj);
+        addToIndex(obj);
         if(obj->isDriveable())
             m_driveable_objects.push_back(obj);
     }
@@ -70,7 +101,8 @@ void TrackObjectManager::init()
     {
         curr->onWorldReady();
     }
-}   // reset
+    buildDriveableTree();
+}   // init
 // ----------------------------------------------------------------------------
 /** Initialises all track objects.
  */
@@ -81,38 +113,116 @@ void TrackObjectManager::reset()
         curr->reset();
         curr->resetEnabled();
     }
+    buildDriveableTree();
 }   // reset
+
 // ----------------------------------------------------------------------------
-/** returns a reference to the track object
- *  with a particular ID
- *  \param name Name or ID of track object
+/** Creates the bounding volume tree over all driveable objects with an exact
+ *  mesh that are not simulated by bullet. All other driveable objects are
+ *  tested for each raycast.
  */
-TrackObject* TrackObjectManager::getTrackObject(const std::string& libraryInstance,
-    const std::string& name)
+void TrackObjectManager::buildDriveableTree()
 {
-    for (TrackObject* curr : m_all_objects)
+    m_driveable_tree.clear();
+    m_driveable_leaves.clear();
+    m_leaf_transforms.clear();
+    m_unbounded_driveable.clear();
+    for (unsigned int i = 0; i < m_driveable_objects.size(); i++)
     {
-        //if (curr->getParentLibrary() != NULL)
-        //    Log::info("TrackObjectManager", "Found %s::%s", curr->getParentLibrary()->getID().c_str(), curr->getID().c_str());
-        //else
-        //    Log::info("TrackObjectManager", "Found ::%s", curr->getID().c_str());
-
-        if (curr->getParentLibrary() == NULL)
+        const PhysicalObject *po = m_driveable_objects.get(i)
+                                 ->getPhysicalObject();
+        if (!po || po->getBodyType() != PhysicalObject::MP_EXACT ||
+            po->isDynamic())
         {
-            if (libraryInstance.size() > 0)
-                continue;
-        }
-        else
-        {
-            if (libraryInstance != curr->getParentLibrary()->getID())
-                continue;
+            m_driveable_leaves.push_back(NULL);
+            m_leaf_transforms.push_back(btTransform::getIdentity());
+            m_unbounded_driveable.push_back(i);
+            continue;
         }
+        Vec3 min, max;
+        po->getBody()->getAabb(min, max);
+        btDbvtNode *leaf =
+            m_driveable_tree.insert(btDbvtVolume::FromMM(min, max), NULL);
+        leaf->dataAsInt = i;
+        m_driveable_leaves.push_back(leaf);
+        m_leaf_transforms.push_back(po->getBody()->getWorldTransform());
+    }
+}   // buildDriveableTree
 
-        if (curr->getID() == name)
-        {
-            return curr;
-        }
+// ----------------------------------------------------------------------------
+/** Updates the leaves of all objects in the tree that were moved since their
+ *  leaf was last updated. This is done once per update, after the objects
+ *  and the physics were updated. The leaves are enlarged by a margin, so
+ *  that an object that moves only a little bit does not need to be
+ *  reinserted, and so that the rays cast before the next update (while
+ *  the object moves a bit further) still find it.
+ */
+void TrackObjectManager::refitDriveableTree()
+{
+    for (unsigned int i = 0; i < m_driveable_leaves.size(); i++)
+    {
+        btDbvtNode *leaf = m_driveable_leaves[i];
+        if (!leaf) continue;
+        const btRigidBody *body = m_driveable_objects.get(i)
+                                ->getPhysicalObject()->getBody();
+        if (body->getWorldTransform() == m_leaf_transforms[i]) continue;
+
+        Vec3 min, max;
+        body->getAabb(min, max);
+        btDbvtVolume volume = btDbvtVolume::FromMM(min, max);
+        m_driveable_tree.update(leaf, volume, 1.0f);
+        m_leaf_transforms[i] = body->getWorldTransform();
     }
+}   // refitDriveableTree
+// ----------------------------------------------------------------------------
+/** Returns the key of an object in m_object_index.
+ *  \param library_instance ID of the library instance the object is part
+ *         of, or an empty string if it is not part of a library.
+ *  \param name ID of the object.
+ */
+std::string TrackObjectManager::getObjectKey(const std::string &library_instance,
+                                             const std::string &name)
+{
+    // IDs can not contain a 0 byte, so different IDs give different keys.
+    std::string key = library_instance;
+    key += '\0';
+    key += name;
+    return key;
+}   // getObjectKey
+
+// ----------------------------------------------------------------------------
+/** Returns the key of an object in m_object_index.
+ *  \param object The track object.
+ */
+std::string TrackObjectManager::getObjectKey(TrackObject *object)
+{
+    TrackObject *library = object->getParentLibrary();
+    return getObjectKey(library ? library->getID() : "", object->getID());
+}   // getObjectKey
+
+// ----------------------------------------------------------------------------
+/** Adds an object to the index used by getTrackObject, unless an object
+ *  with the same IDs was added before. The ID of an object must be set
+ *  before it is added to the track object manager.
+ *  \param object The object to add.
+ */
+void TrackObjectManager::addToIndex(TrackObject *object)
+{
+    m_object_index.insert(std::make_pair(getObjectKey(object), object));
+}   // addToIndex
+
+// ----------------------------------------------------------------------------
+/** returns a reference to the track object
+ *  with a particular ID
+ *  \param name Name or ID of track object
+ */
+TrackObject* TrackObjectManager::getTrackObject(const std::string& libraryInstance,
+    const std::string& name)
+{
+    std::unordered_map<std::string, TrackObject*>::const_iterator it =
+        m_object_index.find(getObjectKey(libraryInstance, name));
+    if (it != m_object_index.end())
+        return it->second;
     //object not found
     Log::warn("TrackObjectManager", "Object not found : %s::%s", libraryInstance.c_str(), name.c_str());
     return NULL;
@@ -138,18 +248,129 @@ void TrackObjectManager::handleExplosion(const Vec3 &pos, const PhysicalObject *
 }   // handleExplosion
 
 // ----------------------------------------------------------------------------
-/** Updates all track objects.
+/** Determines how often an object should be updated, depending on the
+ *  distance to the closest kart. Since this only depends on the positions
+ *  of the karts and objects, the result is the same on server and clients.
+ *  \param object The track object.
+ *  \param kart_xyz Positions of all karts.
+ */
+TrackObject::SimulationLevel
+    TrackObjectManager::computeSimulationLevel(const TrackObject *object,
+                                          const std::vector<Vec3> &kart_xyz) const
+{
+    if (!object->canReduceSimulation())
+        return TrackObject::SIM_FULL;
+
+    // Use the bounding box of physical objects, so that large objects are
+    // not frozen while a kart is close to one of their ends.
+    Vec3 min, max;
+    const PhysicalObject *po = object->getPhysicalObject();
+    if (po)
+    {
+        po->getBody()->getAabb(min, max);
+    }
+    else
+    {
+        min = max = Vec3(object->getAbsoluteCenterPosition());
+    }
+
+    float min_dist2 = -1.0f;
+    for (unsigned int i = 0; i < kart_xyz.size(); i++)
+    {
+        const Vec3 &xyz = kart_xyz[i];
+        Vec3 closest = xyz;
+        closest.setMax(min);
+        closest.setMin(max);
+        const float dist2 = (closest - xyz).length2();
+        if (min_dist2 < 0 || dist2 < min_dist2)
+            min_dist2 = dist2;
+    }
+
+    const float frozen  = stk_config->m_object_frozen_distance;
+    const float reduced = stk_config->m_object_reduced_distance;
+    if (frozen > 0 && min_dist2 > frozen*frozen)
+        return TrackObject::SIM_FROZEN;
+    if (reduced > 0 && min_dist2 > reduced*reduced &&
+        object->canReduceUpdateRate())
+        return TrackObject::SIM_REDUCED;
+    return TrackObject::SIM_FULL;
+}   // computeSimulationLevel
+
+// ----------------------------------------------------------------------------
+/** Updates all track objects. Objects that are far away from all karts are
+ *  frozen, or (only animated objects) updated every few frames (see
+ *  computeSimulationLevel).
+ *  Objects at reduced rate are spread over different time slots based on
+ *  their index, so that they are not all updated in the same frame. The
+ *  time slots are based on the world time, so they are the same on all
+ *  clients and the server.
  *  \param dt Time step size.
  */
 void TrackObjectManager::update(float dt)
 {
+    World *world = World::getWorld();
+
+    // Without karts (e.g. in a cutscene) all objects are updated.
+    m_kart_xyz.clear();
+    if (world)
+    {
+        for (unsigned int i = 0; i < world->getNumKarts(); i++)
+            m_kart_xyz.push_back(world->getKart(i)->getXYZ());
+    }
+
+    const float interval = stk_config->m_object_reduced_interval;
+    const int num_phases = 8;
+    m_num_skipped = 0;
+    m_num_frozen  = 0;
+    unsigned int index = 0;
     TrackObject* curr;
     for_in (curr, m_all_objects)
     {
+        if (!m_kart_xyz.empty())
+            curr->setSimulationLevel(computeSimulationLevel(curr,
+                                                            m_kart_xyz));
         curr->update(dt);
+
+        if (curr->getSimulationLevel() == TrackObject::SIM_REDUCED)
+        {
+            const float phase = (index % num_phases) * interval / num_phases;
+            const int slot = interval > 0
+                           ? (int)floorf((world->getTime() + phase) / interval)
+                           : (int)index;
+            if (curr->isNewTimeSlot(slot))
+                curr->updateSimulation();
+            else
+                m_num_skipped++;
+        }
+        else if (curr->getSimulationLevel() == TrackObject::SIM_FROZEN)
+            m_num_frozen++;
+        index++;
     }
+    m_num_updates++;
+    m_total_skipped += m_num_skipped;
+    m_total_frozen  += m_num_frozen;
+
+    refitDriveableTree();
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Prints the average number of skipped and frozen objects per frame. */
+void TrackObjectManager::printStatistics() const
+{
+    const float n = m_num_updates > 0 ? (float)m_num_updates : 1.0f;
+    Log::verbose("TrackObjectManager",
+                 "%d objects, per frame on average %f skipped and %f frozen.",
+                 (int)m_all_objects.size(), m_total_skipped / n,
+                 m_total_frozen / n);
+    const float r = m_num_rays > 0 ? (float)m_num_rays : 1.0f;
+    Log::verbose("TrackObjectManager",
+                 "%d driveable objects (%d always tested), %d raycasts, "
+                 "on average %f objects tested per raycast.",
+                 (int)m_driveable_objects.size(),
+                 (int)m_unbounded_driveable.size(), m_num_rays,
+                 m_num_ray_tests / r);
+}   // printStatistics
+
 // ----------------------------------------------------------------------------
 /** Does a raycast against all driveable objects. This way part of the track
  *  can be a physical object, and can e.g. be animated. A separate list of all
@@ -158,6 +379,9 @@ void TrackObjectManager::update(float dt)
  *  mesh are the input parameter. It is then tested if the raycast against 
  *  a track object gives a 'closer' result. If so, the parameters hit_point,
  *  normal, and material will be updated.
+ *  Only the objects whose bounding box in m_driveable_tree is hit by the
+ *  ray are tested. They are tested in the same order as in the list of
+ *  driveable objects, so the result is the same as when testing all objects.
  *  \param from/to The from and to position for the raycast.
  *  \param xyz The position in world where the ray hit.
  *  \param material The material of the mesh that was hit.
@@ -182,28 +406,56 @@ void TrackObjectManager::castRay(const btVector3 &from,
     {
         distance = hit_point->distance(from);
     }
-    for (const TrackObject* curr : m_driveable_objects)
+    m_num_rays++;
+
+    m_ray_candidates = m_unbounded_driveable;
+    RayCandidateCollector collector(&m_ray_candidates);
+    btDbvt::rayTest(m_driveable_tree.m_root, from, to, collector);
+    std::sort(m_ray_candidates.begin(), m_ray_candidates.end());
+    for (unsigned int i = 0; i < m_ray_candidates.size(); i++)
     {
-        btVector3 new_hit_point;
-        const Material *new_material;
-        btVector3 new_normal;
-        if(curr->castRay(from, to, &new_hit_point, &new_material, &new_normal,
-                      interpolate_normal))
-        {
-            float new_distance = new_hit_point.distance(from);
-            // If the new hit is closer than the current hit, save
-            // the data.
-            if (new_distance < distance)
-            {
-                *material  = new_material;
-                *hit_point = new_hit_point;
-                *normal    = new_normal;
-                distance   = new_distance;
-            }   // if new_distance < distance
-        }   // if hit
-    }   // for all track objects.
+        castRayObject(m_ray_candidates[i], from, to, hit_point, material,
+                      normal, interpolate_normal, &distance);
+    }
 }   // castRay
 
+// ----------------------------------------------------------------------------
+/** Does a raycast against one driveable object, and updates the result
+ *  if the object is hit closer than the current hit.
+ *  \param index Index of the object in m_driveable_objects.
+ *  \param distance Distance of the current hit, updated if the object
+ *         is hit closer.
+ *  \return True if the result was updated.
+ */
+bool TrackObjectManager::castRayObject(int index, const btVector3 &from,
+                                       const btVector3 &to,
+                                       btVector3 *hit_point,
+                                       const Material **material,
+                                       btVector3 *normal,
+                                       bool interpolate_normal,
+                                       float *distance) const
+{
+    m_num_ray_tests++;
+    btVector3 new_hit_point;
+    const Material *new_material;
+    btVector3 new_normal;
+    if (!m_driveable_objects.get(index)->castRay(from, to, &new_hit_point,
+                                                 &new_material, &new_normal,
+                                                 interpolate_normal))
+        return false;
+
+    float new_distance = new_hit_point.distance(from);
+    // If the new hit is closer than the current hit, save the data.
+    if (new_distance >= *distance)
+        return false;
+
+    *material  = new_material;
+    *hit_point = new_hit_point;
+    *normal    = new_normal;
+    *distance  = new_distance;
+    return true;
+}   // castRayObject
+
 // ----------------------------------------------------------------------------
 /** Enables or disables fog for a given scene node.
  *  \param node The node to adjust.
@@ -275,6 +527,7 @@ void TrackObjectManager::enableFog(bool enable)
 void TrackObjectManager::insertObject(TrackObject* object)
 {
     m_all_objects.push_back(object);
+    addToIndex(object);
 }
 
 // ----------------------------------------------------------------------------
@@ -285,6 +538,29 @@ void TrackObjectManager::insertObject(TrackObject* object)
 void TrackObjectManager::removeObject(TrackObject* obj)
 {
     m_all_objects.remove(obj);
+
+    const std::string key = getObjectKey(obj);
+    std::unordered_map<std::string, TrackObject*>::iterator it =
+        m_object_index.find(key);
+    if (it != m_object_index.end() && it->second == obj)
+    {
+        m_object_index.erase(it);
+        // Another object with the same IDs can be found now
+        for (TrackObject* curr : m_all_objects)
+        {
+            if (getObjectKey(curr) == key)
+            {
+                m_object_index[key] = curr;
+                break;
+            }
+        }
+    }
+
+    if (obj->isDriveable())
+    {
+        m_driveable_objects.remove(obj);
+        buildDriveableTree();
+    }
     delete obj;
 }   // removeObject
 
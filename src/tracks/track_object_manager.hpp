@@ -23,6 +23,8 @@
 #include "tracks/track_object.hpp"
 #include "utils/ptr_vector.hpp"
 
+#include "BulletCollision/BroadphaseCollision/btDbvt.h"
+
 class Track;
 class Vec3;
 class XMLNode;
@@ -31,6 +33,7 @@ class LODNode;
 #include <map>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 /**
   * \ingroup tracks
@@ -51,6 +54,68 @@ protected:
     /** A second list which holds all objects that karts can drive on. */
     PtrVector<TrackObject, REF> m_driveable_objects;
 
+    /** All track objects indexed by the ID of their library instance and
+     *  their own ID (see getObjectKey), so that scripts can quickly find
+     *  objects. If several objects have the same IDs, the first one in
+     *  m_all_objects is stored. */
+    std::unordered_map<std::string, TrackObject*> m_object_index;
+
+    /** A bounding volume tree over the driveable objects, so that a raycast
+     *  only needs to test the objects whose bounding box is hit by the ray.
+     *  Each leaf stores the index of its object in m_driveable_objects. */
+    btDbvt m_driveable_tree;
+
+    /** The leaf of each driveable object in m_driveable_tree, or NULL if
+     *  the object must always be tested (objects without an exact mesh, and
+     *  objects simulated by bullet, which move all the time). */
+    std::vector<btDbvtNode*> m_driveable_leaves;
+
+    /** The transform each object in the tree had when its leaf was last
+     *  updated. Objects with a kinematic body can be moved by animations
+     *  and scripts, so the leaves of moved objects are updated once per
+     *  update (see refitDriveableTree). */
+    std::vector<btTransform> m_leaf_transforms;
+
+    /** Indices of the driveable objects that are always tested. */
+    std::vector<int> m_unbounded_driveable;
+
+    /** Indices of the objects to test for a ray, reused to avoid memory
+     *  allocations. */
+    mutable std::vector<int> m_ray_candidates;
+
+    /** Positions of all karts, used to decide which objects can be frozen
+     *  or updated at reduced rate. Reused to avoid memory allocations. */
+    std::vector<Vec3> m_kart_xyz;
+
+    /** Number of raycasts and of objects tested, for the statistics. */
+    mutable unsigned int m_num_rays;
+    mutable unsigned int m_num_ray_tests;
+
+    /** Number of objects that were not updated in the last frame because
+     *  they are updated at reduced rate. */
+    unsigned int m_num_skipped;
+
+    /** Number of objects that were frozen in the last frame. */
+    unsigned int m_num_frozen;
+
+    /** Number of updates, and sums of skipped and frozen objects over all
+     *  updates, used for the statistics in profile mode. */
+    unsigned int m_num_updates;
+    unsigned int m_total_skipped;
+    unsigned int m_total_frozen;
+
+    TrackObject::SimulationLevel
+         computeSimulationLevel(const TrackObject *object,
+                                const std::vector<Vec3> &kart_xyz) const;
+    static std::string getObjectKey(TrackObject *object);
+    void addToIndex(TrackObject *object);
+    void buildDriveableTree();
+    void refitDriveableTree();
+    bool castRayObject(int index, const btVector3 &from,
+                       const btVector3 &to, btVector3 *hit_point,
+                       const Material **material, btVector3 *normal,
+                       bool interpolate_normal, float *distance) const;
+
 public:
          TrackObjectManager();
         ~TrackObjectManager();
@@ -60,6 +125,7 @@ public:
              ModelDefinitionLoader& model_def_loader,
              TrackObject* parent_library);
     void update(float dt);
+    void printStatistics() const;
     void handleExplosion(const Vec3 &pos, const PhysicalObject *mp,
                          bool secondary_hits=true);
     void castRay(const btVector3 &from,
@@ -76,9 +142,19 @@ public:
 
     TrackObject* getTrackObject(const std::string& libraryInstance, const std::string& name);
 
+    static std::string getObjectKey(const std::string &library_instance,
+                                    const std::string &name);
+
           PtrVector<TrackObject>& getObjects()       { return m_all_objects; }
     const PtrVector<TrackObject>& getObjects() const { return m_all_objects; }
 
+    /** Returns the number of objects not updated in the last frame because
+     *  they are updated at reduced rate. */
+    unsigned int getNumSkipped() const { return m_num_skipped; }
+
+    /** Returns the number of objects frozen in the last frame. */
+    unsigned int getNumFrozen() const { return m_num_frozen; }
+
 };   // class TrackObjectManager
 
 #endif
@@ -680,7 +680,6 @@ TrackObjectPresentationSound::TrackObjectPresentationSound(
                                       rolloff,
                                       max_dist,
                                       volume);
-    buffer->load();
 
     m_sound = SFXManager::get()->createSoundSource(buffer, true, true);
     if (m_sound != NULL)
@@ -18,51 +18,129 @@
 
 #include "utils/random_generator.hpp"
 
+#include <assert.h>
 #include <stdlib.h>
-#include <ctime>
+#include <vector>
 
-std::vector<RandomGenerator*> RandomGenerator::m_all_random_generators;
+uint32_t RandomGenerator::m_race_seed = 0;
 
+// ----------------------------------------------------------------------------
+/** Creates a generator that is seeded from rand() (which is seeded with the
+ *  time at startup), i.e. it gives different numbers each time the game is
+ *  started. Generators used by the simulation must call seedForRace.
+ */
 RandomGenerator::RandomGenerator()
 {
-    m_a = 1103515245;
-    m_c = 12345;
-    m_all_random_generators.push_back(this);
-    m_random_value = 3141591;
+    seed((uint64_t(rand()) << 32) ^ uint64_t(rand()));
 }   // RandomGenerator
 
 // ----------------------------------------------------------------------------
-std::vector<int> RandomGenerator::generateAllSeeds()
+/** SplitMix64, used to turn a seed into a well mixed state (the state of
+ *  xoroshiro must not be all zero).
+ *  \param x The state of the splitmix generator, which is updated.
+ */
+uint64_t RandomGenerator::splitMix64(uint64_t *x)
 {
-    std::vector<int> all_seeds;
-    for(unsigned int i=0; i<m_all_random_generators.size(); i++)
-    {
-        int seed = rand();
-        all_seeds.push_back(seed);
-        m_all_random_generators[i]->seed(seed);
-    }
-    return all_seeds;
-}   // generateAllSeeds
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}   // splitMix64
+
+// ----------------------------------------------------------------------------
+/** Seeds this generator.
+ *  \param s The seed.
+ */
+void RandomGenerator::seed(uint64_t s)
+{
+    m_state[0] = splitMix64(&s);
+    m_state[1] = splitMix64(&s);
+}   // seed
 
-#if 0
+// ----------------------------------------------------------------------------
+/** Seeds this generator for a stream of random numbers of the simulation.
+ *  All generators seeded with the same race seed, stream and id return
+ *  the same numbers.
+ *  \param stream The stream this generator is used for.
+ *  \param id Additional id to split the stream, e.g. the world kart id.
+ */
+void RandomGenerator::seedForRace(RandomStream stream, unsigned int id)
+{
+    seed(  (uint64_t(m_race_seed) << 32)
+         ^ (uint64_t(stream) << 24) ^ uint64_t(id));
+}   // seedForRace
+
+// ----------------------------------------------------------------------------
+/** Returns a 32 bit pseudo random number. The upper bits of xoroshiro128+
+ *  are used, since the lowest bits are of lower quality.
+ */
+uint32_t RandomGenerator::getUInt32()
+{
+    const uint64_t s0 = m_state[0];
+    uint64_t s1       = m_state[1];
+    const uint64_t result = s0 + s1;
+    s1 ^= s0;
+    m_state[0] = ((s0 << 24) | (s0 >> 40)) ^ s1 ^ (s1 << 16);
+    m_state[1] = (s1 << 37) | (s1 >> 27);
+    return uint32_t(result >> 32);
+}   // getUInt32
 
 // ----------------------------------------------------------------------------
-int RandomGenerator::get(int n)
+/** Tests that the streams are reproducible and independent of each other.
+ *  That a whole race is reproducible is tested by running the same race
+ *  twice, see tools/check_race_reproducibility.sh.
+ */
+void RandomGenerator::unitTesting()
 {
-    // This generator is (currently) not good enough, i.e. it often gives
-    // long sequences of same numbers. And the seeding is not done (the
-    // mid term goal is to synchronise all random number generators on
-    // client and server to make less communication necessary).
-    // For now: just use standard random numbers:
-    return rand() % n;
-#ifdef NOT_USED_ATM
-    m_random_value = m_random_value*m_a+m_c;
-    // Note: the lower bits can have a very short cycle, e.g. for n = 4 the
-    // cycle length is 4, meaning that the same sequence 1,2,3,4 is repeated
-    // over and over again. The higher bits are more random, so the lower
-    // 8 bits are discarded.
-    return (m_random_value >> 8) % n;
-#endif
-}   // get
+    const uint32_t old_race_seed = m_race_seed;
+
+    // The same seed gives the same numbers.
+    RandomGenerator a, b;
+    a.seed(1234);
+    b.seed(1234);
+    for (unsigned int i = 0; i < 1000; i++)
+        assert(a.getUInt32() == b.getUInt32());
+
+    // Restoring the state repeats the numbers (as after a rewind).
+    const uint64_t s0 = a.getState(0), s1 = a.getState(1);
+    std::vector<uint32_t> numbers;
+    for (unsigned int i = 0; i < 100; i++)
+        numbers.push_back(a.getUInt32());
+    a.setState(s0, s1);
+    for (unsigned int i = 0; i < 100; i++)
+        assert(a.getUInt32() == numbers[i]);
+
+    // Different streams and ids give different numbers.
+    setRaceSeed(42);
+    a.seedForRace(RS_POWERUP, 0);
+    b.seedForRace(RS_POWERUP, 1);
+    RandomGenerator c;
+    c.seedForRace(RS_ATTACHMENT, 0);
+    unsigned int num_same_ab = 0, num_same_ac = 0;
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        const uint32_t r = a.getUInt32();
+        if (r == b.getUInt32()) num_same_ab++;
+        if (r == c.getUInt32()) num_same_ac++;
+    }
+    assert(num_same_ab == 0 && num_same_ac == 0);
+
+    // The numbers are in range and roughly uniform.
+    unsigned int count[10] = { 0 };
+    for (unsigned int i = 0; i < 100000; i++)
+    {
+        const int n = a.get(10);
+        assert(n >= 0 && n < 10);
+        count[n]++;
+    }
+    for (unsigned int i = 0; i < 10; i++)
+        assert(count[i] > 9000 && count[i] < 11000);
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        const float f = a.getFloat();
+        assert(f >= 0.0f && f < 1.0f);
+        (void)f;   // avoid compiler warning with NDEBUG
+    }
 
-#endif // if 0
+    m_race_seed = old_race_seed;
+}   // unitTesting
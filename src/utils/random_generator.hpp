@@ -19,31 +19,71 @@
 #ifndef HEADER_RANDOM_GENERATOR_HPP
 #define HEADER_RANDOM_GENERATOR_HPP
 
-#include <algorithm>
-#include <vector>
-#include <stdlib.h>
+#include "utils/types.hpp"
 
 /** A random number generator. Each objects that needs a random number uses
-    its own number random generator. They are all seeded with number provided
-    by the server. This guarantees that in a network game all 'random' values
-    are actually identical among all machines.
-    The formula used is x(n+1)=(a*x(n)+c) % m, but m is assumed to be 2^32,
-    so the modulo operation can be skipped (for 4 byte integers).
+    its own number random generator. All generators used by the simulation
+    of a race are seeded with seedForRace, which derives the seed from the
+    seed of the race (provided by the server in a network game) and the
+    stream of random numbers the generator is used for. This guarantees that
+    in a network game all 'random' values are actually identical among all
+    machines, and that a race with the same seed and inputs is simulated
+    the same way. Generators which are not used by the simulation (e.g. in
+    the GUI) are seeded differently each time the game is started.
+    The generator is xoroshiro128+, which only needs 16 bytes of state. The
+    state is part of the rewind state of the objects using it.
  */
 class RandomGenerator
 {
+public:
+    /** The streams of random numbers used by the simulation. Each stream
+     *  can be split further with the id parameter of seedForRace, e.g. to
+     *  give each kart its own stream. */
+    enum RandomStream { RS_ITEMS = 1,   // Random items in arenas
+                        RS_POWERUP,     // Powerups from bonus boxes
+                        RS_ATTACHMENT,  // Attachments from bonus boxes
+                        RS_AI,          // Decisions of the AI
+                        RS_WORLD,       // Decisions of the game mode
+                        RS_KART         // Effects of hits on a kart
+                      };
+
 private:
-    unsigned int m_random_value;
-    unsigned int m_a, m_c;
-    static std::vector<RandomGenerator*> m_all_random_generators;
+    /** The state of the generator. */
+    uint64_t m_state[2];
+
+    /** The seed of the current race. */
+    static uint32_t m_race_seed;
+
+    static uint64_t splitMix64(uint64_t *x);
 
 public:
     RandomGenerator();
-
-    std::vector<int> generateAllSeeds();
+    void     seed(uint64_t s);
+    void     seedForRace(RandomStream stream, unsigned int id=0);
+    uint32_t getUInt32();
+    static void unitTesting();
+    // ------------------------------------------------------------------------
     /** Returns a pseudo random number between 0 and n-1 inclusive */
-    int  get(int n)  {return rand() % n; }
-    void seed(int s) {m_random_value = s;}
+    int  get(int n)  { return int((uint64_t(getUInt32()) * n) >> 32); }
+    // ------------------------------------------------------------------------
+    /** Returns a pseudo random number in [0, 1). */
+    float getFloat() { return (getUInt32() >> 8) * (1.0f / 16777216.0f); }
+    // ------------------------------------------------------------------------
+    /** Returns the i-th 64 bit word of the state (i = 0 or 1). */
+    uint64_t getState(int i) const                    { return m_state[i]; }
+    // ------------------------------------------------------------------------
+    /** Restores a state returned by getState. */
+    void setState(uint64_t s0, uint64_t s1)
+    {
+        m_state[0] = s0;
+        m_state[1] = s1;
+    }   // setState
+    // ------------------------------------------------------------------------
+    /** Sets the seed of the race, which is used by seedForRace. */
+    static void setRaceSeed(uint32_t seed)             { m_race_seed = seed; }
+    // ------------------------------------------------------------------------
+    /** Returns the seed of the current race. */
+    static uint32_t getRaceSeed()                       { return m_race_seed; }
 };  // RandomGenerator
 
 #endif // HEADER_RANDOM_GENERATOR_HPP
@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# Runs the same race twice without graphics, using the same random seed,
+# and compares the saved histories (the controls, positions and rotations
+# of all karts in each frame). Any difference means that the race is not
+# reproducible, e.g. because something still uses rand() instead of a
+# random generator seeded for the race. Hits on karts (explosions and
+# bubblegum) use random numbers as well, so the test fails if the race had
+# no such hits: the defaults use a short track with many AI karts, which
+# fire a lot at each other.
+# Run it from the root directory of the repository:
+#     tools/check_race_reproducibility.sh [supertuxkart executable]
+# The track, number of karts, laps and seed can be set with TRACK,
+# NUMKARTS, LAPS and SEED.
+
+STK=${1:-cmake_build/bin/supertuxkart}
+TRACK=${TRACK:-lighthouse}
+NUMKARTS=${NUMKARTS:-12}
+LAPS=${LAPS:-3}
+SEED=${SEED:-1234}
+
+TMPDIR=`mktemp -d`
+
+for run in 1 2; do
+    echo "Race $run: track $TRACK, $NUMKARTS karts, $LAPS laps, seed $SEED"
+    rm -f history.dat
+    "$STK" --no-graphics --profile-laps="$LAPS" --track="$TRACK"      \
+           --numkarts="$NUMKARTS" --seed="$SEED" --profile-save-history \
+           > "$TMPDIR/stdout$run.txt" 2>&1
+    if [ ! -f history.dat ]; then
+        echo "No history.dat was saved, see $TMPDIR/stdout$run.txt."
+        exit 1
+    fi
+    mv history.dat "$TMPDIR/history$run.dat"
+done
+
+# The number of hits is printed as 'Hits: <explosions> explosions
+# <bubblegums> bubblegums'.
+hits=`grep -o "Hits: [0-9]* explosions [0-9]* bubblegums" "$TMPDIR/stdout1.txt"`
+explosions=`echo "$hits" | awk '{print $2}'`
+bubblegums=`echo "$hits" | awk '{print $4}'`
+echo "$hits"
+if [ -z "$hits" ] || [ "$explosions" = "0" ] || [ "$bubblegums" = "0" ]; then
+    echo "The race needs explosions and bubblegum hits, use more karts"
+    echo "or laps, or a different SEED or TRACK."
+    exit 1
+fi
+
+if cmp -s "$TMPDIR/history1.dat" "$TMPDIR/history2.dat"; then
+    echo "The races are identical."
+    rm -rf "$TMPDIR"
+else
+    echo "The races differ:"
+    diff "$TMPDIR/history1.dat" "$TMPDIR/history2.dat" | head -20
+    echo "The histories are in $TMPDIR."
+    exit 1
+fi